@@ -0,0 +1,268 @@
+#include "Bind.h"
+
+#include <algorithm>
+
+namespace
+{
+// Returns the first descriptor with a hash, or the end of the table if there is none
+Msxmlx::FieldDescriptor const * findHash(Msxmlx::FieldDescriptor const * pFields, size_t count, uint32_t hash)
+{
+    Msxmlx::FieldDescriptor const * pEnd = pFields + count;
+    Msxmlx::FieldDescriptor const * p    = std::lower_bound(pFields, pEnd, hash,
+        [] (Msxmlx::FieldDescriptor const & field, uint32_t h) { return field.hash < h; });
+    return (p != pEnd && p->hash == hash) ? p : pEnd;
+}
+
+// Returns true if UTF-8 text is the same as wide text
+bool equalsWide(std::string_view narrow, wchar_t const * wide, size_t length)
+{
+    // Attribute names are almost always ASCII, so compare directly unless a character is not
+    if (narrow.size() == length)
+    {
+        size_t i = 0;
+        while (i < length && uint32_t(wide[i]) < 0x80 && uint8_t(narrow[i]) < 0x80 && wchar_t(narrow[i]) == wide[i])
+        {
+            ++i;
+        }
+        if (i == length)
+            return true;
+        if (uint32_t(wide[i]) < 0x80 && uint8_t(narrow[i]) < 0x80)
+            return false;
+    }
+
+    std::string converted;
+    Msxmlx::ToUtf8(std::wstring_view(wide, length), converted);
+    return converted == narrow;
+}
+
+// Returns the first non-whitespace text or CDATA of the reader's current element, or an empty string if it has none,
+// as with GetSubElementValue(). References are expanded, using the string if necessary. The reader is left within
+// the element.
+std::string_view readText(Msxmlx::Reader & reader, std::string & expanded)
+{
+    using Token = Msxmlx::Reader::Token;
+
+    if (reader.IsEmptyElement())
+        return std::string_view();
+
+    int depth = reader.Depth();
+    for (Token t = reader.Next(); t != Token::End && t != Token::Error; t = reader.Next())
+    {
+        if (t == Token::EndElement && reader.Depth() == depth)
+            break;
+        if (reader.Depth() != depth + 1)
+            continue;
+
+        if (t == Token::CData)
+            return reader.Value();
+
+        if (t == Token::Text && !Msxmlx::TrimWhitespace(reader.Value()).empty())
+        {
+            std::string_view value = reader.Value();
+            if (value.find('&') == std::string_view::npos)
+                return value;
+
+            expanded.clear();
+            Msxmlx::Unescape(value, expanded);
+            return expanded;
+        }
+    }
+    return std::string_view();
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    pFields    The descriptors, sorted by hash
+//! @param    count      Number of descriptors
+//! @param    name       Name of the attribute
+//!
+//! @return        The descriptor with the name, or nullptr if there is none
+
+FieldDescriptor const * FindField(FieldDescriptor const * pFields, size_t count, std::string_view name)
+{
+    uint32_t hash = Name::Hash(name);
+    for (FieldDescriptor const * p = findHash(pFields, count, hash); p < pFields + count && p->hash == hash; ++p)
+    {
+        if (p->name == name)
+            return p;
+    }
+    return nullptr;
+}
+
+//! @param    pFields    The descriptors, sorted by hash
+//! @param    count      Number of descriptors
+//! @param    name       Name of the attribute
+//! @param    length     Number of characters in the name
+//!
+//! @return        The descriptor with the name, or nullptr if there is none
+
+FieldDescriptor const * FindField(FieldDescriptor const * pFields, size_t count, wchar_t const * name, size_t length)
+{
+    uint32_t hash = Name::Hash(name, length);
+    for (FieldDescriptor const * p = findHash(pFields, count, hash); p < pFields + count && p->hash == hash; ++p)
+    {
+        if (equalsWide(p->name, name, length))
+            return p;
+    }
+    return nullptr;
+}
+
+//! The attributes are enumerated once. Values containing references are expanded before they are converted.
+//!
+//! @param    reader     The reader, positioned on a start tag
+//! @param    pObject    The object to receive the values
+//! @param    pFields    The field descriptors, sorted by hash
+//! @param    count      Number of descriptors
+//!
+//! @return        false, if the value of any bound attribute was invalid
+
+bool BindAttributes(Reader const & reader, void * pObject, FieldDescriptor const * pFields, size_t count)
+{
+    if (reader.Current() != Reader::Token::StartElement)
+        return true;
+
+    bool        valid = true;
+    std::string expanded;
+    for (Attribute const & attribute : reader.Attributes())
+    {
+        FieldDescriptor const * pField = FindField(pFields, count, attribute.name);
+        if (!pField)
+            continue;
+
+        std::string_view value = attribute.value;
+        if (value.find('&') != std::string_view::npos)
+        {
+            expanded.clear();
+            Unescape(value, expanded);
+            value = expanded;
+        }
+        if (!pField->set(pObject, value))
+            valid = false;
+    }
+    return valid;
+}
+
+//! @param    document    The document
+//! @param    element     The element whose attributes are to be stored
+//! @param    pObject     The object to receive the values
+//! @param    pFields     The field descriptors, sorted by hash
+//! @param    count       Number of descriptors
+//!
+//! @return        false, if the value of any bound attribute was invalid
+
+bool BindAttributes(CompactDocument const & document,
+                    CompactDocument::Index  element,
+                    void *                  pObject,
+                    FieldDescriptor const * pFields,
+                    size_t                  count)
+{
+    bool                        valid      = true;
+    CompactDocument::Attributes attributes = document.GetAttributes(element);
+    for (uint32_t i = attributes.first; i < attributes.first + attributes.count; ++i)
+    {
+        FieldDescriptor const * pField = FindField(pFields, count, document.AttributeName(i));
+        if (pField && !pField->set(pObject, document.AttributeValue(i)))
+            valid = false;
+    }
+    return valid;
+}
+
+//! The attributes and the children of the element are each enumerated once. A sub-element bound to a struct with a
+//! Schema is deserialized recursively.
+//!
+//! @param    reader            The reader, positioned on a start tag. It is left on the matching end tag.
+//! @param    pObject           The object to receive the values
+//! @param    pFields           The field descriptors (see Binding::Data())
+//! @param    attributeCount    Number of attribute descriptors
+//! @param    count             Number of descriptors
+//!
+//! @return        false, if the value of any bound attribute or sub-element was invalid or the element is not
+//!                well-formed
+
+bool DeserializeElement(Reader &                reader,
+                        void *                  pObject,
+                        FieldDescriptor const * pFields,
+                        size_t                  attributeCount,
+                        size_t                  count)
+{
+    if (reader.Current() != Reader::Token::StartElement)
+        return false;
+
+    bool valid = BindAttributes(reader, pObject, pFields, attributeCount);
+    if (attributeCount == count)
+    {
+        reader.Skip();
+        return valid && reader.Current() == Reader::Token::EndElement;
+    }
+
+    FieldDescriptor const * pSubElements    = pFields + attributeCount;
+    size_t                  subElementCount = count - attributeCount;
+    std::string             expanded;
+
+    bool wellFormed = reader.ForEachSubElement([&] (Reader & child) {
+        FieldDescriptor const * pField = FindField(pSubElements, subElementCount, child.Name());
+        if (!pField)
+            return true;
+
+        if (pField->kind == FieldKind::Nested)
+        {
+            if (!DeserializeElement(child, pField->target(pObject), pField->pFields, pField->attributeCount,
+                                    pField->count))
+                valid = false;
+        }
+        else if (!pField->set(pObject, readText(child, expanded)))
+        {
+            valid = false;
+        }
+        return child.Current() != Reader::Token::Error;
+    });
+
+    return wellFormed && valid;
+}
+
+//! The attributes and the children of the element are each enumerated once. A sub-element bound to a struct with a
+//! Schema is deserialized recursively.
+//!
+//! @param    document          The document
+//! @param    element           The element to deserialize
+//! @param    pObject           The object to receive the values
+//! @param    pFields           The field descriptors (see Binding::Data())
+//! @param    attributeCount    Number of attribute descriptors
+//! @param    count             Number of descriptors
+//!
+//! @return        false, if the value of any bound attribute or sub-element was invalid
+
+bool DeserializeElement(CompactDocument const & document,
+                        CompactDocument::Index  element,
+                        void *                  pObject,
+                        FieldDescriptor const * pFields,
+                        size_t                  attributeCount,
+                        size_t                  count)
+{
+    bool valid = BindAttributes(document, element, pObject, pFields, attributeCount);
+
+    FieldDescriptor const * pSubElements    = pFields + attributeCount;
+    size_t                  subElementCount = count - attributeCount;
+
+    document.ForEachSubElement(element, [&] (CompactDocument::Index child) {
+        FieldDescriptor const * pField = FindField(pSubElements, subElementCount, document.Name(child));
+        if (!pField)
+            return true;
+
+        if (pField->kind == FieldKind::Nested)
+        {
+            if (!DeserializeElement(document, child, pField->target(pObject), pField->pFields, pField->attributeCount,
+                                    pField->count))
+                valid = false;
+        }
+        else if (!pField->set(pObject, document.Value(child)))
+        {
+            valid = false;
+        }
+        return true;
+    });
+
+    return valid;
+}
+} // namespace Msxmlx
@@ -0,0 +1,1332 @@
+#include "CompactDocument.h"
+
+#include "Convert.h"
+#include "Reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <process.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Largest number of elements, attributes, names or bytes of string that can be indexed
+size_t const MAX_SIZE = 0xfffffffe;
+
+// Identifies a snapshot
+char const SNAPSHOT_MAGIC[8] = { 'M', 'S', 'X', 'M', 'L', 'X', 'C', 'D' };
+
+// Version of the snapshot format. It changes whenever the layout of the arena changes.
+uint32_t const SNAPSHOT_VERSION = 1;
+
+// Written in native byte order, so a snapshot made on a machine with the other byte order is rejected
+uint32_t const SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// The start of a snapshot. The arena follows it, so the arrays in the arena are aligned if the snapshot is.
+struct SnapshotHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeCount;
+    uint32_t attributeCount;
+    uint32_t nameCount;
+    uint32_t poolSize;
+};
+
+static_assert(sizeof(SnapshotHeader) % alignof(uint32_t) == 0, "The arena must be aligned");
+
+// Returns the size of the arena for the given counts
+size_t arenaSize(size_t nodeCount, size_t attributeCount, size_t nameCount, size_t poolSize)
+{
+    size_t indexCount = nodeCount * 6 + (nodeCount + 1) + attributeCount * 3 + nameCount * 2;
+    return indexCount * sizeof(uint32_t) + poolSize;
+}
+
+// Returns true if a string is within a pool
+bool inPool(uint32_t offset, uint32_t length, size_t poolSize)
+{
+    return offset == Msxmlx::CompactDocument::NONE || uint64_t(offset) + length <= poolSize;
+}
+
+// Returns true if an index is NONE or a later element
+bool isLater(uint32_t index, size_t element, size_t nodeCount)
+{
+    return index == Msxmlx::CompactDocument::NONE || (index > element && index < nodeCount);
+}
+
+// Writes a file and flushes it to the device, returning false on failure
+bool writeDurably(char const * sPath, std::string const & data)
+{
+#if defined(_WIN32)
+    int fd = _open(sPath, _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = open(sPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+#endif
+    if (fd < 0)
+        return false;
+
+    char const * p    = data.data();
+    size_t       size = data.size();
+    bool         ok   = true;
+    while (ok && size > 0)
+    {
+#if defined(_WIN32)
+        int n = _write(fd, p, unsigned(std::min(size, size_t(INT_MAX))));
+#else
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+#endif
+        ok = n > 0;
+        if (ok)
+        {
+            p += n;
+            size -= size_t(n);
+        }
+    }
+
+#if defined(_WIN32)
+    ok = ok && _commit(fd) == 0;
+    return (_close(fd) == 0) && ok;
+#else
+    ok = ok && fsync(fd) == 0;
+    return (close(fd) == 0) && ok;
+#endif
+}
+
+// Replaces a file with another, atomically
+bool replaceFile(char const * sSource, char const * sTarget)
+{
+#if defined(_WIN32)
+    return MoveFileExA(sSource, sTarget, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(sSource, sTarget) == 0;
+#endif
+}
+
+// Copies an array into the arena
+template <typename T>
+void copy(std::vector<T> const & v, std::byte *& next)
+{
+    if (!v.empty())
+        memcpy(next, v.data(), v.size() * sizeof(T));
+    next += v.size() * sizeof(T);
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! The text is not referenced once the document has been parsed.
+//!
+//! @param    text    The text to parse
+//!
+//! @return        true, if the document was parsed successfully
+
+bool CompactDocument::Parse(std::string_view text)
+{
+    *this = CompactDocument();
+
+    Builder builder;
+    Reader  reader(text);
+    for (Reader::Token t = reader.Next(); t != Reader::Token::End; t = reader.Next())
+    {
+        bool ok = true;
+        switch (t)
+        {
+        case Reader::Token::StartElement:
+            ok = builder.StartElement(reader.Name(), reader.Attributes());
+            break;
+
+        case Reader::Token::EndElement:
+            builder.EndElement();
+            break;
+
+        case Reader::Token::Text:
+        case Reader::Token::CData:
+            ok = builder.Text(reader.Value(), t == Reader::Token::CData, false);
+            break;
+
+        default:
+            error_       = reader.ErrorMessage();
+            errorOffset_ = reader.Offset();
+            return false;
+        }
+
+        if (!ok)
+        {
+            error_       = builder.ErrorMessage();
+            errorOffset_ = reader.Offset();
+            return false;
+        }
+    }
+
+    if (!builder.Finish(*this))
+    {
+        error_       = builder.ErrorMessage();
+        errorOffset_ = reader.Offset();
+        return false;
+    }
+    return true;
+}
+
+//! The snapshot is a header followed by a copy of the document's arrays and string pool. Since the arrays contain
+//! indices and offsets rather than pointers, the snapshot can be loaded at any address. It is only valid on machines
+//! with the same byte order, and only for the same version of the format.
+//!
+//! @return        The snapshot, or an empty string if there is no document
+
+std::string CompactDocument::Snapshot() const
+{
+    if (nodeCount_ == 0)
+        return std::string();
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version        = SNAPSHOT_VERSION;
+    header.byteOrder      = SNAPSHOT_BYTE_ORDER;
+    header.nodeCount      = uint32_t(nodeCount_);
+    header.attributeCount = firstAttribute_[nodeCount_];
+    header.nameCount      = uint32_t(nameCount_);
+    header.poolSize       = uint32_t(arenaSize_ - arenaSize(nodeCount_, header.attributeCount, nameCount_, 0));
+
+    std::string image;
+    image.reserve(sizeof(header) + arenaSize_);
+    image.append(reinterpret_cast<char const *>(&header), sizeof(header));
+    image.append(reinterpret_cast<char const *>(parent_), arenaSize_);
+    return image;
+}
+
+//! A snapshot file is mapped by the processes that load it, so it is never rewritten in place. The snapshot is
+//! written to a new file in the same directory, flushed to the device, and then renamed over the file. A process that
+//! has the old file mapped continues to see the old snapshot.
+//!
+//! @param    sPath    Path of the file to write. It is replaced if it exists.
+//!
+//! @return        true, if the snapshot was written
+
+bool CompactDocument::SaveSnapshot(char const * sPath) const
+{
+    static std::atomic<unsigned> s_next{ 0 };
+
+    std::string image = Snapshot();
+    if (image.empty())
+        return false;
+
+#if defined(_WIN32)
+    int process = _getpid();
+#else
+    int process = int(getpid());
+#endif
+    std::string temporary = std::string(sPath) + ".tmp" + std::to_string(process) + "." + std::to_string(s_next++);
+    if (!writeDurably(temporary.c_str(), image) || !replaceFile(temporary.c_str(), sPath))
+    {
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+//! Every index and string offset in the snapshot is checked in one pass over its arrays, so a corrupt or hostile
+//! snapshot is rejected instead of causing reads outside of it. Nothing is parsed or copied. The current contents of
+//! the document are replaced even if the snapshot is not valid.
+//!
+//! @param    pData    The snapshot. It must be aligned to 4 bytes.
+//! @param    size     Size of the snapshot
+//!
+//! @return        true, if the snapshot was loaded
+
+bool CompactDocument::LoadSnapshot(void const * pData, size_t size)
+{
+    if (!LoadTrustedSnapshot(pData, size))
+        return false;
+
+    if (!validate())
+    {
+        *this  = CompactDocument();
+        error_ = "Snapshot is truncated or corrupt";
+        return false;
+    }
+    return true;
+}
+
+//! Only the header is checked, so loading takes constant time regardless of the size of the document. The contents
+//! are trusted to be a snapshot made by Snapshot(), so this must only be used for snapshots that cannot have been
+//! corrupted or tampered with, such as one just made by this process. The current contents of the document are
+//! replaced even if the snapshot is not valid.
+//!
+//! @param    pData    The snapshot. It must be aligned to 4 bytes.
+//! @param    size     Size of the snapshot
+//!
+//! @return        true, if the header of the snapshot is valid
+
+bool CompactDocument::LoadTrustedSnapshot(void const * pData, size_t size)
+{
+    *this = CompactDocument();
+
+    SnapshotHeader header;
+    if (size < sizeof(header))
+    {
+        error_ = "Not a snapshot";
+        return false;
+    }
+    memcpy(&header, pData, sizeof(header));
+
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+    {
+        error_ = "Not a snapshot";
+        return false;
+    }
+    if (header.byteOrder != SNAPSHOT_BYTE_ORDER || header.version != SNAPSHOT_VERSION)
+    {
+        error_ = "Unsupported snapshot version";
+        return false;
+    }
+    if (header.nodeCount == 0 ||
+        size - sizeof(header) != arenaSize(header.nodeCount, header.attributeCount, header.nameCount, header.poolSize))
+    {
+        error_ = "Snapshot is truncated or corrupt";
+        return false;
+    }
+    if (reinterpret_cast<uintptr_t>(pData) % alignof(uint32_t) != 0)
+    {
+        error_ = "Snapshot is not aligned";
+        return false;
+    }
+
+    arenaSize_ = size - sizeof(header);
+    nodeCount_ = header.nodeCount;
+    nameCount_ = header.nameCount;
+    place(static_cast<std::byte const *>(pData) + sizeof(header), header.attributeCount);
+    return true;
+}
+
+//! @param    sPath    Path of the snapshot file
+//!
+//! @return        true, if the snapshot was loaded
+
+bool CompactDocument::LoadSnapshot(char const * sPath)
+{
+    MappedFile file(sPath);
+    if (!file.IsOpen())
+    {
+        *this  = CompactDocument();
+        error_ = "The snapshot could not be opened";
+        return false;
+    }
+
+    if (!LoadSnapshot(file.Data(), file.Size()))
+        return false;
+
+    file_ = std::move(file);
+    return true;
+}
+
+//! @param    element    Element to query
+//!
+//! @return        The attributes of the element (empty if element is NONE)
+
+CompactDocument::Attributes CompactDocument::GetAttributes(Index element) const
+{
+    if (element == NONE)
+        return Attributes{ 0, 0 };
+    return Attributes{ firstAttribute_[element], firstAttribute_[element + 1] - firstAttribute_[element] };
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//!
+//! @return        The first sub-element with the name, or NONE if not found
+
+CompactDocument::Index CompactDocument::GetSubElement(Index element, std::string_view sName) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    if (element == NONE)
+        return NONE;
+
+    uint32_t id = FindName(sName);
+    if (id == NONE)
+        return NONE;
+
+    for (Index child = firstChild_[element]; child != NONE; child = nextSibling_[child])
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (nameId_[child] == id)
+            return child;
+    }
+    return NONE;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//!
+//! @return        The attributes of the sub-element, or no attributes if the sub-element is not found
+
+CompactDocument::Attributes CompactDocument::GetSubElementAttributes(Index element, std::string_view sName) const
+{
+    return GetAttributes(GetSubElement(element, sName));
+}
+
+//! @param    attributes    Attributes to search
+//! @param    sName         Name of the attribute
+//! @param    value         Location to put the value
+//!
+//! @return        true, if the attribute is present
+
+bool CompactDocument::FindAttribute(Attributes attributes, std::string_view sName, std::string_view & value) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    if (attributes.count == 0)
+        return false;
+
+    uint32_t id = FindName(sName);
+    if (id == NONE)
+        return false;
+
+    for (uint32_t i = attributes.first; i < attributes.first + attributes.count; ++i)
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (attributeName_[i] == id)
+        {
+            value = AttributeValue(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    sDefault    Value to return if the attribute is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the attribute
+
+std::string CompactDocument::GetStringAttribute(Index            element,
+                                                std::string_view sName,
+                                                char const *     sDefault /* = ""*/) const
+{
+    return GetStringAttribute(GetAttributes(element), sName, sDefault);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    sDefault      Value to return if the attribute is not present. The default default value is an empty
+//!                         string.
+//!
+//! @return        The value of the attribute
+
+std::string CompactDocument::GetStringAttribute(Attributes       attributes,
+                                                std::string_view sName,
+                                                char const *     sDefault /* = ""*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view value;
+    if (!FindAttribute(attributes, sName, value))
+        value = sDefault;
+    Instrumentation::Add(Instrumentation::Counter::ALLOCATED, value.size());
+    return std::string(value);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    fDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to a float
+
+float CompactDocument::GetFloatAttribute(Index element, std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    return GetFloatAttribute(GetAttributes(element), sName, fDefault);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    fDefault      Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to a float
+
+float CompactDocument::GetFloatAttribute(Attributes attributes, std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    float            value = fDefault;
+    if (FindAttribute(attributes, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseFloat(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to an int
+
+int CompactDocument::GetIntAttribute(Index element, std::string_view sName, int iDefault /* = 0*/) const
+{
+    return GetIntAttribute(GetAttributes(element), sName, iDefault);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    iDefault      Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to an int
+
+int CompactDocument::GetIntAttribute(Attributes attributes, std::string_view sName, int iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    int              value = iDefault;
+    if (FindAttribute(attributes, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseInt(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted from hex to an unsigned int
+
+uint32_t CompactDocument::GetHexAttribute(Index element, std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    return GetHexAttribute(GetAttributes(element), sName, iDefault);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    iDefault      Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted from hex to an unsigned int
+
+uint32_t CompactDocument::GetHexAttribute(Attributes       attributes,
+                                          std::string_view sName,
+                                          uint32_t         iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    uint32_t         value = iDefault;
+    if (FindAttribute(attributes, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseHex(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    bDefault    Value to return if the attribute is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the attribute converted to a bool
+
+bool CompactDocument::GetBoolAttribute(Index element, std::string_view sName, bool bDefault /* = false*/) const
+{
+    return GetBoolAttribute(GetAttributes(element), sName, bDefault);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    bDefault      Value to return if the attribute is not present or invalid. The default default value is
+//!                         false.
+//!
+//! @return        The value of the attribute converted to a bool
+
+bool CompactDocument::GetBoolAttribute(Attributes attributes, std::string_view sName, bool bDefault /* = false*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    bool             value = bDefault;
+    if (FindAttribute(attributes, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseBool(text, value);
+    }
+    return value;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    values     The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool CompactDocument::GetFloatArrayAttribute(Index element, std::string_view sName, std::vector<float> & values) const
+{
+    return GetFloatArrayAttribute(GetAttributes(element), sName, values);
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the document.
+//!
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    values        The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool CompactDocument::GetFloatArrayAttribute(Attributes           attributes,
+                                             std::string_view     sName,
+                                             std::vector<float> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    if (!FindAttribute(attributes, sName, text))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseFloatArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool CompactDocument::GetFloatArrayAttribute(Index            element,
+                                             std::string_view sName,
+                                             float *          pValues,
+                                             size_t &         count) const
+{
+    return GetFloatArrayAttribute(GetAttributes(element), sName, pValues, count);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    pValues       The array to receive the values
+//! @param    count         On input, the size of the array. On output, the number of values (even if they do not all
+//!                         fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool CompactDocument::GetFloatArrayAttribute(Attributes       attributes,
+                                             std::string_view sName,
+                                             float *          pValues,
+                                             size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    if (!FindAttribute(attributes, sName, text))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseFloatArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    values     The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool CompactDocument::GetIntArrayAttribute(Index element, std::string_view sName, std::vector<int> & values) const
+{
+    return GetIntArrayAttribute(GetAttributes(element), sName, values);
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the document.
+//!
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    values        The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool CompactDocument::GetIntArrayAttribute(Attributes         attributes,
+                                           std::string_view   sName,
+                                           std::vector<int> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    if (!FindAttribute(attributes, sName, text))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseIntArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool CompactDocument::GetIntArrayAttribute(Index element, std::string_view sName, int * pValues, size_t & count) const
+{
+    return GetIntArrayAttribute(GetAttributes(element), sName, pValues, count);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    pValues       The array to receive the values
+//! @param    count         On input, the size of the array. On output, the number of values (even if they do not all
+//!                         fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool CompactDocument::GetIntArrayAttribute(Attributes       attributes,
+                                           std::string_view sName,
+                                           int *            pValues,
+                                           size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    if (!FindAttribute(attributes, sName, text))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseIntArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    values     The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool CompactDocument::GetHexArrayAttribute(Index element, std::string_view sName, std::vector<uint32_t> & values) const
+{
+    return GetHexArrayAttribute(GetAttributes(element), sName, values);
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the document.
+//!
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    values        The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool CompactDocument::GetHexArrayAttribute(Attributes              attributes,
+                                           std::string_view        sName,
+                                           std::vector<uint32_t> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    if (!FindAttribute(attributes, sName, text))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseHexArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool CompactDocument::GetHexArrayAttribute(Index            element,
+                                           std::string_view sName,
+                                           uint32_t *       pValues,
+                                           size_t &         count) const
+{
+    return GetHexArrayAttribute(GetAttributes(element), sName, pValues, count);
+}
+
+//! @param    attributes    Attributes to query
+//! @param    sName         Name of the attribute to get
+//! @param    pValues       The array to receive the values
+//! @param    count         On input, the size of the array. On output, the number of values (even if they do not all
+//!                         fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool CompactDocument::GetHexArrayAttribute(Attributes       attributes,
+                                           std::string_view sName,
+                                           uint32_t *       pValues,
+                                           size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view text;
+    if (!FindAttribute(attributes, sName, text))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseHexArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    value      Location to put the value. It is empty if the sub-element has no text.
+//!
+//! @return        true, if the sub-element is present
+
+bool CompactDocument::GetSubElementValue(Index element, std::string_view sName, std::string_view & value) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+        return false;
+
+    value = Value(subElement);
+    return true;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    sDefault    Value to return if the sub-element is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the sub-element
+
+std::string CompactDocument::GetStringSubElement(Index            element,
+                                                 std::string_view sName,
+                                                 char const *     sDefault /* = ""*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view value;
+    if (!GetSubElementValue(element, sName, value))
+        value = sDefault;
+    Instrumentation::Add(Instrumentation::Counter::ALLOCATED, value.size());
+    return std::string(value);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    fDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted to a float
+
+float CompactDocument::GetFloatSubElement(Index element, std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    float            value = fDefault;
+    if (GetSubElementValue(element, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseFloat(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted to an int
+
+int CompactDocument::GetIntSubElement(Index element, std::string_view sName, int iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    int              value = iDefault;
+    if (GetSubElementValue(element, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseInt(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted from hex to an unsigned int
+
+uint32_t CompactDocument::GetHexSubElement(Index element, std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    uint32_t         value = iDefault;
+    if (GetSubElementValue(element, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseHex(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    bDefault    Value to return if the sub-element is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the sub-element converted to a bool
+
+bool CompactDocument::GetBoolSubElement(Index element, std::string_view sName, bool bDefault /* = false*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             value = bDefault;
+    if (GetSubElementValue(element, sName, text))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseBool(text, value);
+    }
+    return value;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the document.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    values     The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the sub-element is present and every value is valid
+
+bool CompactDocument::GetFloatArraySubElement(Index element, std::string_view sName, std::vector<float> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    if (!GetSubElementValue(element, sName, text))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseFloatArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the sub-element is present, every value is valid and they all fit
+
+bool CompactDocument::GetFloatArraySubElement(Index            element,
+                                              std::string_view sName,
+                                              float *          pValues,
+                                              size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    if (!GetSubElementValue(element, sName, text))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseFloatArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the document.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    values     The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the sub-element is present and every value is valid
+
+bool CompactDocument::GetIntArraySubElement(Index element, std::string_view sName, std::vector<int> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    if (!GetSubElementValue(element, sName, text))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseIntArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the sub-element is present, every value is valid and they all fit
+
+bool CompactDocument::GetIntArraySubElement(Index element, std::string_view sName, int * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    if (!GetSubElementValue(element, sName, text))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseIntArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the document.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    values     The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the sub-element is present and every value is valid
+
+bool CompactDocument::GetHexArraySubElement(Index element, std::string_view sName, std::vector<uint32_t> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    if (!GetSubElementValue(element, sName, text))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseHexArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the sub-element is present, every value is valid and they all fit
+
+bool CompactDocument::GetHexArraySubElement(Index            element,
+                                            std::string_view sName,
+                                            uint32_t *       pValues,
+                                            size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    if (!GetSubElementValue(element, sName, text))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseHexArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! Names are interned, so two elements or attributes have the same name if and only if their name ids are equal. A
+//! name can be looked up once and then compared with many elements by id.
+//!
+//! @param    sName    The name
+//!
+//! @return        The id of the name, or NONE if the name does not appear in the document
+
+uint32_t CompactDocument::FindName(std::string_view sName) const
+{
+    size_t low  = 0;
+    size_t high = nameCount_;
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        int    c   = name(uint32_t(mid)).compare(sName);
+        if (c == 0)
+            return uint32_t(mid);
+        if (c < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NONE;
+}
+
+// Checks that the indices and string offsets of a loaded snapshot are within its arrays and pool. The elements must be
+// in document order, so that walking the children of an element always ends.
+bool CompactDocument::validate() const
+{
+    size_t attributeCount = size_t(attributeValueOffset_ - attributeName_);
+    size_t poolSize       = arenaSize_ - arenaSize(nodeCount_, attributeCount, nameCount_, 0);
+
+    if (parent_[0] != NONE || firstAttribute_[0] != 0 || firstAttribute_[nodeCount_] != attributeCount)
+        return false;
+
+    for (size_t i = 0; i < nodeCount_; ++i)
+    {
+        if ((i > 0 && parent_[i] >= i) ||
+            !isLater(firstChild_[i], i, nodeCount_) ||
+            !isLater(nextSibling_[i], i, nodeCount_) ||
+            (firstChild_[i] != NONE && parent_[firstChild_[i]] != i) ||
+            (nextSibling_[i] != NONE && parent_[nextSibling_[i]] != parent_[i]) ||
+            nameId_[i] >= nameCount_ ||
+            !inPool(valueOffset_[i], valueLength_[i], poolSize) ||
+            firstAttribute_[i + 1] < firstAttribute_[i])
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < attributeCount; ++i)
+    {
+        if (attributeName_[i] >= nameCount_ || !inPool(attributeValueOffset_[i], attributeValueLength_[i], poolSize))
+            return false;
+    }
+
+    for (size_t i = 0; i < nameCount_; ++i)
+    {
+        if (nameOffset_[i] == NONE || !inPool(nameOffset_[i], nameLength_[i], poolSize))
+            return false;
+    }
+    return true;
+}
+
+// Points the arrays at an arena laid out as by Parse(). The node and name counts must already be set.
+void CompactDocument::place(std::byte const * pArena, size_t attributeCount)
+{
+    uint32_t const * next = reinterpret_cast<uint32_t const *>(pArena);
+    auto take = [&next] (size_t count) {
+        uint32_t const * p = next;
+        next += count;
+        return p;
+    };
+
+    parent_               = take(nodeCount_);
+    firstChild_           = take(nodeCount_);
+    nextSibling_          = take(nodeCount_);
+    nameId_               = take(nodeCount_);
+    valueOffset_          = take(nodeCount_);
+    valueLength_          = take(nodeCount_);
+    firstAttribute_       = take(nodeCount_ + 1);
+    attributeName_        = take(attributeCount);
+    attributeValueOffset_ = take(attributeCount);
+    attributeValueLength_ = take(attributeCount);
+    nameOffset_           = take(nameCount_);
+    nameLength_           = take(nameCount_);
+    pool_                 = reinterpret_cast<char const *>(next);
+}
+
+//! @param    name          Name of the element
+//! @param    attributes    Attributes of the element, with raw values
+//!
+//! @return        false, if the document is too large
+
+bool CompactDocument::Builder::StartElement(std::string_view name, AttributeRange attributes)
+{
+    Index node = Index(parent_.size());
+    Index up   = open_.empty() ? NONE : open_.back();
+    parent_.push_back(up);
+    firstChild_.push_back(NONE);
+    nextSibling_.push_back(NONE);
+    lastChild_.push_back(NONE);
+    if (up != NONE)
+    {
+        if (lastChild_[up] == NONE)
+            firstChild_[up] = node;
+        else
+            nextSibling_[lastChild_[up]] = node;
+        lastChild_[up] = node;
+    }
+    nameId_.push_back(intern(name));
+    valueOffset_.push_back(NONE);
+    valueLength_.push_back(0);
+    firstAttribute_.push_back(uint32_t(attributeName_.size()));
+    for (Attribute const & attribute : attributes)
+    {
+        size_t offset = pool_.size();
+        Unescape(attribute.value, pool_);
+        attributeName_.push_back(intern(attribute.name));
+        attributeValueOffset_.push_back(uint32_t(offset));
+        attributeValueLength_.push_back(uint32_t(pool_.size() - offset));
+    }
+    open_.push_back(node);
+    extending_ = false;
+    return checkSize();
+}
+
+//! The value of an element is its first text that is a CDATA section or is not only whitespace. A text that is
+//! reported in parts is treated as one text.
+//!
+//! @param    text          The text. Character data is raw, with references not yet expanded.
+//! @param    bCData        True if the text is a CDATA section
+//! @param    bContinued    True if the text is the rest of the previous one
+//!
+//! @return        false, if the document is too large
+
+bool CompactDocument::Builder::Text(std::string_view text, bool bCData, bool bContinued)
+{
+    Index node = open_.back();
+    if (!bContinued)
+    {
+        whitespace_.clear();
+        extending_ = false;
+    }
+
+    if (valueOffset_[node] != NONE)
+    {
+        if (!extending_)
+            return true;
+        size_t length = pool_.size();
+        Unescape(text, pool_);
+        valueLength_[node] += uint32_t(pool_.size() - length);
+        return checkSize();
+    }
+
+    // Whitespace is kept in case the rest of the text is not whitespace
+    if (!bCData && TrimWhitespace(text).empty())
+    {
+        whitespace_.append(text.data(), text.size());
+        return true;
+    }
+
+    size_t offset = pool_.size();
+    if (bCData)
+    {
+        pool_.append(text.data(), text.size());
+    }
+    else
+    {
+        pool_.append(whitespace_);
+        Unescape(text, pool_);
+        extending_ = true;
+    }
+    whitespace_.clear();
+    valueOffset_[node] = uint32_t(offset);
+    valueLength_[node] = uint32_t(pool_.size() - offset);
+    return checkSize();
+}
+
+//! @param    document    The document to replace
+//!
+//! @return        false, if there is no element or the document is too large
+
+bool CompactDocument::Builder::Finish(CompactDocument & document)
+{
+    if (parent_.empty())
+    {
+        error_ = "No root element";
+        return false;
+    }
+    firstAttribute_.push_back(uint32_t(attributeName_.size()));
+
+    // Renumber the names in sorted order so they can be found with a binary search
+    std::vector<uint32_t> sorted(names_.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(), [this] (uint32_t a, uint32_t b) { return names_[a] < names_[b]; });
+
+    std::vector<uint32_t> renumbered(names_.size());
+    std::vector<uint32_t> nameOffset(names_.size());
+    std::vector<uint32_t> nameLength(names_.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        std::string const & name = names_[sorted[i]];
+        renumbered[sorted[i]]    = uint32_t(i);
+        nameOffset[i]            = uint32_t(pool_.size());
+        nameLength[i]            = uint32_t(name.size());
+        pool_.append(name);
+    }
+    for (uint32_t & id : nameId_)
+    {
+        id = renumbered[id];
+    }
+    for (uint32_t & id : attributeName_)
+    {
+        id = renumbered[id];
+    }
+
+    if (!checkSize())
+        return false;
+
+    // Move everything into a single allocation, in the order expected by place()
+    document = CompactDocument();
+    document.arenaSize_ = arenaSize(parent_.size(), attributeName_.size(), names_.size(), pool_.size());
+    document.arena_.reset(new std::byte[document.arenaSize_]);
+
+    std::byte * next = document.arena_.get();
+    copy(parent_, next);
+    copy(firstChild_, next);
+    copy(nextSibling_, next);
+    copy(nameId_, next);
+    copy(valueOffset_, next);
+    copy(valueLength_, next);
+    copy(firstAttribute_, next);
+    copy(attributeName_, next);
+    copy(attributeValueOffset_, next);
+    copy(attributeValueLength_, next);
+    copy(nameOffset, next);
+    copy(nameLength, next);
+    if (!pool_.empty())
+        memcpy(next, pool_.data(), pool_.size());
+
+    document.nodeCount_ = parent_.size();
+    document.nameCount_ = names_.size();
+    document.place(document.arena_.get(), attributeName_.size());
+
+    *this = Builder();
+    return true;
+}
+
+// Returns the id of a name, adding it if necessary
+uint32_t CompactDocument::Builder::intern(std::string_view name)
+{
+    auto i = ids_.find(name);
+    if (i != ids_.end())
+        return i->second;
+
+    names_.emplace_back(name);
+    uint32_t id = uint32_t(names_.size() - 1);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+// Returns false if the document has grown too large to be indexed
+bool CompactDocument::Builder::checkSize()
+{
+    if (pool_.size() > MAX_SIZE || parent_.size() > MAX_SIZE || attributeName_.size() > MAX_SIZE)
+    {
+        error_ = "Document is too large";
+        return false;
+    }
+    return true;
+}
+} // namespace Msxmlx
@@ -0,0 +1,743 @@
+#include "Convert.h"
+
+#include "Scan.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+bool isXmlWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Returns true if the text matches the keyword, ignoring ASCII case
+bool equalsIgnoreCase(std::string_view text, char const * keyword)
+{
+    size_t i = 0;
+    for (; i < text.size() && keyword[i] != 0; ++i)
+    {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z')
+            c = char(c - 'A' + 'a');
+        if (c != keyword[i])
+            return false;
+    }
+    return i == text.size() && keyword[i] == 0;
+}
+
+// std::from_chars does not accept a leading '+', but the text being converted might have one
+std::string_view skipPlus(std::string_view text)
+{
+    if (text.size() > 1 && text[0] == '+' && text[1] != '-')
+        text.remove_prefix(1);
+    return text;
+}
+
+// Calls the narrow version of a conversion with wide text. Text that is not ASCII cannot be valid, so it is narrowed
+// to a buffer on the stack. Only unusually long text (for example, a number with hundreds of digits) is allocated.
+template <typename T>
+bool parseWide(std::wstring_view text, T & value, bool (*parse)(std::string_view, T &))
+{
+    static size_t constexpr BUFFER_SIZE = 128;
+
+    text = Msxmlx::TrimWhitespace(text);
+
+    char        buffer[BUFFER_SIZE];
+    std::string overflow;
+    char *      narrow = buffer;
+    if (text.size() > BUFFER_SIZE)
+    {
+        overflow.resize(text.size());
+        narrow = &overflow[0];
+    }
+
+    wchar_t const * end = text.data() + text.size();
+    if (Msxmlx::Scan::NarrowAscii(text.data(), end, narrow) != end)
+        return false;
+
+    return parse(std::string_view(narrow, text.size()), value);
+}
+
+// Converts wide text to UTF-8 in a buffer for as long as it fits, and returns the length of all of the converted text.
+// Nothing more is written once a character does not fit, so the buffer never ends with part of a character.
+size_t toUtf8(std::wstring_view text, char * pBuffer, size_t size, bool & valid)
+{
+    wchar_t const * p   = text.data();
+    wchar_t const * end = p + text.size();
+    size_t          n   = 0;
+
+    valid = true;
+    while (p < end)
+    {
+        // Runs of ASCII are converted by the fastest kernel supported by the CPU
+        if (n < size)
+        {
+            wchar_t const * run = Msxmlx::Scan::NarrowAscii(p, p + std::min(size_t(end - p), size - n), pBuffer + n);
+            n += size_t(run - p);
+            p  = run;
+            if (p == end)
+                break;
+        }
+
+        uint32_t c = uint32_t(*p++);
+        if (c >= 0xd800 && c < 0xe000)
+        {
+            uint32_t low = (p < end) ? uint32_t(*p) : 0;
+            if (sizeof(wchar_t) == 2 && c < 0xdc00 && low >= 0xdc00 && low < 0xe000)
+            {
+                c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                ++p;
+            }
+            else
+            {
+                c     = 0xfffd;
+                valid = false;
+            }
+        }
+        else if (c > 0x10ffff)
+        {
+            c     = 0xfffd;
+            valid = false;
+        }
+
+        char   bytes[4];
+        size_t length;
+        if (c < 0x80)
+        {
+            bytes[0] = char(c);
+            length   = 1;
+        }
+        else if (c < 0x800)
+        {
+            bytes[0] = char(0xc0 | (c >> 6));
+            bytes[1] = char(0x80 | (c & 0x3f));
+            length   = 2;
+        }
+        else if (c < 0x10000)
+        {
+            bytes[0] = char(0xe0 | (c >> 12));
+            bytes[1] = char(0x80 | ((c >> 6) & 0x3f));
+            bytes[2] = char(0x80 | (c & 0x3f));
+            length   = 3;
+        }
+        else
+        {
+            bytes[0] = char(0xf0 | (c >> 18));
+            bytes[1] = char(0x80 | ((c >> 12) & 0x3f));
+            bytes[2] = char(0x80 | ((c >> 6) & 0x3f));
+            bytes[3] = char(0x80 | (c & 0x3f));
+            length   = 4;
+        }
+
+        if (n + length <= size)
+            memcpy(pBuffer + n, bytes, length);
+        n += length;
+    }
+    return n;
+}
+
+size_t constexpr INVALID = ~size_t(0); // Result of parseValues() if a value is not valid
+
+// Converts the float at the start of text, as with ParseFloat(). Returns the end of the value, or nullptr if it is not
+// valid or is not followed by whitespace or the end of the text.
+char const * parseNext(char const * p, char const * end, float & value)
+{
+    if (end - p > 1 && p[0] == '+' && p[1] != '-')
+        ++p;
+    std::from_chars_result r = std::from_chars(p, end, value);
+    return (r.ec == std::errc() && (r.ptr == end || isXmlWhitespace(*r.ptr))) ? r.ptr : nullptr;
+}
+
+// Converts the integer at the start of text, as with ParseInt()
+char const * parseNext(char const * p, char const * end, int & value)
+{
+    if (end - p > 1 && p[0] == '+' && p[1] != '-')
+        ++p;
+    std::from_chars_result r = std::from_chars(p, end, value, 10);
+    return (r.ec == std::errc() && (r.ptr == end || isXmlWhitespace(*r.ptr))) ? r.ptr : nullptr;
+}
+
+// Converts the hexadecimal number at the start of text, as with ParseHex()
+char const * parseNext(char const * p, char const * end, uint32_t & value)
+{
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        p += 2;
+    std::from_chars_result r = std::from_chars(p, end, value, 16);
+    return (r.ec == std::errc() && (r.ptr == end || isXmlWhitespace(*r.ptr))) ? r.ptr : nullptr;
+}
+
+// Converts a whitespace-separated list of values to an array for as long as it fits. Returns the number of values in
+// the text, or INVALID. Each value is converted where it is, so the text is only read once.
+template <typename T>
+size_t parseValues(std::string_view text, T * pValues, size_t count)
+{
+    char const * p   = text.data();
+    char const * end = p + text.size();
+    size_t       n   = 0;
+    T            overflow;
+    while (true)
+    {
+        while (p < end && isXmlWhitespace(*p))
+        {
+            ++p;
+        }
+        if (p == end)
+            return n;
+
+        p = parseNext(p, end, (n < count) ? pValues[n] : overflow);
+        if (p == nullptr)
+            return INVALID;
+        ++n;
+    }
+}
+
+// Converts a wide value, selecting the conversion by type
+bool parseToken(std::wstring_view text, float & value)
+{
+    return parseWide<float>(text, value, Msxmlx::ParseFloat);
+}
+
+bool parseToken(std::wstring_view text, int & value)
+{
+    return parseWide<int>(text, value, Msxmlx::ParseInt);
+}
+
+bool parseToken(std::wstring_view text, uint32_t & value)
+{
+    return parseWide<uint32_t>(text, value, Msxmlx::ParseHex);
+}
+
+// Converts a whitespace-separated list of values in wide text to an array for as long as it fits. Returns the number
+// of values in the text, or INVALID.
+template <typename T>
+size_t parseValues(std::wstring_view text, T * pValues, size_t count)
+{
+    size_t n = 0;
+    size_t i = 0;
+    T      overflow;
+    while (true)
+    {
+        while (i < text.size() && uint32_t(text[i]) < 0x80 && isXmlWhitespace(char(text[i])))
+        {
+            ++i;
+        }
+        if (i == text.size())
+            return n;
+
+        size_t start = i;
+        while (i < text.size() && !(uint32_t(text[i]) < 0x80 && isXmlWhitespace(char(text[i]))))
+        {
+            ++i;
+        }
+        if (!parseToken(text.substr(start, i - start), (n < count) ? pValues[n] : overflow))
+            return INVALID;
+        ++n;
+    }
+}
+
+// Converts a whitespace-separated list of values to a vector, which is sized from a count of the values
+template <typename Text, typename T>
+bool parseArray(Text text, std::vector<T> & values)
+{
+    values.resize(Msxmlx::CountValues(text));
+    if (parseValues(text, values.data(), values.size()) != values.size())
+    {
+        values.clear();
+        return false;
+    }
+    return true;
+}
+
+// Converts a whitespace-separated list of values to an array. On output, count is the number of values in the text.
+template <typename Text, typename T>
+bool parseArray(Text text, T * pValues, size_t & count)
+{
+    size_t n = parseValues(text, pValues, count);
+    if (n == INVALID)
+    {
+        count = 0;
+        return false;
+    }
+
+    bool fits = n <= count;
+    count     = n;
+    return fits;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    text        Text to trim
+//!
+//! @return        The text without leading or trailing whitespace
+
+std::string_view TrimWhitespace(std::string_view text)
+{
+    while (!text.empty() && isXmlWhitespace(text.front()))
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isXmlWhitespace(text.back()))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+//! Leading and trailing whitespace is ignored. The conversion does not depend on the current locale.
+//!
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid number
+
+bool ParseFloat(std::string_view text, float & value)
+{
+    text = skipPlus(TrimWhitespace(text));
+
+    float result;
+    std::from_chars_result r = std::from_chars(text.data(), text.data() + text.size(), result);
+    if (r.ec != std::errc() || r.ptr != text.data() + text.size())
+        return false;
+
+    value = result;
+    return true;
+}
+
+//! Leading and trailing whitespace is ignored.
+//!
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid integer that fits in an int
+
+bool ParseInt(std::string_view text, int & value)
+{
+    text = skipPlus(TrimWhitespace(text));
+
+    int result;
+    std::from_chars_result r = std::from_chars(text.data(), text.data() + text.size(), result, 10);
+    if (r.ec != std::errc() || r.ptr != text.data() + text.size())
+        return false;
+
+    value = result;
+    return true;
+}
+
+//! Leading and trailing whitespace is ignored, and an optional 0x or 0X prefix is allowed. A sign is not allowed, so
+//! unlike wcstoul(), which the conversion used to be based on, "-1" is not valid rather than 0xffffffff.
+//!
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid hexadecimal number that fits in 32 bits
+
+bool ParseHex(std::string_view text, uint32_t & value)
+{
+    text = TrimWhitespace(text);
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+        text.remove_prefix(2);
+
+    uint32_t result;
+    std::from_chars_result r = std::from_chars(text.data(), text.data() + text.size(), result, 16);
+    if (r.ec != std::errc() || r.ptr != text.data() + text.size())
+        return false;
+
+    value = result;
+    return true;
+}
+
+//! "true" and "false" are accepted in any case. Finite numbers are also accepted, and any non-zero number is true, as
+//! with VariantChangeType(VT_BOOL). Infinities and NaNs are not valid. Leading and trailing whitespace is ignored.
+//!
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid boolean
+
+bool ParseBool(std::string_view text, bool & value)
+{
+    text = TrimWhitespace(text);
+
+    if (equalsIgnoreCase(text, "true"))
+    {
+        value = true;
+        return true;
+    }
+    if (equalsIgnoreCase(text, "false"))
+    {
+        value = false;
+        return true;
+    }
+
+    float number;
+    if (!ParseFloat(text, number) || !std::isfinite(number))
+        return false;
+
+    value = number != 0.f;
+    return true;
+}
+
+//! @param    text        Text to trim
+//!
+//! @return        The text without leading or trailing whitespace
+
+std::wstring_view TrimWhitespace(std::wstring_view text)
+{
+    while (!text.empty() && (text.front() < 0x80 && isXmlWhitespace(char(text.front()))))
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() < 0x80 && isXmlWhitespace(char(text.back()))))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid number
+
+bool ParseFloat(std::wstring_view text, float & value)
+{
+    return parseWide<float>(text, value, ParseFloat);
+}
+
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid integer that fits in an int
+
+bool ParseInt(std::wstring_view text, int & value)
+{
+    return parseWide<int>(text, value, ParseInt);
+}
+
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid hexadecimal number that fits in 32 bits
+
+bool ParseHex(std::wstring_view text, uint32_t & value)
+{
+    return parseWide<uint32_t>(text, value, ParseHex);
+}
+
+//! @param    text        Text to convert
+//! @param    value       Location to put the converted value. It is not changed if the conversion fails.
+//!
+//! @return        true, if the text is a valid boolean
+
+bool ParseBool(std::wstring_view text, bool & value)
+{
+    return parseWide<bool>(text, value, ParseBool);
+}
+
+//! Tokens are counted many characters at a time with the scanning kernels (see Scan.h).
+//!
+//! @param    text        Whitespace-separated list of values
+//!
+//! @return        The number of values
+
+size_t CountValues(std::string_view text)
+{
+    return Scan::CountTokens(text.data(), text.data() + text.size());
+}
+
+//! @param    text        Whitespace-separated list of values
+//!
+//! @return        The number of values
+
+size_t CountValues(std::wstring_view text)
+{
+    size_t count   = 0;
+    bool   inToken = false;
+    for (wchar_t c : text)
+    {
+        bool whitespace = uint32_t(c) < 0x80 && isXmlWhitespace(char(c));
+        if (!whitespace && !inToken)
+            ++count;
+        inToken = !whitespace;
+    }
+    return count;
+}
+
+//! The vector is sized from a count of the values, and then each value is converted where it is in the text, as
+//! with ParseFloat(), so the text is read twice and the vector is allocated at most once.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    values      The vector to receive the values. It is emptied if a value is not valid.
+//!
+//! @return        true, if every value is a number
+
+bool ParseFloatArray(std::string_view text, std::vector<float> & values)
+{
+    return parseArray(text, values);
+}
+
+//! Only the values that fit are written, and the values written before an invalid value are not reverted.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    pValues     The array to receive the values
+//! @param    count       On input, the size of the array. On output, the number of values in the text (even if they
+//!                       do not all fit), or 0 if a value is not valid.
+//!
+//! @return        true, if every value is a number and they all fit
+
+bool ParseFloatArray(std::string_view text, float * pValues, size_t & count)
+{
+    return parseArray(text, pValues, count);
+}
+
+//! The vector is sized from a count of the values, and then each value is converted where it is in the text, as
+//! with ParseInt(), so the text is read twice and the vector is allocated at most once.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    values      The vector to receive the values. It is emptied if a value is not valid.
+//!
+//! @return        true, if every value is an integer that fits in an int
+
+bool ParseIntArray(std::string_view text, std::vector<int> & values)
+{
+    return parseArray(text, values);
+}
+
+//! Only the values that fit are written, and the values written before an invalid value are not reverted.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    pValues     The array to receive the values
+//! @param    count       On input, the size of the array. On output, the number of values in the text (even if they
+//!                       do not all fit), or 0 if a value is not valid.
+//!
+//! @return        true, if every value is an integer that fits in an int and they all fit
+
+bool ParseIntArray(std::string_view text, int * pValues, size_t & count)
+{
+    return parseArray(text, pValues, count);
+}
+
+//! The vector is sized from a count of the values, and then each value is converted where it is in the text, as
+//! with ParseHex(), so the text is read twice and the vector is allocated at most once.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    values      The vector to receive the values. It is emptied if a value is not valid.
+//!
+//! @return        true, if every value is a hexadecimal number that fits in 32 bits
+
+bool ParseHexArray(std::string_view text, std::vector<uint32_t> & values)
+{
+    return parseArray(text, values);
+}
+
+//! Only the values that fit are written, and the values written before an invalid value are not reverted.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    pValues     The array to receive the values
+//! @param    count       On input, the size of the array. On output, the number of values in the text (even if they
+//!                       do not all fit), or 0 if a value is not valid.
+//!
+//! @return        true, if every value is a hexadecimal number that fits in 32 bits and they all fit
+
+bool ParseHexArray(std::string_view text, uint32_t * pValues, size_t & count)
+{
+    return parseArray(text, pValues, count);
+}
+
+//! Each value is converted as with ParseFloat().
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    values      The vector to receive the values. It is emptied if a value is not valid.
+//!
+//! @return        true, if every value is a number
+
+bool ParseFloatArray(std::wstring_view text, std::vector<float> & values)
+{
+    return parseArray(text, values);
+}
+
+//! Only the values that fit are written, and the values written before an invalid value are not reverted.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    pValues     The array to receive the values
+//! @param    count       On input, the size of the array. On output, the number of values in the text (even if they
+//!                       do not all fit), or 0 if a value is not valid.
+//!
+//! @return        true, if every value is a number and they all fit
+
+bool ParseFloatArray(std::wstring_view text, float * pValues, size_t & count)
+{
+    return parseArray(text, pValues, count);
+}
+
+//! Each value is converted as with ParseInt().
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    values      The vector to receive the values. It is emptied if a value is not valid.
+//!
+//! @return        true, if every value is an integer that fits in an int
+
+bool ParseIntArray(std::wstring_view text, std::vector<int> & values)
+{
+    return parseArray(text, values);
+}
+
+//! Only the values that fit are written, and the values written before an invalid value are not reverted.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    pValues     The array to receive the values
+//! @param    count       On input, the size of the array. On output, the number of values in the text (even if they
+//!                       do not all fit), or 0 if a value is not valid.
+//!
+//! @return        true, if every value is an integer that fits in an int and they all fit
+
+bool ParseIntArray(std::wstring_view text, int * pValues, size_t & count)
+{
+    return parseArray(text, pValues, count);
+}
+
+//! Each value is converted as with ParseHex().
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    values      The vector to receive the values. It is emptied if a value is not valid.
+//!
+//! @return        true, if every value is a hexadecimal number that fits in 32 bits
+
+bool ParseHexArray(std::wstring_view text, std::vector<uint32_t> & values)
+{
+    return parseArray(text, values);
+}
+
+//! Only the values that fit are written, and the values written before an invalid value are not reverted.
+//!
+//! @param    text        Whitespace-separated list of values
+//! @param    pValues     The array to receive the values
+//! @param    count       On input, the size of the array. On output, the number of values in the text (even if they
+//!                       do not all fit), or 0 if a value is not valid.
+//!
+//! @return        true, if every value is a hexadecimal number that fits in 32 bits and they all fit
+
+bool ParseHexArray(std::wstring_view text, uint32_t * pValues, size_t & count)
+{
+    return parseArray(text, pValues, count);
+}
+
+//! Wide text is UTF-16 if wchar_t is 16 bits, otherwise UTF-32. Invalid characters are replaced by U+FFFD. The
+//! memory already held by the string is reused, so nothing is allocated unless the converted text is longer.
+//!
+//! @param    text        Text to convert
+//! @param    value       The string to receive the converted text
+//!
+//! @return        true, if the text did not contain invalid characters
+
+bool ToUtf8(std::wstring_view text, std::string & value)
+{
+    // Most text is ASCII, so the first attempt assumes that it is not much longer than the wide text
+    bool valid;
+    value.resize(std::max(text.size(), std::min(value.capacity(), text.size() * 3)));
+    size_t length = toUtf8(text, &value[0], value.size(), valid);
+    if (length > value.size())
+    {
+        value.resize(length);
+        toUtf8(text, &value[0], length, valid);
+    }
+    value.resize(length);
+    return valid;
+}
+
+//! Wide text is UTF-16 if wchar_t is 16 bits, otherwise UTF-32. Invalid characters are replaced by U+FFFD. As with
+//! snprintf(), the result is the length of all of the converted text even if it does not fit, so a buffer of that
+//! size can be provided to try again. The converted text is not terminated.
+//!
+//! @param    text        Text to convert
+//! @param    pBuffer     Where to put the converted text. If it does not fit, only the characters that fit in full
+//!                       are written. May be nullptr if the size is 0.
+//! @param    size        Size of the buffer in bytes
+//!
+//! @return        The length in bytes of the converted text
+
+size_t ToUtf8(std::wstring_view text, char * pBuffer, size_t size)
+{
+    bool valid;
+    return toUtf8(text, pBuffer, size, valid);
+}
+
+//! Wide text is UTF-16 if wchar_t is 16 bits, otherwise UTF-32. Invalid sequences are replaced by U+FFFD. The
+//! converted text is never longer than the UTF-8 text, so a buffer of text.size() characters is always enough.
+//!
+//! @param    text        Text to convert (UTF-8)
+//! @param    pBuffer     Where to put the converted text, which is not terminated. If nullptr, the characters are
+//!                       only counted.
+//!
+//! @return        The number of wide characters
+
+size_t ToWide(std::string_view text, wchar_t * pBuffer)
+{
+    size_t n = 0;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        // Runs of ASCII are converted (or counted) by the fastest kernel supported by the CPU
+        char const * p   = text.data() + i;
+        char const * end = text.data() + text.size();
+        char const * run = pBuffer ? Scan::WidenAscii(p, end, pBuffer + n) : Scan::FindNonAscii(p, end);
+        n += size_t(run - p);
+        i += size_t(run - p);
+        if (i == text.size())
+            break;
+
+        static uint32_t const MINIMUM[] = { 0, 0x80, 0x800, 0x10000 }; // Smallest code point for each length
+
+        uint32_t c     = uint8_t(text[i]);
+        int      extra = (c >= 0xf0) ? 3 : (c >= 0xe0) ? 2 : (c >= 0xc0) ? 1 : 0;
+        bool     valid = c < 0x80 || (extra > 0 && c < 0xf8);
+
+        if (extra > 0)
+            c &= 0x3f >> extra;
+        for (int k = 1; valid && k <= extra; ++k)
+        {
+            if (i + k >= text.size() || (uint8_t(text[i + k]) & 0xc0) != 0x80)
+                valid = false;
+            else
+                c = (c << 6) | (uint8_t(text[i + k]) & 0x3f);
+        }
+        if (valid && (c < MINIMUM[extra] || c > 0x10ffff || (c >= 0xd800 && c < 0xe000)))
+            valid = false;
+
+        if (!valid)
+        {
+            if (pBuffer)
+                pBuffer[n] = wchar_t(0xfffd);
+            ++n;
+            ++i;
+            continue;
+        }
+
+        if (sizeof(wchar_t) == 2 && c >= 0x10000)
+        {
+            if (pBuffer)
+            {
+                pBuffer[n]     = wchar_t(0xd800 + ((c - 0x10000) >> 10));
+                pBuffer[n + 1] = wchar_t(0xdc00 + ((c - 0x10000) & 0x3ff));
+            }
+            n += 2;
+        }
+        else
+        {
+            if (pBuffer)
+                pBuffer[n] = wchar_t(c);
+            ++n;
+        }
+        i += size_t(extra) + 1;
+    }
+    return n;
+}
+} // namespace Msxmlx
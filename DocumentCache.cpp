@@ -0,0 +1,512 @@
+#include "DocumentCache.h"
+
+#include "MappedFile.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+// Reads and parses a file. Returns nullptr if it cannot be read or is not well-formed.
+Msxmlx::DocumentCache::Handle loadDocument(std::string const & path)
+{
+    Msxmlx::MappedFile file(path.c_str());
+    if (!file.IsOpen())
+        return nullptr;
+
+    auto pDocument = std::make_shared<Msxmlx::CompactDocument>();
+    if (!pDocument->Parse(file.View()))
+        return nullptr;
+    return pDocument;
+}
+
+// Returns a future that is already satisfied by a document
+std::shared_future<Msxmlx::DocumentCache::Handle> ready(Msxmlx::DocumentCache::Handle pDocument)
+{
+    std::promise<Msxmlx::DocumentCache::Handle> promise;
+    promise.set_value(std::move(pDocument));
+    return promise.get_future().share();
+}
+
+#if defined(__linux__)
+// Splits a path into the directory to watch and the prefix of the paths of the files in it
+void splitPath(std::string const & path, std::string & directory, std::string & prefix)
+{
+    size_t slash = path.rfind('/');
+    if (slash == std::string::npos)
+    {
+        directory = ".";
+        prefix.clear();
+    }
+    else
+    {
+        directory = (slash == 0) ? std::string("/") : path.substr(0, slash);
+        prefix    = path.substr(0, slash + 1);
+    }
+}
+#endif
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! Watching is only supported on Linux. It is disabled if the inotify instance cannot be created.
+//!
+//! @param    maxBytes    Limit on the memory used by the cached documents
+//! @param    bWatch      If true, changed files are reloaded in the background
+
+DocumentCache::DocumentCache(size_t maxBytes /* = DEFAULT_MAX_BYTES*/, bool bWatch /* = true*/)
+    : maxBytes_(maxBytes)
+{
+#if defined(__linux__)
+    if (bWatch)
+    {
+        watchFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watchFd_ >= 0 && pipe2(stopFds_, O_CLOEXEC) != 0)
+        {
+            close(watchFd_);
+            watchFd_ = -1;
+        }
+        if (watchFd_ >= 0)
+            thread_ = std::thread([this] { watcher(); });
+    }
+#else
+    (void)bWatch;
+#endif
+}
+
+DocumentCache::~DocumentCache()
+{
+#if defined(__linux__)
+    if (watchFd_ >= 0)
+    {
+        char stop = 0;
+        while (write(stopFds_[1], &stop, 1) < 0 && errno == EINTR)
+        {
+        }
+        thread_.join();
+        close(stopFds_[0]);
+        close(stopFds_[1]);
+        close(watchFd_);
+    }
+#endif
+}
+
+//! A cached document is returned if the file has not changed. Otherwise the file is loaded by this call, and any
+//! concurrent requests for the same file wait for it instead of loading it again. A file that cannot be read or
+//! parsed is not cached, so the next request tries again. If loading throws (e.g. std::bad_alloc), the exception is
+//! passed to this call and to the requests waiting for it, and the file is not cached.
+//!
+//! @param    path    Path of the file. Different paths to the same file are cached separately.
+//!
+//! @return        The document, or nullptr if the file cannot be read or parsed
+
+DocumentCache::Handle DocumentCache::Get(std::string const & path)
+{
+    // A watched file does not need to be checked, so the check is made before locking only if watching is disabled
+    Stamp stamp;
+    bool  stamped = !IsWatching() && getStamp(path, stamp);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto i = entries_.find(path);
+    if (i != entries_.end())
+    {
+        Entry & entry = i->second;
+        recent_.splice(recent_.begin(), recent_, entry.recent);
+
+        if ((!entry.watched || entry.check) && !stamped)
+            stamped = getStamp(path, stamp);
+
+        // A document being loaded is shared rather than loaded again
+        if (entry.load != 0 || (entry.watched && !entry.check) || (stamped && stamp == entry.stamp))
+        {
+            // A watched file that has been checked is reported by the watcher again
+            if (entry.load == 0 && stamped)
+                entry.check = false;
+
+            ++hits_;
+            std::shared_future<Handle> document = entry.document;
+            lock.unlock();
+            return document.get();
+        }
+    }
+    else
+    {
+        i = entries_.emplace(path, Entry()).first;
+        recent_.push_front(path);
+        i->second.recent  = recent_.begin();
+        i->second.watched = IsWatching() && watch(path);
+    }
+
+    // The file is checked again after it is watched, so that no change can be missed
+    ++misses_;
+    Entry & entry = i->second;
+    if (!getStamp(path, entry.stamp))
+    {
+        erase(i);
+        return nullptr;
+    }
+
+    std::promise<Handle> promise;
+    entry.document = promise.get_future().share();
+    entry.load     = ++nextLoad_;
+    entry.check    = false;
+
+    uint64_t id = entry.load;
+    lock.unlock();
+
+    Handle pDocument;
+    try
+    {
+        pDocument = loadDocument(path);
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        i = entries_.find(path);
+        if (i != entries_.end() && i->second.load == id)
+            erase(i);
+        throw;
+    }
+    promise.set_value(pDocument);
+
+    // The entry may have been removed in the meantime
+    lock.lock();
+    i = entries_.find(path);
+    if (i != entries_.end() && i->second.load == id)
+    {
+        if (pDocument)
+        {
+            bytes_          = bytes_ - i->second.bytes + pDocument->Capacity();
+            i->second.bytes = pDocument->Capacity();
+            i->second.load  = 0;
+            evict();
+        }
+        else
+        {
+            erase(i);
+        }
+    }
+    return pDocument;
+}
+
+//! Holders of the document are not affected.
+//!
+//! @param    path    Path of the file, as given to Get()
+
+void DocumentCache::Remove(std::string const & path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto i = entries_.find(path);
+    if (i != entries_.end())
+        erase(i);
+}
+
+//! Holders of the documents are not affected.
+
+void DocumentCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    while (!entries_.empty())
+    {
+        erase(entries_.begin());
+    }
+}
+
+//! @return        The counters
+
+DocumentCache::Statistics DocumentCache::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Statistics{ hits_, misses_, reloads_, evictions_, entries_.size(), bytes_ };
+}
+
+// Gets the modification time and size of a file. Returns false if the file does not exist.
+bool DocumentCache::getStamp(std::string const & path, Stamp & stamp)
+{
+#if defined(_WIN32)
+    struct _stat64 status;
+    if (_stat64(path.c_str(), &status) != 0)
+        return false;
+    stamp.modified = int64_t(status.st_mtime) * 1000000000;
+#else
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0)
+        return false;
+#if defined(__APPLE__)
+    stamp.modified = int64_t(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+    stamp.modified = int64_t(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+#endif
+    stamp.size = uint64_t(status.st_size);
+    return true;
+}
+
+// Watches the directory of a file. Returns false if it cannot be watched. The lock must be held.
+bool DocumentCache::watch(std::string const & path)
+{
+#if defined(__linux__)
+    std::string directory;
+    std::string prefix;
+    splitPath(path, directory, prefix);
+
+    auto w = watches_.find(directory);
+    if (w == watches_.end())
+    {
+        uint32_t const EVENTS =
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+        // The same directory has the same descriptor, however it is named
+        int wd = inotify_add_watch(watchFd_, directory.c_str(), EVENTS);
+        if (wd < 0)
+            return false;
+        w = watches_.emplace(directory, wd).first;
+    }
+
+    ++directories_[w->second].prefixes[prefix];
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+// Stops watching the directory of a file, if no other cached file is in it. The lock must be held.
+void DocumentCache::unwatch(std::string const & path)
+{
+#if defined(__linux__)
+    std::string directory;
+    std::string prefix;
+    splitPath(path, directory, prefix);
+
+    auto w = watches_.find(directory);
+    if (w == watches_.end())
+        return;
+
+    int         wd       = w->second;
+    Directory & watched  = directories_[wd];
+    auto        prefixes = watched.prefixes.find(prefix);
+    if (prefixes != watched.prefixes.end() && --prefixes->second == 0)
+        watched.prefixes.erase(prefixes);
+
+    if (watched.prefixes.empty())
+    {
+        inotify_rm_watch(watchFd_, wd);
+        directories_.erase(wd);
+        for (auto i = watches_.begin(); i != watches_.end();)
+        {
+            i = (i->second == wd) ? watches_.erase(i) : std::next(i);
+        }
+    }
+#else
+    (void)path;
+#endif
+}
+
+// Stops relying on a directory's watch after the directory is deleted or moved, or the watch is removed. The files
+// that were in it are checked by each request instead. The lock must be held.
+void DocumentCache::forget(int wd)
+{
+#if defined(__linux__)
+    auto d = directories_.find(wd);
+    if (d == directories_.end())
+        return;
+
+    // A prefix names a single directory, so the files in it are those with its prefixes
+    std::string directory;
+    std::string prefix;
+    for (auto & entry : entries_)
+    {
+        splitPath(entry.first, directory, prefix);
+        if (d->second.prefixes.count(prefix) != 0)
+            entry.second.watched = false;
+    }
+
+    inotify_rm_watch(watchFd_, wd);
+    directories_.erase(d);
+    for (auto i = watches_.begin(); i != watches_.end();)
+    {
+        i = (i->second == wd) ? watches_.erase(i) : std::next(i);
+    }
+#else
+    (void)wd;
+#endif
+}
+
+// Removes an entry. The lock must be held.
+void DocumentCache::erase(std::unordered_map<std::string, Entry>::iterator i)
+{
+    bytes_ -= i->second.bytes;
+    recent_.erase(i->second.recent);
+    if (i->second.watched)
+        unwatch(i->first);
+    entries_.erase(i);
+}
+
+// Evicts the least recently requested documents until the memory limit is met. Documents being loaded are kept. The
+// lock must be held.
+void DocumentCache::evict()
+{
+    auto r = recent_.end();
+    while (bytes_ > maxBytes_ && r != recent_.begin())
+    {
+        auto victim = std::prev(r);
+        auto i      = entries_.find(*victim);
+        if (i->second.load != 0)
+        {
+            r = victim;
+            continue;
+        }
+
+        erase(i);
+        ++evictions_;
+    }
+}
+
+// The watcher thread. It reloads changed files until it is told to stop. If events were lost because the queue
+// overflowed, every file is checked by its next request.
+void DocumentCache::watcher()
+{
+#if defined(__linux__)
+    alignas(inotify_event) char buffer[16 * 1024];
+    pollfd descriptors[2] = { { watchFd_, POLLIN, 0 }, { stopFds_[0], POLLIN, 0 } };
+
+    for (;;)
+    {
+        if (poll(descriptors, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (descriptors[1].revents != 0)
+            break;
+
+        ssize_t size = read(watchFd_, buffer, sizeof(buffer));
+        if (size <= 0)
+            continue;
+
+        // Find the cached files that changed, then reload them without holding the lock
+        std::vector<std::string> changed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (char const * p = buffer; p < buffer + size;)
+            {
+                inotify_event const * pEvent = reinterpret_cast<inotify_event const *>(p);
+                p += sizeof(inotify_event) + pEvent->len;
+
+                if ((pEvent->mask & IN_Q_OVERFLOW) != 0)
+                {
+                    for (auto & entry : entries_)
+                    {
+                        entry.second.check = true;
+                    }
+                    continue;
+                }
+                if ((pEvent->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+                {
+                    forget(pEvent->wd);
+                    continue;
+                }
+
+                auto d = directories_.find(pEvent->wd);
+                if (pEvent->len == 0 || d == directories_.end())
+                    continue;
+                for (auto const & prefix : d->second.prefixes)
+                {
+                    std::string path = prefix.first + pEvent->name;
+                    if (entries_.count(path) != 0)
+                        changed.push_back(std::move(path));
+                }
+            }
+        }
+
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for (std::string const & path : changed)
+        {
+            reload(path);
+        }
+    }
+#endif
+}
+
+// Reloads a changed file and swaps the new document in, while requests continue to get the old one. If the new
+// version cannot be parsed (for example, because it is only partly written), the old document is kept until the file
+// changes again. A deleted file is removed.
+void DocumentCache::reload(std::string const & path)
+{
+    Stamp    stamp;
+    bool     exists = getStamp(path, stamp);
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto i = entries_.find(path);
+        if (i == entries_.end())
+            return;
+        if (!exists)
+        {
+            erase(i);
+            return;
+        }
+        // A load in progress may have read the old version, so the next request checks the file again
+        if (i->second.load != 0)
+        {
+            i->second.check = true;
+            return;
+        }
+        if (stamp == i->second.stamp)
+            return;
+
+        id = i->second.load = ++nextLoad_;
+    }
+
+    // The old document is kept if loading throws, but the next request checks the file again
+    Handle pDocument;
+    bool   failed = false;
+    try
+    {
+        pDocument = loadDocument(path);
+    }
+    catch (...)
+    {
+        failed = true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto i = entries_.find(path);
+    if (i == entries_.end() || i->second.load != id)
+        return;
+
+    Entry & entry = i->second;
+    entry.load    = 0;
+    entry.check   = entry.check || failed;
+    if (!pDocument)
+        return;
+
+    bytes_         = bytes_ - entry.bytes + pDocument->Capacity();
+    entry.bytes    = pDocument->Capacity();
+    entry.stamp    = stamp;
+    entry.document = ready(std::move(pDocument));
+    ++reloads_;
+    evict();
+}
+} // namespace Msxmlx
@@ -0,0 +1,193 @@
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+using namespace Msxmlx::Instrumentation;
+
+namespace
+{
+size_t constexpr FAMILY_COUNT  = size_t(Family::COUNT);
+size_t constexpr COUNTER_COUNT = size_t(Counter::COUNT);
+
+std::atomic<uint64_t> s_counts[FAMILY_COUNT][COUNTER_COUNT];
+std::atomic<uint64_t> s_latency[FAMILY_COUNT][LATENCY_BUCKETS];
+std::atomic<bool> s_measureLatency{ false };
+
+// The family of the outermost call on the current thread, or COUNT if there is none
+thread_local Family t_family = Family::COUNT;
+
+int64_t now()
+{
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+// Returns the histogram bucket of a duration in ns
+int bucket(int64_t duration)
+{
+    int n = 0;
+    while (duration > 1 && n < LATENCY_BUCKETS - 1)
+    {
+        duration >>= 1;
+        ++n;
+    }
+    return n;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+namespace Instrumentation
+{
+//! @return        The counters of every family
+
+Snapshot GetSnapshot()
+{
+    Snapshot snapshot;
+    for (size_t family = 0; family < FAMILY_COUNT; ++family)
+    {
+        Counters & counters = snapshot.families[family];
+        for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+            counters.counts[counter] = s_counts[family][counter].load(std::memory_order_relaxed);
+        for (int i = 0; i < LATENCY_BUCKETS; ++i)
+            counters.latency[i] = s_latency[family][i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+//! Calls in progress on other threads are still counted when they end.
+
+void Reset()
+{
+    for (size_t family = 0; family < FAMILY_COUNT; ++family)
+    {
+        for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+            s_counts[family][counter].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < LATENCY_BUCKETS; ++i)
+            s_latency[family][i].store(0, std::memory_order_relaxed);
+    }
+}
+
+//! Measuring latency reads the clock twice per call, which is significant for the faster accessors.
+//!
+//! @param    bEnable    true to measure the latency of calls that start from now on
+
+void MeasureLatency(bool bEnable)
+{
+    s_measureLatency.store(bEnable, std::memory_order_relaxed);
+}
+
+//! @param    family    The family
+//!
+//! @return        The name of the family, or an empty string if it is not valid
+
+char const * FamilyName(Family family)
+{
+    static char const * const NAMES[] = {
+        "Get*Attribute", "Get*SubElement", "GetSubElement", "ForEach*", "CreateTextElement"
+    };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == FAMILY_COUNT, "A family has no name");
+    return (size_t(family) < FAMILY_COUNT) ? NAMES[size_t(family)] : "";
+}
+
+//! @param    counter    The counter
+//!
+//! @return        The name of the counter, or an empty string if it is not valid
+
+char const * CounterName(Counter counter)
+{
+    static char const * const NAMES[] = { "calls", "scanned", "coercions", "conversions", "allocated" };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == COUNTER_COUNT, "A counter has no name");
+    return (size_t(counter) < COUNTER_COUNT) ? NAMES[size_t(counter)] : "";
+}
+
+//! Each family that has been called has its counters and, if any latencies were measured, a histogram as a list of
+//! [lower bound in ns, calls] pairs for the buckets that are not empty. For example:
+//!
+//! @code
+//!     { "enabled": true, "families": { "GetSubElement": { "calls": 12, "scanned": 840, "coercions": 0,
+//!       "conversions": 12, "allocated": 1536, "latency": [ [256, 3], [512, 9] ] } } }
+//! @endcode
+//!
+//! @param    snapshot    The counters
+//!
+//! @return        The JSON text
+
+std::string ToJson(Snapshot const & snapshot)
+{
+    std::string json = ENABLED ? "{ \"enabled\": true, \"families\": {" : "{ \"enabled\": false, \"families\": {";
+    char        buffer[64];
+    bool        first = true;
+    for (size_t family = 0; family < FAMILY_COUNT; ++family)
+    {
+        Counters const & counters = snapshot.families[family];
+        if (counters.counts[size_t(Counter::CALLS)] == 0)
+            continue;
+
+        json += first ? " \"" : ", \"";
+        json += FamilyName(Family(family));
+        json += "\": {";
+        first = false;
+        for (size_t counter = 0; counter < COUNTER_COUNT; ++counter)
+        {
+            snprintf(buffer, sizeof(buffer), "%s\"%s\": %" PRIu64, (counter > 0) ? ", " : " ",
+                     CounterName(Counter(counter)), counters.counts[counter]);
+            json += buffer;
+        }
+
+        bool measured = false;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i)
+        {
+            if (counters.latency[i] == 0)
+                continue;
+            snprintf(buffer, sizeof(buffer), "%s[%" PRIu64 ", %" PRIu64 "]", measured ? ", " : ", \"latency\": [ ",
+                     (i == 0) ? uint64_t(0) : uint64_t(1) << i, counters.latency[i]);
+            json += buffer;
+            measured = true;
+        }
+        json += measured ? " ] }" : " }";
+    }
+    json += first ? "} }" : " } }";
+    return json;
+}
+
+namespace Detail
+{
+// Starts a call, returning its start time (or 0) if it is the outermost call on the thread, or -1
+int64_t beginCall(Family family)
+{
+    if (t_family != Family::COUNT)
+        return -1;
+
+    t_family = family;
+    s_counts[size_t(family)][size_t(Counter::CALLS)].fetch_add(1, std::memory_order_relaxed);
+    return s_measureLatency.load(std::memory_order_relaxed) ? std::max<int64_t>(now(), 1) : 0;
+}
+
+// Ends the outermost call on the thread
+void endCall(int64_t start)
+{
+    if (start > 0)
+        s_latency[size_t(t_family)][bucket(now() - start)].fetch_add(1, std::memory_order_relaxed);
+    t_family = Family::COUNT;
+}
+
+// Adds to a counter of the current call, if there is one
+void add(Counter counter, uint64_t n)
+{
+    if (t_family != Family::COUNT)
+        s_counts[size_t(t_family)][size_t(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+
+// Adds to a counter of a family
+void add(Family family, Counter counter, uint64_t n)
+{
+    s_counts[size_t(family)][size_t(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+} // namespace Detail
+} // namespace Instrumentation
+} // namespace Msxmlx
@@ -0,0 +1,645 @@
+#include "LazyDocument.h"
+
+#include "Convert.h"
+#include "Scan.h"
+
+namespace
+{
+using Msxmlx::Scan::FindChar;
+using Msxmlx::Scan::FindNameEnd;
+
+// Returns the end of the attribute section of a start tag, which starts at p. The syntax has already been validated
+// by the reader.
+char const * findAttributesEnd(char const * p, char const * end)
+{
+    while (p < end && *p != '>')
+    {
+        if (*p == '"' || *p == '\'')
+            p = FindChar(p + 1, end, *p);
+        ++p;
+    }
+    return (p < end && p[-1] == '/') ? p - 1 : p;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! Documents of 2 GB or more are too large, since the tape holds 32-bit offsets and lengths.
+//!
+//! @param    text    The document. It must remain valid and unchanged while the document is used.
+//!
+//! @return        false, if the document is not well-formed or is too large
+
+bool LazyDocument::Parse(std::string_view text)
+{
+    file_.Close();
+    return build(text);
+}
+
+//! @param    sPath    Path of the file
+//!
+//! @return        false, if the file could not be opened or the document is not well-formed or is too large
+
+bool LazyDocument::Open(char const * sPath)
+{
+    MappedFile file;
+    if (!file.Open(sPath))
+    {
+        *this  = LazyDocument();
+        error_ = "The file could not be opened";
+        return false;
+    }
+
+    file_ = std::move(file);
+    return build(file_.View());
+}
+
+//! @param    element    Element to query
+//!
+//! @return        The next element with the same parent, or NONE if there is none
+
+LazyDocument::Index LazyDocument::NextSibling(Index element) const
+{
+    if (element == NONE)
+        return NONE;
+
+    Index parent = tape_[element].parent;
+    if (parent == NONE || tape_[element].end >= tape_[parent].end)
+        return NONE;
+    return tape_[element].end;
+}
+
+//! @param    element    Element to query
+//!
+//! @return        The name of the element, which refers to the text of the document, or an empty string if element is
+//!                NONE
+
+std::string_view LazyDocument::Name(Index element) const
+{
+    if (element == NONE)
+        return std::string_view();
+
+    char const * name = text_.data() + tape_[element].name;
+    return std::string_view(name, size_t(FindNameEnd(name, text_.data() + text_.size()) - name));
+}
+
+//! @param    element    Element to query
+//! @param    raw        Location to put the text, which refers to the text of the document. It is empty if the
+//!                      element has no text.
+//!
+//! @return        false, if the text is a CDATA section, so its references must not be expanded
+
+bool LazyDocument::RawValue(Index element, std::string_view & raw) const
+{
+    if (element == NONE || tape_[element].value == NONE)
+    {
+        raw = std::string_view();
+        return true;
+    }
+
+    Entry const & entry = tape_[element];
+    raw                 = text_.substr(entry.value, entry.valueLength & ~CDATA_FLAG);
+    return (entry.valueLength & CDATA_FLAG) == 0;
+}
+
+//! @param    element    Element to query
+//!
+//! @return        The value of the element, or an empty string if it has no text
+
+std::string LazyDocument::Value(Index element) const
+{
+    std::string_view raw;
+    std::string      value;
+    if (RawValue(element, raw))
+        Unescape(raw, value);
+    else
+        value.assign(raw.data(), raw.size());
+    return value;
+}
+
+//! The end of the attributes is found when they are first touched, rather than when the document is parsed.
+//!
+//! @param    element    Element to query
+//!
+//! @return        The attributes of the element, which refer to the text of the document
+
+AttributeRange LazyDocument::GetAttributes(Index element) const
+{
+    if (element == NONE)
+        return AttributeRange(nullptr, nullptr);
+
+    char const * end   = text_.data() + text_.size();
+    char const * begin = FindNameEnd(text_.data() + tape_[element].name, end);
+    return AttributeRange(begin, findAttributesEnd(begin, end));
+}
+
+//! The sub-trees of the sub-elements that do not match are skipped without being examined.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//!
+//! @return        The first sub-element with the name, or NONE if not found
+
+LazyDocument::Index LazyDocument::GetSubElement(Index element, std::string_view sName) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    if (element == NONE)
+        return NONE;
+
+    for (Index child = element + 1; child < tape_[element].end; child = tape_[child].end)
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (Name(child) == sName)
+            return child;
+    }
+    return NONE;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute
+//! @param    value      Location to put the raw value of the attribute
+//!
+//! @return        true, if the attribute is present
+
+bool LazyDocument::FindAttribute(Index element, std::string_view sName, std::string_view & value) const
+{
+    return GetAttributes(element).FindAttribute(sName, value);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    sDefault    Value to return if the attribute is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the attribute with references expanded
+
+std::string LazyDocument::GetStringAttribute(Index            element,
+                                             std::string_view sName,
+                                             char const *     sDefault /* = ""*/) const
+{
+    return GetAttributes(element).GetStringAttribute(sName, sDefault);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    fDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to a float
+
+float LazyDocument::GetFloatAttribute(Index element, std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    return GetAttributes(element).GetFloatAttribute(sName, fDefault);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to an int
+
+int LazyDocument::GetIntAttribute(Index element, std::string_view sName, int iDefault /* = 0*/) const
+{
+    return GetAttributes(element).GetIntAttribute(sName, iDefault);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted from hex to an unsigned int
+
+uint32_t LazyDocument::GetHexAttribute(Index element, std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    return GetAttributes(element).GetHexAttribute(sName, iDefault);
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    bDefault    Value to return if the attribute is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the attribute converted to a bool
+
+bool LazyDocument::GetBoolAttribute(Index element, std::string_view sName, bool bDefault /* = false*/) const
+{
+    return GetAttributes(element).GetBoolAttribute(sName, bDefault);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    values     The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool LazyDocument::GetFloatArrayAttribute(Index element, std::string_view sName, std::vector<float> & values) const
+{
+    return GetAttributes(element).GetFloatArrayAttribute(sName, values);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool LazyDocument::GetFloatArrayAttribute(Index            element,
+                                          std::string_view sName,
+                                          float *          pValues,
+                                          size_t &         count) const
+{
+    return GetAttributes(element).GetFloatArrayAttribute(sName, pValues, count);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    values     The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool LazyDocument::GetIntArrayAttribute(Index element, std::string_view sName, std::vector<int> & values) const
+{
+    return GetAttributes(element).GetIntArrayAttribute(sName, values);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool LazyDocument::GetIntArrayAttribute(Index element, std::string_view sName, int * pValues, size_t & count) const
+{
+    return GetAttributes(element).GetIntArrayAttribute(sName, pValues, count);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    values     The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool LazyDocument::GetHexArrayAttribute(Index element, std::string_view sName, std::vector<uint32_t> & values) const
+{
+    return GetAttributes(element).GetHexArrayAttribute(sName, values);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool LazyDocument::GetHexArrayAttribute(Index            element,
+                                        std::string_view sName,
+                                        uint32_t *       pValues,
+                                        size_t &         count) const
+{
+    return GetAttributes(element).GetHexArrayAttribute(sName, pValues, count);
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    value      Location to put the value. It is empty if the sub-element has no text.
+//!
+//! @return        true, if the sub-element is present
+
+bool LazyDocument::GetSubElementValue(Index element, std::string_view sName, std::string & value) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+        return false;
+
+    value = Value(subElement);
+    Instrumentation::Add(Instrumentation::Counter::ALLOCATED, value.size());
+    return true;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    sDefault    Value to return if the sub-element is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the sub-element
+
+std::string LazyDocument::GetStringSubElement(Index            element,
+                                              std::string_view sName,
+                                              char const *     sDefault /* = ""*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string value;
+    if (!GetSubElementValue(element, sName, value))
+        value = sDefault;
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    fDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted to a float
+
+float LazyDocument::GetFloatSubElement(Index element, std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index            subElement = GetSubElement(element, sName);
+    std::string_view text;
+    float            value = fDefault;
+    if (subElement != NONE)
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        RawValue(subElement, text);
+        ParseFloat(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted to an int
+
+int LazyDocument::GetIntSubElement(Index element, std::string_view sName, int iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index            subElement = GetSubElement(element, sName);
+    std::string_view text;
+    int              value = iDefault;
+    if (subElement != NONE)
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        RawValue(subElement, text);
+        ParseInt(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted from hex to an unsigned int
+
+uint32_t LazyDocument::GetHexSubElement(Index element, std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index            subElement = GetSubElement(element, sName);
+    std::string_view text;
+    uint32_t         value = iDefault;
+    if (subElement != NONE)
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        RawValue(subElement, text);
+        ParseHex(text, value);
+    }
+    return value;
+}
+
+//! @param    element     Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    bDefault    Value to return if the sub-element is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the sub-element converted to a bool
+
+bool LazyDocument::GetBoolSubElement(Index element, std::string_view sName, bool bDefault /* = false*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index            subElement = GetSubElement(element, sName);
+    std::string_view text;
+    bool             value = bDefault;
+    if (subElement != NONE)
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        RawValue(subElement, text);
+        ParseBool(text, value);
+    }
+    return value;
+}
+
+//! The values are converted where they are in the text.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    values     The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the sub-element is present and every value is valid
+
+bool LazyDocument::GetFloatArraySubElement(Index element, std::string_view sName, std::vector<float> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+    {
+        values.clear();
+        return false;
+    }
+
+    std::string_view text;
+    RawValue(subElement, text);
+    bool valid = ParseFloatArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the sub-element is present, every value is valid and they all fit
+
+bool LazyDocument::GetFloatArraySubElement(Index            element,
+                                           std::string_view sName,
+                                           float *          pValues,
+                                           size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+    {
+        count = 0;
+        return false;
+    }
+
+    std::string_view text;
+    RawValue(subElement, text);
+    bool valid = ParseFloatArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The values are converted where they are in the text.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    values     The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the sub-element is present and every value is valid
+
+bool LazyDocument::GetIntArraySubElement(Index element, std::string_view sName, std::vector<int> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+    {
+        values.clear();
+        return false;
+    }
+
+    std::string_view text;
+    RawValue(subElement, text);
+    bool valid = ParseIntArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the sub-element is present, every value is valid and they all fit
+
+bool LazyDocument::GetIntArraySubElement(Index element, std::string_view sName, int * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+    {
+        count = 0;
+        return false;
+    }
+
+    std::string_view text;
+    RawValue(subElement, text);
+    bool valid = ParseIntArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The values are converted where they are in the text.
+//!
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    values     The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the sub-element is present and every value is valid
+
+bool LazyDocument::GetHexArraySubElement(Index element, std::string_view sName, std::vector<uint32_t> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+    {
+        values.clear();
+        return false;
+    }
+
+    std::string_view text;
+    RawValue(subElement, text);
+    bool valid = ParseHexArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    element    Element to query
+//! @param    sName      Name of the sub-element
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the sub-element is present, every value is valid and they all fit
+
+bool LazyDocument::GetHexArraySubElement(Index            element,
+                                         std::string_view sName,
+                                         uint32_t *       pValues,
+                                         size_t &         count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    Index subElement = GetSubElement(element, sName);
+    if (subElement == NONE)
+    {
+        count = 0;
+        return false;
+    }
+
+    std::string_view text;
+    RawValue(subElement, text);
+    bool valid = ParseHexArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+// Records the tape of a document, replacing the current contents except for the mapped file
+bool LazyDocument::build(std::string_view text)
+{
+    tape_.clear();
+    text_        = text;
+    error_       = nullptr;
+    errorOffset_ = 0;
+    if (text.size() >= CDATA_FLAG)
+    {
+        error_ = "Document is too large";
+        text_  = std::string_view();
+        return false;
+    }
+
+    Index  current = NONE; // The innermost open element
+    Reader reader(text);
+    for (Reader::Token t = reader.Next(); t != Reader::Token::End; t = reader.Next())
+    {
+        switch (t)
+        {
+        case Reader::Token::StartElement:
+            tape_.push_back(Entry{ uint32_t(reader.Name().data() - text.data()), NONE, 0, current, NONE });
+            current = Index(tape_.size() - 1);
+            break;
+
+        case Reader::Token::EndElement:
+            tape_[current].end = Index(tape_.size());
+            current            = tape_[current].parent;
+            break;
+
+        case Reader::Token::Text:
+        case Reader::Token::CData:
+        {
+            std::string_view value = reader.Value();
+            if (current == NONE || tape_[current].value != NONE)
+                break;
+            if (t == Reader::Token::Text && TrimWhitespace(value).empty())
+                break;
+
+            tape_[current].value       = uint32_t(value.data() - text.data());
+            tape_[current].valueLength = uint32_t(value.size()) | ((t == Reader::Token::CData) ? CDATA_FLAG : 0);
+            break;
+        }
+
+        default:
+            error_       = reader.ErrorMessage();
+            errorOffset_ = reader.Offset();
+            tape_.clear();
+            text_ = std::string_view();
+            return false;
+        }
+    }
+
+    if (tape_.empty())
+    {
+        error_       = "No root element";
+        errorOffset_ = reader.Offset();
+        text_        = std::string_view();
+        return false;
+    }
+    return true;
+}
+} // namespace Msxmlx
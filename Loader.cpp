@@ -0,0 +1,758 @@
+#include "Loader.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace
+{
+// A file that has been read (or could not be read)
+struct File
+{
+    size_t       index = 0;
+    std::string  text;
+    char const * error = nullptr;
+};
+
+// Passes the files from the readers to the parsers, limiting the number that are being read or waiting to be parsed
+class Pipeline
+{
+public:
+
+    explicit Pipeline(size_t capacity) : capacity_(capacity) {}
+
+    // Reserves room for a file before it is read, waiting until there is room. Returns false if reading has failed.
+    bool Acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [this] { return pending_ < capacity_ || error_; });
+        if (error_)
+            return false;
+        ++pending_;
+        return true;
+    }
+
+    // Reserves room for a file before it is read. Returns false if there is no room or reading has failed.
+    bool TryAcquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_ >= capacity_ || error_)
+            return false;
+        ++pending_;
+        return true;
+    }
+
+    // Adds a file for which room was reserved
+    void Push(File && file)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            files_.push_back(std::move(file));
+        }
+        ready_.notify_one();
+    }
+
+    // Stops reading after an exception, which Pop() throws once the files that were read have been removed
+    void Fail(std::exception_ptr error)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+                error_ = error;
+        }
+        ready_.notify_all();
+        space_.notify_all();
+    }
+
+    // Removes the next file, waiting until there is one
+    File Pop()
+    {
+        File file;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return !files_.empty() || error_; });
+            if (files_.empty())
+                std::rethrow_exception(error_);
+            file = std::move(files_.front());
+            files_.pop_front();
+            --pending_;
+        }
+        space_.notify_one();
+        return file;
+    }
+
+private:
+
+    std::mutex              mutex_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<File>        files_;
+    size_t                  pending_ = 0; // Files being read or waiting to be parsed
+    size_t                  capacity_;
+    std::exception_ptr      error_;       // The exception that stopped reading, if any
+};
+
+// Reads a whole file with blocking calls
+void readFile(std::string const & path, File & file)
+{
+    FILE * pFile = fopen(path.c_str(), "rb");
+    if (pFile == nullptr)
+    {
+        file.error = "The file could not be opened";
+        return;
+    }
+
+    // The size is that of the file that was opened, even if the path has since been replaced. The file is read to its
+    // end, even if its size has changed since it was checked.
+    struct stat status;
+    size_t      size = (fstat(fileno(pFile), &status) == 0) ? size_t(status.st_size) : 0;
+    try
+    {
+        file.text.resize(size);
+        size_t length = fread(&file.text[0], 1, size, pFile);
+        file.text.resize(length);
+
+        char buffer[4096];
+        for (size_t n; (n = fread(buffer, 1, sizeof(buffer), pFile)) > 0;)
+        {
+            file.text.append(buffer, n);
+        }
+        if (ferror(pFile))
+            file.error = "The file could not be read";
+    }
+    catch (std::exception const &)
+    {
+        // std::bad_alloc or std::length_error
+        file.text  = std::string();
+        file.error = "The file is too large to be read";
+    }
+    fclose(pFile);
+}
+
+// Reads the files with several threads making blocking calls
+void readWithThreads(std::vector<std::string> const & paths, Pipeline & pipeline, size_t threadCount)
+{
+    std::atomic<size_t> next{ 0 };
+    auto read = [&] {
+        try
+        {
+            for (size_t i = next++; i < paths.size() && pipeline.Acquire(); i = next++)
+            {
+                File file;
+                file.index = i;
+                readFile(paths[i], file);
+                pipeline.Push(std::move(file));
+            }
+        }
+        catch (...)
+        {
+            pipeline.Fail(std::current_exception());
+        }
+    };
+
+    // If not all of the threads can be started, fewer threads read the files
+    std::vector<std::thread> threads;
+    try
+    {
+        for (size_t i = 1; i < std::min(threadCount, paths.size()); ++i)
+        {
+            threads.emplace_back(read);
+        }
+    }
+    catch (std::exception const &)
+    {
+    }
+    read();
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+}
+
+#if defined(__linux__)
+// An io_uring instance that reads files. Only the system calls are used, so liburing is not required.
+class Ring
+{
+public:
+
+    Ring() = default;
+
+    // The reads in flight are waited for, since the kernel may still be writing to their buffers
+    ~Ring()
+    {
+        Drain([] (uint64_t, int) {});
+        Close();
+    }
+
+    Ring(Ring const &) = delete;
+    Ring & operator =(Ring const &) = delete;
+
+    // Creates the instance. Returns false if io_uring is not supported or not permitted.
+    bool Open(unsigned entries)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        fd_ = int(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0)
+            return false;
+
+        sqSize_   = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize_   = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+
+        sq_ = map(sqSize_, IORING_OFF_SQ_RING);
+        cq_ = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq_ : map(cqSize_, IORING_OFF_CQ_RING);
+        sqes_ = static_cast<io_uring_sqe *>(map(sqesSize_, IORING_OFF_SQES));
+        if (sq_ == nullptr || cq_ == nullptr || sqes_ == nullptr)
+        {
+            Close();
+            return false;
+        }
+
+        sqTail_  = at<unsigned>(sq_, params.sq_off.tail);
+        sqMask_  = *at<unsigned>(sq_, params.sq_off.ring_mask);
+        sqArray_ = at<unsigned>(sq_, params.sq_off.array);
+        cqHead_  = at<unsigned>(cq_, params.cq_off.head);
+        cqTail_  = at<unsigned>(cq_, params.cq_off.tail);
+        cqMask_  = *at<unsigned>(cq_, params.cq_off.ring_mask);
+        cqes_    = at<io_uring_cqe>(cq_, params.cq_off.cqes);
+        return true;
+    }
+
+    void Close()
+    {
+        if (sqes_ != nullptr)
+            munmap(sqes_, sqesSize_);
+        if (cq_ != nullptr && cq_ != sq_)
+            munmap(cq_, cqSize_);
+        if (sq_ != nullptr)
+            munmap(sq_, sqSize_);
+        if (fd_ >= 0)
+            close(fd_);
+        sq_   = cq_ = nullptr;
+        sqes_ = nullptr;
+        fd_   = -1;
+    }
+
+    // Queues a read. It is not started until Submit() is called. The caller limits the reads to the size of the ring.
+    void Read(int fd, char * pBuffer, size_t size, uint64_t offset, uint64_t data)
+    {
+        unsigned       tail = *sqTail_;
+        unsigned       slot = tail & sqMask_;
+        io_uring_sqe & sqe  = sqes_[slot];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = IORING_OP_READ;
+        sqe.fd        = fd;
+        sqe.addr      = uint64_t(uintptr_t(pBuffer));
+        sqe.len       = unsigned(std::min<size_t>(size, 1u << 30));
+        sqe.off       = offset;
+        sqe.user_data = data;
+        sqArray_[slot] = slot;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        ++queued_;
+    }
+
+    // Starts the queued reads and waits for at least one to complete. Returns false on failure.
+    bool Submit()
+    {
+        for (;;)
+        {
+            int submitted = int(syscall(__NR_io_uring_enter, fd_, queued_, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (submitted >= 0)
+            {
+                queued_ -= unsigned(submitted);
+                inFlight_ += unsigned(submitted);
+                return true;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                return false;
+        }
+    }
+
+    // Calls a function with the data and the result of each completed read
+    template <typename F>
+    void Reap(F f)
+    {
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            io_uring_cqe const & cqe = cqes_[head & cqMask_];
+            --inFlight_;
+            f(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    }
+
+    // Waits for every submitted read to complete, calling a function with each as Reap() does. Reads that are queued
+    // but not submitted are never started. Returns false if waiting fails, in which case reads may still be in flight.
+    template <typename F>
+    bool Drain(F f)
+    {
+        Reap(f);
+        while (inFlight_ > 0)
+        {
+            if (syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                return false;
+            }
+            Reap(f);
+        }
+        return true;
+    }
+
+private:
+
+    template <typename T>
+    static T * at(void * pBase, unsigned offset)
+    {
+        return reinterpret_cast<T *>(static_cast<char *>(pBase) + offset);
+    }
+
+    void * map(size_t size, off_t offset)
+    {
+        void * p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return (p == MAP_FAILED) ? nullptr : p;
+    }
+
+    int            fd_       = -1;
+    void *         sq_       = nullptr;
+    void *         cq_       = nullptr;
+    io_uring_sqe * sqes_     = nullptr;
+    size_t         sqSize_   = 0;
+    size_t         cqSize_   = 0;
+    size_t         sqesSize_ = 0;
+    unsigned *     sqTail_   = nullptr;
+    unsigned       sqMask_   = 0;
+    unsigned *     sqArray_  = nullptr;
+    unsigned *     cqHead_   = nullptr;
+    unsigned *     cqTail_   = nullptr;
+    unsigned       cqMask_   = 0;
+    io_uring_cqe * cqes_     = nullptr;
+    unsigned       queued_   = 0; // Reads queued but not yet submitted
+    unsigned       inFlight_ = 0; // Reads submitted but not yet reaped
+};
+
+// Reads the rest of a file to its end with blocking calls, growing the text if the file is larger. Returns a
+// description of the error, or nullptr if the file was read.
+char const * readRest(int fd, std::string & text, size_t done)
+{
+    try
+    {
+        for (;;)
+        {
+            if (done == text.size())
+                text.resize(std::max<size_t>(2 * text.size(), 4096));
+            ssize_t n = pread(fd, &text[done], text.size() - done, off_t(done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                text.resize(done);
+                return (n == 0) ? nullptr : "The file could not be read";
+            }
+            done += size_t(n);
+        }
+    }
+    catch (std::exception const &)
+    {
+        text = std::string();
+        return "The file is too large to be read";
+    }
+}
+
+// Reads the files with a single thread that keeps many reads in flight. The files are opened with blocking calls,
+// which are cheap compared with the reads. Each file is read to its end, whatever its size was when it was opened, as
+// readFile() does. Returns false, having read nothing, if io_uring cannot be used.
+bool readWithRing(std::vector<std::string> const & paths, Pipeline & pipeline, size_t depth)
+{
+    // A read of each file that is in flight
+    struct Read
+    {
+        int    fd   = -1;
+        size_t done = 0; // Bytes read so far
+        File   file;
+    };
+
+    // The ring is destroyed before the buffers of its reads, even if an exception is thrown
+    depth = std::min<size_t>(depth, 4096);
+    std::vector<Read> reads(depth);
+    Ring              ring;
+    if (!ring.Open(unsigned(depth)))
+        return false;
+
+    std::vector<size_t> free(depth);
+    for (size_t i = 0; i < depth; ++i)
+    {
+        free[i] = depth - 1 - i;
+    }
+
+    // Ends a read, passing the file to the parsers
+    auto finish = [&] (size_t slot, char const * error) {
+        Read & read = reads[slot];
+        close(read.fd);
+        read.file.error = error;
+        pipeline.Push(std::move(read.file));
+        read = Read();
+        free.push_back(slot);
+    };
+
+    size_t next   = 0;
+    bool   failed = false;
+    while (next < paths.size() || free.size() < depth)
+    {
+        // Start as many reads as there is room for. Waiting for room with reads in flight would never end.
+        while (next < paths.size() && !free.empty())
+        {
+            if (free.size() < depth)
+            {
+                if (!pipeline.TryAcquire())
+                    break;
+            }
+            else if (!pipeline.Acquire())
+            {
+                break;
+            }
+
+            File file;
+            file.index = next;
+            int         fd = open(paths[next++].c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat status;
+            if (fd < 0 || fstat(fd, &status) != 0)
+            {
+                file.error = (fd < 0) ? "The file could not be opened" : "The file could not be read";
+                if (fd >= 0)
+                    close(fd);
+                pipeline.Push(std::move(file));
+                continue;
+            }
+
+            // The text has room for a byte more than the file, so that a file that has grown fills it, and the end
+            // of one that has not is seen by a read that returns nothing
+            char const * error = nullptr;
+            try
+            {
+                file.text.resize(size_t(status.st_size) + 1);
+            }
+            catch (std::exception const &)
+            {
+                error = "The file is too large to be read";
+            }
+            if (error != nullptr || failed)
+            {
+                file.error = (error != nullptr) ? error : readRest(fd, file.text, 0);
+                close(fd);
+                pipeline.Push(std::move(file));
+                continue;
+            }
+
+            size_t slot = free.back();
+            free.pop_back();
+            reads[slot].fd   = fd;
+            reads[slot].file = std::move(file);
+            ring.Read(fd, &reads[slot].file.text[0], reads[slot].file.text.size(), 0, slot);
+        }
+
+        if (free.size() == depth)
+            continue;
+
+        // If the ring fails, the reads are finished with blocking calls, as are the remaining files. The kernel may
+        // still be writing to the buffers of the reads in flight, so they are waited for first.
+        if (!ring.Submit())
+        {
+            failed       = true;
+            bool drained = ring.Drain([&] (uint64_t data, int result) {
+                if (result > 0)
+                    reads[size_t(data)].done += size_t(result);
+            });
+
+            // If even waiting fails, the buffers (some of which are within the reads) are abandoned rather than
+            // reused or freed
+            if (!drained)
+            {
+                std::vector<Read> & abandoned = *new std::vector<Read>(depth);
+                abandoned.swap(reads);
+                for (size_t slot = 0; slot < depth; ++slot)
+                {
+                    if (abandoned[slot].fd < 0)
+                        continue;
+                    close(abandoned[slot].fd);
+                    File file;
+                    file.index = abandoned[slot].file.index;
+                    file.error = "The file could not be read";
+                    pipeline.Push(std::move(file));
+                    free.push_back(slot);
+                }
+                continue;
+            }
+
+            for (size_t slot = 0; slot < depth; ++slot)
+            {
+                Read & read = reads[slot];
+                if (read.fd >= 0)
+                    finish(slot, readRest(read.fd, read.file.text, read.done));
+            }
+            continue;
+        }
+
+        ring.Reap([&] (uint64_t data, int result) {
+            size_t slot = size_t(data);
+            Read & read = reads[slot];
+            std::string & text = read.file.text;
+            if (result == -EINTR || result == -EAGAIN)
+            {
+                ring.Read(read.fd, &text[read.done], text.size() - read.done, read.done, slot);
+            }
+            else if (result == -EINVAL || result == -EOPNOTSUPP)
+            {
+                // The kernel does not support IORING_OP_READ (before Linux 5.6)
+                finish(slot, readRest(read.fd, text, read.done));
+            }
+            else if (result < 0)
+            {
+                finish(slot, "The file could not be read");
+            }
+            else if (result == 0)
+            {
+                text.resize(read.done);
+                finish(slot, nullptr);
+            }
+            else if (read.done + size_t(result) == text.size())
+            {
+                // The file has grown since it was opened, or its size was not known (e.g. in procfs)
+                finish(slot, readRest(read.fd, text, read.done + size_t(result)));
+            }
+            else
+            {
+                read.done += size_t(result);
+                ring.Read(read.fd, &text[read.done], text.size() - read.done, read.done, slot);
+            }
+        });
+    }
+    return true;
+}
+#endif
+
+// The threads that run the loads started by the overload of LoadAll() that returns futures. A thread may be using the
+// default pool, so the threads are joined before the pool is destroyed when the process exits.
+class Drivers
+{
+public:
+
+    ~Drivers()
+    {
+        std::vector<Driver> drivers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            drivers.swap(drivers_);
+        }
+        for (Driver & driver : drivers)
+        {
+            driver.thread.join();
+        }
+    }
+
+    // Returns the instance. The default pool is created first, so that it is destroyed after the instance.
+    static Drivers & Get()
+    {
+        Msxmlx::ThreadPool::Default();
+        static Drivers s_drivers;
+        return s_drivers;
+    }
+
+    // Starts a thread that calls a function. The threads that have finished are joined.
+    template <typename F>
+    void Start(F f)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto i = drivers_.begin(); i != drivers_.end();)
+        {
+            if (i->pDone->load(std::memory_order_acquire))
+            {
+                i->thread.join();
+                i = drivers_.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        auto pDone = std::make_shared<std::atomic<bool>>(false);
+        drivers_.push_back(Driver{ std::thread([f = std::move(f), pDone] () mutable {
+            f();
+            pDone->store(true, std::memory_order_release);
+        }), pDone });
+    }
+
+private:
+
+    struct Driver
+    {
+        std::thread                        thread;
+        std::shared_ptr<std::atomic<bool>> pDone;
+    };
+
+    std::mutex          mutex_;
+    std::vector<Driver> drivers_;
+};
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! Reading overlaps parsing. The files are read ahead of the threads of the pool, which parse them in the order that
+//! they are read and call the function. On Linux, the files are read by a single thread that keeps many reads in
+//! flight with io_uring. Elsewhere, or if io_uring is not available or not wanted, several threads read the files with
+//! blocking calls. Either way, the number of files read but not yet parsed is limited by LoadOptions::readAhead, so
+//! memory use is bounded however many files there are.
+//!
+//! The function is called on the threads of the pool, several at a time and in no particular order. A file that
+//! cannot be read or parsed, including one too large to hold in memory, is reported with an error. If the function
+//! throws, the files that have not been parsed are skipped, and the exception is rethrown once reading has stopped. An
+//! exception thrown while reading is rethrown in the same way.
+//!
+//! @code
+//!     Msxmlx::LoadAll(paths, [&] (Msxmlx::LoadResult & result) {
+//!         if (result.error)
+//!             Log("%s: %s", paths[result.index].c_str(), result.error);
+//!         else
+//!             Register(result.index, std::move(result.document));
+//!     });
+//! @endcode
+//!
+//! @param    paths       Paths of the files
+//! @param    callback    The function to call with each document, or with the error if it could not be loaded. It
+//!                       must be safe to call from several threads at once.
+//! @param    options     How the files are read and parsed
+
+void LoadAll(std::vector<std::string> const & paths,
+             LoadCallback const &             callback,
+             LoadOptions const &              options /* = LoadOptions()*/)
+{
+    if (paths.empty())
+        return;
+
+    ThreadPool & pool = (options.pool != nullptr) ? *options.pool : ThreadPool::Default();
+    Pipeline     pipeline(std::max<size_t>(options.readAhead, 1));
+    std::thread  reader([&] {
+        // An exception that a file's error cannot report stops the loading, and is rethrown by the parsing threads
+        try
+        {
+#if defined(__linux__)
+            if (options.asyncIo && readWithRing(paths, pipeline, std::max<size_t>(options.readAhead, 1)))
+                return;
+#endif
+            readWithThreads(paths, pipeline, std::max<size_t>(options.readThreads, 1));
+        }
+        catch (...)
+        {
+            pipeline.Fail(std::current_exception());
+        }
+    });
+
+    std::atomic<size_t> popped{ 0 };
+    try
+    {
+        pool.ParallelFor(0, paths.size(), 1, [&] (size_t begin, size_t end) {
+            // Each iteration parses whichever file is read next, so none waits for a particular file
+            for (size_t i = begin; i < end; ++i)
+            {
+                File file = pipeline.Pop();
+                ++popped;
+                LoadResult result;
+                result.index = file.index;
+                result.error = file.error;
+                if (result.error == nullptr && !result.document.Parse(file.text))
+                    result.error = result.document.ErrorMessage();
+                file.text = std::string();
+                callback(result);
+            }
+        });
+    }
+    catch (...)
+    {
+        // The files that will not be parsed are discarded, so that the reader can finish. If the reader has failed,
+        // the files it did not read are not waited for.
+        try
+        {
+            for (size_t i = popped; i < paths.size(); ++i)
+            {
+                pipeline.Pop();
+            }
+        }
+        catch (...)
+        {
+        }
+        reader.join();
+        throw;
+    }
+    reader.join();
+}
+
+//! The files are loaded by a background thread as with the other overload, which this returns without waiting for.
+//! The pool, if one is given, must outlive the loading. If the process exits while files are being loaded, the exit
+//! waits for the loading to finish. If loading throws (e.g. std::bad_alloc), the futures of the documents not yet
+//! loaded receive the exception.
+//!
+//! @param    paths      Paths of the files
+//! @param    options    How the files are read and parsed
+//!
+//! @return        A future for the document in each file, in the order of the paths
+
+std::vector<std::future<LoadResult>> LoadAll(std::vector<std::string> paths,
+                                             LoadOptions const &      options /* = LoadOptions()*/)
+{
+    std::vector<std::promise<LoadResult>> promises(paths.size());
+    std::vector<std::future<LoadResult>>  futures;
+    futures.reserve(paths.size());
+    for (std::promise<LoadResult> & promise : promises)
+    {
+        futures.push_back(promise.get_future());
+    }
+
+    Drivers::Get().Start([paths = std::move(paths), promises = std::move(promises), options] () mutable {
+        std::vector<char> loaded(paths.size(), false); // Each element is written by one thread only
+        try
+        {
+            LoadAll(paths, [&] (LoadResult & result) {
+                size_t index = result.index;
+                promises[index].set_value(std::move(result));
+                loaded[index] = true;
+            }, options);
+        }
+        catch (...)
+        {
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                if (!loaded[i])
+                    promises[i].set_exception(std::current_exception());
+            }
+        }
+    });
+    return futures;
+}
+} // namespace Msxmlx
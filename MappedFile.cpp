@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Msxmlx
+{
+MappedFile::MappedFile(MappedFile && rhs) noexcept
+    : data_(rhs.data_)
+    , size_(rhs.size_)
+    , open_(rhs.open_)
+{
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    rhs.open_ = false;
+}
+
+MappedFile & MappedFile::operator =(MappedFile && rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        Close();
+        data_     = rhs.data_;
+        size_     = rhs.size_;
+        open_     = rhs.open_;
+        rhs.data_ = nullptr;
+        rhs.size_ = 0;
+        rhs.open_ = false;
+    }
+    return *this;
+}
+
+//! Any previously mapped file is closed first. An empty file is opened successfully, but has no data.
+//!
+//! @param    sPath    Path of the file to map
+//!
+//! @return        true, if the file was mapped
+
+bool MappedFile::Open(char const * sPath)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(sPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    if (size.QuadPart > 0)
+    {
+        // The view keeps the file and the mapping alive, so their handles can be closed once it is mapped
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping)
+        {
+            data_ = static_cast<char const *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        if (!data_)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        size_ = size_t(size.QuadPart);
+    }
+    CloseHandle(file);
+#else
+    int fd = open(sPath, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    if (status.st_size > 0)
+    {
+        // The mapping keeps the file alive, so the descriptor can be closed once it is mapped
+        void * data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        data_ = static_cast<char const *>(data);
+        size_ = size_t(status.st_size);
+    }
+    close(fd);
+#endif
+
+    open_ = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data_)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<char *>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+} // namespace Msxmlx
@@ -1,60 +1,303 @@
 #include "Msxmlx.h"
 
-namespace Msxmlx
+#include "Convert.h"
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cwchar>
+#include <memory>
+#include <utility>
+
+namespace
 {
-//! @param    pNode        The node in question
-//! @param    type        The type to test for
-//!
-//! @return                true, if the node has the specified type
+namespace Instrumentation = Msxmlx::Instrumentation;
 
-bool IsNodeType(IXMLDOMNode * pNode, DOMNodeType type)
+// Returns the wide version of a name as a BSTR. It may only be passed as an [in] parameter.
+BSTR bstr(Msxmlx::Name const & name)
 {
-    HRESULT     hr;
-    DOMNodeType nodeType;
+    return const_cast<BSTR>(name.Wide());
+}
 
-    hr = pNode->get_nodeType(&nodeType);
+// Counts a BSTR allocated by MSXML for the current call
+void countBstr(BSTR text)
+{
+    if (text)
+    {
+        Instrumentation::Add(Instrumentation::Counter::ALLOCATED,
+                             sizeof(uint32_t) + (SysStringLen(text) + 1) * sizeof(wchar_t));
+    }
+}
 
-    return nodeType == type;
+// Counts a value returned by MSXML for the current call
+void countValue(VARIANT const & value)
+{
+    if (value.vt == VT_BSTR)
+        countBstr(value.bstrVal);
 }
 
-//! @param    pNode        The node in question
-//!
-//! @return                true, if the node has the type NODE_ELEMENT
+// Returns a value returned by MSXML as wide text, coercing it to a string if necessary
+std::wstring_view toText(CComVariant & value)
+{
+    if (value.vt != VT_BSTR)
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        value.ChangeType(VT_BSTR);
+    }
+    Instrumentation::Add(Instrumentation::Counter::CONVERSIONS);
+    return std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal));
+}
 
-bool IsElementNode(IXMLDOMNode * pNode)
+// Converts a value returned by MSXML to UTF-8, reusing the memory of the string
+void toString(CComVariant & value, std::string & text)
 {
-    return IsNodeType(pNode, NODE_ELEMENT);
+    size_t capacity = text.capacity();
+    Msxmlx::ToUtf8(toText(value), text);
+    if (text.capacity() != capacity)
+        Instrumentation::Add(Instrumentation::Counter::ALLOCATED, text.capacity());
 }
 
-//! This function returns the named sub-element. If the sub-element does not exist or there is an error, NULL is
-//! returned.
-//! @param    pElement        Element node to query
-//! @param    sName            Name of the sub-node
-//! @param    ppResult        Location to put the element pointer or NULL.
-//!
-//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named node was not found.
+// Converts a value returned by MSXML to UTF-8 in a buffer, and terminates it. Returns E_NOT_SUFFICIENT_BUFFER if the
+// value and the terminator do not fit.
+HRESULT toString(CComVariant & value, char * pBuffer, size_t size, size_t * pLength)
+{
+    size_t length = Msxmlx::ToUtf8(toText(value), pBuffer, size);
+    if (pLength)
+        *pLength = length;
+    if (length >= size)
+        return E_NOT_SUFFICIENT_BUFFER;
 
-HRESULT GetSubElement(IXMLDOMElement * pElement, char const * sName, IXMLDOMElement ** ppResult)
+    pBuffer[length] = 0;
+    return S_OK;
+}
+
+// A BSTR that is reused for a series of conversions, laid out like the wide version of a Name. Converting into it does
+// not allocate unless the text is longer than any before it.
+class BstrBuffer
+{
+public:
+
+    // Converts UTF-8 text. The result is valid until the next conversion and may only be passed as an [in] parameter.
+    BSTR Convert(std::string_view text)
+    {
+        size_t required = sizeof(uint32_t) + (text.size() + 1) * sizeof(wchar_t);
+        if (required > capacity_)
+        {
+            capacity_ = std::max(required, capacity_ * 2);
+            buffer_.reset(new std::byte[capacity_]);
+            Instrumentation::Add(Instrumentation::Counter::ALLOCATED, capacity_);
+        }
+        Instrumentation::Add(Instrumentation::Counter::CONVERSIONS);
+
+        wchar_t * characters = reinterpret_cast<wchar_t *>(buffer_.get() + sizeof(uint32_t));
+        size_t    length     = Msxmlx::ToWide(text, characters);
+        uint32_t  byteCount  = uint32_t(length * sizeof(wchar_t));
+
+        memcpy(buffer_.get(), &byteCount, sizeof(uint32_t));
+        characters[length] = 0;
+        return characters;
+    }
+
+private:
+
+    std::unique_ptr<std::byte[]> buffer_;
+    size_t                       capacity_ = 0;
+};
+
+// The wide version of a name that is given as UTF-8 text, in a BSTR on the stack, so that looking the name up does not
+// allocate. A name that is too long for the stack is converted into a BstrBuffer instead. It may only be passed as an
+// [in] parameter.
+class WideName
+{
+public:
+
+    explicit WideName(char const * sName)
+    {
+        std::string_view name(sName);
+
+        // UTF-8 never has fewer bytes than the wide version has characters
+        if (name.size() < CAPACITY)
+        {
+            size_t length = Msxmlx::ToWide(name, local_.characters);
+            local_.byteCount          = uint32_t(length * sizeof(wchar_t));
+            local_.characters[length] = 0;
+            text_                     = local_.characters;
+            Instrumentation::Add(Instrumentation::Counter::CONVERSIONS);
+        }
+        else
+        {
+            text_ = overflow_.Convert(name);
+        }
+    }
+
+    WideName(WideName const &) = delete;
+    WideName & operator =(WideName const &) = delete;
+
+    operator BSTR() const { return text_; }
+
+private:
+
+    static size_t constexpr CAPACITY = 64; // Characters, including the terminator
+
+    struct
+    {
+        uint32_t byteCount;
+        wchar_t  characters[CAPACITY];
+    } local_;
+    BstrBuffer overflow_;
+    BSTR       text_;
+};
+
+// Appends an element containing a single text sub-node to a fragment
+HRESULT appendTextElement(IXMLDOMDocument2 * pDocument, IXMLDOMDocumentFragment * pFragment, BSTR name, BSTR value)
+{
+    HRESULT hr;
+    CComPtr<IXMLDOMElement> pElement;
+    CComPtr<IXMLDOMText>    pText;
+
+    if (FAILED(hr = pDocument->createElement(name, &pElement)))
+        return hr;
+    if (FAILED(hr = pDocument->createTextNode(value, &pText)))
+        return hr;
+    if (FAILED(hr = pElement->appendChild(pText, NULL)))
+        return hr;
+    return pFragment->appendChild(pElement, NULL);
+}
+
+// Returns the value of the first text node of an element. If there is none, the value is not changed and the result
+// of getting the child nodes is returned.
+HRESULT getFirstText(IXMLDOMElement * pElement, VARIANT * pValue)
+{
+    HRESULT hr;
+    CComPtr<IXMLDOMNodeList> pNodeList;
+    CComPtr<IXMLDOMNode>     pSubNode;
+
+    if (FAILED(hr = pElement->get_childNodes(&pNodeList)))
+        return hr;
+
+    for (pNodeList->nextNode(&pSubNode); pSubNode; pNodeList->nextNode(&pSubNode))
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (Msxmlx::IsNodeType(pSubNode, NODE_TEXT))
+        {
+            pSubNode->get_nodeValue(pValue);
+            countValue(*pValue);
+            return S_OK;
+        }
+
+        pSubNode.Release();
+    }
+
+    return hr;
+}
+
+// Returns the nth element sub-node with a name (counting from 1), or NULL if there is none
+CComPtr<IXMLDOMElement> getNthSubElement(IXMLDOMElement * pElement, Msxmlx::Name const & name, uint32_t position)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    CComPtr<IXMLDOMNode> pSubNode;
+    CComPtr<IXMLDOMNode> pNext;
+    uint32_t             count = 0;
+
+    for (pElement->get_firstChild(&pSubNode); pSubNode; pSubNode = pNext)
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (Msxmlx::IsElementNode(pSubNode))
+        {
+            CComBSTR tag;
+            pSubNode->get_nodeName(&tag);
+            countBstr(tag);
+            if (name.Matches(tag, tag.Length()) && ++count == position)
+                return CComQIPtr<IXMLDOMElement>(pSubNode);
+        }
+
+        pNext.Release();
+        pSubNode->get_nextSibling(&pNext);
+    }
+
+    return nullptr;
+}
+
+// Converts a value returned by MSXML (normally a BSTR) with one of the Parse functions in Convert.h. Returns
+// DISP_E_TYPEMISMATCH if the value is not valid.
+template <typename T>
+HRESULT parseValue(VARIANT & value, T * pValue, bool (*parse)(std::wstring_view, T &))
+{
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, (value.vt != VT_BSTR) ? 2 : 1);
+    if (value.vt != VT_BSTR && FAILED(VariantChangeTypeEx(&value, &value, LOCALE_INVARIANT, 0, VT_BSTR)))
+        return DISP_E_TYPEMISMATCH;
+
+    if (!parse(std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal)), *pValue))
+        return DISP_E_TYPEMISMATCH;
+
+    return S_OK;
+}
+
+// Converts a value returned by MSXML to a list of values in a vector, which is emptied if a value is not valid.
+// Returns DISP_E_TYPEMISMATCH if a value is not valid.
+template <typename T>
+HRESULT parseArray(VARIANT & value, std::vector<T> * pValues, bool (*parse)(std::wstring_view, std::vector<T> &))
+{
+    if (value.vt != VT_BSTR && FAILED(VariantChangeTypeEx(&value, &value, LOCALE_INVARIANT, 0, VT_BSTR)))
+    {
+        pValues->clear();
+        return DISP_E_TYPEMISMATCH;
+    }
+
+    bool valid = parse(std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal)), *pValues);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, pValues->size());
+    return valid ? S_OK : DISP_E_TYPEMISMATCH;
+}
+
+// Converts a value returned by MSXML to a list of values in an array. *pCount is the size of the array, and is set to
+// the number of values. Returns DISP_E_TYPEMISMATCH if a value is not valid or E_NOT_SUFFICIENT_BUFFER if they do not
+// all fit.
+template <typename T>
+HRESULT parseArray(VARIANT & value, T * pValues, size_t * pCount, bool (*parse)(std::wstring_view, T *, size_t &))
+{
+    if (value.vt != VT_BSTR && FAILED(VariantChangeTypeEx(&value, &value, LOCALE_INVARIANT, 0, VT_BSTR)))
+    {
+        *pCount = 0;
+        return DISP_E_TYPEMISMATCH;
+    }
+
+    if (parse(std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal)), pValues, *pCount))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS, *pCount);
+        return S_OK;
+    }
+    return (*pCount == 0) ? DISP_E_TYPEMISMATCH : E_NOT_SUFFICIENT_BUFFER;
+}
+
+// Returns the first sub-element with a name, as with GetSubElement(). The name is a BSTR, which may be a Name or a
+// WideName.
+HRESULT getSubElement(IXMLDOMElement * pElement, BSTR name, IXMLDOMElement ** ppResult)
 {
     HRESULT hr;
     CComPtr<IXMLDOMNodeList> pNodeList;
     CComPtr<IXMLDOMNode>     pSubNode;
+    UINT                     length = SysStringLen(name);
 
     *ppResult = nullptr;
 
-    hr = pElement->get_childNodes(&pNodeList);
+    if (FAILED(hr = pElement->get_childNodes(&pNodeList)))
+        return hr;
 
     for (pNodeList->nextNode(&pSubNode); pSubNode; pNodeList->nextNode(&pSubNode))
     {
-        if (IsElementNode(pSubNode))
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (Msxmlx::IsElementNode(pSubNode))
         {
             CComBSTR tag;
-            CComQIPtr<IXMLDOMElement> pSubElement(pSubNode);
 
-            pSubElement->get_tagName(&tag);
+            // The node name of an element is its tag name, so the element interface is only needed for a match
+            pSubNode->get_nodeName(&tag);
+            countBstr(tag);
 
-            if (tag == CComBSTR(sName))
+            if (tag.Length() == length && (length == 0 || wmemcmp(tag, name, length) == 0))
             {
+                CComQIPtr<IXMLDOMElement> pSubElement(pSubNode);
                 pSubElement.CopyTo(ppResult);
                 return S_OK;
             }
@@ -66,20 +309,13 @@ HRESULT GetSubElement(IXMLDOMElement * pElement, char const * sName, IXMLDOMElem
     return S_FALSE;
 }
 
-//! @param    pElement        Element node to query
-//! @param    sName            Name of the sub-element
-//! @param    ppAttributes    Location to put the attributes pointer, or NULL if there is an error.
-//!
-//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named element was not found.
-
-HRESULT GetSubElementAttributes(IXMLDOMElement *       pElement,
-                                char const *           sName,
-                                IXMLDOMNamedNodeMap ** ppAttributes)
+// Returns the attributes of the first sub-element with a name, as with GetSubElementAttributes()
+HRESULT getSubElementAttributes(IXMLDOMElement * pElement, BSTR name, IXMLDOMNamedNodeMap ** ppAttributes)
 {
     HRESULT hr;
     CComPtr<IXMLDOMElement> pSubElement;
 
-    hr = GetSubElement(pElement, sName, &pSubElement);
+    hr = getSubElement(pElement, name, &pSubElement);
 
     if (pSubElement)
         hr = pSubElement->get_attributes(ppAttributes);
@@ -89,540 +325,2576 @@ HRESULT GetSubElementAttributes(IXMLDOMElement *       pElement,
     return hr;
 }
 
-//! @param    pElement        Element node to query
-//! @param    sName            Name of the sub-element
-//! @param    pValue            Location to put the value.
-//!
-//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named element was not found.
-
-HRESULT GetSubElementValue(IXMLDOMElement * pElement, char const * sName, VARIANT * pValue)
+// Returns the value of the first sub-element with a name, as with GetSubElementValue()
+HRESULT getSubElementValue(IXMLDOMElement * pElement, BSTR name, VARIANT * pValue)
 {
     HRESULT hr;
     CComPtr<IXMLDOMElement> pSubElement;
 
-    hr = GetSubElement(pElement, sName, &pSubElement);
+    hr = getSubElement(pElement, name, &pSubElement);
 
     if (pSubElement)
-    {
-        CComPtr<IXMLDOMNodeList> pNodeList;
-        CComPtr<IXMLDOMNode>     pSubNode;
+        hr = getFirstText(pSubElement, pValue);
+
+    return hr;
+}
 
-        hr = pSubElement->get_childNodes(&pNodeList);
+// Returns the value of an attribute of an element. Returns S_FALSE if the attribute is not present.
+HRESULT getAttribute(IXMLDOMElement * pElement, BSTR name, CComVariant & value)
+{
+    HRESULT hr = pElement->getAttribute(name, &value);
+    countValue(value);
+    return hr;
+}
 
-        for (pNodeList->nextNode(&pSubNode); pSubNode; pNodeList->nextNode(&pSubNode))
-        {
-            if (IsNodeType(pSubNode, NODE_TEXT))
-            {
-                pSubNode->get_nodeValue(pValue);
-                return S_OK;
-            }
+// Returns the typed value of an attribute in a list. Returns S_FALSE if the attribute is not present.
+HRESULT getAttribute(IXMLDOMNamedNodeMap * pAttributes, BSTR name, CComVariant & value)
+{
+    HRESULT hr;
+    CComPtr<IXMLDOMNode> pAttribute;
 
-            pSubNode.Release();
-        }
-    }
+    hr = pAttributes->getNamedItem(name, &pAttribute);
+    if (hr != S_OK)
+        return hr;
+
+    hr = pAttribute->get_nodeTypedValue(&value);
+    countValue(value);
+    return SUCCEEDED(hr) ? S_OK : hr;
+}
 
+// Converts the value of an attribute of an element or in a list, as with QueryFloatAttribute()
+template <typename Source, typename T>
+HRESULT queryAttribute(Source * pSource, BSTR name, T * pValue, bool (*parse)(std::wstring_view, T &))
+{
+    CComVariant value;
+    HRESULT     hr = getAttribute(pSource, name, value);
+    if (hr == S_OK)
+        hr = parseValue(value, pValue, parse);
     return hr;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the attribute to get
-//! @param    sDefault        Value to return if the attribute is not present. The default default value is an empty
-//!                            string.
-//!
-//! @return        The value of the attribute (coerced to a string, if necessary)
+// Converts the value of an attribute of an element or in a list to UTF-8, as with QueryStringAttribute()
+template <typename Source>
+HRESULT queryAttribute(Source * pSource, BSTR name, std::string * pValue)
+{
+    CComVariant value;
+    HRESULT     hr = getAttribute(pSource, name, value);
+    if (hr == S_OK)
+        toString(value, *pValue);
+    return hr;
+}
 
-std::string GetStringAttribute(IXMLDOMElement * pElement, char const * sName, char const * sDefault /* = ""*/)
+// Converts the value of an attribute to a list of values, as with QueryFloatArrayAttribute()
+template <typename T>
+HRESULT queryArrayAttribute(IXMLDOMElement * pElement,
+                            BSTR             name,
+                            std::vector<T> * pValues,
+                            bool (*parse)(std::wstring_view, std::vector<T> &))
 {
-    HRESULT     hr;
     CComVariant value;
+    HRESULT     hr = getAttribute(pElement, name, value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, parse);
+    else
+        pValues->clear();
+    return hr;
+}
 
-    hr = pElement->getAttribute(CComBSTR(sName), &value);
+// Converts the value of a sub-element, as with QueryFloatSubElement()
+template <typename T>
+HRESULT querySubElement(IXMLDOMElement * pElement, BSTR name, T * pValue, bool (*parse)(std::wstring_view, T &))
+{
+    CComVariant value;
+    HRESULT     hr = getSubElementValue(pElement, name, &value);
     if (hr == S_OK)
-    {
-        USES_CONVERSION;
-        hr = value.ChangeType(VT_BSTR);
+        hr = parseValue(value, pValue, parse);
+    return hr;
+}
 
-        return std::string(OLE2CA(value.bstrVal));
-    }
-    else
-    {
-        return std::string(sDefault);
-    }
+// Converts the value of a sub-element to UTF-8, as with QueryStringSubElement()
+HRESULT querySubElement(IXMLDOMElement * pElement, BSTR name, std::string * pValue)
+{
+    CComVariant value;
+    HRESULT     hr = getSubElementValue(pElement, name, &value);
+    if (hr == S_OK)
+        toString(value, *pValue);
+    return hr;
 }
 
-//! @param    pAttributes        Attribute list
-//! @param    sName            Name of the attribute to get
-//! @param    sDefault        Value to return if the attribute is not present. The default default value is an empty
-//!                            string.
-//!
-//! @return        The value of the attribute (coerced to a string, if necessary)
+// Converts the value of a sub-element to a list of values, as with QueryFloatArraySubElement()
+template <typename T>
+HRESULT queryArraySubElement(IXMLDOMElement * pElement,
+                             BSTR             name,
+                             std::vector<T> * pValues,
+                             bool (*parse)(std::wstring_view, std::vector<T> &))
+{
+    CComVariant value;
+    HRESULT     hr = getSubElementValue(pElement, name, &value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, parse);
+    else
+        pValues->clear();
+    return hr;
+}
 
-std::string GetStringAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, char const * sDefault /* = ""*/)
+// Creates an element containing a single text sub-node, as with CreateTextElement()
+HRESULT createTextElement(IXMLDOMDocument2 * pDocument, BSTR name, VARIANT const & value, IXMLDOMElement ** ppResult)
 {
     HRESULT hr;
-    CComPtr<IXMLDOMNode> pAttribute;
+    CComPtr<IXMLDOMElement> pElement;
 
-    hr = pAttributes->getNamedItem(CComBSTR(sName), &pAttribute);
-    if (hr == S_OK)
-    {
-        USES_CONVERSION;
-        CComVariant value;
-        hr = pAttribute->get_nodeTypedValue(&value);
-        hr = value.ChangeType(VT_BSTR);
+    if (FAILED(hr = pDocument->createElement(name, &pElement)))
+        return hr;
 
-        return std::string(OLE2CA(value.bstrVal));
-    }
-    else
+    CComPtr<IXMLDOMText> pText;
+    CComVariant          variant(value);
+
+    if (variant.vt != VT_BSTR)
     {
-        return std::string(sDefault);
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        variant.ChangeType(VT_BSTR, NULL);
     }
+
+    if (FAILED(hr = pDocument->createTextNode(V_BSTR(&variant), &pText)))
+        return hr;
+    if (FAILED(hr = pElement->appendChild(pText, NULL)))
+        return hr;
+
+    pElement.CopyTo(ppResult);
+    return S_OK;
 }
+} // anonymous namespace
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the attribute to get
-//! @param    fDefault        Value to return if the attribute is not present. The default default value is 0.
+namespace Msxmlx
+{
+//! @param    pNode        The node in question
+//! @param    type        The type to test for
 //!
-//! @return        The value of the attribute (coerced to a float, if necessary)
+//! @return                true, if the node has the specified type
 
-float GetFloatAttribute(IXMLDOMElement * pElement, char const * sName, float fDefault /* = 0.f*/)
+bool IsNodeType(IXMLDOMNode * pNode, DOMNodeType type)
 {
     HRESULT     hr;
-    CComVariant value;
+    DOMNodeType nodeType;
 
-    hr = pElement->getAttribute(CComBSTR(sName), &value);
-    if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_R4);
+    hr = pNode->get_nodeType(&nodeType);
 
-        return value.fltVal;
-    }
-    else
-    {
-        return fDefault;
-    }
+    return nodeType == type;
 }
 
-//! @param    pAttributes        Attribute list
-//! @param    sName            Name of the attribute to get
-//! @param    fDefault        Value to return if the attribute is not present. The default default value is 0.
+//! @param    pNode        The node in question
 //!
-//! @return        The value of the attribute (coerced to a float, if necessary)
+//! @return                true, if the node has the type NODE_ELEMENT
 
-float GetFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, float fDefault /* = 0.f*/)
+bool IsElementNode(IXMLDOMNode * pNode)
 {
-    HRESULT hr;
-    CComPtr<IXMLDOMNode> pAttribute;
+    return IsNodeType(pNode, NODE_ELEMENT);
+}
 
-    hr = pAttributes->getNamedItem(CComBSTR(sName), &pAttribute);
+//! This function returns the named sub-element. If the sub-element does not exist or there is an error, NULL is
+//! returned. The name is converted on the stack, so nothing is allocated for it unless it is long.
+//! @param    pElement        Element node to query
+//! @param    sName            Name of the sub-node
+//! @param    ppResult        Location to put the element pointer or NULL.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named node was not found.
+
+HRESULT GetSubElement(IXMLDOMElement * pElement, char const * sName, IXMLDOMElement ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    return getSubElement(pElement, WideName(sName), ppResult);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call. MSXML has no accessor for
+//! a tag name that does not allocate, so the tag of each sub-element that is examined is still returned as a new
+//! BSTR. Lookups that are repeated on the same element are better served by a ChildIndex.
+//!
+//! This function returns the named sub-element. If the sub-element does not exist or there is an error, NULL is
+//! returned.
+//! @param    pElement        Element node to query
+//! @param    name             Name of the sub-node
+//! @param    ppResult        Location to put the element pointer or NULL.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named node was not found.
+
+HRESULT GetSubElement(IXMLDOMElement * pElement, Name const & name, IXMLDOMElement ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    return getSubElement(pElement, bstr(name), ppResult);
+}
+
+//! @param    pElement        Element node to query
+//! @param    sName            Name of the sub-element
+//! @param    ppAttributes    Location to put the attributes pointer, or NULL if there is an error.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named element was not found.
+
+HRESULT GetSubElementAttributes(IXMLDOMElement *       pElement,
+                                char const *           sName,
+                                IXMLDOMNamedNodeMap ** ppAttributes)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    return getSubElementAttributes(pElement, WideName(sName), ppAttributes);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element node to query
+//! @param    name             Name of the sub-element
+//! @param    ppAttributes    Location to put the attributes pointer, or NULL if there is an error.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named element was not found.
+
+HRESULT GetSubElementAttributes(IXMLDOMElement *       pElement,
+                                Name const &           name,
+                                IXMLDOMNamedNodeMap ** ppAttributes)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    return getSubElementAttributes(pElement, bstr(name), ppAttributes);
+}
+
+//! @param    pElement        Element node to query
+//! @param    sName            Name of the sub-element
+//! @param    pValue            Location to put the value.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named element was not found.
+
+HRESULT GetSubElementValue(IXMLDOMElement * pElement, char const * sName, VARIANT * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return getSubElementValue(pElement, WideName(sName), pValue);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element node to query
+//! @param    name             Name of the sub-element
+//! @param    pValue            Location to put the value.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the named element was not found.
+
+HRESULT GetSubElementValue(IXMLDOMElement * pElement, Name const & name, VARIANT * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return getSubElementValue(pElement, bstr(name), pValue);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the attribute to get
+//! @param    sDefault        Value to return if the attribute is not present. The default default value is an empty
+//!                            string.
+//!
+//! @return        The value of the attribute (coerced to a string, if necessary)
+
+std::string GetStringAttribute(IXMLDOMElement * pElement, char const * sName, char const * sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string value;
+    if (QueryStringAttribute(pElement, sName, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the attribute to get
+//! @param    sDefault        Value to return if the attribute is not present. The default default value is an empty
+//!                            string.
+//!
+//! @return        The value of the attribute (coerced to a string, if necessary)
+
+std::string GetStringAttribute(IXMLDOMElement * pElement, Name const & name, char const * sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string value;
+    if (QueryStringAttribute(pElement, name, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! @param    pAttributes        Attribute list
+//! @param    sName            Name of the attribute to get
+//! @param    sDefault        Value to return if the attribute is not present. The default default value is an empty
+//!                            string.
+//!
+//! @return        The value of the attribute (coerced to a string, if necessary)
+
+std::string GetStringAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, char const * sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string value;
+    if (QueryStringAttribute(pAttributes, sName, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes        Attribute list
+//! @param    name             Name of the attribute to get
+//! @param    sDefault        Value to return if the attribute is not present. The default default value is an empty
+//!                            string.
+//!
+//! @return        The value of the attribute (coerced to a string, if necessary)
+
+std::string GetStringAttribute(IXMLDOMNamedNodeMap * pAttributes,
+                               Name const &          name,
+                               char const *          sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string value;
+    if (QueryStringAttribute(pAttributes, name, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      String to receive the value. Its memory is reused, so nothing is allocated unless the value
+//!                       is longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, or another error.
+
+HRESULT QueryStringAttribute(IXMLDOMElement * pElement, char const * sName, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, WideName(sName), pValue);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValue      String to receive the value. Its memory is reused, so nothing is allocated unless the value
+//!                       is longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, or another error.
+
+HRESULT QueryStringAttribute(IXMLDOMElement * pElement, Name const & name, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, bstr(name), pValue);
+}
+
+//! The value is converted directly to UTF-8 in the buffer, so nothing is allocated.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pBuffer     Buffer to receive the value, which is terminated if it fits
+//! @param    size        Size of the buffer in bytes
+//! @param    pLength     If not NULL, receives the length in bytes of the value, without the terminator, whether or
+//!                       not it fits
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, E_NOT_SUFFICIENT_BUFFER
+//!                if the value does not fit, or another error.
+
+HRESULT QueryStringAttribute(IXMLDOMElement * pElement,
+                             Name const &     name,
+                             char *           pBuffer,
+                             size_t           size,
+                             size_t *         pLength /* = NULL*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getAttribute(pElement, bstr(name), value);
+    if (hr == S_OK)
+        hr = toString(value, pBuffer, size, pLength);
+
+    return hr;
+}
+
+//! @param    pAttributes    Attribute list
+//! @param    sName          Name of the attribute to get
+//! @param    pValue         String to receive the value. Its memory is reused, so nothing is allocated unless the
+//!                          value is longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, or another error.
+
+HRESULT QueryStringAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, WideName(sName), pValue);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes    Attribute list
+//! @param    name           Name of the attribute to get
+//! @param    pValue         String to receive the value. Its memory is reused, so nothing is allocated unless the
+//!                          value is longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, or another error.
+
+HRESULT QueryStringAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, bstr(name), pValue);
+}
+
+//! The value is converted directly to UTF-8 in the buffer, so nothing is allocated.
+//!
+//! @param    pAttributes    Attribute list
+//! @param    name           Name of the attribute to get
+//! @param    pBuffer        Buffer to receive the value, which is terminated if it fits
+//! @param    size           Size of the buffer in bytes
+//! @param    pLength        If not NULL, receives the length in bytes of the value, without the terminator, whether
+//!                          or not it fits
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, E_NOT_SUFFICIENT_BUFFER
+//!                if the value does not fit, or another error.
+
+HRESULT QueryStringAttribute(IXMLDOMNamedNodeMap * pAttributes,
+                             Name const &          name,
+                             char *                pBuffer,
+                             size_t                size,
+                             size_t *              pLength /* = NULL*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getAttribute(pAttributes, bstr(name), value);
+    if (hr == S_OK)
+        hr = toString(value, pBuffer, size, pLength);
+
+    return hr;
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the attribute to get
+//! @param    fDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to a float, if necessary)
+
+float GetFloatAttribute(IXMLDOMElement * pElement, char const * sName, float fDefault /* = 0.f*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    float value;
+    return (QueryFloatAttribute(pElement, sName, &value) == S_OK) ? value : fDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the attribute to get
+//! @param    fDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to a float, if necessary)
+
+float GetFloatAttribute(IXMLDOMElement * pElement, Name const & name, float fDefault /* = 0.f*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    float value;
+    return (QueryFloatAttribute(pElement, name, &value) == S_OK) ? value : fDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryFloatAttribute(IXMLDOMElement * pElement, char const * sName, float * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, WideName(sName), pValue, ParseFloat);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryFloatAttribute(IXMLDOMElement * pElement, Name const & name, float * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, bstr(name), pValue, ParseFloat);
+}
+
+//! @param    pAttributes        Attribute list
+//! @param    sName            Name of the attribute to get
+//! @param    fDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to a float, if necessary)
+
+float GetFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, float fDefault /* = 0.f*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    float value;
+    return (QueryFloatAttribute(pAttributes, sName, &value) == S_OK) ? value : fDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes        Attribute list
+//! @param    name             Name of the attribute to get
+//! @param    fDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to a float, if necessary)
+
+float GetFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, float fDefault /* = 0.f*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    float value;
+    return (QueryFloatAttribute(pAttributes, name, &value) == S_OK) ? value : fDefault;
+}
+
+//! @param    pAttributes    Attribute list
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, float * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, WideName(sName), pValue, ParseFloat);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes    Attribute list
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, float * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, bstr(name), pValue, ParseFloat);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to an int, if necessary), or the default value if the attribute
+//!                is not present.
+
+int GetIntAttribute(IXMLDOMElement * pElement, char const * sName, int iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    int value;
+    return (QueryIntAttribute(pElement, sName, &value) == S_OK) ? value : iDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to an int, if necessary), or the default value if the attribute
+//!                is not present.
+
+int GetIntAttribute(IXMLDOMElement * pElement, Name const & name, int iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    int value;
+    return (QueryIntAttribute(pElement, name, &value) == S_OK) ? value : iDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryIntAttribute(IXMLDOMElement * pElement, char const * sName, int * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, WideName(sName), pValue, ParseInt);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryIntAttribute(IXMLDOMElement * pElement, Name const & name, int * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, bstr(name), pValue, ParseInt);
+}
+
+//! @param    pAttributes        Attribute list
+//! @param    sName            Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to an int, if necessary), or the default value if the attribute
+//!                is not present.
+
+int GetIntAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, int iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    int value;
+    return (QueryIntAttribute(pAttributes, sName, &value) == S_OK) ? value : iDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes        Attribute list
+//! @param    name             Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute (coerced to an int, if necessary), or the default value if the attribute
+//!                is not present.
+
+int GetIntAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, int iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    int value;
+    return (QueryIntAttribute(pAttributes, name, &value) == S_OK) ? value : iDefault;
+}
+
+//! @param    pAttributes    Attribute list
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryIntAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, int * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, WideName(sName), pValue, ParseInt);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes    Attribute list
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryIntAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, int * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, bstr(name), pValue, ParseInt);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute, read as hexadecimal text with an optional 0x prefix, or the default
+//!                value if the attribute is not present or its text is not valid hexadecimal.
+
+uint32_t GetHexAttribute(IXMLDOMElement * pElement, char const * sName, uint32_t iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    uint32_t value;
+    return (QueryHexAttribute(pElement, sName, &value) == S_OK) ? value : iDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute, read as hexadecimal text with an optional 0x prefix, or the default
+//!                value if the attribute is not present or its text is not valid hexadecimal.
+
+uint32_t GetHexAttribute(IXMLDOMElement * pElement, Name const & name, uint32_t iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    uint32_t value;
+    return (QueryHexAttribute(pElement, name, &value) == S_OK) ? value : iDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryHexAttribute(IXMLDOMElement * pElement, char const * sName, uint32_t * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, WideName(sName), pValue, ParseHex);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryHexAttribute(IXMLDOMElement * pElement, Name const & name, uint32_t * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, bstr(name), pValue, ParseHex);
+}
+
+//! @param    pAttributes        Attribute list
+//! @param    sName            Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute, read as hexadecimal text with an optional 0x prefix, or the default
+//!                value if the attribute is not present or its text is not valid hexadecimal.
+
+uint32_t GetHexAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, uint32_t iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    uint32_t value;
+    return (QueryHexAttribute(pAttributes, sName, &value) == S_OK) ? value : iDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes        Attribute list
+//! @param    name             Name of the attribute to get
+//! @param    iDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the attribute, read as hexadecimal text with an optional 0x prefix, or the default
+//!                value if the attribute is not present or its text is not valid hexadecimal.
+
+uint32_t GetHexAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, uint32_t iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    uint32_t value;
+    return (QueryHexAttribute(pAttributes, name, &value) == S_OK) ? value : iDefault;
+}
+
+//! @param    pAttributes    Attribute list
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryHexAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, uint32_t * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, WideName(sName), pValue, ParseHex);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes    Attribute list
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryHexAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, uint32_t * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, bstr(name), pValue, ParseHex);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the attribute to get
+//! @param    bDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is false.
+//!
+//! @return        The value of the attribute (coerced to a bool, if necessary), or the default value if the
+//!                attribute is not present.
+
+bool GetBoolAttribute(IXMLDOMElement * pElement, char const * sName, bool bDefault /* = false*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    bool value;
+    return (QueryBoolAttribute(pElement, sName, &value) == S_OK) ? value : bDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the attribute to get
+//! @param    bDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is false.
+//!
+//! @return        The value of the attribute (coerced to a bool, if necessary), or the default value if the
+//!                attribute is not present.
+
+bool GetBoolAttribute(IXMLDOMElement * pElement, Name const & name, bool bDefault /* = false*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    bool value;
+    return (QueryBoolAttribute(pElement, name, &value) == S_OK) ? value : bDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolAttribute(IXMLDOMElement * pElement, char const * sName, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, WideName(sName), pValue, ParseBool);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolAttribute(IXMLDOMElement * pElement, Name const & name, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pElement, bstr(name), pValue, ParseBool);
+}
+
+//! @param    pAttributes        Attribute list
+//! @param    sName            Name of the attribute to get
+//! @param    bDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is false.
+//!
+//! @return        The value of the attribute (coerced to an bool, if necessary), or the default value if the
+//!                attribute is not present.
+
+bool GetBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, bool bDefault /* = false*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    bool value;
+    return (QueryBoolAttribute(pAttributes, sName, &value) == S_OK) ? value : bDefault;
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes        Attribute list
+//! @param    name             Name of the attribute to get
+//! @param    bDefault        Value to return if the attribute is not present or invalid.
+//!                           The default default value is false.
+//!
+//! @return        The value of the attribute (coerced to an bool, if necessary), or the default value if the
+//!                attribute is not present.
+
+bool GetBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, bool bDefault /* = false*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    bool value;
+    return (QueryBoolAttribute(pAttributes, name, &value) == S_OK) ? value : bDefault;
+}
+
+//! @param    pAttributes    Attribute list
+//! @param    sName       Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, WideName(sName), pValue, ParseBool);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pAttributes    Attribute list
+//! @param    name        Name of the attribute to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryAttribute(pAttributes, bstr(name), pValue, ParseBool);
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, or another error.
+
+HRESULT QueryFloatArrayAttribute(IXMLDOMElement * pElement, char const * sName, std::vector<float> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryArrayAttribute(pElement, WideName(sName), pValues, ParseFloatArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up. The vector is sized once from a
+//! count of the values.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, or another error.
+
+HRESULT QueryFloatArrayAttribute(IXMLDOMElement * pElement, Name const & name, std::vector<float> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryArrayAttribute(pElement, bstr(name), pValues, ParseFloatArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
+
+HRESULT QueryFloatArrayAttribute(IXMLDOMElement * pElement, Name const & name, float * pValues, size_t * pCount)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getAttribute(pElement, bstr(name), value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseFloatArray);
+    else
+        *pCount = 0;
+
+    return hr;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, or another error.
+
+HRESULT QueryIntArrayAttribute(IXMLDOMElement * pElement, char const * sName, std::vector<int> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryArrayAttribute(pElement, WideName(sName), pValues, ParseIntArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up. The vector is sized once from a
+//! count of the values.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, or another error.
+
+HRESULT QueryIntArrayAttribute(IXMLDOMElement * pElement, Name const & name, std::vector<int> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryArrayAttribute(pElement, bstr(name), pValues, ParseIntArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
+
+HRESULT QueryIntArrayAttribute(IXMLDOMElement * pElement, Name const & name, int * pValues, size_t * pCount)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getAttribute(pElement, bstr(name), value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseIntArray);
+    else
+        *pCount = 0;
+
+    return hr;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the attribute to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, or another error.
+
+HRESULT QueryHexArrayAttribute(IXMLDOMElement * pElement, char const * sName, std::vector<uint32_t> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryArrayAttribute(pElement, WideName(sName), pValues, ParseHexArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up. The vector is sized once from a
+//! count of the values.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, or another error.
+
+HRESULT QueryHexArrayAttribute(IXMLDOMElement * pElement, Name const & name, std::vector<uint32_t> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    return queryArrayAttribute(pElement, bstr(name), pValues, ParseHexArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the attribute to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the attribute is not present, DISP_E_TYPEMISMATCH if a
+//!                value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
+
+HRESULT QueryHexArrayAttribute(IXMLDOMElement * pElement, Name const & name, uint32_t * pValues, size_t * pCount)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getAttribute(pElement, bstr(name), value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseHexArray);
+    else
+        *pCount = 0;
+
+    return hr;
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the sub-element to get
+//! @param    sDefault        Value to return if the sub-element is not present. The default default value is an empty
+//!                            string.
+//!
+//! @return        The value of the sub-element (coerced to a string, if necessary)
+
+std::string GetStringSubElement(IXMLDOMElement * pElement, char const * sName, char const * sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string value;
+    if (QueryStringSubElement(pElement, sName, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the sub-element to get
+//! @param    sDefault        Value to return if the sub-element is not present. The default default value is an empty
+//!                            string.
+//!
+//! @return        The value of the sub-element (coerced to a string, if necessary)
+
+std::string GetStringSubElement(IXMLDOMElement * pElement, Name const & name, char const * sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string value;
+    if (QueryStringSubElement(pElement, name, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValue      String to receive the value. Its memory is reused, so nothing is allocated unless the value
+//!                       is longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, or another error.
+
+HRESULT QueryStringSubElement(IXMLDOMElement * pElement, char const * sName, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, WideName(sName), pValue);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      String to receive the value. Its memory is reused, so nothing is allocated unless the value
+//!                       is longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, or another error.
+
+HRESULT QueryStringSubElement(IXMLDOMElement * pElement, Name const & name, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, bstr(name), pValue);
+}
+
+//! The value is converted directly to UTF-8 in the buffer, so nothing is allocated.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pBuffer     Buffer to receive the value, which is terminated if it fits
+//! @param    size        Size of the buffer in bytes
+//! @param    pLength     If not NULL, receives the length in bytes of the value, without the terminator, whether or
+//!                       not it fits
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present,
+//!                E_NOT_SUFFICIENT_BUFFER if the value does not fit, or another error.
+
+HRESULT QueryStringSubElement(IXMLDOMElement * pElement,
+                              Name const &     name,
+                              char *           pBuffer,
+                              size_t           size,
+                              size_t *         pLength /* = NULL*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getSubElementValue(pElement, bstr(name), &value);
+    if (hr == S_OK)
+        hr = toString(value, pBuffer, size, pLength);
+
+    return hr;
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the sub-element to get
+//! @param    fDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the sub-element (coerced to a float, if necessary)
+
+float GetFloatSubElement(IXMLDOMElement * pElement, char const * sName, float fDefault /* = 0.f*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    float value;
+    return (QueryFloatSubElement(pElement, sName, &value) == S_OK) ? value : fDefault;
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the sub-element to get
+//! @param    fDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the sub-element (coerced to a float, if necessary)
+
+float GetFloatSubElement(IXMLDOMElement * pElement, Name const & name, float fDefault /* = 0.f*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    float value;
+    return (QueryFloatSubElement(pElement, name, &value) == S_OK) ? value : fDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryFloatSubElement(IXMLDOMElement * pElement, char const * sName, float * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, WideName(sName), pValue, ParseFloat);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryFloatSubElement(IXMLDOMElement * pElement, Name const & name, float * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, bstr(name), pValue, ParseFloat);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the sub-element to get
+//! @param    iDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the sub-element (coerced to an int, if necessary), or the default value if the sub-element
+//!                is not present.
+
+int GetIntSubElement(IXMLDOMElement * pElement, char const * sName, int iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    int value;
+    return (QueryIntSubElement(pElement, sName, &value) == S_OK) ? value : iDefault;
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the sub-element to get
+//! @param    iDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the sub-element (coerced to an int, if necessary), or the default value if the sub-element
+//!                is not present.
+
+int GetIntSubElement(IXMLDOMElement * pElement, Name const & name, int iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    int value;
+    return (QueryIntSubElement(pElement, name, &value) == S_OK) ? value : iDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryIntSubElement(IXMLDOMElement * pElement, char const * sName, int * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, WideName(sName), pValue, ParseInt);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryIntSubElement(IXMLDOMElement * pElement, Name const & name, int * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, bstr(name), pValue, ParseInt);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the sub-element to get
+//! @param    iDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the sub-element (coerced to an unsigned int, if necessary), or the default value if the
+//!                sub-element is not present.
+
+uint32_t GetHexSubElement(IXMLDOMElement * pElement, char const * sName, uint32_t iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    uint32_t value;
+    return (QueryHexSubElement(pElement, sName, &value) == S_OK) ? value : iDefault;
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the sub-element to get
+//! @param    iDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is 0.
+//!
+//! @return        The value of the sub-element (coerced to an unsigned int, if necessary), or the default value if the
+//!                sub-element is not present.
+
+uint32_t GetHexSubElement(IXMLDOMElement * pElement, Name const & name, uint32_t iDefault /* = 0*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    uint32_t value;
+    return (QueryHexSubElement(pElement, name, &value) == S_OK) ? value : iDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryHexSubElement(IXMLDOMElement * pElement, char const * sName, uint32_t * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, WideName(sName), pValue, ParseHex);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryHexSubElement(IXMLDOMElement * pElement, Name const & name, uint32_t * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, bstr(name), pValue, ParseHex);
+}
+
+//! @param    pElement        Element to query
+//! @param    sName            Name of the sub-element to get
+//! @param    bDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is false.
+//!
+//! @return        The value of the sub-element (coerced to a bool, if necessary), or the default value if the
+//!                sub-element is not present.
+
+bool GetBoolSubElement(IXMLDOMElement * pElement, char const * sName, bool bDefault /* = false*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    bool value;
+    return (QueryBoolSubElement(pElement, sName, &value) == S_OK) ? value : bDefault;
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement        Element to query
+//! @param    name             Name of the sub-element to get
+//! @param    bDefault        Value to return if the sub-element is not present or invalid.
+//!                           The default default value is false.
+//!
+//! @return        The value of the sub-element (coerced to a bool, if necessary), or the default value if the
+//!                sub-element is not present.
+
+bool GetBoolSubElement(IXMLDOMElement * pElement, Name const & name, bool bDefault /* = false*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    bool value;
+    return (QueryBoolSubElement(pElement, name, &value) == S_OK) ? value : bDefault;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolSubElement(IXMLDOMElement * pElement, char const * sName, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, WideName(sName), pValue, ParseBool);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolSubElement(IXMLDOMElement * pElement, Name const & name, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return querySubElement(pElement, bstr(name), pValue, ParseBool);
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
+
+HRESULT QueryFloatArraySubElement(IXMLDOMElement * pElement, char const * sName, std::vector<float> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return queryArraySubElement(pElement, WideName(sName), pValues, ParseFloatArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up. The vector is sized once from a
+//! count of the values.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
+
+HRESULT QueryFloatArraySubElement(IXMLDOMElement * pElement, Name const & name, std::vector<float> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return queryArraySubElement(pElement, bstr(name), pValues, ParseFloatArray);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
+
+HRESULT QueryFloatArraySubElement(IXMLDOMElement * pElement, Name const & name, float * pValues, size_t * pCount)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getSubElementValue(pElement, bstr(name), &value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseFloatArray);
+    else
+        *pCount = 0;
+
+    return hr;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
+
+HRESULT QueryIntArraySubElement(IXMLDOMElement * pElement, char const * sName, std::vector<int> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return queryArraySubElement(pElement, WideName(sName), pValues, ParseIntArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up. The vector is sized once from a
+//! count of the values.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
+
+HRESULT QueryIntArraySubElement(IXMLDOMElement * pElement, Name const & name, std::vector<int> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return queryArraySubElement(pElement, bstr(name), pValues, ParseIntArray);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
+
+HRESULT QueryIntArraySubElement(IXMLDOMElement * pElement, Name const & name, int * pValues, size_t * pCount)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getSubElementValue(pElement, bstr(name), &value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseIntArray);
+    else
+        *pCount = 0;
+
+    return hr;
+}
+
+//! @param    pElement    Element to query
+//! @param    sName       Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
+
+HRESULT QueryHexArraySubElement(IXMLDOMElement * pElement, char const * sName, std::vector<uint32_t> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return queryArraySubElement(pElement, WideName(sName), pValues, ParseHexArray);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up. The vector is sized once from a
+//! count of the values.
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
+
+HRESULT QueryHexArraySubElement(IXMLDOMElement * pElement, Name const & name, std::vector<uint32_t> * pValues)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    return queryArraySubElement(pElement, bstr(name), pValues, ParseHexArray);
+}
+
+//! This overload uses a pre-converted name, so the name is not converted for each call (see GetSubElement()).
+//!
+//! @param    pElement    Element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
+
+HRESULT QueryHexArraySubElement(IXMLDOMElement * pElement, Name const & name, uint32_t * pValues, size_t * pCount)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = getSubElementValue(pElement, bstr(name), &value);
     if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseHexArray);
+    else
+        *pCount = 0;
+
+    return hr;
+}
+
+//! The sub-elements at each step are walked as siblings and compared with the step's pre-converted name, so nothing
+//! is allocated for the names.
+//!
+//! @param    pElement    Element the path starts from
+//! @param    path        The path
+//! @param    ppResult    Location to put the element pointer, or NULL if it is not found.
+//!
+//! @return        S_OK if the element was found, or S_FALSE if it was not found or the path is not valid
+
+HRESULT SelectElement(IXMLDOMElement * pElement, Path const & path, IXMLDOMElement ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    *ppResult = nullptr;
+    if (!path.IsValid())
+        return S_FALSE;
+
+    CComPtr<IXMLDOMElement> pCurrent(pElement);
+    for (Path::Step const & step : path.Steps())
+    {
+        pCurrent = getNthSubElement(pCurrent, step.name, step.position);
+        if (!pCurrent)
+            return S_FALSE;
+    }
+
+    pCurrent.CopyTo(ppResult);
+    return S_OK;
+}
+
+//! @param    pElement    Element the path starts from
+//! @param    path        The path
+//! @param    pValue      Location to put the value.
+//!
+//! @return        S_OK if the value was found, or S_FALSE if it was not found or the path is not valid
+
+HRESULT GetPathValue(IXMLDOMElement * pElement, Path const & path, VARIANT * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT hr;
+    CComPtr<IXMLDOMElement> pSelected;
+
+    hr = SelectElement(pElement, path, &pSelected);
+    if (hr != S_OK)
+        return hr;
+
+    if (path.HasAttribute())
+        return pSelected->getAttribute(bstr(path.Attribute()), pValue);
+
+    hr = getFirstText(pSelected, pValue);
+    return SUCCEEDED(hr) ? S_OK : hr;
+}
+
+//! This function calls the specified function for each node in the specified node list. If false is
+//! returned, then the function aborted the enumeration process.
+//!
+//! @param    pNodeList   The node list to be enumerated.
+//! @param    f           The function to call for each node. See Msxmlx::ForEachNodeCB.
+//! @param    context     A value that is passed to the function.
+//!
+//! @return        false if the function aborted the enumeration.
+
+bool ForEachNode(IXMLDOMNodeList * pNodeList, ForEachNodeCB f)
+{
+    bool bContinue = true;
+    CComPtr<IXMLDOMNode> pNode;
+
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    for (pNodeList->nextNode(&pNode); pNode && bContinue; pNodeList->nextNode(&pNode))
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        bContinue = f(pNode);
+        pNode.Release();
+    }
+
+    return bContinue;
+}
+
+//! This function calls the specified function for each element node in the specified node list. If
+//! false is returned, then the function aborted the enumeration process.
+//!
+//! @param    pNodeList    The node whose subnodes are to be enumerated.
+//! @param    f    The function to call for each element. See Msxmlx::ForEachElementCB.
+//! @param    context        A value that is passed to the function.
+//!
+//! @return        false if the function aborted the enumeration.
+
+bool ForEachElement(IXMLDOMNodeList * pNodeList, ForEachElementCB f)
+{
+    bool bContinue = true;
+    CComPtr<IXMLDOMNode> pNode;
+
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    for (pNodeList->nextNode(&pNode); pNode && bContinue; pNodeList->nextNode(&pNode))
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (IsElementNode(pNode))
+            bContinue = f(CComQIPtr<IXMLDOMElement>(pNode));
+
+        pNode.Release();
+    }
+
+    return bContinue;
+}
+
+//! This function calls the specified function for each subnode of the specified node. If false is
+//! returned, then the function aborted the enumeration process.
+//!
+//! @param    pNode        The node whose subnodes are to be enumerated.
+//! @param    f    The function to call for each subnode. See Msxmlx::ForEachNodeCB.
+//! @param    context        A value that is passed to the function.
+//!
+//! @return        false, if the function aborted the enumeration.
+
+bool ForEachSubNode(IXMLDOMNode * pNode, ForEachNodeCB f)
+{
+    HRESULT hr;
+    CComPtr<IXMLDOMNodeList> pSubNodeList;
+
+    hr = pNode->get_childNodes(&pSubNodeList);
+
+    return ForEachNode(pSubNodeList, f);
+}
+
+//! This function calls the specified function for each element subnode of the specified node. If false
+//! is returned, then the function aborted the enumeration process.
+//!
+//! @param    pNode        The node whose subnodes are to be enumerated.
+//! @param    f    The function to call for each subnode. See Msxmlx::ForEachElementCB.
+//! @param    context        A value that is passed to the function.
+//!
+//! @return        false, if the function aborted the enumeration.
+
+bool ForEachSubElement(IXMLDOMNode * pNode, ForEachElementCB f)
+{
+    HRESULT hr;
+    CComPtr<IXMLDOMNodeList> pSubNodeList;
+
+    hr = pNode->get_childNodes(&pSubNodeList);
+
+    return ForEachElement(pSubNodeList, f);
+}
+
+//! @param    pNodeList    The node list. The iterator starts at its current position.
+
+NodeIterator::NodeIterator(IXMLDOMNodeList * pNodeList)
+    : pNodeList_(pNodeList)
+{
+    pNodeList_->nextNode(&pNode_);
+}
+
+NodeIterator & NodeIterator::operator ++()
+{
+    pNode_.Release();
+    pNodeList_->nextNode(&pNode_);
+    return *this;
+}
+
+//! @return        An iterator at the first node of the list
+
+NodeIterator NodeRange::begin() const
+{
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    pNodeList_->reset();
+    return NodeIterator(pNodeList_);
+}
+
+//! @param    pFirst    The first node to consider, or NULL for an empty range
+//! @param    pName     Name of the elements to iterate, or NULL for all elements
+
+ElementIterator::ElementIterator(IXMLDOMNode * pFirst, Name const * pName)
+    : pNode_(pFirst)
+    , pName_(pName)
+{
+    settle();
+}
+
+ElementIterator & ElementIterator::operator ++()
+{
+    CComPtr<IXMLDOMNode> pNext;
+
+    pNode_->get_nextSibling(&pNext);
+    pNode_ = pNext;
+    settle();
+    return *this;
+}
+
+// Advances to the first matching element at or after the current node
+void ElementIterator::settle()
+{
+    pElement_.Release();
+
+    while (pNode_)
     {
-        CComVariant value;
-        hr = pAttribute->get_nodeTypedValue(&value);
-        hr = value.ChangeType(VT_R4);
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (IsElementNode(pNode_))
+        {
+            bool matches = true;
+            if (pName_)
+            {
+                CComBSTR tag;
+                pNode_->get_nodeName(&tag);
+                Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::ALLOCATED,
+                                     sizeof(uint32_t) + (tag.Length() + 1) * sizeof(wchar_t));
+                matches = pName_->Matches(tag, tag.Length());
+            }
+            if (matches)
+            {
+                pElement_ = CComQIPtr<IXMLDOMElement>(pNode_);
+                return;
+            }
+        }
 
-        return value.fltVal;
+        CComPtr<IXMLDOMNode> pNext;
+        pNode_->get_nextSibling(&pNext);
+        pNode_ = pNext;
     }
-    else
+}
+
+//! @return        An iterator at the first matching element child
+
+ElementIterator ElementRange::begin() const
+{
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    CComPtr<IXMLDOMNode> pFirst;
+
+    pParent_->get_firstChild(&pFirst);
+    return ElementIterator(pFirst, pName_);
+}
+
+//! This function creates an element with the given name containing a single text sub-node with the given value.
+//!
+//! @param    pDocument        Document containing the node
+//! @param    sName            Name of the node
+//! @param    value            Value of the text
+//! @param    ppResult        Where to put the created node
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the node could not be created.
+
+HRESULT CreateTextElement(IXMLDOMDocument2 * pDocument,
+                          char const * sName, VARIANT const & value,
+                          IXMLDOMElement ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::CREATE_TEXT_ELEMENT);
+    return createTextElement(pDocument, WideName(sName), value, ppResult);
+}
+
+//! This overload uses a pre-converted name, so nothing is allocated to look it up.
+//!
+//! This function creates an element with the given name containing a single text sub-node with the given value.
+//!
+//! @param    pDocument        Document containing the node
+//! @param    name             Name of the node
+//! @param    value            Value of the text
+//! @param    ppResult        Where to put the created node
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the node could not be created.
+
+HRESULT CreateTextElement(IXMLDOMDocument2 * pDocument,
+                          Name const & name, VARIANT const & value,
+                          IXMLDOMElement ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::CREATE_TEXT_ELEMENT);
+    return createTextElement(pDocument, bstr(name), value, ppResult);
+}
+
+//! This is the equivalent of calling CreateTextElement() for each value and appending the elements to a fragment, but
+//! the values are converted into a single reused buffer instead of a VARIANT each. The fragment is not part of the
+//! document, so appending the elements to it is cheap, and appending the fragment to a node then moves all of them
+//! at once.
+//!
+//! @param    pDocument    Document that creates the elements
+//! @param    pValues      Names and values of the elements, in order
+//! @param    count        Number of elements
+//! @param    ppResult     Where to put the created fragment
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and an error if any element could not be created.
+
+HRESULT CreateTextElements(IXMLDOMDocument2 *         pDocument,
+                           TextElementValue const *   pValues,
+                           size_t                     count,
+                           IXMLDOMDocumentFragment ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::CREATE_TEXT_ELEMENT);
+    HRESULT hr;
+    CComPtr<IXMLDOMDocumentFragment> pFragment;
+    BstrBuffer                       value;
+
+    if (FAILED(hr = pDocument->createDocumentFragment(&pFragment)))
+        return hr;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        hr = appendTextElement(pDocument, pFragment, bstr(pValues[i].name), value.Convert(pValues[i].value));
+        if (FAILED(hr))
+            return hr;
+    }
+
+    pFragment.CopyTo(ppResult);
+    return S_OK;
+}
+
+//! @param    pDocument    Document that creates the elements
+//! @param    values       Names and values of the elements, in order
+//! @param    ppResult     Where to put the created fragment
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and an error if any element could not be created.
+
+HRESULT CreateTextElements(IXMLDOMDocument2 *                    pDocument,
+                           std::vector<TextElementValue> const & values,
+                           IXMLDOMDocumentFragment **            ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::CREATE_TEXT_ELEMENT);
+    return CreateTextElements(pDocument, values.data(), values.size(), ppResult);
+}
+
+//! An element is created for each occurrence of each sub-element field: none for an empty std::optional, and one for
+//! each item of a std::vector. The elements are in the order of the descriptors, which for a binding is the order in
+//! which the fields were declared (see Binding::Declared()). The values are formatted so that Deserialize() reads
+//! them back. Attribute fields and nested structs are ignored.
+//!
+//! @param    pDocument    Document that creates the elements
+//! @param    pObject      The object
+//! @param    pFields      Descriptors of the sub-element fields
+//! @param    count        Number of descriptors
+//! @param    ppResult     Where to put the created fragment
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and an error if any element could not be created.
+
+HRESULT CreateTextElements(IXMLDOMDocument2 *         pDocument,
+                           void const *               pObject,
+                           FieldDescriptor const *    pFields,
+                           size_t                     count,
+                           IXMLDOMDocumentFragment ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::CREATE_TEXT_ELEMENT);
+    HRESULT hr;
+    CComPtr<IXMLDOMDocumentFragment> pFragment;
+    BstrBuffer                       name;
+    BstrBuffer                       value;
+    std::string                      text;
+
+    if (FAILED(hr = pDocument->createDocumentFragment(&pFragment)))
+        return hr;
+
+    for (FieldDescriptor const * pField = pFields; pField < pFields + count; ++pField)
+    {
+        if (pField->kind != FieldKind::SubElement || !pField->get)
+            continue;
+
+        for (size_t i = 0; pField->get(pObject, i, text); ++i)
+        {
+            if (FAILED(hr = appendTextElement(pDocument, pFragment, name.Convert(pField->name), value.Convert(text))))
+                return hr;
+        }
+    }
+
+    pFragment.CopyTo(ppResult);
+    return S_OK;
+}
+
+void ChildIndex::Invalidate()
+{
+    built_ = false;
+    entries_.clear();
+    chains_.clear();
+}
+
+//! @param    pElement    The element to index. The index is built on the next lookup.
+
+void ChildIndex::Reset(IXMLDOMElement * pElement)
+{
+    Invalidate();
+    pElement_ = pElement;
+}
+
+//! @param    name        Name of the sub-element
+//! @param    ppResult    Location to put the element pointer or NULL.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FALSE if the named element was not found.
+
+HRESULT ChildIndex::GetSubElement(Name const & name, IXMLDOMElement ** ppResult)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    HRESULT hr;
+
+    *ppResult = nullptr;
+
+    if (!built_ && FAILED(hr = build()))
+        return hr;
+
+    auto chain = chains_.find(name.Hash());
+    if (chain != chains_.end())
+    {
+        for (uint32_t i = chain->second.first; i != NONE; i = entries_[i].next)
+        {
+            Instrumentation::Add(Instrumentation::Counter::SCANNED);
+            if (name.Matches(entries_[i].tag, entries_[i].tag.Length()))
+                return entries_[i].pElement.CopyTo(ppResult);
+        }
+    }
+
+    return S_FALSE;
+}
+
+//! The sub-elements are enumerated in document order. If the index cannot be built, the function is not called.
+//!
+//! @param    name          Name of the sub-elements
+//! @param    f             The function to call for each sub-element. See Msxmlx::ForEachElementCB.
+//! @param    pCompleted    Location to put false if the function aborted the enumeration, or true otherwise. May be
+//!                         NULL.
+//!
+//! @return        The HRESULT, S_OK if everything is ok or the error from reading the children.
+
+HRESULT ChildIndex::ForEachSubElement(Name const & name, ForEachElementCB f, bool * pCompleted /* = NULL*/)
+{
+    HRESULT hr;
+
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    if (pCompleted)
+        *pCompleted = true;
+
+    if (!built_ && FAILED(hr = build()))
+        return hr;
+
+    auto chain = chains_.find(name.Hash());
+    if (chain != chains_.end())
+    {
+        for (uint32_t i = chain->second.first; i != NONE; i = entries_[i].next)
+        {
+            Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+            if (name.Matches(entries_[i].tag, entries_[i].tag.Length()) && !f(entries_[i].pElement))
+            {
+                if (pCompleted)
+                    *pCompleted = false;
+                return S_OK;
+            }
+        }
+    }
+
+    return S_OK;
+}
+
+//! @param    pCount    Location to put the number of element children of the indexed element, or 0 if there is an
+//!                     error.
+//!
+//! @return        The HRESULT, S_OK if everything is ok or the error from reading the children.
+
+HRESULT ChildIndex::Size(size_t * pCount)
+{
+    HRESULT hr;
+
+    *pCount = 0;
+
+    if (!built_ && FAILED(hr = build()))
+        return hr;
+
+    *pCount = entries_.size();
+    return S_OK;
+}
+
+// Scans the children of the element once, recording each element child by the hash of its tag name.
+HRESULT ChildIndex::build()
+{
+    HRESULT hr;
+    CComPtr<IXMLDOMNodeList> pNodeList;
+    CComPtr<IXMLDOMNode>     pSubNode;
+
+    Invalidate();
+
+    if (FAILED(hr = pElement_->get_childNodes(&pNodeList)))
+        return hr;
+
+    for (pNodeList->nextNode(&pSubNode); pSubNode; pNodeList->nextNode(&pSubNode))
     {
-        return fDefault;
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (IsElementNode(pSubNode))
+        {
+            Entry entry;
+
+            pSubNode->get_nodeName(&entry.tag);
+            countBstr(entry.tag);
+            entry.hash     = Name::Hash(entry.tag, entry.tag.Length());
+            entry.pElement = CComQIPtr<IXMLDOMElement>(pSubNode);
+            entry.next     = NONE;
+
+            uint32_t index = uint32_t(entries_.size());
+            auto inserted = chains_.emplace(entry.hash, Chain{ index, index });
+            if (!inserted.second)
+            {
+                entries_[inserted.first->second.last].next = index;
+                inserted.first->second.last = index;
+            }
+
+            entries_.push_back(std::move(entry));
+        }
+
+        pSubNode.Release();
     }
+
+    built_ = true;
+    return S_OK;
+}
+
+//! @param    index           Index of the element to query
+//! @param    name            Name of the sub-element
+//! @param    ppAttributes    Location to put the attributes pointer, or NULL if there is an error.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FALSE if the named element was not found.
+
+HRESULT GetSubElementAttributes(ChildIndex & index, Name const & name, IXMLDOMNamedNodeMap ** ppAttributes)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    HRESULT hr;
+    CComPtr<IXMLDOMElement> pSubElement;
+
+    hr = index.GetSubElement(name, &pSubElement);
+
+    if (pSubElement)
+        hr = pSubElement->get_attributes(ppAttributes);
+    else
+        *ppAttributes = nullptr;
+
+    return hr;
+}
+
+//! @param    index     Index of the element to query
+//! @param    name      Name of the sub-element
+//! @param    pValue    Location to put the value.
+//!
+//! @return        The HRESULT, generally S_OK if everything is ok and S_FALSE if the named element was not found.
+
+HRESULT GetSubElementValue(ChildIndex & index, Name const & name, VARIANT * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT hr;
+    CComPtr<IXMLDOMElement> pSubElement;
+
+    hr = index.GetSubElement(name, &pSubElement);
+
+    if (pSubElement)
+        hr = getFirstText(pSubElement, pValue);
+
+    return hr;
+}
+
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    sDefault    Value to return if the sub-element is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the sub-element (coerced to a string, if necessary)
+
+std::string GetStringSubElement(ChildIndex & index, Name const & name, char const * sDefault /* = ""*/)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string value;
+    if (QueryStringSubElement(index, name, &value) != S_OK)
+        value = sDefault;
+    return value;
+}
+
+//! @param    index     Index of the element to query
+//! @param    name      Name of the sub-element to get
+//! @param    pValue    String to receive the value. Its memory is reused, so nothing is allocated unless the value is
+//!                     longer than the string's capacity. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, or another error.
+
+HRESULT QueryStringSubElement(ChildIndex & index, Name const & name, std::string * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
+
+    hr = GetSubElementValue(index, name, &value);
+    if (hr == S_OK)
+        toString(value, *pValue);
+
+    return hr;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the attribute to get
-//! @param    iDefault        Value to return if the attribute is not present. The default default value is 0.
+//! The value is converted directly to UTF-8 in the buffer, so nothing is allocated.
 //!
-//! @return        The value of the attribute (coerced to an int, if necessary), or the default value if the attribute
-//!                is not present.
-
-int GetIntAttribute(IXMLDOMElement * pElement, char const * sName, int iDefault /* = 0*/)
+//! @param    index      Index of the element to query
+//! @param    name       Name of the sub-element to get
+//! @param    pBuffer    Buffer to receive the value, which is terminated if it fits
+//! @param    size       Size of the buffer in bytes
+//! @param    pLength    If not NULL, receives the length in bytes of the value, without the terminator, whether or
+//!                      not it fits
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present,
+//!                E_NOT_SUFFICIENT_BUFFER if the value does not fit, or another error.
+
+HRESULT QueryStringSubElement(ChildIndex &  index,
+                              Name const &  name,
+                              char *        pBuffer,
+                              size_t        size,
+                              size_t *      pLength /* = NULL*/)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = pElement->getAttribute(CComBSTR(sName), &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_INT);
+        hr = toString(value, pBuffer, size, pLength);
 
-        return value.intVal;
-    }
-    else
-    {
-        return iDefault;
-    }
+    return hr;
 }
 
-//! @param    pAttributes        Attribute list
-//! @param    sName            Name of the attribute to get
-//! @param    iDefault        Value to return if the attribute is not present. The default default value is 0.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    fDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
 //!
-//! @return        The value of the attribute (coerced to an int, if necessary), or the default value if the attribute
-//!                is not present.
+//! @return        The value of the sub-element (coerced to a float, if necessary)
 
-int GetIntAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, int iDefault /* = 0*/)
+float GetFloatSubElement(ChildIndex & index, Name const & name, float fDefault /* = 0.f*/)
 {
-    HRESULT hr;
-    CComPtr<IXMLDOMNode> pAttribute;
-
-    hr = pAttributes->getNamedItem(CComBSTR(sName), &pAttribute);
-    if (hr == S_OK)
-    {
-        CComVariant value;
-        hr = pAttribute->get_nodeTypedValue(&value);
-        hr = value.ChangeType(VT_INT);
-
-        return value.intVal;
-    }
-    else
-    {
-        return iDefault;
-    }
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    float value;
+    return (QueryFloatSubElement(index, name, &value) == S_OK) ? value : fDefault;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the attribute to get
-//! @param    iDefault        Value to return if the attribute is not present. The default default value is 0.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
 //!
-//! @return        The value of the attribute (coerced to an unsigned int, if necessary), or the default value if the
-//!                attribute is not present.
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
 
-uint32_t GetHexAttribute(IXMLDOMElement * pElement, char const * sName, uint32_t iDefault /* = 0*/)
+HRESULT QueryFloatSubElement(ChildIndex & index, Name const & name, float * pValue)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = pElement->getAttribute(CComBSTR(sName), &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_BSTR);
-        return wcstoul(value.bstrVal, NULL, 16);
-    }
-    else
-    {
-        return iDefault;
-    }
+        hr = parseValue(value, pValue, ParseFloat);
+
+    return hr;
 }
 
-//! @param    pAttributes        Attribute list
-//! @param    sName            Name of the attribute to get
-//! @param    iDefault        Value to return if the attribute is not present. The default default value is 0.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
 //!
-//! @return        The value of the attribute (coerced to an unsigned int, if necessary), or the default value if the
-//!                attribute is not present.
+//! @return        The value of the sub-element (coerced to an int, if necessary)
 
-uint32_t GetHexAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, uint32_t iDefault /* = 0*/)
+int GetIntSubElement(ChildIndex & index, Name const & name, int iDefault /* = 0*/)
 {
-    HRESULT hr;
-    CComPtr<IXMLDOMNode> pAttribute;
-
-    hr = pAttributes->getNamedItem(CComBSTR(sName), &pAttribute);
-    if (hr == S_OK)
-    {
-        CComVariant value;
-        hr = pAttribute->get_nodeTypedValue(&value);
-        hr = value.ChangeType(VT_UINT);
-
-        return value.uintVal;
-    }
-    else
-    {
-        return iDefault;
-    }
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    int value;
+    return (QueryIntSubElement(index, name, &value) == S_OK) ? value : iDefault;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the attribute to get
-//! @param    bDefault        Value to return if the attribute is not present. The default default value is false.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
 //!
-//! @return        The value of the attribute (coerced to a bool, if necessary), or the default value if the
-//!                attribute is not present.
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
 
-bool GetBoolAttribute(IXMLDOMElement * pElement, char const * sName, bool bDefault /* = false*/)
+HRESULT QueryIntSubElement(ChildIndex & index, Name const & name, int * pValue)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = pElement->getAttribute(CComBSTR(sName), &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_BOOL);
+        hr = parseValue(value, pValue, ParseInt);
 
-        return value.boolVal != 0;
-    }
-    else
-    {
-        return bDefault;
-    }
+    return hr;
 }
 
-//! @param    pAttributes        Attribute list
-//! @param    sName            Name of the attribute to get
-//! @param    bDefault        Value to return if the attribute is not present. The default default value is false.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
 //!
-//! @return        The value of the attribute (coerced to an bool, if necessary), or the default value if the
-//!                attribute is not present.
+//! @return        The value of the sub-element (coerced to an unsigned int, if necessary)
 
-bool GetBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, bool bDefault /* = false*/)
+uint32_t GetHexSubElement(ChildIndex & index, Name const & name, uint32_t iDefault /* = 0*/)
 {
-    HRESULT hr;
-    CComPtr<IXMLDOMNode> pAttribute;
-
-    hr = pAttributes->getNamedItem(CComBSTR(sName), &pAttribute);
-    if (hr == S_OK)
-    {
-        CComVariant value;
-        hr = pAttribute->get_nodeTypedValue(&value);
-        hr = value.ChangeType(VT_BOOL);
-
-        return value.boolVal != 0;
-    }
-    else
-    {
-        return bDefault;
-    }
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    uint32_t value;
+    return (QueryHexSubElement(index, name, &value) == S_OK) ? value : iDefault;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the sub-element to get
-//! @param    sDefault        Value to return if the sub-element is not present. The default default value is an empty
-//!                            string.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
 //!
-//! @return        The value of the sub-element (coerced to a string, if necessary)
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
 
-std::string GetStringSubElement(IXMLDOMElement * pElement, char const * sName, char const * sDefault /* = ""*/)
+HRESULT QueryHexSubElement(ChildIndex & index, Name const & name, uint32_t * pValue)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = GetSubElementValue(pElement, sName, &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        USES_CONVERSION;
-        hr = value.ChangeType(VT_BSTR);
+        hr = parseValue(value, pValue, ParseHex);
 
-        return std::string(OLE2CA(value.bstrVal));
-    }
-    else
-    {
-        return std::string(sDefault);
-    }
+    return hr;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the sub-element to get
-//! @param    fDefault        Value to return if the sub-element is not present. The default default value is 0.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    bDefault    Value to return if the sub-element is not present or invalid.
+//!                       The default default value is false.
 //!
-//! @return        The value of the sub-element (coerced to a float, if necessary)
+//! @return        The value of the sub-element (coerced to a bool, if necessary)
 
-float GetFloatSubElement(IXMLDOMElement * pElement, char const * sName, float fDefault /* = 0.f*/)
+bool GetBoolSubElement(ChildIndex & index, Name const & name, bool bDefault /* = false*/)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    bool value;
+    return (QueryBoolSubElement(index, name, &value) == S_OK) ? value : bDefault;
+}
+
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValue      Location to put the value. It is not changed unless the result is S_OK.
+//!
+//! @return        S_OK if the value was converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH if it
+//!                is not valid, or another error.
+
+HRESULT QueryBoolSubElement(ChildIndex & index, Name const & name, bool * pValue)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = GetSubElementValue(pElement, sName, &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_R4);
+        hr = parseValue(value, pValue, ParseBool);
 
-        return value.fltVal;
-    }
-    else
-    {
-        return fDefault;
-    }
+    return hr;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the sub-element to get
-//! @param    iDefault        Value to return if the sub-element is not present. The default default value is 0.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
 //!
-//! @return        The value of the sub-element (coerced to an int, if necessary), or the default value if the sub-element
-//!                is not present.
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
 
-int GetIntSubElement(IXMLDOMElement * pElement, char const * sName, int iDefault /* = 0*/)
+HRESULT QueryFloatArraySubElement(ChildIndex & index, Name const & name, std::vector<float> * pValues)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = GetSubElementValue(pElement, sName, &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_INT);
-
-        return value.intVal;
-    }
+        hr = parseArray(value, pValues, ParseFloatArray);
     else
-    {
-        return iDefault;
-    }
+        pValues->clear();
+
+    return hr;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the sub-element to get
-//! @param    iDefault        Value to return if the sub-element is not present. The default default value is 0.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the sub-element is not present or a value is not valid.
 //!
-//! @return        The value of the sub-element (coerced to an unsigned int, if necessary), or the default value if the
-//!                sub-element is not present.
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
 
-uint32_t GetHexSubElement(IXMLDOMElement * pElement, char const * sName, uint32_t iDefault /* = 0*/)
+HRESULT QueryFloatArraySubElement(ChildIndex & index, Name const & name, float * pValues, size_t * pCount)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = GetSubElementValue(pElement, sName, &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_BSTR);
-        return wcstoul(value.bstrVal, NULL, 16);
-    }
+        hr = parseArray(value, pValues, pCount, ParseFloatArray);
     else
-    {
-        return iDefault;
-    }
+        *pCount = 0;
+
+    return hr;
 }
 
-//! @param    pElement        Element to query
-//! @param    sName            Name of the sub-element to get
-//! @param    bDefault        Value to return if the sub-element is not present. The default default value is false.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
 //!
-//! @return        The value of the sub-element (coerced to a bool, if necessary), or the default value if the
-//!                sub-element is not present.
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
 
-bool GetBoolSubElement(IXMLDOMElement * pElement, char const * sName, bool bDefault /* = false*/)
+HRESULT QueryIntArraySubElement(ChildIndex & index, Name const & name, std::vector<int> * pValues)
 {
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
     HRESULT     hr;
     CComVariant value;
 
-    hr = GetSubElementValue(pElement, sName, &value);
+    hr = GetSubElementValue(index, name, &value);
     if (hr == S_OK)
-    {
-        hr = value.ChangeType(VT_BOOL);
-
-        return value.boolVal != 0;
-    }
+        hr = parseArray(value, pValues, ParseIntArray);
     else
-    {
-        return bDefault;
-    }
+        pValues->clear();
+
+    return hr;
 }
 
-//! This function calls the specified function for each node in the specified node list. If false is
-//! returned, then the function aborted the enumeration process.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the sub-element is not present or a value is not valid.
 //!
-//! @param    pNodeList   The node list to be enumerated.
-//! @param    f           The function to call for each node. See Msxmlx::ForEachNodeCB.
-//! @param    context     A value that is passed to the function.
-//!
-//! @return        false if the function aborted the enumeration.
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
 
-bool ForEachNode(IXMLDOMNodeList * pNodeList, ForEachNodeCB f)
+HRESULT QueryIntArraySubElement(ChildIndex & index, Name const & name, int * pValues, size_t * pCount)
 {
-    bool bContinue = true;
-    CComPtr<IXMLDOMNode> pNode;
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
 
-    for (pNodeList->nextNode(&pNode); pNode && bContinue; pNodeList->nextNode(&pNode))
-    {
-        bContinue = f(pNode);
-        pNode.Release();
-    }
+    hr = GetSubElementValue(index, name, &value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseIntArray);
+    else
+        *pCount = 0;
 
-    return bContinue;
+    return hr;
 }
 
-//! This function calls the specified function for each element node in the specified node list. If
-//! false is returned, then the function aborted the enumeration process.
-//!
-//! @param    pNodeList    The node whose subnodes are to be enumerated.
-//! @param    f    The function to call for each element. See Msxmlx::ForEachElementCB.
-//! @param    context        A value that is passed to the function.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values. It is emptied if the result is not S_OK.
 //!
-//! @return        false if the function aborted the enumeration.
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, or another error.
 
-bool ForEachElement(IXMLDOMNodeList * pNodeList, ForEachElementCB f)
+HRESULT QueryHexArraySubElement(ChildIndex & index, Name const & name, std::vector<uint32_t> * pValues)
 {
-    bool bContinue = true;
-    CComPtr<IXMLDOMNode> pNode;
-
-    for (pNodeList->nextNode(&pNode); pNode && bContinue; pNodeList->nextNode(&pNode))
-    {
-        if (IsElementNode(pNode))
-            bContinue = f(CComQIPtr<IXMLDOMElement>(pNode));
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
 
-        pNode.Release();
-    }
+    hr = GetSubElementValue(index, name, &value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, ParseHexArray);
+    else
+        pValues->clear();
 
-    return bContinue;
+    return hr;
 }
 
-//! This function calls the specified function for each subnode of the specified node. If false is
-//! returned, then the function aborted the enumeration process.
-//!
-//! @param    pNode        The node whose subnodes are to be enumerated.
-//! @param    f    The function to call for each subnode. See Msxmlx::ForEachNodeCB.
-//! @param    context        A value that is passed to the function.
+//! @param    index       Index of the element to query
+//! @param    name        Name of the sub-element to get
+//! @param    pValues     Location to put the values
+//! @param    pCount      On input, the size of the array. On output, the number of values (even if they do not all
+//!                       fit), or 0 if the sub-element is not present or a value is not valid.
 //!
-//! @return        false, if the function aborted the enumeration.
+//! @return        S_OK if the values were converted, S_FALSE if the sub-element is not present, DISP_E_TYPEMISMATCH
+//!                if a value is not valid, E_NOT_SUFFICIENT_BUFFER if they do not all fit, or another error.
 
-bool ForEachSubNode(IXMLDOMNode * pNode, ForEachNodeCB f)
+HRESULT QueryHexArraySubElement(ChildIndex & index, Name const & name, uint32_t * pValues, size_t * pCount)
 {
-    HRESULT hr;
-    CComPtr<IXMLDOMNodeList> pSubNodeList;
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    HRESULT     hr;
+    CComVariant value;
 
-    hr = pNode->get_childNodes(&pSubNodeList);
+    hr = GetSubElementValue(index, name, &value);
+    if (hr == S_OK)
+        hr = parseArray(value, pValues, pCount, ParseHexArray);
+    else
+        *pCount = 0;
 
-    return ForEachNode(pSubNodeList, f);
+    return hr;
 }
 
-//! This function calls the specified function for each element subnode of the specified node. If false
-//! is returned, then the function aborted the enumeration process.
+//! The attribute list is enumerated once, instead of looking up each bound attribute separately. Attributes that are
+//! not bound are ignored, and fields whose attributes are not present are not changed.
 //!
-//! @param    pNode        The node whose subnodes are to be enumerated.
-//! @param    f    The function to call for each subnode. See Msxmlx::ForEachElementCB.
-//! @param    context        A value that is passed to the function.
+//! @param    pElement    The element whose attributes are to be stored
+//! @param    pObject     The object to receive the values
+//! @param    pFields     The field descriptors, sorted by hash
+//! @param    count       Number of descriptors
 //!
-//! @return        false, if the function aborted the enumeration.
+//! @return        The HRESULT, generally S_OK, or DISP_E_TYPEMISMATCH if the value of any bound attribute was invalid.
 
-bool ForEachSubElement(IXMLDOMNode * pNode, ForEachElementCB f)
+HRESULT BindAttributes(IXMLDOMElement * pElement, void * pObject, FieldDescriptor const * pFields, size_t count)
 {
     HRESULT hr;
-    CComPtr<IXMLDOMNodeList> pSubNodeList;
+    CComPtr<IXMLDOMNamedNodeMap> pAttributes;
+    CComPtr<IXMLDOMNode>         pAttribute;
+    bool                         valid = true;
 
-    hr = pNode->get_childNodes(&pSubNodeList);
+    if (FAILED(hr = pElement->get_attributes(&pAttributes)))
+        return hr;
 
-    return ForEachElement(pSubNodeList, f);
+    for (pAttributes->nextNode(&pAttribute); pAttribute; pAttributes->nextNode(&pAttribute))
+    {
+        CComBSTR tag;
+        pAttribute->get_nodeName(&tag);
+
+        FieldDescriptor const * pField = FindField(pFields, count, tag, tag.Length());
+        if (pField)
+        {
+            CComVariant value;
+            hr = pAttribute->get_nodeValue(&value);
+            if (SUCCEEDED(hr) && value.vt == VT_BSTR)
+            {
+                if (!pField->setWide(pObject, std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal))))
+                    valid = false;
+            }
+        }
+
+        pAttribute.Release();
+    }
+
+    return valid ? S_OK : DISP_E_TYPEMISMATCH;
 }
 
-//! This function creates an element with the given name containing a single text sub-node with the given value.
+//! The attributes and the children of the element are each enumerated once. A sub-element bound to a struct with a
+//! Schema is deserialized recursively.
 //!
-//! @param    pDocument        Document containing the node
-//! @param    sName            Name of the node
-//! @param    value            Value of the text
-//! @param    ppResult        Where to put the created node
+//! @param    pElement          The element to deserialize
+//! @param    pObject           The object to receive the values
+//! @param    pFields           The field descriptors (see Binding::Data())
+//! @param    attributeCount    Number of attribute descriptors
+//! @param    count             Number of descriptors
 //!
-//! @return        The HRESULT, generally S_OK if everything is ok and S_FAIL if the node could not be created.
-
-HRESULT CreateTextElement(IXMLDOMDocument2 * pDocument,
-                          char const * sName, VARIANT const & value,
-                          IXMLDOMElement ** ppResult)
+//! @return        The HRESULT, generally S_OK, or DISP_E_TYPEMISMATCH if the value of any bound attribute or
+//!                sub-element was invalid.
+
+HRESULT DeserializeElement(IXMLDOMElement *        pElement,
+                           void *                  pObject,
+                           FieldDescriptor const * pFields,
+                           size_t                  attributeCount,
+                           size_t                  count)
 {
     HRESULT hr;
-    CComPtr<IXMLDOMElement> pElement;
+    CComPtr<IXMLDOMNodeList> pNodeList;
+    CComPtr<IXMLDOMNode>     pSubNode;
+    bool                     valid = true;
 
-    if (FAILED(hr = pDocument->createElement(CComBSTR(sName), &pElement)))
+    hr = BindAttributes(pElement, pObject, pFields, attributeCount);
+    if (FAILED(hr) && hr != DISP_E_TYPEMISMATCH)
         return hr;
+    valid = hr == S_OK;
 
-    CComPtr<IXMLDOMText> pText;
-    CComVariant          variant(value);
+    if (attributeCount == count)
+        return valid ? S_OK : DISP_E_TYPEMISMATCH;
 
-    variant.ChangeType(VT_BSTR, NULL);
+    FieldDescriptor const * pSubElements    = pFields + attributeCount;
+    size_t                  subElementCount = count - attributeCount;
 
-    if (FAILED(hr = pDocument->createTextNode(V_BSTR(&variant), &pText)))
-        return hr;
-    if (FAILED(hr = pElement->appendChild(pText, NULL)))
+    if (FAILED(hr = pElement->get_childNodes(&pNodeList)))
         return hr;
 
-    pElement.CopyTo(ppResult);
-    return S_OK;
+    for (pNodeList->nextNode(&pSubNode); pSubNode; pNodeList->nextNode(&pSubNode))
+    {
+        if (IsElementNode(pSubNode))
+        {
+            CComBSTR tag;
+            pSubNode->get_nodeName(&tag);
+
+            FieldDescriptor const * pField = FindField(pSubElements, subElementCount, tag, tag.Length());
+            if (pField)
+            {
+                CComQIPtr<IXMLDOMElement> pSubElement(pSubNode);
+                if (pField->kind == FieldKind::Nested)
+                {
+                    hr = DeserializeElement(pSubElement, pField->target(pObject), pField->pFields,
+                                            pField->attributeCount, pField->count);
+                    if (FAILED(hr) && hr != DISP_E_TYPEMISMATCH)
+                        return hr;
+                    if (hr != S_OK)
+                        valid = false;
+                }
+                else
+                {
+                    CComVariant       value;
+                    std::wstring_view text; // An element without text has an empty value
+
+                    getFirstText(pSubElement, &value);
+                    if (value.vt == VT_BSTR)
+                        text = std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal));
+                    if (!pField->setWide(pObject, text))
+                        valid = false;
+                }
+            }
+        }
+
+        pSubNode.Release();
+    }
+
+    return valid ? S_OK : DISP_E_TYPEMISMATCH;
 }
 } // namespace Msxmlx
@@ -0,0 +1,154 @@
+#include "Name.h"
+
+#include "Convert.h"
+#include "Instrumentation.h"
+
+#include <cstring>
+#include <cwchar>
+#include <utility>
+
+namespace
+{
+uint32_t hashByte(uint32_t hash, uint32_t b)
+{
+    return (hash ^ b) * 16777619u;
+}
+
+// The wide version of a name that has been moved from, laid out as a BSTR
+struct
+{
+    uint32_t byteCount;
+    wchar_t  characters[1];
+} const EMPTY_WIDE = { 0, { 0 } };
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    name    The name (UTF-8)
+
+Name::Name(std::string_view name)
+    : narrow_(name)
+    , hash_(Hash(name))
+{
+    wideLength_ = ToWide(name, nullptr);
+
+    uint32_t byteCount = uint32_t(wideLength_ * sizeof(wchar_t));
+    wide_.reset(new std::byte[sizeof(uint32_t) + (wideLength_ + 1) * sizeof(wchar_t)]);
+    memcpy(wide_.get(), &byteCount, sizeof(uint32_t));
+
+    wchar_t * characters = reinterpret_cast<wchar_t *>(wide_.get() + sizeof(uint32_t));
+    ToWide(name, characters);
+    characters[wideLength_] = 0;
+
+    Instrumentation::Add(Instrumentation::Counter::CONVERSIONS);
+    Instrumentation::Add(Instrumentation::Counter::ALLOCATED, sizeof(uint32_t) + (wideLength_ + 1) * sizeof(wchar_t));
+}
+
+//! @param    rhs    The name to move. It is left empty.
+
+Name::Name(Name && rhs) noexcept
+    : narrow_(std::move(rhs.narrow_))
+    , wide_(std::move(rhs.wide_))
+    , wideLength_(rhs.wideLength_)
+    , hash_(rhs.hash_)
+{
+    rhs.narrow_.clear();
+    rhs.wideLength_ = 0;
+    rhs.hash_       = Hash(std::string_view());
+}
+
+Name & Name::operator =(Name const & rhs)
+{
+    if (this != &rhs)
+        *this = Name(rhs.narrow_);
+    return *this;
+}
+
+//! @param    rhs    The name to move. It is left empty.
+
+Name & Name::operator =(Name && rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        narrow_     = std::move(rhs.narrow_);
+        wide_       = std::move(rhs.wide_);
+        wideLength_ = rhs.wideLength_;
+        hash_       = rhs.hash_;
+        rhs.narrow_.clear();
+        rhs.wideLength_ = 0;
+        rhs.hash_       = Hash(std::string_view());
+    }
+    return *this;
+}
+
+//! A name that has been moved from has no wide version of its own, so a shared empty BSTR is returned.
+//!
+//! @return        The wide version of the name, preceded by its byte count as in a BSTR
+
+wchar_t const * Name::Wide() const
+{
+    if (!wide_)
+        return EMPTY_WIDE.characters;
+    return reinterpret_cast<wchar_t const *>(wide_.get() + sizeof(uint32_t));
+}
+
+//! @param    wide      Text to compare
+//! @param    length    Number of characters in the text
+//!
+//! @return        true, if the text is the same as the wide version of the name
+
+bool Name::Matches(wchar_t const * wide, size_t length) const
+{
+    return length == wideLength_ && (length == 0 || wmemcmp(wide, Wide(), length) == 0);
+}
+
+//! Surrogate pairs are combined and each character is hashed as its UTF-8 encoding, so a wide tag name can be
+//! compared by hash with a Name without converting it.
+//!
+//! @param    wide      Text to hash
+//! @param    length    Number of characters in the text
+//!
+//! @return        The hash
+
+uint32_t Name::Hash(wchar_t const * wide, size_t length)
+{
+    uint32_t hash = Hash(std::string_view());
+    for (size_t i = 0; i < length; ++i)
+    {
+        uint32_t c = uint32_t(wide[i]);
+        if (sizeof(wchar_t) == 2 && c >= 0xd800 && c < 0xdc00 && i + 1 < length)
+        {
+            uint32_t low = uint32_t(wide[i + 1]);
+            if (low >= 0xdc00 && low < 0xe000)
+            {
+                c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                ++i;
+            }
+        }
+
+        if (c < 0x80)
+        {
+            hash = hashByte(hash, c);
+        }
+        else if (c < 0x800)
+        {
+            hash = hashByte(hash, 0xc0 | (c >> 6));
+            hash = hashByte(hash, 0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000)
+        {
+            hash = hashByte(hash, 0xe0 | (c >> 12));
+            hash = hashByte(hash, 0x80 | ((c >> 6) & 0x3f));
+            hash = hashByte(hash, 0x80 | (c & 0x3f));
+        }
+        else
+        {
+            hash = hashByte(hash, 0xf0 | (c >> 18));
+            hash = hashByte(hash, 0x80 | ((c >> 12) & 0x3f));
+            hash = hashByte(hash, 0x80 | ((c >> 6) & 0x3f));
+            hash = hashByte(hash, 0x80 | (c & 0x3f));
+        }
+    }
+    return hash;
+}
+} // namespace Msxmlx
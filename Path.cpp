@@ -0,0 +1,299 @@
+#include "Path.h"
+
+#include <algorithm>
+
+namespace
+{
+// Characters that cannot appear in a name in a path
+bool isDelimiter(char c)
+{
+    return c == '/' || c == '[' || c == ']' || c == '@' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Returns the end of the name at the start of some text
+size_t nameLength(std::string_view text)
+{
+    size_t n = 0;
+    while (n < text.size() && !isDelimiter(text[n]))
+    {
+        ++n;
+    }
+    return n;
+}
+
+// Returns the sub-element of an element at a step, or NONE
+Msxmlx::CompactDocument::Index step(Msxmlx::CompactDocument const & document,
+                                    Msxmlx::CompactDocument::Index  element,
+                                    uint32_t                        id,
+                                    uint32_t                        position)
+{
+    uint32_t count = 0;
+    for (auto child = document.FirstChild(element); child != Msxmlx::CompactDocument::NONE;
+         child      = document.NextSibling(child))
+    {
+        Msxmlx::Instrumentation::Add(Msxmlx::Instrumentation::Counter::SCANNED);
+        if (document.NameId(child) == id && ++count == position)
+            return child;
+    }
+    return Msxmlx::CompactDocument::NONE;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    text    The path (e.g. "render/light[2]/@color")
+//!
+//! @return        The compiled path. Use IsValid() to check for errors.
+
+Path Path::Compile(std::string_view text)
+{
+    Path path;
+    path.text_ = text;
+
+    std::string_view rest = text;
+    while (!rest.empty())
+    {
+        if (rest[0] == '@')
+        {
+            size_t length = nameLength(rest.substr(1));
+            if (length == 0 || length + 1 != rest.size())
+            {
+                path.error_ = "An attribute must be the last step and must have a name";
+                return path;
+            }
+            path.attribute_.emplace(rest.substr(1));
+            break;
+        }
+
+        size_t length = nameLength(rest);
+        if (length == 0)
+        {
+            path.error_ = "A step must have a name";
+            return path;
+        }
+
+        uint32_t position = 1;
+        size_t   end      = length;
+        if (end < rest.size() && rest[end] == '[')
+        {
+            position = 0;
+            for (++end; end < rest.size() && rest[end] >= '0' && rest[end] <= '9'; ++end)
+            {
+                position = (position > 100000000) ? 0xffffffff : position * 10 + uint32_t(rest[end] - '0');
+            }
+            if (end >= rest.size() || rest[end] != ']' || position == 0 || position == 0xffffffff)
+            {
+                path.error_ = "A position must be a number from 1, as in name[2]";
+                return path;
+            }
+            ++end;
+        }
+        path.steps_.push_back(Step{ Name(rest.substr(0, length)), position });
+
+        if (end < rest.size() && rest[end] != '/')
+        {
+            path.error_ = "Steps must be separated by '/'";
+            return path;
+        }
+        bool separated = end < rest.size();
+        rest.remove_prefix(separated ? end + 1 : end);
+        if (separated && rest.empty())
+        {
+            path.error_ = "A path cannot end with '/'";
+            return path;
+        }
+    }
+
+    return path;
+}
+
+//! @param    document    The document
+//! @param    element     The element the path starts from
+//! @param    path        The path
+//!
+//! @return        The element at the path, or NONE if it is not found or the path is not valid
+
+CompactDocument::Index Select(CompactDocument const & document, CompactDocument::Index element, Path const & path)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT);
+    if (!path.IsValid())
+        return CompactDocument::NONE;
+
+    for (Path::Step const & s : path.Steps())
+    {
+        if (element == CompactDocument::NONE)
+            break;
+
+        uint32_t id = document.FindName(s.name);
+        element     = (id != CompactDocument::NONE) ? step(document, element, id, s.position) : CompactDocument::NONE;
+    }
+    return element;
+}
+
+//! The value of an element is its first non-whitespace text, as with CompactDocument::GetSubElementValue().
+//!
+//! @param    document    The document
+//! @param    element     The element the path starts from
+//! @param    path        The path
+//! @param    value       Location to put the value
+//!
+//! @return        true, if the path was found
+
+bool Find(CompactDocument const & document,
+          CompactDocument::Index  element,
+          Path const &            path,
+          std::string_view &      value)
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    element = Select(document, element, path);
+    if (element == CompactDocument::NONE)
+        return false;
+
+    if (!path.HasAttribute())
+    {
+        value = document.Value(element);
+        return true;
+    }
+
+    uint32_t id = document.FindName(path.Attribute());
+    if (id == CompactDocument::NONE)
+        return false;
+
+    CompactDocument::Attributes attributes = document.GetAttributes(element);
+    for (uint32_t i = attributes.first; i < attributes.first + attributes.count; ++i)
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (document.AttributeNameId(i) == id)
+        {
+            value = document.AttributeValue(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Paths that share leading steps share the nodes of the tree for those steps.
+//!
+//! @param    path    The path
+//!
+//! @return        The index of the path's result in the results of Evaluate()
+
+size_t PathSet::Add(Path const & path)
+{
+    uint32_t result = uint32_t(resultCount_++);
+    if (!path.IsValid())
+        return result;
+
+    uint32_t node = 0;
+    for (Path::Step const & s : path.Steps())
+    {
+        uint32_t name = intern(s.name);
+        auto     same = std::find_if(nodes_[node].children.begin(), nodes_[node].children.end(), [&] (uint32_t child) {
+            return nodes_[child].name == name && nodes_[child].position == s.position;
+        });
+
+        if (same != nodes_[node].children.end())
+        {
+            node = *same;
+        }
+        else
+        {
+            nodes_[node].children.push_back(uint32_t(nodes_.size()));
+            node = uint32_t(nodes_.size());
+            nodes_.push_back(Node{ name, s.position, {}, {}, {} });
+        }
+    }
+
+    if (path.HasAttribute())
+    {
+        uint32_t name = intern(path.Attribute());
+        nodes_[node].attributes.push_back(name);
+        nodes_[node].attributes.push_back(result);
+    }
+    else
+    {
+        nodes_[node].results.push_back(result);
+    }
+    return result;
+}
+
+//! @param    document    The document
+//! @param    element     The element the paths start from
+//! @param    results     Receives the result of each path, in the order in which the paths were added
+
+void PathSet::Evaluate(CompactDocument const & document,
+                       CompactDocument::Index  element,
+                       std::vector<Result> &   results) const
+{
+    results.assign(resultCount_, Result{ CompactDocument::NONE, std::string_view(), false });
+    if (element == CompactDocument::NONE)
+        return;
+
+    std::vector<uint32_t> ids(names_.size());
+    for (size_t i = 0; i < names_.size(); ++i)
+    {
+        ids[i] = document.FindName(names_[i]);
+    }
+
+    std::vector<uint32_t> counts(nodes_.size(), 0);
+    visit(document, 0, element, ids.data(), counts.data(), results.data());
+}
+
+// Returns the index of a name in names_, adding it if necessary
+uint32_t PathSet::intern(std::string_view name)
+{
+    auto i = std::find(names_.begin(), names_.end(), name);
+    if (i != names_.end())
+        return uint32_t(i - names_.begin());
+
+    names_.emplace_back(name);
+    return uint32_t(names_.size() - 1);
+}
+
+// Finds the results of the paths through a node of the tree, given the element it matched. The sub-elements and
+// attributes of the element are each scanned once for all of the node's children and attributes.
+void PathSet::visit(CompactDocument const & document,
+                    uint32_t                node,
+                    CompactDocument::Index  element,
+                    uint32_t const *        pIds,
+                    uint32_t *              pCounts,
+                    Result *                pResults) const
+{
+    Node const & n = nodes_[node];
+
+    for (uint32_t result : n.results)
+    {
+        pResults[result] = Result{ element, document.Value(element), true };
+    }
+
+    if (!n.attributes.empty())
+    {
+        CompactDocument::Attributes attributes = document.GetAttributes(element);
+        for (uint32_t a = attributes.first; a < attributes.first + attributes.count; ++a)
+        {
+            uint32_t id = document.AttributeNameId(a);
+            for (size_t i = 0; i < n.attributes.size(); i += 2)
+            {
+                if (pIds[n.attributes[i]] == id)
+                    pResults[n.attributes[i + 1]] = Result{ element, document.AttributeValue(a), true };
+            }
+        }
+    }
+
+    // Stop scanning the sub-elements once every child of the node has been matched
+    size_t remaining = n.children.size();
+    for (auto child = document.FirstChild(element); child != CompactDocument::NONE && remaining > 0;
+         child      = document.NextSibling(child))
+    {
+        uint32_t id = document.NameId(child);
+        for (uint32_t c : n.children)
+        {
+            if (pIds[nodes_[c].name] == id && ++pCounts[c] == nodes_[c].position)
+            {
+                visit(document, c, child, pIds, pCounts, pResults);
+                --remaining;
+            }
+        }
+    }
+}
+} // namespace Msxmlx
@@ -0,0 +1,188 @@
+#include "PushParser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Msxmlx
+{
+// Builds a document from the events
+class PushParser::DocumentHandler : public SaxHandler
+{
+public:
+    explicit DocumentHandler(CompactDocument & document) : document_(document) {}
+
+    bool StartElement(StreamReader & reader) override
+    {
+        return builder_.StartElement(reader.Name(), reader.Attributes());
+    }
+
+    bool EndElement(StreamReader &) override
+    {
+        builder_.EndElement();
+        return true;
+    }
+
+    bool Text(StreamReader & reader) override
+    {
+        return builder_.Text(reader.Value(), reader.Current() == StreamReader::Token::CData, reader.IsTextContinued());
+    }
+
+    bool Finish() { return builder_.Finish(document_); }
+
+    char const * ErrorMessage() const { return builder_.ErrorMessage(); }
+
+private:
+    CompactDocument &        document_;
+    CompactDocument::Builder builder_;
+};
+
+//! @param    handler          The handler of the events
+//! @param    bufferSize       Initial size of the window that holds the data being parsed
+//! @param    maxBufferSize    Size to which the window may grow to hold a single tag
+
+PushParser::PushParser(SaxHandler & handler,
+                       size_t bufferSize /* = StreamReader::DEFAULT_BUFFER_SIZE*/,
+                       size_t maxBufferSize /* = StreamReader::DEFAULT_MAX_BUFFER_SIZE*/)
+    : reader_(source(), bufferSize, maxBufferSize)
+    , handler_(handler)
+{
+}
+
+//! @param    document         The document to replace when the parser finishes
+//! @param    bufferSize       Initial size of the window that holds the data being parsed
+//! @param    maxBufferSize    Size to which the window may grow to hold a single tag
+
+PushParser::PushParser(CompactDocument & document,
+                       size_t bufferSize /* = StreamReader::DEFAULT_BUFFER_SIZE*/,
+                       size_t maxBufferSize /* = StreamReader::DEFAULT_MAX_BUFFER_SIZE*/)
+    : reader_(source(), bufferSize, maxBufferSize)
+    , pDocumentHandler_(new DocumentHandler(document))
+    , handler_(*pDocumentHandler_)
+{
+}
+
+PushParser::~PushParser() = default;
+
+//! The piece is parsed before the call returns, and is not referenced afterwards. A piece may be empty.
+//!
+//! @param    pData    The piece
+//! @param    size     Size of the piece
+//!
+//! @return        false, if the handler stopped, the document is not well-formed, or Finish() has been called
+
+bool PushParser::Feed(char const * pData, size_t size)
+{
+    if (stopped_ || finished_)
+        return false;
+
+    pData_   = pData;
+    size_    = size;
+    stopped_ = !run();
+    return !stopped_;
+}
+
+//! If a document is being built, it replaces the contents of the given document.
+//!
+//! @return        false, if the handler stopped, the document is not well-formed or is incomplete, or the document
+//!                could not be built
+
+bool PushParser::Finish()
+{
+    if (stopped_ || finished_)
+        return false;
+
+    finished_ = true;
+    pData_    = nullptr;
+    size_     = 0;
+    stopped_  = !run() || reader_.Current() != StreamReader::Token::End ||
+               (pDocumentHandler_ && !pDocumentHandler_->Finish());
+    return !stopped_;
+}
+
+//! @return        A description of the error, or nullptr if there is none
+
+char const * PushParser::ErrorMessage() const
+{
+    if (reader_.ErrorMessage())
+        return reader_.ErrorMessage();
+    return pDocumentHandler_ ? pDocumentHandler_->ErrorMessage() : nullptr;
+}
+
+// Returns the source of the reader, which reads from the current piece. The reader waits for the next piece when it
+// has been read, unless the document has been finished.
+StreamReader::Source PushParser::source()
+{
+    return [this] (char * pBuffer, size_t size) -> ptrdiff_t {
+        if (size_ == 0)
+            return finished_ ? 0 : StreamReader::PENDING;
+        size = std::min(size, size_);
+        memcpy(pBuffer, pData_, size);
+        pData_ += size;
+        size_ -= size;
+        return ptrdiff_t(size);
+    };
+}
+
+// Reports the events of the data that is available, as ParseStream() does. Returns false if the handler stopped or
+// there was an error.
+bool PushParser::run()
+{
+    using Token = StreamReader::Token;
+
+    // An element skipped by the handler is skipped as the rest of it arrives
+    if (skipping_ >= 0)
+    {
+        Token t = reader_.Next();
+        while (t != Token::None && t != Token::End && t != Token::Error &&
+               (t != Token::EndElement || reader_.Depth() != skipping_))
+        {
+            t = reader_.Next();
+        }
+        if (t == Token::None)
+            return true;
+
+        skipping_ = -1;
+        if (t != Token::EndElement || !handler_.EndElement(reader_))
+            return false;
+    }
+
+    for (;;)
+    {
+        switch (reader_.Next())
+        {
+        case Token::None:
+        case Token::End:
+            return true;
+
+        case Token::StartElement:
+        {
+            int depth = reader_.Depth();
+            if (!handler_.StartElement(reader_))
+                return false;
+            if (reader_.Current() == Token::None)
+            {
+                skipping_ = depth;
+                return true;
+            }
+            if (reader_.Current() == Token::EndElement && !handler_.EndElement(reader_))
+                return false;
+            break;
+        }
+
+        case Token::EndElement:
+            if (!handler_.EndElement(reader_))
+                return false;
+            break;
+
+        case Token::Text:
+        case Token::CData:
+            if (!handler_.Text(reader_))
+                return false;
+            break;
+
+        default:
+            return false;
+        }
+    }
+}
+} // namespace Msxmlx
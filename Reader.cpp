@@ -0,0 +1,1236 @@
+#include "Reader.h"
+
+#include "Convert.h"
+#include "Scan.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+char const * skipWhitespace(char const * p, char const * end)
+{
+    while (p < end && isWhitespace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+using Msxmlx::Scan::FindChar;
+using Msxmlx::Scan::FindNameEnd;
+
+// Returns the first occurrence of the terminator, or nullptr if not found
+char const * findTerminator(char const * p, char const * end, char const * terminator)
+{
+    size_t length = strlen(terminator);
+    for (p = FindChar(p, end, terminator[0]); p < end; p = FindChar(p + 1, end, terminator[0]))
+    {
+        if (size_t(end - p) >= length && memcmp(p, terminator, length) == 0)
+            return p;
+    }
+    return nullptr;
+}
+
+bool startsWith(char const * p, char const * end, char const * prefix)
+{
+    size_t length = strlen(prefix);
+    return size_t(end - p) >= length && memcmp(p, prefix, length) == 0;
+}
+
+// Appends a code point as UTF-8
+void appendUtf8(uint32_t c, std::string & out)
+{
+    if (c < 0x80)
+    {
+        out.push_back(char(c));
+    }
+    else if (c < 0x800)
+    {
+        out.push_back(char(0xc0 | (c >> 6)));
+        out.push_back(char(0x80 | (c & 0x3f)));
+    }
+    else if (c < 0x10000)
+    {
+        out.push_back(char(0xe0 | (c >> 12)));
+        out.push_back(char(0x80 | ((c >> 6) & 0x3f)));
+        out.push_back(char(0x80 | (c & 0x3f)));
+    }
+    else
+    {
+        out.push_back(char(0xf0 | (c >> 18)));
+        out.push_back(char(0x80 | ((c >> 12) & 0x3f)));
+        out.push_back(char(0x80 | ((c >> 6) & 0x3f)));
+        out.push_back(char(0x80 | (c & 0x3f)));
+    }
+}
+
+// Converts the contents of a reference (without the & and ;) to a code point. Returns false if it is not valid.
+bool decodeReference(std::string_view reference, uint32_t & c)
+{
+    if (reference == "lt")
+        c = '<';
+    else if (reference == "gt")
+        c = '>';
+    else if (reference == "amp")
+        c = '&';
+    else if (reference == "quot")
+        c = '"';
+    else if (reference == "apos")
+        c = '\'';
+    else if (reference.size() > 1 && reference[0] == '#')
+    {
+        int          base   = 10;
+        char const * digits = reference.data() + 1;
+        char const * end    = reference.data() + reference.size();
+        if (*digits == 'x')
+        {
+            base = 16;
+            ++digits;
+        }
+
+        uint32_t value;
+        std::from_chars_result r = std::from_chars(digits, end, value, base);
+        if (r.ec != std::errc() || r.ptr != end || value == 0 || value > 0x10ffff)
+            return false;
+        c = value;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    pBegin    Start of the attribute section of a start tag
+//! @param    pEnd      End of the attribute section of a start tag
+
+AttributeIterator::AttributeIterator(char const * pBegin, char const * pEnd)
+    : end_(pEnd)
+{
+    load(pBegin);
+}
+
+AttributeIterator & AttributeIterator::operator ++()
+{
+    load(next_);
+    return *this;
+}
+
+AttributeIterator AttributeIterator::operator ++(int)
+{
+    AttributeIterator old(*this);
+    load(next_);
+    return old;
+}
+
+// Parses the attribute starting at or after pNext. The syntax has already been validated by the reader.
+void AttributeIterator::load(char const * pNext)
+{
+    char const * p = skipWhitespace(pNext, end_);
+    if (p >= end_)
+    {
+        cursor_  = end_;
+        next_    = end_;
+        current_ = Attribute();
+        return;
+    }
+
+    cursor_ = p;
+    char const * nameEnd = FindNameEnd(p, end_);
+    current_.name = std::string_view(p, size_t(nameEnd - p));
+
+    p = skipWhitespace(nameEnd, end_) + 1; // Skip the '='
+    p = skipWhitespace(p, end_);
+
+    char         quote    = *p++;
+    char const * valueEnd = FindChar(p, end_, quote);
+    current_.value = std::string_view(p, size_t(valueEnd - p));
+    next_ = valueEnd + 1;
+}
+
+//! @param    sName    Name of the attribute
+//! @param    value    Location to put the raw value of the attribute
+//!
+//! @return        true, if the attribute is present
+
+bool AttributeRange::FindAttribute(std::string_view sName, std::string_view & value) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    for (Attribute const & attribute : *this)
+    {
+        Instrumentation::Add(Instrumentation::Counter::SCANNED);
+        if (attribute.name == sName)
+        {
+            value = attribute.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    sDefault    Value to return if the attribute is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the attribute with references expanded
+
+std::string AttributeRange::GetStringAttribute(std::string_view sName, char const * sDefault /* = ""*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+        return std::string(sDefault);
+
+    std::string value;
+    Unescape(raw, value);
+    Instrumentation::Add(Instrumentation::Counter::ALLOCATED, value.size());
+    return value;
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    fDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to a float
+
+float AttributeRange::GetFloatAttribute(std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    float            value = fDefault;
+    if (FindAttribute(sName, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseFloat(raw, value);
+    }
+    return value;
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to an int
+
+int AttributeRange::GetIntAttribute(std::string_view sName, int iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    int              value = iDefault;
+    if (FindAttribute(sName, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseInt(raw, value);
+    }
+    return value;
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted from hex to an unsigned int
+
+uint32_t AttributeRange::GetHexAttribute(std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    uint32_t         value = iDefault;
+    if (FindAttribute(sName, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseHex(raw, value);
+    }
+    return value;
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    bDefault    Value to return if the attribute is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the attribute converted to a bool
+
+bool AttributeRange::GetBoolAttribute(std::string_view sName, bool bDefault /* = false*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    bool             value = bDefault;
+    if (FindAttribute(sName, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseBool(raw, value);
+    }
+    return value;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the text.
+//!
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool AttributeRange::GetFloatArrayAttribute(std::string_view sName, std::vector<float> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseFloatArray(raw, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool AttributeRange::GetFloatArrayAttribute(std::string_view sName, float * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseFloatArray(raw, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the text.
+//!
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool AttributeRange::GetIntArrayAttribute(std::string_view sName, std::vector<int> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseIntArray(raw, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool AttributeRange::GetIntArrayAttribute(std::string_view sName, int * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseIntArray(raw, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the text.
+//!
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool AttributeRange::GetHexArrayAttribute(std::string_view sName, std::vector<uint32_t> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseHexArray(raw, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool AttributeRange::GetHexArrayAttribute(std::string_view sName, uint32_t * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_ATTRIBUTE);
+    std::string_view raw;
+    if (!FindAttribute(sName, raw))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseHexArray(raw, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The predefined entities (&lt; &gt; &amp; &quot; &apos;) and character references (&#NNN; and &#xHHHH;) are
+//! expanded. Character references are encoded as UTF-8. A reference that is not valid is copied as-is.
+//!
+//! @param    raw        Text to expand
+//! @param    out        String to append the result to
+//!
+//! @return        false, if the text contains a reference that is not valid
+
+bool Unescape(std::string_view raw, std::string & out)
+{
+    bool         ok  = true;
+    char const * p   = raw.data();
+    char const * end = p + raw.size();
+
+    out.reserve(out.size() + raw.size());
+    while (p < end)
+    {
+        char const * amp = FindChar(p, end, '&');
+        out.append(p, size_t(amp - p));
+        if (amp == end)
+            break;
+
+        char const * semicolon = FindChar(amp + 1, end, ';');
+        uint32_t     c;
+        if (semicolon < end && decodeReference(std::string_view(amp + 1, size_t(semicolon - amp - 1)), c))
+        {
+            appendUtf8(c, out);
+            p = semicolon + 1;
+        }
+        else
+        {
+            out.push_back('&');
+            p  = amp + 1;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+//! @param    document    The document to parse. It must remain valid for the lifetime of the reader.
+
+Reader::Reader(std::string_view document)
+    : begin_(document.data())
+    , end_(document.data() + document.size())
+    , cursor_(document.data())
+{
+    open_.reserve(32);
+}
+
+//! Tokens are returned in document order. An empty-element tag is reported as a StartElement followed by an
+//! EndElement. Once End or Error has been returned, it is returned by all subsequent calls.
+//!
+//! @return        The type of the new current token
+
+Reader::Token Reader::Next()
+{
+    if (token_ == Token::End || token_ == Token::Error)
+        return token_;
+
+    if (pendingEnd_)
+    {
+        pendingEnd_ = false;
+        return token_ = Token::EndElement;
+    }
+
+    Lexeme lexeme;
+    for (;;)
+    {
+        switch (lex(cursor_, end_, lexeme, error_))
+        {
+        case Token::Text:
+            if (open_.empty())
+            {
+                if (!TrimWhitespace(lexeme.value).empty())
+                    return fail("Text outside of the root element");
+                continue;
+            }
+            value_ = lexeme.value;
+            depth_ = int(open_.size());
+            return token_ = Token::Text;
+
+        case Token::CData:
+            if (open_.empty())
+                return fail("CDATA outside of the root element");
+            value_ = lexeme.value;
+            depth_ = int(open_.size());
+            return token_ = Token::CData;
+
+        case Token::StartElement:
+            if (open_.empty() && rootClosed_)
+                return fail("More than one root element");
+            name_          = lexeme.name;
+            attributes_    = lexeme.attributes;
+            attributesEnd_ = lexeme.attributesEnd;
+            empty_         = lexeme.empty;
+            depth_         = int(open_.size());
+            if (empty_)
+            {
+                pendingEnd_ = true;
+                rootClosed_ = rootClosed_ || open_.empty();
+            }
+            else
+            {
+                open_.push_back(name_);
+            }
+            return token_ = Token::StartElement;
+
+        case Token::EndElement:
+            if (open_.empty() || open_.back() != lexeme.name)
+                return fail("Mismatched end tag");
+            open_.pop_back();
+            name_       = lexeme.name;
+            empty_      = false;
+            depth_      = int(open_.size());
+            rootClosed_ = open_.empty();
+            return token_ = Token::EndElement;
+
+        case Token::End:
+            if (!open_.empty())
+                return fail("Unexpected end of document");
+            if (!rootClosed_)
+                return fail("No root element");
+            return token_ = Token::End;
+
+        default:
+            return token_ = Token::Error;
+        }
+    }
+}
+
+//! @return        The text, or an empty string if the current token is not Text or CData
+
+std::string Reader::GetText() const
+{
+    std::string text;
+    if (token_ == Token::CData)
+        text.assign(value_.data(), value_.size());
+    else if (token_ == Token::Text)
+        Unescape(value_, text);
+    return text;
+}
+
+//! @return        The attributes, or an empty range if the current token is not StartElement
+
+AttributeRange Reader::Attributes() const
+{
+    if (token_ != Token::StartElement)
+        return AttributeRange(nullptr, nullptr);
+    return AttributeRange(attributes_, attributesEnd_);
+}
+
+//! @param    sName    Name of the attribute
+//! @param    value    Location to put the raw value of the attribute
+//!
+//! @return        true, if the current token is StartElement and the attribute is present
+
+bool Reader::FindAttribute(std::string_view sName, std::string_view & value) const
+{
+    return Attributes().FindAttribute(sName, value);
+}
+
+//! If the current token is a start tag, the reader is advanced to the matching end tag. Otherwise, nothing happens.
+
+void Reader::Skip()
+{
+    if (token_ == Token::StartElement)
+        skipTo(depth_);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    sDefault    Value to return if the attribute is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the attribute with references expanded
+
+std::string Reader::GetStringAttribute(std::string_view sName, char const * sDefault /* = ""*/) const
+{
+    return Attributes().GetStringAttribute(sName, sDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    fDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to a float
+
+float Reader::GetFloatAttribute(std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    return Attributes().GetFloatAttribute(sName, fDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to an int
+
+int Reader::GetIntAttribute(std::string_view sName, int iDefault /* = 0*/) const
+{
+    return Attributes().GetIntAttribute(sName, iDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted from hex to an unsigned int
+
+uint32_t Reader::GetHexAttribute(std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    return Attributes().GetHexAttribute(sName, iDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    bDefault    Value to return if the attribute is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the attribute converted to a bool
+
+bool Reader::GetBoolAttribute(std::string_view sName, bool bDefault /* = false*/) const
+{
+    return Attributes().GetBoolAttribute(sName, bDefault);
+}
+
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool Reader::GetFloatArrayAttribute(std::string_view sName, std::vector<float> & values) const
+{
+    return Attributes().GetFloatArrayAttribute(sName, values);
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool Reader::GetFloatArrayAttribute(std::string_view sName, float * pValues, size_t & count) const
+{
+    return Attributes().GetFloatArrayAttribute(sName, pValues, count);
+}
+
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool Reader::GetIntArrayAttribute(std::string_view sName, std::vector<int> & values) const
+{
+    return Attributes().GetIntArrayAttribute(sName, values);
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool Reader::GetIntArrayAttribute(std::string_view sName, int * pValues, size_t & count) const
+{
+    return Attributes().GetIntArrayAttribute(sName, pValues, count);
+}
+
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool Reader::GetHexArrayAttribute(std::string_view sName, std::vector<uint32_t> & values) const
+{
+    return Attributes().GetHexArrayAttribute(sName, values);
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool Reader::GetHexArrayAttribute(std::string_view sName, uint32_t * pValues, size_t & count) const
+{
+    return Attributes().GetHexArrayAttribute(sName, pValues, count);
+}
+
+//! The value is the first non-whitespace text (or CDATA section) directly inside the sub-element, with references
+//! expanded. If the sub-element has no text, the value is empty.
+//!
+//! @param    sName    Name of the sub-element
+//! @param    value    Location to put the value
+//!
+//! @return        true, if the current token is StartElement and the sub-element is present
+
+bool Reader::GetSubElementValue(std::string_view sName, std::string & value) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+        return false;
+
+    value.clear();
+    if (raw)
+        value.assign(text.data(), text.size());
+    else
+        Unescape(text, value);
+    Instrumentation::Add(Instrumentation::Counter::ALLOCATED, value.size());
+    return true;
+}
+
+//! @param    sName       Name of the sub-element to get
+//! @param    sDefault    Value to return if the sub-element is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the sub-element
+
+std::string Reader::GetStringSubElement(std::string_view sName, char const * sDefault /* = ""*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string value;
+    if (!GetSubElementValue(sName, value))
+        value = sDefault;
+    return value;
+}
+
+//! @param    sName       Name of the sub-element to get
+//! @param    fDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted to a float
+
+float Reader::GetFloatSubElement(std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    float            value = fDefault;
+    if (findSubElementText(sName, text, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseFloat(text, value);
+    }
+    return value;
+}
+
+//! @param    sName       Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted to an int
+
+int Reader::GetIntSubElement(std::string_view sName, int iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    int              value = iDefault;
+    if (findSubElementText(sName, text, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseInt(text, value);
+    }
+    return value;
+}
+
+//! @param    sName       Name of the sub-element to get
+//! @param    iDefault    Value to return if the sub-element is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the sub-element converted from hex to an unsigned int
+
+uint32_t Reader::GetHexSubElement(std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    uint32_t         value = iDefault;
+    if (findSubElementText(sName, text, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseHex(text, value);
+    }
+    return value;
+}
+
+//! @param    sName       Name of the sub-element to get
+//! @param    bDefault    Value to return if the sub-element is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the sub-element converted to a bool
+
+bool Reader::GetBoolSubElement(std::string_view sName, bool bDefault /* = false*/) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    bool             value = bDefault;
+    if (findSubElementText(sName, text, raw))
+    {
+        Instrumentation::Add(Instrumentation::Counter::COERCIONS);
+        ParseBool(text, value);
+    }
+    return value;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the text.
+//!
+//! @param    sName     Name of the sub-element to get
+//! @param    values    The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the current token is StartElement, the sub-element is present and every value is valid
+
+bool Reader::GetFloatArraySubElement(std::string_view sName, std::vector<float> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseFloatArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    sName      Name of the sub-element to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the current token is StartElement, the sub-element is present, every value is valid and
+//!                they all fit
+
+bool Reader::GetFloatArraySubElement(std::string_view sName, float * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseFloatArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the text.
+//!
+//! @param    sName     Name of the sub-element to get
+//! @param    values    The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the current token is StartElement, the sub-element is present and every value is valid
+
+bool Reader::GetIntArraySubElement(std::string_view sName, std::vector<int> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseIntArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    sName      Name of the sub-element to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the current token is StartElement, the sub-element is present, every value is valid and
+//!                they all fit
+
+bool Reader::GetIntArraySubElement(std::string_view sName, int * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseIntArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+//! The vector is sized once from a count of the values, which are then converted where they are in the text.
+//!
+//! @param    sName     Name of the sub-element to get
+//! @param    values    The vector to receive the values. It is emptied if the sub-element is not present.
+//!
+//! @return        true, if the current token is StartElement, the sub-element is present and every value is valid
+
+bool Reader::GetHexArraySubElement(std::string_view sName, std::vector<uint32_t> & values) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+    {
+        values.clear();
+        return false;
+    }
+
+    bool valid = ParseHexArray(text, values);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, values.size());
+    return valid;
+}
+
+//! @param    sName      Name of the sub-element to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the sub-element is not present or a value is not valid.
+//!
+//! @return        true, if the current token is StartElement, the sub-element is present, every value is valid and
+//!                they all fit
+
+bool Reader::GetHexArraySubElement(std::string_view sName, uint32_t * pValues, size_t & count) const
+{
+    Instrumentation::Call call(Instrumentation::Family::GET_SUB_ELEMENT_VALUE);
+    std::string_view text;
+    bool             raw;
+    if (!findSubElementText(sName, text, raw))
+    {
+        count = 0;
+        return false;
+    }
+
+    bool valid = ParseHexArray(text, pValues, count);
+    Instrumentation::Add(Instrumentation::Counter::COERCIONS, count);
+    return valid;
+}
+
+// Lexes the next token starting at cursor, skipping comments, processing instructions and declarations. The
+// cursor is left after the token. Nesting is not checked. If the token (or the error) might be different given more
+// text after the end, lexeme.truncated is set.
+Reader::Token Reader::lex(char const *& cursor, char const * end, Lexeme & lexeme, char const *& error)
+{
+    lexeme.truncated = true;
+    for (;;)
+    {
+        char const * p = cursor;
+        lexeme.start   = p;
+        if (p >= end)
+            return lexeme.token = Token::End;
+
+        // Character data
+        if (*p != '<')
+        {
+            cursor           = FindChar(p, end, '<');
+            lexeme.value     = std::string_view(p, size_t(cursor - p));
+            lexeme.truncated = cursor >= end;
+            return lexeme.token = Token::Text;
+        }
+
+        // Processing instruction or XML declaration
+        if (startsWith(p, end, "<?"))
+        {
+            char const * terminator = findTerminator(p + 2, end, "?>");
+            if (!terminator)
+            {
+                error = "Unterminated processing instruction";
+                return lexeme.token = Token::Error;
+            }
+            cursor = terminator + 2;
+            continue;
+        }
+
+        // Comment
+        if (startsWith(p, end, "<!--"))
+        {
+            char const * terminator = findTerminator(p + 4, end, "-->");
+            if (!terminator)
+            {
+                error = "Unterminated comment";
+                return lexeme.token = Token::Error;
+            }
+            cursor = terminator + 3;
+            continue;
+        }
+
+        // CDATA section
+        if (startsWith(p, end, "<![CDATA["))
+        {
+            char const * terminator = findTerminator(p + 9, end, "]]>");
+            if (!terminator)
+            {
+                error = "Unterminated CDATA section";
+                return lexeme.token = Token::Error;
+            }
+            lexeme.value     = std::string_view(p + 9, size_t(terminator - p - 9));
+            lexeme.truncated = false;
+            cursor           = terminator + 3;
+            return lexeme.token = Token::CData;
+        }
+
+        // DOCTYPE or other declaration, possibly with an internal subset
+        if (startsWith(p, end, "<!"))
+        {
+            int  brackets = 0;
+            char quote    = 0;
+            for (p += 2; p < end; ++p)
+            {
+                if (quote)
+                {
+                    if (*p == quote)
+                        quote = 0;
+                }
+                else if (*p == '"' || *p == '\'')
+                    quote = *p;
+                else if (*p == '[')
+                    ++brackets;
+                else if (*p == ']')
+                    --brackets;
+                else if (*p == '>' && brackets <= 0)
+                    break;
+            }
+            if (p >= end)
+            {
+                error = "Unterminated declaration";
+                return lexeme.token = Token::Error;
+            }
+            cursor = p + 1;
+            continue;
+        }
+
+        // End tag
+        if (startsWith(p, end, "</"))
+        {
+            char const * nameEnd = FindNameEnd(p + 2, end);
+            lexeme.name = std::string_view(p + 2, size_t(nameEnd - p - 2));
+            p           = skipWhitespace(nameEnd, end);
+            if (lexeme.name.empty() || p >= end || *p != '>')
+            {
+                lexeme.truncated = p >= end;
+                cursor           = p;
+                error            = "Malformed end tag";
+                return lexeme.token = Token::Error;
+            }
+            lexeme.truncated = false;
+            cursor           = p + 1;
+            return lexeme.token = Token::EndElement;
+        }
+
+        // Start tag
+        char const * nameEnd = FindNameEnd(p + 1, end);
+        lexeme.name = std::string_view(p + 1, size_t(nameEnd - p - 1));
+        if (lexeme.name.empty())
+        {
+            lexeme.truncated = nameEnd >= end;
+            cursor           = p;
+            error            = "Malformed start tag";
+            return lexeme.token = Token::Error;
+        }
+
+        lexeme.attributes = nameEnd;
+        for (p = nameEnd;;)
+        {
+            char const * next = skipWhitespace(p, end);
+            if (next >= end)
+            {
+                cursor = next;
+                error  = "Unterminated start tag";
+                return lexeme.token = Token::Error;
+            }
+
+            if (*next == '>')
+            {
+                lexeme.attributesEnd = next;
+                lexeme.empty         = false;
+                lexeme.truncated     = false;
+                cursor               = next + 1;
+                return lexeme.token = Token::StartElement;
+            }
+
+            if (*next == '/')
+            {
+                if (next + 1 >= end || next[1] != '>')
+                {
+                    lexeme.truncated = next + 1 >= end;
+                    cursor           = next;
+                    error            = "Malformed empty-element tag";
+                    return lexeme.token = Token::Error;
+                }
+                lexeme.attributesEnd = next;
+                lexeme.empty         = true;
+                lexeme.truncated     = false;
+                cursor               = next + 2;
+                return lexeme.token = Token::StartElement;
+            }
+
+            // Attribute, which must be preceded by whitespace
+            char const * attributeNameEnd = FindNameEnd(next, end);
+            if (next == p || attributeNameEnd == next)
+            {
+                lexeme.truncated = false;
+                cursor           = next;
+                error            = "Malformed attribute";
+                return lexeme.token = Token::Error;
+            }
+
+            p = skipWhitespace(attributeNameEnd, end);
+            if (p >= end || *p != '=')
+            {
+                lexeme.truncated = p >= end;
+                cursor           = p;
+                error            = "Attribute is missing a value";
+                return lexeme.token = Token::Error;
+            }
+
+            p = skipWhitespace(p + 1, end);
+            if (p >= end || (*p != '"' && *p != '\''))
+            {
+                lexeme.truncated = p >= end;
+                cursor           = p;
+                error            = "Attribute value is not quoted";
+                return lexeme.token = Token::Error;
+            }
+
+            char const * valueEnd = Scan::FindEither(p + 1, end, *p, '<');
+            if (valueEnd >= end || *valueEnd == '<')
+            {
+                lexeme.truncated = valueEnd >= end;
+                cursor           = p;
+                error            = "Malformed attribute value";
+                return lexeme.token = Token::Error;
+            }
+            p = valueEnd + 1;
+        }
+    }
+}
+
+// Finds the first text of the named sub-element of the current element without moving the reader. raw is set to
+// true if the text is a CDATA section or empty (i.e. it contains no references).
+bool Reader::findSubElementText(std::string_view sName, std::string_view & text, bool & raw) const
+{
+    if (token_ != Token::StartElement || empty_)
+        return false;
+
+    char const * cursor   = cursor_;
+    char const * error    = nullptr;
+    int          depth    = 0; // Depth relative to the content of the current element
+    bool         inTarget = false;
+    Lexeme       lexeme;
+
+    for (;;)
+    {
+        switch (lex(cursor, end_, lexeme, error))
+        {
+        case Token::StartElement:
+            if (depth == 0)
+                Instrumentation::Add(Instrumentation::Counter::SCANNED);
+            if (!inTarget && depth == 0 && lexeme.name == sName)
+            {
+                if (lexeme.empty)
+                {
+                    text = std::string_view();
+                    raw  = true;
+                    return true;
+                }
+                inTarget = true;
+            }
+            if (!lexeme.empty)
+                ++depth;
+            break;
+
+        case Token::EndElement:
+            if (depth == 0)
+                return false;
+            --depth;
+            if (inTarget && depth == 0)
+            {
+                text = std::string_view();
+                raw  = true;
+                return true;
+            }
+            break;
+
+        case Token::Text:
+            if (inTarget && depth == 1 && !TrimWhitespace(lexeme.value).empty())
+            {
+                text = lexeme.value;
+                raw  = false;
+                return true;
+            }
+            break;
+
+        case Token::CData:
+            if (inTarget && depth == 1)
+            {
+                text = lexeme.value;
+                raw  = true;
+                return true;
+            }
+            break;
+
+        default:
+            return false;
+        }
+    }
+}
+
+// Advances until the end tag at the given depth. Returns false if the end of the document or an error is reached
+// first.
+bool Reader::skipTo(int depth)
+{
+    while (token_ != Token::EndElement || depth_ != depth)
+    {
+        Token t = Next();
+        if (t == Token::End || t == Token::Error)
+            return false;
+    }
+    return true;
+}
+
+Reader::Token Reader::fail(char const * message)
+{
+    error_ = message;
+    return token_ = Token::Error;
+}
+} // namespace Msxmlx
@@ -0,0 +1,643 @@
+#include "Scan.h"
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MSXMLX_SCAN_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MSXMLX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MSXMLX_TARGET_AVX2
+#endif
+
+using namespace Msxmlx::Scan;
+
+namespace
+{
+/********************************************************************************************************************/
+/*													S C A L A R														*/
+/********************************************************************************************************************/
+
+bool isNameEnd(char c)
+{
+    return static_cast<unsigned char>(c) <= ' ' || c == '>' || c == '/' || c == '=';
+}
+
+bool isEscape(char c)
+{
+    return static_cast<unsigned char>(c) < ' ' || c == '<' || c == '>' || c == '&' || c == '"';
+}
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+char const * findCharScalar(char const * p, char const * end, char c)
+{
+    while (p < end && *p != c)
+    {
+        ++p;
+    }
+    return p;
+}
+
+char const * findEitherScalar(char const * p, char const * end, char a, char b)
+{
+    while (p < end && *p != a && *p != b)
+    {
+        ++p;
+    }
+    return p;
+}
+
+char const * findNameEndScalar(char const * p, char const * end)
+{
+    while (p < end && !isNameEnd(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+char const * findEscapeScalar(char const * p, char const * end)
+{
+    while (p < end && !isEscape(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+char const * findNonAsciiScalar(char const * p, char const * end)
+{
+    while (p < end && static_cast<unsigned char>(*p) < 0x80)
+    {
+        ++p;
+    }
+    return p;
+}
+
+char const * widenAsciiScalar(char const * p, char const * end, wchar_t * pOut)
+{
+    for (; p < end && static_cast<unsigned char>(*p) < 0x80; ++p, ++pOut)
+    {
+        *pOut = wchar_t(*p);
+    }
+    return p;
+}
+
+wchar_t const * narrowAsciiScalar(wchar_t const * p, wchar_t const * end, char * pOut)
+{
+    for (; p < end && uint32_t(*p) < 0x80; ++p, ++pOut)
+    {
+        *pOut = char(*p);
+    }
+    return p;
+}
+
+// Counts the tokens that start in a range. inToken is true if the range starts within a token.
+size_t countTokensFrom(char const * p, char const * end, bool inToken)
+{
+    size_t count = 0;
+    for (; p < end; ++p)
+    {
+        bool whitespace = isWhitespace(*p);
+        if (!whitespace && !inToken)
+            ++count;
+        inToken = !whitespace;
+    }
+    return count;
+}
+
+size_t countTokensScalar(char const * p, char const * end)
+{
+    return countTokensFrom(p, end, false);
+}
+
+Kernels const SCALAR_KERNELS = {
+    findCharScalar, findEitherScalar, findNameEndScalar, findEscapeScalar,
+    findNonAsciiScalar, widenAsciiScalar, narrowAsciiScalar, countTokensScalar
+};
+
+#if defined(MSXMLX_SCAN_X64)
+
+int firstBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+int bitCount(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    // __popcnt requires the POPCNT instruction, which not every CPU with SSE2 has
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return int((((mask + (mask >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+/********************************************************************************************************************/
+/*														S S E 2														*/
+/********************************************************************************************************************/
+
+// Returns a mask of the bytes that end a name
+__m128i nameEndMask16(__m128i v)
+{
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(' ')), v);
+    __m128i gt      = _mm_cmpeq_epi8(v, _mm_set1_epi8('>'));
+    __m128i slash   = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    __m128i equals  = _mm_cmpeq_epi8(v, _mm_set1_epi8('='));
+    return _mm_or_si128(_mm_or_si128(control, gt), _mm_or_si128(slash, equals));
+}
+
+// Returns a mask of the bytes that may need to be escaped
+__m128i escapeMask16(__m128i v)
+{
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(' ' - 1)), v);
+    __m128i lt      = _mm_cmpeq_epi8(v, _mm_set1_epi8('<'));
+    __m128i gt      = _mm_cmpeq_epi8(v, _mm_set1_epi8('>'));
+    __m128i amp     = _mm_cmpeq_epi8(v, _mm_set1_epi8('&'));
+    __m128i quote   = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    return _mm_or_si128(_mm_or_si128(control, quote), _mm_or_si128(_mm_or_si128(lt, gt), amp));
+}
+
+char const * findCharSse2(char const * p, char const * end, char c)
+{
+    __m128i const target = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i  v    = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, target)));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findCharScalar(p, end, c);
+}
+
+char const * findEitherSse2(char const * p, char const * end, char a, char b)
+{
+    __m128i const targetA = _mm_set1_epi8(a);
+    __m128i const targetB = _mm_set1_epi8(b);
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i  v    = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        __m128i  hits = _mm_or_si128(_mm_cmpeq_epi8(v, targetA), _mm_cmpeq_epi8(v, targetB));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(hits));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findEitherScalar(p, end, a, b);
+}
+
+char const * findNameEndSse2(char const * p, char const * end)
+{
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i  v    = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(nameEndMask16(v)));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findNameEndScalar(p, end);
+}
+
+char const * findEscapeSse2(char const * p, char const * end)
+{
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i  v    = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(escapeMask16(v)));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findEscapeScalar(p, end);
+}
+
+char const * findNonAsciiSse2(char const * p, char const * end)
+{
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i  v    = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(v));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findNonAsciiScalar(p, end);
+}
+
+char const * widenAsciiSse2(char const * p, char const * end, wchar_t * pOut)
+{
+    __m128i const zero = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16, pOut += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        if (_mm_movemask_epi8(v) != 0)
+            break;
+
+        __m128i low  = _mm_unpacklo_epi8(v, zero);
+        __m128i high = _mm_unpackhi_epi8(v, zero);
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut + 8), high);
+        }
+        else
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut + 12), _mm_unpackhi_epi16(high, zero));
+        }
+    }
+    return widenAsciiScalar(p, end, pOut);
+}
+
+wchar_t const * narrowAsciiSse2(wchar_t const * p, wchar_t const * end, char * pOut)
+{
+    __m128i const zero = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16, pOut += 16)
+    {
+        __m128i const * pIn = reinterpret_cast<__m128i const *>(p);
+        __m128i         narrow;
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            __m128i a     = _mm_loadu_si128(pIn);
+            __m128i b     = _mm_loadu_si128(pIn + 1);
+            __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(short(0xff80))), zero);
+            if (_mm_movemask_epi8(ascii) != 0xffff)
+                break;
+            narrow = _mm_packus_epi16(a, b);
+        }
+        else
+        {
+            __m128i a      = _mm_loadu_si128(pIn);
+            __m128i b      = _mm_loadu_si128(pIn + 1);
+            __m128i c      = _mm_loadu_si128(pIn + 2);
+            __m128i d      = _mm_loadu_si128(pIn + 3);
+            __m128i all    = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            __m128i ascii  = _mm_cmpeq_epi32(_mm_and_si128(all, _mm_set1_epi32(int(0xffffff80))), zero);
+            if (_mm_movemask_epi8(ascii) != 0xffff)
+                break;
+            narrow = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut), narrow);
+    }
+    return narrowAsciiScalar(p, end, pOut);
+}
+
+// Returns a mask of the bytes that are whitespace
+__m128i whitespaceMask16(__m128i v)
+{
+    __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i tab   = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+    __m128i lf    = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    __m128i cr    = _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'));
+    return _mm_or_si128(_mm_or_si128(space, tab), _mm_or_si128(lf, cr));
+}
+
+// A token starts at each byte that is not whitespace and follows one that is, so they are counted by comparing the
+// mask of the bytes that are not whitespace with itself shifted by one byte
+size_t countTokensSse2From(char const * p, char const * end, bool inToken)
+{
+    size_t   count    = 0;
+    uint32_t previous = inToken ? 1 : 0;
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i  v      = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        uint32_t tokens = ~uint32_t(_mm_movemask_epi8(whitespaceMask16(v))) & 0xffff;
+        count   += size_t(bitCount(tokens & ~((tokens << 1) | previous)));
+        previous = tokens >> 15;
+    }
+    return count + countTokensFrom(p, end, previous != 0);
+}
+
+size_t countTokensSse2(char const * p, char const * end)
+{
+    return countTokensSse2From(p, end, false);
+}
+
+Kernels const SSE2_KERNELS = {
+    findCharSse2, findEitherSse2, findNameEndSse2, findEscapeSse2,
+    findNonAsciiSse2, widenAsciiSse2, narrowAsciiSse2, countTokensSse2
+};
+
+/********************************************************************************************************************/
+/*														A V X 2														*/
+/********************************************************************************************************************/
+
+MSXMLX_TARGET_AVX2 char const * findCharAvx2(char const * p, char const * end, char c)
+{
+    __m256i const target = _mm256_set1_epi8(c);
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i  v    = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, target)));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findCharSse2(p, end, c);
+}
+
+MSXMLX_TARGET_AVX2 char const * findEitherAvx2(char const * p, char const * end, char a, char b)
+{
+    __m256i const targetA = _mm256_set1_epi8(a);
+    __m256i const targetB = _mm256_set1_epi8(b);
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i  v    = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        __m256i  hits = _mm256_or_si256(_mm256_cmpeq_epi8(v, targetA), _mm256_cmpeq_epi8(v, targetB));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(hits));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findEitherSse2(p, end, a, b);
+}
+
+MSXMLX_TARGET_AVX2 char const * findNameEndAvx2(char const * p, char const * end)
+{
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i v       = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(' ')), v);
+        __m256i gt      = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('>'));
+        __m256i slash   = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+        __m256i equals  = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('='));
+        __m256i hits    = _mm256_or_si256(_mm256_or_si256(control, gt), _mm256_or_si256(slash, equals));
+        uint32_t mask   = uint32_t(_mm256_movemask_epi8(hits));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findNameEndSse2(p, end);
+}
+
+MSXMLX_TARGET_AVX2 char const * findEscapeAvx2(char const * p, char const * end)
+{
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i v       = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(' ' - 1)), v);
+        __m256i lt      = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('<'));
+        __m256i gt      = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('>'));
+        __m256i amp     = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('&'));
+        __m256i quote   = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+        __m256i markup  = _mm256_or_si256(_mm256_or_si256(lt, gt), amp);
+        __m256i hits    = _mm256_or_si256(_mm256_or_si256(control, quote), markup);
+        uint32_t mask   = uint32_t(_mm256_movemask_epi8(hits));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findEscapeSse2(p, end);
+}
+
+MSXMLX_TARGET_AVX2 char const * findNonAsciiAvx2(char const * p, char const * end)
+{
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i  v    = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(v));
+        if (mask)
+            return p + firstBit(mask);
+    }
+    return findNonAsciiSse2(p, end);
+}
+
+MSXMLX_TARGET_AVX2 char const * widenAsciiAvx2(char const * p, char const * end, wchar_t * pOut)
+{
+    for (; end - p >= 32; p += 32, pOut += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        if (_mm256_movemask_epi8(v) != 0)
+            break;
+
+        __m256i * pWide = reinterpret_cast<__m256i *>(pOut);
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            _mm256_storeu_si256(pWide, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+            _mm256_storeu_si256(pWide + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+        }
+        else
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                __m128i eight = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(p + i * 8));
+                _mm256_storeu_si256(pWide + i, _mm256_cvtepu8_epi32(eight));
+            }
+        }
+    }
+    return widenAsciiSse2(p, end, pOut);
+}
+
+MSXMLX_TARGET_AVX2 wchar_t const * narrowAsciiAvx2(wchar_t const * p, wchar_t const * end, char * pOut)
+{
+    for (; end - p >= 32; p += 32, pOut += 32)
+    {
+        __m256i const * pIn = reinterpret_cast<__m256i const *>(p);
+        __m256i         narrow;
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            __m256i a = _mm256_loadu_si256(pIn);
+            __m256i b = _mm256_loadu_si256(pIn + 1);
+            if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_set1_epi16(short(0xff80))))
+                break;
+
+            // Packing works within each 128-bit lane, so the 64-bit parts are put back in order
+            narrow = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        }
+        else
+        {
+            __m256i a   = _mm256_loadu_si256(pIn);
+            __m256i b   = _mm256_loadu_si256(pIn + 1);
+            __m256i c   = _mm256_loadu_si256(pIn + 2);
+            __m256i d   = _mm256_loadu_si256(pIn + 3);
+            __m256i all = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+            if (!_mm256_testz_si256(all, _mm256_set1_epi32(int(0xffffff80))))
+                break;
+
+            // Packing works within each 128-bit lane, so the 32-bit parts are put back in order
+            __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+            narrow = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(pOut), narrow);
+    }
+    return narrowAsciiSse2(p, end, pOut);
+}
+
+MSXMLX_TARGET_AVX2 size_t countTokensAvx2(char const * p, char const * end)
+{
+    size_t   count    = 0;
+    uint32_t previous = 0;
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i  v          = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        __m256i  space      = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+        __m256i  tab        = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'));
+        __m256i  lf         = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+        __m256i  cr         = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'));
+        __m256i  whitespace = _mm256_or_si256(_mm256_or_si256(space, tab), _mm256_or_si256(lf, cr));
+        uint32_t tokens     = ~uint32_t(_mm256_movemask_epi8(whitespace));
+        count   += size_t(bitCount(tokens & ~((tokens << 1) | previous)));
+        previous = tokens >> 31;
+    }
+    return count + countTokensSse2From(p, end, previous != 0);
+}
+
+Kernels const AVX2_KERNELS = {
+    findCharAvx2, findEitherAvx2, findNameEndAvx2, findEscapeAvx2,
+    findNonAsciiAvx2, widenAsciiAvx2, narrowAsciiAvx2, countTokensAvx2
+};
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // AVX must be supported by the CPU and its state must be saved by the OS
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // defined(MSXMLX_SCAN_X64)
+
+Isa detect()
+{
+#if defined(MSXMLX_SCAN_X64)
+    return cpuHasAvx2() ? Isa::Avx2 : Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+std::atomic<Kernels const *> s_selected{ nullptr };
+
+Kernels const & selected()
+{
+    Kernels const * kernels = s_selected.load(std::memory_order_relaxed);
+    if (!kernels)
+    {
+        kernels = &GetKernels(Supported());
+        s_selected.store(kernels, std::memory_order_relaxed);
+    }
+    return *kernels;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+namespace Scan
+{
+//! @return        Avx2 or Sse2 on x86-64, depending on the CPU. Scalar on other architectures.
+
+Isa Supported()
+{
+    static Isa const isa = detect();
+    return isa;
+}
+
+Isa Selected()
+{
+    Kernels const * kernels = &selected();
+#if defined(MSXMLX_SCAN_X64)
+    if (kernels == &AVX2_KERNELS)
+        return Isa::Avx2;
+    if (kernels == &SSE2_KERNELS)
+        return Isa::Sse2;
+#endif
+    return Isa::Scalar;
+}
+
+//! This is intended for testing and benchmarking. It should not be called while other threads are scanning.
+//!
+//! @param    isa    The instruction set to use. If it is not supported, the best supported one is used instead.
+
+void Select(Isa isa)
+{
+    if (int(isa) > int(Supported()))
+        isa = Supported();
+    s_selected.store(&GetKernels(isa), std::memory_order_relaxed);
+}
+
+//! @param    isa    The instruction set
+//!
+//! @return        The kernels implemented with the instruction set, or the scalar kernels if it is not supported
+
+Kernels const & GetKernels(Isa isa)
+{
+#if defined(MSXMLX_SCAN_X64)
+    if (isa == Isa::Avx2 && Supported() == Isa::Avx2)
+        return AVX2_KERNELS;
+    if (isa == Isa::Sse2)
+        return SSE2_KERNELS;
+#endif
+    (void)isa;
+    return SCALAR_KERNELS;
+}
+
+char const * FindChar(char const * p, char const * end, char c)
+{
+    return selected().findChar(p, end, c);
+}
+
+char const * FindEither(char const * p, char const * end, char a, char b)
+{
+    return selected().findEither(p, end, a, b);
+}
+
+char const * FindNameEnd(char const * p, char const * end)
+{
+    return selected().findNameEnd(p, end);
+}
+
+char const * FindEscape(char const * p, char const * end)
+{
+    return selected().findEscape(p, end);
+}
+
+char const * FindNonAscii(char const * p, char const * end)
+{
+    return selected().findNonAscii(p, end);
+}
+
+char const * WidenAscii(char const * p, char const * end, wchar_t * pOut)
+{
+    return selected().widenAscii(p, end, pOut);
+}
+
+wchar_t const * NarrowAscii(wchar_t const * p, wchar_t const * end, char * pOut)
+{
+    return selected().narrowAscii(p, end, pOut);
+}
+
+size_t CountTokens(char const * p, char const * end)
+{
+    return selected().countTokens(p, end);
+}
+} // namespace Scan
+} // namespace Msxmlx
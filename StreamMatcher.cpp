@@ -0,0 +1,419 @@
+#include "StreamMatcher.h"
+
+#include "Convert.h"
+
+#include <algorithm>
+
+namespace
+{
+// Returns true if a step is a name or '*'
+bool isValidStep(std::string_view step)
+{
+    if (step == "*")
+        return true;
+    if (step.empty())
+        return false;
+    for (char c : step)
+    {
+        if (c == '[' || c == ']' || c == '@' || c == '*' || c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            return false;
+    }
+    return true;
+}
+
+// A step of a path being compiled
+struct ParsedStep
+{
+    std::string_view name; // A name or '*'
+    bool             descendant;
+};
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! The handler is called with the value of each match. The value is only valid during the call.
+//!
+//! @param    path       The path (e.g. "feed//entry/@id")
+//! @param    handler    Function to call with each value. It returns false to stop the run.
+//!
+//! @return        false, if the path is not valid (see ErrorMessage())
+
+bool StreamMatcher::Add(std::string_view path, Handler handler)
+{
+    return add(path, std::move(handler), false);
+}
+
+//! The states of the automaton are built as they are first needed, so the first documents take longer than the rest.
+//! The reader may be positioned anywhere before the root element.
+//!
+//! @param    reader    The reader
+//!
+//! @return        false, if a handler stopped the run or the document is not well-formed or could not be read
+
+bool StreamMatcher::Run(StreamReader & reader)
+{
+    using Token = StreamReader::Token;
+
+    if (states_.empty())
+        addState(std::vector<uint32_t>(1, 0));
+
+    matched_.assign(queries_.size(), false);
+    open_.assign(1, 0);
+    captureCount_ = 0;
+
+    for (;;)
+    {
+        Token t = reader.Next();
+
+        // A value ends at the first token that is not the rest of its text
+        if (captureCount_ > 0 && captures_[captureCount_ - 1].reading &&
+            (t != Token::Text || !reader.IsTextContinued()))
+        {
+            if (!finishValue(captures_[captureCount_ - 1]))
+                return false;
+        }
+
+        switch (t)
+        {
+        case Token::StartElement:
+            if (!startElement(reader, transition(open_.back(), findName(reader.Name()))))
+                return false;
+            if (reader.Current() == Token::EndElement && !endElement())
+                return false;
+            break;
+
+        case Token::EndElement:
+            if (!endElement())
+                return false;
+            break;
+
+        case Token::Text:
+        case Token::CData:
+        {
+            if (captureCount_ == 0)
+                break;
+
+            // Only the text of the element itself is its value
+            Capture & capture = captures_[captureCount_ - 1];
+            if (capture.done || capture.element + 1 != open_.size())
+                break;
+
+            // Leading whitespace is kept in case the rest of the text is not whitespace
+            if (t == Token::CData || !reader.IsTextContinued())
+                capture.text.clear();
+            if (t == Token::CData)
+            {
+                capture.text.append(reader.Value().data(), reader.Value().size());
+                if (!finishValue(capture))
+                    return false;
+                break;
+            }
+            Unescape(reader.Value(), capture.text);
+            capture.reading = capture.reading || !TrimWhitespace(reader.Value()).empty();
+            break;
+        }
+
+        case Token::End:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+}
+
+// Compiles a path into the tree of steps
+bool StreamMatcher::add(std::string_view path, Handler handler, bool once)
+{
+    error_ = nullptr;
+
+    // The path is checked before anything is added, so that an invalid path leaves no steps behind
+    std::vector<ParsedStep> parsed;
+    std::string_view        attribute;
+    std::string_view        rest       = path;
+    bool                    descendant = false;
+    if (rest.substr(0, 2) == "//")
+    {
+        descendant = true;
+        rest.remove_prefix(2);
+    }
+    else if (rest.substr(0, 1) == "/")
+    {
+        rest.remove_prefix(1);
+    }
+
+    for (;;)
+    {
+        size_t           end  = rest.find('/');
+        std::string_view text = rest.substr(0, end);
+        if (!text.empty() && text[0] == '@')
+        {
+            attribute = text.substr(1);
+            if (end != std::string_view::npos || !isValidStep(attribute) || attribute == "*")
+            {
+                error_ = "An attribute must be the last step and must have a name";
+                return false;
+            }
+            if (parsed.empty() && !descendant)
+            {
+                error_ = "An attribute must belong to an element";
+                return false;
+            }
+            break;
+        }
+        if (!isValidStep(text))
+        {
+            error_ = "A step must be a name or '*'";
+            return false;
+        }
+
+        parsed.push_back(ParsedStep{ text, descendant });
+        if (end == std::string_view::npos)
+            break;
+
+        rest.remove_prefix(end + 1);
+        descendant = rest.substr(0, 1) == "/";
+        if (descendant)
+            rest.remove_prefix(1);
+    }
+
+    uint32_t query = uint32_t(queries_.size());
+    queries_.push_back(Query{ std::move(handler), once });
+
+    uint32_t step = 0;
+    for (ParsedStep const & p : parsed)
+    {
+        if (p.descendant)
+        {
+            uint32_t next = steps_[step].descendant;
+            if (next == NONE)
+                steps_[step].descendant = next = addStep(true);
+            step = next;
+        }
+
+        uint32_t next = NONE;
+        if (p.name == "*")
+        {
+            next = steps_[step].any;
+            if (next == NONE)
+                steps_[step].any = next = addStep(false);
+        }
+        else
+        {
+            uint32_t name     = intern(p.name);
+            auto &   children = steps_[step].children;
+            auto     child    = std::find_if(children.begin(), children.end(), [name] (auto const & c) {
+                return c.first == name;
+            });
+            if (child != children.end())
+            {
+                next = child->second;
+            }
+            else
+            {
+                next = addStep(false);
+                steps_[step].children.emplace_back(name, next);
+            }
+        }
+        step = next;
+    }
+
+    if (!attribute.empty())
+    {
+        if (descendant)
+        {
+            uint32_t next = steps_[step].descendant;
+            if (next == NONE)
+                steps_[step].descendant = next = addStep(true);
+            step = next;
+        }
+        steps_[step].attributes.emplace_back(intern(attribute), query);
+    }
+    else
+    {
+        steps_[step].queries.push_back(query);
+    }
+
+    // The automaton is built again for the new paths
+    states_.clear();
+    stateIds_.clear();
+    return true;
+}
+
+// Returns the id of a name, adding it if necessary
+uint32_t StreamMatcher::intern(std::string_view name)
+{
+    uint32_t id = findName(name);
+    if (id != NONE)
+        return id;
+
+    names_.emplace_back(name);
+    id = uint32_t(names_.size() - 1);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+// Returns the id of a name, or NONE if no path has the name
+uint32_t StreamMatcher::findName(std::string_view name) const
+{
+    auto i = ids_.find(name);
+    return (i != ids_.end()) ? i->second : NONE;
+}
+
+// Adds a step and returns its index
+uint32_t StreamMatcher::addStep(bool loop)
+{
+    steps_.push_back(Step{ {}, NONE, NONE, loop, {}, {} });
+    return uint32_t(steps_.size() - 1);
+}
+
+// Returns the state for a set of active steps, adding it if necessary. The steps following a "//" are active
+// wherever the step before it is, so they are added to the set.
+uint32_t StreamMatcher::addState(std::vector<uint32_t> steps)
+{
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        if (steps_[steps[i]].descendant != NONE)
+            steps.push_back(steps_[steps[i]].descendant);
+    }
+    std::sort(steps.begin(), steps.end());
+    steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+
+    auto i = stateIds_.find(steps);
+    if (i != stateIds_.end())
+        return i->second;
+
+    State state;
+    state.next.assign(names_.size() + 1, NONE);
+    for (uint32_t s : steps)
+    {
+        state.queries.insert(state.queries.end(), steps_[s].queries.begin(), steps_[s].queries.end());
+        state.attributes.insert(state.attributes.end(), steps_[s].attributes.begin(), steps_[s].attributes.end());
+    }
+    std::sort(state.attributes.begin(), state.attributes.end());
+
+    uint32_t id = uint32_t(states_.size());
+    stateIds_.emplace(steps, id);
+    state.steps = std::move(steps);
+    states_.push_back(std::move(state));
+    return id;
+}
+
+// Returns the state entered by an element with a name from a state. Names that no path has share a transition.
+uint32_t StreamMatcher::transition(uint32_t state, uint32_t name)
+{
+    size_t index = (name != NONE) ? name : names_.size();
+    if (states_[state].next[index] != NONE)
+        return states_[state].next[index];
+
+    std::vector<uint32_t> steps;
+    for (uint32_t s : states_[state].steps)
+    {
+        Step const & step = steps_[s];
+        if (step.loop)
+            steps.push_back(s);
+        if (step.any != NONE)
+            steps.push_back(step.any);
+        for (auto const & child : step.children)
+        {
+            if (child.first == name)
+                steps.push_back(child.second);
+        }
+    }
+
+    uint32_t next              = addState(std::move(steps));
+    states_[state].next[index] = next;
+    return next;
+}
+
+// Calls the handler of a path
+bool StreamMatcher::report(uint32_t query, std::string_view value)
+{
+    if (queries_[query].once)
+    {
+        if (matched_[query])
+            return true;
+        matched_[query] = true;
+    }
+    return queries_[query].handler(value);
+}
+
+// Enters an element. Its attributes are reported, and if the paths end at the element, reading its value begins. An
+// element that no path can reach is skipped.
+bool StreamMatcher::startElement(StreamReader & reader, uint32_t state)
+{
+    open_.push_back(state);
+
+    State const & s = states_[state];
+    if (s.steps.empty())
+    {
+        reader.Skip();
+        return true;
+    }
+
+    if (!s.attributes.empty())
+    {
+        for (Attribute const & attribute : reader.Attributes())
+        {
+            uint32_t name  = findName(attribute.name);
+            auto     first = std::lower_bound(s.attributes.begin(), s.attributes.end(), std::make_pair(name, 0u));
+            for (auto a = first; a != s.attributes.end() && a->first == name; ++a)
+            {
+                std::string_view value = attribute.value;
+                if (value.find('&') != std::string_view::npos)
+                {
+                    scratch_.clear();
+                    Unescape(attribute.value, scratch_);
+                    value = scratch_;
+                }
+                if (!report(a->second, value))
+                    return false;
+            }
+        }
+    }
+
+    if (!s.queries.empty())
+    {
+        if (captureCount_ == captures_.size())
+            captures_.emplace_back();
+
+        Capture & capture = captures_[captureCount_++];
+        capture.state     = state;
+        capture.element   = open_.size() - 1;
+        capture.reading   = false;
+        capture.done      = false;
+        capture.text.clear();
+    }
+    return true;
+}
+
+// Leaves an element. If its value has not been reported, it has no text and its value is empty.
+bool StreamMatcher::endElement()
+{
+    if (captureCount_ > 0 && captures_[captureCount_ - 1].element + 1 == open_.size())
+    {
+        Capture & capture = captures_[--captureCount_];
+        if (!capture.done)
+        {
+            capture.text.clear();
+            if (!finishValue(capture))
+                return false;
+        }
+    }
+    open_.pop_back();
+    return true;
+}
+
+// Reports the value of an element to the paths that end at it
+bool StreamMatcher::finishValue(Capture & capture)
+{
+    capture.reading = false;
+    capture.done    = true;
+    for (uint32_t query : states_[capture.state].queries)
+    {
+        if (!report(query, capture.text))
+            return false;
+    }
+    return true;
+}
+} // namespace Msxmlx
@@ -0,0 +1,555 @@
+#include "StreamReader.h"
+
+#include "Convert.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Returns a source that reads from a file descriptor
+Msxmlx::StreamReader::Source readFile(int fd)
+{
+    return [fd] (char * pBuffer, size_t size) -> ptrdiff_t {
+#if defined(_WIN32)
+        return _read(fd, pBuffer, unsigned(std::min(size, size_t(INT_MAX))));
+#else
+        for (;;)
+        {
+            ssize_t n = read(fd, pBuffer, std::min(size, size_t(SSIZE_MAX)));
+            if (n >= 0 || errno != EINTR)
+                return n;
+        }
+#endif
+    };
+}
+
+// Returns the end of the longest part of the text that can be reported without splitting a reference or a UTF-8
+// sequence
+char const * splitText(char const * begin, char const * end)
+{
+    // A reference is short, so only the end of the text needs to be checked
+    char const * split = end;
+    for (char const * p = end; p > begin && end - p < 32;)
+    {
+        --p;
+        if (*p == ';')
+            break;
+        if (*p == '&')
+        {
+            split = p;
+            break;
+        }
+    }
+
+    // Back up to the start of the last UTF-8 sequence if it is incomplete
+    char const * lead = split;
+    while (lead > begin && split - lead < 3 && (uint8_t(lead[-1]) & 0xc0) == 0x80)
+    {
+        --lead;
+    }
+    if (lead > begin && uint8_t(lead[-1]) >= 0xc0)
+    {
+        --lead;
+        uint8_t   c      = uint8_t(*lead);
+        ptrdiff_t length = (c >= 0xf0) ? 4 : (c >= 0xe0) ? 3 : 2;
+        if (split - lead < length)
+            split = lead;
+    }
+    return split;
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    document    The document to parse. It must remain valid for the lifetime of the reader.
+
+StreamReader::StreamReader(std::string_view document)
+    : bufferSize_(document.size())
+    , maxBufferSize_(document.size())
+    , window_(document.data())
+    , end_(document.data() + document.size())
+    , cursor_(document.data())
+    , eof_(true)
+{
+    openEnds_.reserve(32);
+}
+
+//! @param    fd               The file descriptor to read from
+//! @param    bufferSize       Initial size of the window
+//! @param    maxBufferSize    Size to which the window may grow to hold a single tag
+
+StreamReader::StreamReader(int fd,
+                           size_t bufferSize /* = DEFAULT_BUFFER_SIZE*/,
+                           size_t maxBufferSize /* = DEFAULT_MAX_BUFFER_SIZE*/)
+    : StreamReader(readFile(fd), bufferSize, maxBufferSize)
+{
+}
+
+//! @param    source           The function that reads the data
+//! @param    bufferSize       Initial size of the window
+//! @param    maxBufferSize    Size to which the window may grow to hold a single tag
+
+StreamReader::StreamReader(Source source,
+                           size_t bufferSize /* = DEFAULT_BUFFER_SIZE*/,
+                           size_t maxBufferSize /* = DEFAULT_MAX_BUFFER_SIZE*/)
+    : source_(std::move(source))
+    , bufferSize_(std::max(bufferSize, size_t(16)))
+    , maxBufferSize_(std::max(maxBufferSize, bufferSize_))
+{
+    buffer_.reset(new char[bufferSize_]);
+    window_ = buffer_.get();
+    end_    = window_;
+    cursor_ = window_;
+    openEnds_.reserve(32);
+}
+
+//! Tokens are returned in document order, as with Reader::Next(), except that character data longer than the window
+//! is returned as several consecutive Text tokens (see IsTextContinued()). The data is read as needed. Once End or
+//! Error has been returned, it is returned by all subsequent calls.
+//!
+//! If the source returns PENDING, None is returned and nothing is consumed, so Next() can be called again to resume
+//! once the source has more data.
+//!
+//! @return        The type of the new current token
+
+StreamReader::Token StreamReader::Next()
+{
+    if (token_ == Token::End || token_ == Token::Error)
+        return token_;
+
+    continued_ = false;
+    if (pendingEnd_)
+    {
+        pendingEnd_ = false;
+        return token_ = Token::EndElement;
+    }
+
+    Lexeme lexeme;
+    for (;;)
+    {
+        bool split = split_;
+        switch (lex(lexeme))
+        {
+        case Token::None:
+            return token_ = Token::None;
+
+        case Token::Text:
+            if (openEnds_.empty())
+            {
+                if (!TrimWhitespace(lexeme.value).empty())
+                    return fail("Text outside of the root element");
+                continue;
+            }
+            value_     = lexeme.value;
+            depth_     = int(openEnds_.size());
+            continued_ = split;
+            return token_ = Token::Text;
+
+        case Token::CData:
+            if (openEnds_.empty())
+                return fail("CDATA outside of the root element");
+            value_ = lexeme.value;
+            depth_ = int(openEnds_.size());
+            return token_ = Token::CData;
+
+        case Token::StartElement:
+            if (openEnds_.empty() && rootClosed_)
+                return fail("More than one root element");
+            name_          = lexeme.name;
+            attributes_    = lexeme.attributes;
+            attributesEnd_ = lexeme.attributesEnd;
+            empty_         = lexeme.empty;
+            depth_         = int(openEnds_.size());
+            if (empty_)
+            {
+                pendingEnd_ = true;
+                rootClosed_ = rootClosed_ || openEnds_.empty();
+            }
+            else
+            {
+                openNames_.append(name_.data(), name_.size());
+                openEnds_.push_back(openNames_.size());
+            }
+            return token_ = Token::StartElement;
+
+        case Token::EndElement:
+            if (openEnds_.empty() || Ancestor(int(openEnds_.size()) - 1) != lexeme.name)
+                return fail("Mismatched end tag");
+            openEnds_.pop_back();
+            openNames_.resize(openEnds_.empty() ? 0 : openEnds_.back());
+            name_       = lexeme.name;
+            empty_      = false;
+            depth_      = int(openEnds_.size());
+            rootClosed_ = openEnds_.empty();
+            return token_ = Token::EndElement;
+
+        case Token::End:
+            if (!openEnds_.empty())
+                return fail("Unexpected end of document");
+            if (!rootClosed_)
+                return fail("No root element");
+            return token_ = Token::End;
+
+        default:
+            return token_ = Token::Error;
+        }
+    }
+}
+
+//! @return        The text, or an empty string if the current token is not Text or CData
+
+std::string StreamReader::GetText() const
+{
+    std::string text;
+    if (token_ == Token::CData)
+        text.assign(value_.data(), value_.size());
+    else if (token_ == Token::Text)
+        Unescape(value_, text);
+    return text;
+}
+
+//! @param    depth    Depth of the ancestor. The root element is at depth 0.
+//!
+//! @return        The name of the ancestor
+
+std::string_view StreamReader::Ancestor(int depth) const
+{
+    size_t begin = (depth > 0) ? openEnds_[depth - 1] : 0;
+    return std::string_view(openNames_).substr(begin, openEnds_[depth] - begin);
+}
+
+//! The path is a list of names separated by '/', starting with the root element. For StartElement and EndElement
+//! tokens, the last name is that of the current element. For Text and CData tokens, it is that of the element
+//! containing the text.
+//!
+//! @param    path    The path
+//!
+//! @return        true, if the path matches the current position exactly
+
+bool StreamReader::IsAt(std::string_view path) const
+{
+    bool   element = (token_ == Token::StartElement || token_ == Token::EndElement);
+    int    count   = depth_ + (element ? 1 : 0);
+    int    i       = 0;
+    size_t start   = 0;
+    for (;;)
+    {
+        size_t           slash = path.find('/', start);
+        std::string_view name  = path.substr(start, (slash == std::string_view::npos) ? slash : slash - start);
+        if (i >= count || name != ((i < depth_) ? Ancestor(i) : name_))
+            return false;
+        ++i;
+        if (slash == std::string_view::npos)
+            break;
+        start = slash + 1;
+    }
+    return i == count;
+}
+
+//! @return        The attributes, or an empty range if the current token is not StartElement
+
+AttributeRange StreamReader::Attributes() const
+{
+    if (token_ != Token::StartElement)
+        return AttributeRange(nullptr, nullptr);
+    return AttributeRange(attributes_, attributesEnd_);
+}
+
+//! @param    sName    Name of the attribute
+//! @param    value    Location to put the raw value of the attribute
+//!
+//! @return        true, if the current token is StartElement and the attribute is present
+
+bool StreamReader::FindAttribute(std::string_view sName, std::string_view & value) const
+{
+    return Attributes().FindAttribute(sName, value);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    sDefault    Value to return if the attribute is not present. The default default value is an empty
+//!                       string.
+//!
+//! @return        The value of the attribute with references expanded
+
+std::string StreamReader::GetStringAttribute(std::string_view sName, char const * sDefault /* = ""*/) const
+{
+    return Attributes().GetStringAttribute(sName, sDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    fDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to a float
+
+float StreamReader::GetFloatAttribute(std::string_view sName, float fDefault /* = 0.f*/) const
+{
+    return Attributes().GetFloatAttribute(sName, fDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted to an int
+
+int StreamReader::GetIntAttribute(std::string_view sName, int iDefault /* = 0*/) const
+{
+    return Attributes().GetIntAttribute(sName, iDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    iDefault    Value to return if the attribute is not present or invalid. The default default value is 0.
+//!
+//! @return        The value of the attribute converted from hex to an unsigned int
+
+uint32_t StreamReader::GetHexAttribute(std::string_view sName, uint32_t iDefault /* = 0*/) const
+{
+    return Attributes().GetHexAttribute(sName, iDefault);
+}
+
+//! @param    sName       Name of the attribute to get
+//! @param    bDefault    Value to return if the attribute is not present or invalid. The default default value is
+//!                       false.
+//!
+//! @return        The value of the attribute converted to a bool
+
+bool StreamReader::GetBoolAttribute(std::string_view sName, bool bDefault /* = false*/) const
+{
+    return Attributes().GetBoolAttribute(sName, bDefault);
+}
+
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool StreamReader::GetFloatArrayAttribute(std::string_view sName, std::vector<float> & values) const
+{
+    return Attributes().GetFloatArrayAttribute(sName, values);
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool StreamReader::GetFloatArrayAttribute(std::string_view sName, float * pValues, size_t & count) const
+{
+    return Attributes().GetFloatArrayAttribute(sName, pValues, count);
+}
+
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool StreamReader::GetIntArrayAttribute(std::string_view sName, std::vector<int> & values) const
+{
+    return Attributes().GetIntArrayAttribute(sName, values);
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool StreamReader::GetIntArrayAttribute(std::string_view sName, int * pValues, size_t & count) const
+{
+    return Attributes().GetIntArrayAttribute(sName, pValues, count);
+}
+
+//! @param    sName     Name of the attribute to get
+//! @param    values    The vector to receive the values. It is emptied if the attribute is not present.
+//!
+//! @return        true, if the attribute is present and every value is valid
+
+bool StreamReader::GetHexArrayAttribute(std::string_view sName, std::vector<uint32_t> & values) const
+{
+    return Attributes().GetHexArrayAttribute(sName, values);
+}
+
+//! @param    sName      Name of the attribute to get
+//! @param    pValues    The array to receive the values
+//! @param    count      On input, the size of the array. On output, the number of values (even if they do not all
+//!                      fit), or 0 if the attribute is not present or a value is not valid.
+//!
+//! @return        true, if the attribute is present, every value is valid and they all fit
+
+bool StreamReader::GetHexArrayAttribute(std::string_view sName, uint32_t * pValues, size_t & count) const
+{
+    return Attributes().GetHexArrayAttribute(sName, pValues, count);
+}
+
+//! If the current token is a start tag, the reader is advanced to the matching end tag. Otherwise, nothing happens.
+//! If the source has no more data yet, the reader stops at None instead, part way through the element.
+
+void StreamReader::Skip()
+{
+    if (token_ == Token::StartElement)
+        skipTo(depth_);
+}
+
+// Lexes the next token, reading more data whenever the token might extend past the end of the window. Returns None,
+// consuming nothing, if the source has no data yet.
+StreamReader::Token StreamReader::lex(Lexeme & lexeme)
+{
+    for (;;)
+    {
+        char const * cursor = cursor_;
+        char const * error  = nullptr;
+        Token        t      = Reader::lex(cursor, end_, lexeme, error);
+        if (!lexeme.truncated || eof_)
+        {
+            cursor_ = cursor;
+            split_  = false;
+            if (t == Token::Error)
+                error_ = error;
+            return t;
+        }
+
+        // Anything skipped before the token is complete, so it can be discarded. Text that fills the window is
+        // returned in parts, rather than growing the window.
+        cursor_ = lexeme.start;
+        if (t == Token::Text && cursor_ == window_ && size_t(end_ - window_) == bufferSize_)
+        {
+            char const * split = splitText(cursor_, end_);
+            if (split > cursor_)
+            {
+                lexeme.value = std::string_view(cursor_, size_t(split - cursor_));
+                cursor_      = split;
+                split_       = true;
+                return t;
+            }
+        }
+
+        bool pending = false;
+        if (!fill(pending))
+            return Token::Error;
+        if (pending)
+            return Token::None;
+    }
+}
+
+// Discards the data before the cursor and reads more. The window is grown if it is full. Returns false if the data
+// could not be read or the window cannot be grown. If the source has no data yet, pending is set.
+bool StreamReader::fill(bool & pending)
+{
+    char * buffer = buffer_.get();
+    size_t kept   = size_t(end_ - cursor_);
+    if (cursor_ > buffer)
+    {
+        memmove(buffer, cursor_, kept);
+        consumed_ += uint64_t(cursor_ - buffer);
+    }
+    else if (kept == bufferSize_)
+    {
+        if (bufferSize_ >= maxBufferSize_)
+        {
+            error_ = "A tag is larger than the maximum buffer size";
+            return false;
+        }
+
+        size_t                  size = std::min(bufferSize_ * 2, maxBufferSize_);
+        std::unique_ptr<char[]> larger(new char[size]);
+        memcpy(larger.get(), buffer, kept);
+        buffer_     = std::move(larger);
+        buffer      = buffer_.get();
+        bufferSize_ = size;
+    }
+
+    window_ = buffer;
+    cursor_ = buffer;
+    end_    = buffer + kept;
+
+    ptrdiff_t n = source_(buffer + kept, bufferSize_ - kept);
+    if (n == PENDING)
+    {
+        pending = true;
+        return true;
+    }
+    if (n < 0)
+    {
+        error_ = "The document could not be read";
+        return false;
+    }
+    if (n == 0)
+        eof_ = true;
+    end_ += n;
+    return true;
+}
+
+// Advances until the end tag at the given depth. Returns false if the end of the document or an error is reached
+// first.
+bool StreamReader::skipTo(int depth)
+{
+    while (token_ != Token::EndElement || depth_ != depth)
+    {
+        Token t = Next();
+        if (t == Token::End || t == Token::Error || t == Token::None)
+            return false;
+    }
+    return true;
+}
+
+StreamReader::Token StreamReader::fail(char const * message)
+{
+    error_ = message;
+    return token_ = Token::Error;
+}
+
+//! If the handler skips an element in StartElement() (with StreamReader::Skip() or ForEachSubElement()), EndElement()
+//! is called for it. Only the depth of the document and the size of its largest tag determine the memory used. The
+//! reader's source must not return PENDING (see PushParser).
+//!
+//! @param    reader     The reader, before its first token
+//! @param    handler    The handler
+//!
+//! @return        false, if the handler stopped parsing or the document is not well-formed or could not be read
+
+bool ParseStream(StreamReader & reader, SaxHandler & handler)
+{
+    using Token = StreamReader::Token;
+
+    for (;;)
+    {
+        switch (reader.Next())
+        {
+        case Token::StartElement:
+            if (!handler.StartElement(reader))
+                return false;
+            if (reader.Current() == Token::EndElement && !handler.EndElement(reader))
+                return false;
+            break;
+
+        case Token::EndElement:
+            if (!handler.EndElement(reader))
+                return false;
+            break;
+
+        case Token::Text:
+        case Token::CData:
+            if (!handler.Text(reader))
+                return false;
+            break;
+
+        case Token::End:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+}
+} // namespace Msxmlx
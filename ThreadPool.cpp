@@ -0,0 +1,222 @@
+#include "ThreadPool.h"
+
+namespace
+{
+// The pool and queue of the current worker thread, if it is one
+thread_local Msxmlx::ThreadPool const * t_pPool = nullptr;
+thread_local size_t t_queue                      = 0;
+} // anonymous namespace
+
+namespace Msxmlx
+{
+//! @param    threadCount    Number of threads that execute loops, including the calling thread. If it is 0, the
+//!                          number of hardware threads is used.
+
+ThreadPool::ThreadPool(size_t threadCount /* = 0*/)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+
+    workers_.reserve(threadCount - 1);
+    for (size_t i = 0; i + 1 < threadCount; ++i)
+    {
+        workers_.emplace_back([this, i] { work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (std::thread & worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+//! @return        The default pool
+
+ThreadPool & ThreadPool::Default()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// Runs a loop, helping with any work until the loop is done. The calling thread sleeps while there is nothing to help
+// with.
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, void (*run)(void *, size_t, size_t),
+                             void * pContext)
+{
+    if (begin >= end)
+        return;
+    if (grain == 0)
+        grain = 1;
+
+    // Small loops and single-threaded pools do not need the queues
+    if (end - begin <= grain || workers_.empty())
+    {
+        for (size_t first = begin; first < end; first += grain)
+        {
+            run(pContext, first, (end - first > grain) ? first + grain : end);
+        }
+        return;
+    }
+
+    Job job;
+    job.run       = run;
+    job.pContext  = pContext;
+    job.grain     = grain;
+    job.remaining = end - begin;
+
+    size_t queue = queueIndex();
+    execute(queue, Task{ &job, begin, end });
+
+    while (job.remaining.load(std::memory_order_acquire) > 0)
+    {
+        Task task;
+        if (pop(queue, task) || steal(queue, task))
+        {
+            execute(queue, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this, &job] {
+            return job.remaining.load(std::memory_order_acquire) == 0 || queued_.load(std::memory_order_acquire) > 0;
+        });
+    }
+
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+// Returns the queue used by the current thread
+size_t ThreadPool::queueIndex() const
+{
+    return (t_pPool == this) ? t_queue : workers_.size();
+}
+
+void ThreadPool::push(size_t queue, Task const & task)
+{
+    {
+        std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+        queues_[queue]->tasks.push_back(task);
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock ensures that a worker checking for work before going to sleep sees the new task or is woken
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_one();
+}
+
+// Takes the most recently pushed task from a queue
+bool ThreadPool::pop(size_t queue, Task & task)
+{
+    std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+    if (queues_[queue]->tasks.empty())
+        return false;
+
+    task = queues_[queue]->tasks.back();
+    queues_[queue]->tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Takes the oldest (and so the largest) task from another queue
+bool ThreadPool::steal(size_t thief, Task & task)
+{
+    size_t count = queues_.size();
+    for (size_t i = 1; i < count; ++i)
+    {
+        Queue & victim = *queues_[(thief + i) % count];
+
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Splits a task until it is no larger than the grain size, leaving the other halves to be stolen, and runs it. Once
+// the function has thrown, the rest of the loop is skipped.
+void ThreadPool::execute(size_t queue, Task task)
+{
+    Job & job = *task.pJob;
+    if (job.failed.load(std::memory_order_relaxed))
+    {
+        finish(job, task.end - task.begin);
+        return;
+    }
+
+    while (task.end - task.begin > job.grain)
+    {
+        size_t middle = task.begin + (task.end - task.begin) / 2;
+        push(queue, Task{ &job, middle, task.end });
+        task.end = middle;
+    }
+
+    try
+    {
+        job.run(job.pContext, task.begin, task.end);
+    }
+    catch (...)
+    {
+        if (!job.failed.exchange(true))
+            job.error = std::current_exception();
+    }
+    finish(job, task.end - task.begin);
+}
+
+// Counts iterations of a loop as done, waking the thread that called ParallelFor() if they are the last ones. The job
+// may be destroyed as soon as the count reaches 0, so it is not touched after that.
+void ThreadPool::finish(Job & job, size_t count)
+{
+    if (job.remaining.fetch_sub(count, std::memory_order_acq_rel) != count)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_all();
+}
+
+// The loop of a worker thread
+void ThreadPool::work(size_t index)
+{
+    t_pPool = this;
+    t_queue = index;
+
+    for (;;)
+    {
+        Task task;
+        if (pop(index, task) || steal(index, task))
+        {
+            execute(index, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+        if (stopping_)
+            return;
+    }
+}
+} // namespace Msxmlx
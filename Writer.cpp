@@ -0,0 +1,485 @@
+#include "Writer.h"
+
+#include "Scan.h"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Returns a sink that writes to a file descriptor
+Msxmlx::Writer::Sink writeFile(int fd)
+{
+    return [fd] (char const * pData, size_t size) {
+        while (size > 0)
+        {
+#if defined(_WIN32)
+            int n = _write(fd, pData, unsigned(std::min(size, size_t(INT_MAX))));
+#else
+            ssize_t n = write(fd, pData, std::min(size, size_t(SSIZE_MAX)));
+            if (n < 0 && errno == EINTR)
+                continue;
+#endif
+            if (n <= 0)
+                return false;
+            pData += n;
+            size -= size_t(n);
+        }
+        return true;
+    };
+}
+
+// Formats a number in a buffer
+template <typename T>
+std::string_view format(char (&buffer)[32], T value)
+{
+    std::to_chars_result r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, size_t(r.ptr - buffer));
+}
+
+// Formats an unsigned int as 0x followed by 8 hex digits, which is accepted by ParseHex()
+std::string_view formatHex(char (&buffer)[32], uint32_t value)
+{
+    static char const DIGITS[] = "0123456789abcdef";
+
+    buffer[0] = '0';
+    buffer[1] = 'x';
+    for (int i = 0; i < 8; ++i)
+    {
+        buffer[2 + i] = DIGITS[(value >> (28 - 4 * i)) & 0xf];
+    }
+    return std::string_view(buffer, 10);
+}
+} // anonymous namespace
+
+namespace Msxmlx
+{
+Writer::Writer()
+    : buffer_(new char[4096])
+    , capacity_(4096)
+    , growable_(true)
+{
+    open_.reserve(32);
+}
+
+//! @param    fd            The file descriptor to write to
+//! @param    bufferSize    Size of the chunks written to the file descriptor
+
+Writer::Writer(int fd, size_t bufferSize /* = DEFAULT_BUFFER_SIZE*/)
+    : Writer(writeFile(fd), bufferSize)
+{
+}
+
+//! @param    sink          The function that writes the output
+//! @param    bufferSize    Size of the chunks passed to the sink
+
+Writer::Writer(Sink sink, size_t bufferSize /* = DEFAULT_BUFFER_SIZE*/)
+    : sink_(std::move(sink))
+    , capacity_(std::max(bufferSize, size_t(64)))
+{
+    buffer_.reset(new char[capacity_]);
+    open_.reserve(32);
+}
+
+//! The declaration specifies version 1.0 and UTF-8 encoding.
+
+void Writer::Declaration()
+{
+    if (started_)
+    {
+        fail("The declaration must be written first");
+        return;
+    }
+    append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+    started_ = true;
+}
+
+//! The start tag is left open until the content of the element is written, so that attributes can be added.
+//!
+//! @param    sName    Name of the element. It is not checked.
+
+void Writer::StartElement(std::string_view sName)
+{
+    if (open_.empty() && rootClosed_)
+    {
+        fail("More than one root element");
+        return;
+    }
+
+    closeStartTag();
+    if (!open_.empty())
+        open_.back().children = true;
+    if (indentation_ > 0 && started_ && (open_.empty() || !open_.back().text))
+        indent(open_.size());
+
+    append('<');
+    append(sName);
+    names_.append(sName.data(), sName.size());
+    open_.push_back(Open{ names_.size(), false, false });
+    inStartTag_ = true;
+    started_    = true;
+}
+
+//! If the element has no content, its start tag is written as an empty-element tag instead.
+
+void Writer::EndElement()
+{
+    if (open_.empty())
+    {
+        fail("There is no element to end");
+        return;
+    }
+
+    Open   element = open_.back();
+    size_t begin   = (open_.size() > 1) ? open_[open_.size() - 2].nameEnd : 0;
+    open_.pop_back();
+
+    if (inStartTag_)
+    {
+        append("/>");
+        inStartTag_ = false;
+    }
+    else
+    {
+        if (indentation_ > 0 && element.children && !element.text)
+            indent(open_.size());
+        append("</");
+        append(names_.data() + begin, element.nameEnd - begin);
+        append('>');
+    }
+
+    names_.resize(begin);
+    rootClosed_ = open_.empty();
+}
+
+//! @param    sName    Name of the attribute. It is not checked.
+//! @param    value    Value of the attribute. It is escaped.
+
+void Writer::StringAttribute(std::string_view sName, std::string_view value)
+{
+    attribute(sName, value);
+}
+
+//! The value is written in the shortest form that converts back to the same float.
+//!
+//! @param    sName     Name of the attribute. It is not checked.
+//! @param    fValue    Value of the attribute
+
+void Writer::FloatAttribute(std::string_view sName, float fValue)
+{
+    char buffer[32];
+    attribute(sName, format(buffer, fValue));
+}
+
+//! @param    sName     Name of the attribute. It is not checked.
+//! @param    iValue    Value of the attribute
+
+void Writer::IntAttribute(std::string_view sName, int iValue)
+{
+    char buffer[32];
+    attribute(sName, format(buffer, iValue));
+}
+
+//! @param    sName     Name of the attribute. It is not checked.
+//! @param    iValue    Value of the attribute
+
+void Writer::HexAttribute(std::string_view sName, uint32_t iValue)
+{
+    char buffer[32];
+    attribute(sName, formatHex(buffer, iValue));
+}
+
+//! @param    sName     Name of the attribute. It is not checked.
+//! @param    bValue    Value of the attribute
+
+void Writer::BoolAttribute(std::string_view sName, bool bValue)
+{
+    attribute(sName, bValue ? "true" : "false");
+}
+
+//! The text is escaped. Once an element has text, its content is not indented, so that the text is not changed.
+//!
+//! @param    text    The text (UTF-8)
+
+void Writer::Text(std::string_view text)
+{
+    if (open_.empty())
+    {
+        fail("Text outside of the root element");
+        return;
+    }
+
+    closeStartTag();
+    open_.back().text = true;
+    escape(text, false);
+}
+
+//! A CDATA section cannot contain "]]>", so the text is split into several sections where it occurs.
+//!
+//! @param    text    The text (UTF-8)
+
+void Writer::CData(std::string_view text)
+{
+    if (open_.empty())
+    {
+        fail("CDATA outside of the root element");
+        return;
+    }
+
+    closeStartTag();
+    open_.back().text = true;
+
+    append("<![CDATA[");
+    for (size_t split = text.find("]]>"); split != std::string_view::npos; split = text.find("]]>"))
+    {
+        append(text.substr(0, split + 2));
+        append("]]><![CDATA[");
+        text.remove_prefix(split + 2);
+    }
+    append(text);
+    append("]]>");
+}
+
+//! @param    text    The text of the comment. It must not contain "--" or end with '-'.
+
+void Writer::Comment(std::string_view text)
+{
+    if (text.find("--") != std::string_view::npos || (!text.empty() && text.back() == '-'))
+    {
+        fail("A comment cannot contain \"--\" or end with '-'");
+        return;
+    }
+
+    closeStartTag();
+    if (!open_.empty())
+        open_.back().children = true;
+    if (indentation_ > 0 && started_ && (open_.empty() || !open_.back().text))
+        indent(open_.size());
+
+    append("<!--");
+    append(text);
+    append("-->");
+    started_ = true;
+}
+
+//! This is the equivalent of CreateTextElement().
+//!
+//! @param    sName    Name of the element. It is not checked.
+//! @param    value    The text. It is escaped.
+
+void Writer::StringElement(std::string_view sName, std::string_view value)
+{
+    StartElement(sName);
+    Text(value);
+    EndElement();
+}
+
+//! The value is written in the shortest form that converts back to the same float.
+//!
+//! @param    sName     Name of the element. It is not checked.
+//! @param    fValue    The value
+
+void Writer::FloatElement(std::string_view sName, float fValue)
+{
+    char buffer[32];
+    StringElement(sName, format(buffer, fValue));
+}
+
+//! @param    sName     Name of the element. It is not checked.
+//! @param    iValue    The value
+
+void Writer::IntElement(std::string_view sName, int iValue)
+{
+    char buffer[32];
+    StringElement(sName, format(buffer, iValue));
+}
+
+//! @param    sName     Name of the element. It is not checked.
+//! @param    iValue    The value
+
+void Writer::HexElement(std::string_view sName, uint32_t iValue)
+{
+    char buffer[32];
+    StringElement(sName, formatHex(buffer, iValue));
+}
+
+//! @param    sName     Name of the element. It is not checked.
+//! @param    bValue    The value
+
+void Writer::BoolElement(std::string_view sName, bool bValue)
+{
+    StringElement(sName, bValue ? "true" : "false");
+}
+
+//! If the output is collected in a buffer, nothing happens. Once writing has failed, the rest of the output is
+//! discarded.
+//!
+//! @return        false, if an error has occurred
+
+bool Writer::Flush()
+{
+    if (!growable_ && size_ > 0)
+    {
+        if (!error_ && !sink_(buffer_.get(), size_))
+            fail("The output could not be written");
+        size_ = 0;
+    }
+    return error_ == nullptr;
+}
+
+//! @return        false, if an error has occurred or there is no root element
+
+bool Writer::Finish()
+{
+    while (!open_.empty())
+    {
+        EndElement();
+    }
+    if (!rootClosed_)
+        fail("No root element");
+    if (indentation_ > 0)
+        append('\n');
+    return Flush();
+}
+
+// Ends the current start tag, if it is open
+void Writer::closeStartTag()
+{
+    if (inStartTag_)
+    {
+        append('>');
+        inStartTag_ = false;
+    }
+}
+
+// Starts a new line indented to a depth
+void Writer::indent(size_t depth)
+{
+    size_t size = 1 + depth * size_t(indentation_);
+    char * p    = reserve(size);
+    p[0]        = '\n';
+    memset(p + 1, ' ', size - 1);
+    size_ += size;
+}
+
+// Appends text with the characters that cannot appear literally replaced by references. Tabs and line feeds are only
+// replaced in attribute values, where they would otherwise be normalized to spaces. Control characters that are not
+// allowed in XML are replaced by U+FFFD.
+void Writer::escape(std::string_view text, bool attribute)
+{
+    char const * p   = text.data();
+    char const * end = p + text.size();
+    while (p < end)
+    {
+        char const * special = Scan::FindEscape(p, end);
+        append(p, size_t(special - p));
+        if (special == end)
+            break;
+
+        switch (*special)
+        {
+        case '<':
+            append("&lt;");
+            break;
+        case '>':
+            append("&gt;");
+            break;
+        case '&':
+            append("&amp;");
+            break;
+        case '"':
+            attribute ? append("&quot;") : append('"');
+            break;
+        case '\t':
+            attribute ? append("&#9;") : append('\t');
+            break;
+        case '\n':
+            attribute ? append("&#10;") : append('\n');
+            break;
+        case '\r':
+            append("&#13;");
+            break;
+        default:
+            append("\xef\xbf\xbd");
+            break;
+        }
+        p = special + 1;
+    }
+}
+
+// Appends an attribute to the current start tag
+void Writer::attribute(std::string_view sName, std::string_view value)
+{
+    if (!inStartTag_)
+    {
+        fail("Attributes must immediately follow a start tag");
+        return;
+    }
+
+    append(' ');
+    append(sName);
+    append("=\"");
+    escape(value, true);
+    append('"');
+}
+
+// Appends to the buffer, flushing it whenever it is full unless it is growable
+void Writer::append(char const * pData, size_t size)
+{
+    while (!growable_ && size > capacity_ - size_)
+    {
+        size_t part = capacity_ - size_;
+        memcpy(buffer_.get() + size_, pData, part);
+        size_ += part;
+        pData += part;
+        size  -= part;
+        Flush();
+    }
+
+    if (size > 0)
+    {
+        memcpy(reserve(size), pData, size);
+        size_ += size;
+    }
+}
+
+void Writer::append(char c)
+{
+    *reserve(1) = c;
+    ++size_;
+}
+
+// Returns space for some characters at the end of the buffer, flushing or growing it as necessary
+char * Writer::reserve(size_t size)
+{
+    if (capacity_ - size_ < size)
+    {
+        if (!growable_)
+            Flush();
+        if (capacity_ - size_ < size)
+        {
+            size_t                  capacity = std::max(capacity_ * 2, size_ + size);
+            std::unique_ptr<char[]> larger(new char[capacity]);
+            memcpy(larger.get(), buffer_.get(), size_);
+            buffer_   = std::move(larger);
+            capacity_ = capacity;
+        }
+    }
+    return buffer_.get() + size_;
+}
+
+void Writer::fail(char const * message)
+{
+    if (!error_)
+        error_ = message;
+}
+} // namespace Msxmlx
@@ -0,0 +1,451 @@
+#include "Bench.h"
+
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/Path.h>
+#include <Msxmlx/Reader.h>
+#include <Msxmlx/StreamReader.h>
+#include <Msxmlx/Writer.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Msxmlx;
+using Bench::Shape;
+using Bench::ValueType;
+
+namespace
+{
+using Index = CompactDocument::Index;
+
+// A value of an attribute, for the writer
+struct Value
+{
+    std::string_view text;
+    float            f;
+    int              i;
+    uint32_t         hex;
+    bool             b;
+};
+
+// The names of the elements and attributes of a generated document
+struct Names
+{
+    std::vector<std::string> elements;
+    std::vector<std::string> attributes;
+};
+
+// Returns a number summarizing a value, so that the values returned by different accessors can be compared
+size_t digest(std::string const & value) { return value.size(); }
+size_t digest(float value) { return size_t(int64_t(value * 8.f)); }
+size_t digest(int value) { return size_t(value); }
+size_t digest(uint32_t value) { return value; }
+size_t digest(bool value) { return value ? 1 : 0; }
+
+// Gets an attribute of an element (an index or its attributes) with the accessor for a type
+template <typename Element>
+size_t getAttribute(CompactDocument const & document, Element element, std::string_view name, ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::STRING: return digest(document.GetStringAttribute(element, name));
+    case ValueType::INT:    return digest(document.GetIntAttribute(element, name));
+    case ValueType::FLOAT:  return digest(document.GetFloatAttribute(element, name));
+    case ValueType::HEX:    return digest(document.GetHexAttribute(element, name));
+    default:                return digest(document.GetBoolAttribute(element, name));
+    }
+}
+
+// Gets an attribute of the current element of a Reader or StreamReader with the accessor for a type
+template <typename R>
+size_t getAttribute(R const & reader, std::string_view name, ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::STRING: return digest(reader.GetStringAttribute(name));
+    case ValueType::INT:    return digest(reader.GetIntAttribute(name));
+    case ValueType::FLOAT:  return digest(reader.GetFloatAttribute(name));
+    case ValueType::HEX:    return digest(reader.GetHexAttribute(name));
+    default:                return digest(reader.GetBoolAttribute(name));
+    }
+}
+
+// Gets the value of a sub-element with the accessor for a type
+size_t getSubElement(CompactDocument const & document, Index element, std::string_view name, ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::STRING: return digest(document.GetStringSubElement(element, name));
+    case ValueType::INT:    return digest(document.GetIntSubElement(element, name));
+    case ValueType::FLOAT:  return digest(document.GetFloatSubElement(element, name));
+    case ValueType::HEX:    return digest(document.GetHexSubElement(element, name));
+    default:                return digest(document.GetBoolSubElement(element, name));
+    }
+}
+
+// Gets the value of a sub-element of the current element of a Reader with the accessor for a type
+size_t getSubElement(Reader const & reader, std::string_view name, ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::STRING: return digest(reader.GetStringSubElement(name));
+    case ValueType::INT:    return digest(reader.GetIntSubElement(name));
+    case ValueType::FLOAT:  return digest(reader.GetFloatSubElement(name));
+    case ValueType::HEX:    return digest(reader.GetHexSubElement(name));
+    default:                return digest(reader.GetBoolSubElement(name));
+    }
+}
+
+// Gets the value at a path with Get() for a type
+size_t getPath(CompactDocument const & document, Index element, Path const & path, ValueType type)
+{
+    switch (type)
+    {
+    case ValueType::STRING: return digest(Get<std::string>(document, element, path, std::string()));
+    case ValueType::INT:    return digest(Get<int>(document, element, path, 0));
+    case ValueType::FLOAT:  return digest(Get<float>(document, element, path, 0.f));
+    case ValueType::HEX:    return digest(Get<uint32_t>(document, element, path, 0u));
+    default:                return digest(Get<bool>(document, element, path, false));
+    }
+}
+
+// Compiles the paths from the root of a tree to each of its leaves
+void addLeafPaths(Shape const & shape, Names const & names, std::string const & prefix, int level,
+                  std::vector<Path> & paths)
+{
+    if (level == shape.depth)
+    {
+        paths.push_back(Path::Compile(prefix));
+        return;
+    }
+    for (int i = 0; i < shape.width; ++i)
+    {
+        addLeafPaths(shape, names, prefix.empty() ? names.elements[i] : prefix + '/' + names.elements[i], level + 1,
+                     paths);
+    }
+}
+
+// Gets every attribute of every element while reading a document
+template <typename R>
+size_t readAttributes(std::string const & text, Shape const & shape, Names const & names)
+{
+    R      reader(text);
+    size_t sum = 0;
+    for (Reader::Token t = reader.Next(); t != Reader::Token::End && t != Reader::Token::Error; t = reader.Next())
+    {
+        if (t == Reader::Token::StartElement)
+        {
+            for (int i = 0; i < shape.attributes; ++i)
+                sum += getAttribute(reader, names.attributes[i], shape.TypeOf(i));
+        }
+    }
+    return sum;
+}
+
+// Counts the descendants of the current element of a Reader or StreamReader
+template <typename R>
+size_t countElements(R & reader)
+{
+    size_t count = 0;
+    reader.ForEachSubElement([&count] (R & child) {
+        count += 1 + countElements(child);
+        return true;
+    });
+    return count;
+}
+
+// Counts the descendants of an element
+size_t countElements(CompactDocument const & document, Index element)
+{
+    size_t count = 0;
+    document.ForEachSubElement(element, [&] (Index child) {
+        count += 1 + countElements(document, child);
+        return true;
+    });
+    return count;
+}
+
+// Gets the values of the leaves below the current element of a Reader, at a level of the trees
+size_t readValues(Reader & reader, Shape const & shape, Names const & names, int level)
+{
+    size_t sum = 0;
+    reader.ForEachSubElement([&] (Reader & child) {
+        if (level + 1 < shape.depth)
+        {
+            sum += readValues(child, shape, names, level + 1);
+        }
+        else
+        {
+            for (int i = 0; i < shape.width; ++i)
+                sum += getSubElement(child, names.elements[i], shape.TypeOf(i));
+        }
+        return true;
+    });
+    return sum;
+}
+
+// Writes an element of a tree and its descendants, taking the values in document order
+void writeElement(Writer &                  writer,
+                  Shape const &             shape,
+                  Names const &             names,
+                  int                       level,
+                  int                       position,
+                  Value const *&            pValue,
+                  std::string_view const *& pText)
+{
+    writer.StartElement(names.elements[position]);
+    for (int i = 0; i < shape.attributes; ++i, ++pValue)
+    {
+        std::string const & name = names.attributes[i];
+        switch (shape.TypeOf(i))
+        {
+        case ValueType::STRING: writer.StringAttribute(name, pValue->text); break;
+        case ValueType::INT:    writer.IntAttribute(name, pValue->i);       break;
+        case ValueType::FLOAT:  writer.FloatAttribute(name, pValue->f);     break;
+        case ValueType::HEX:    writer.HexAttribute(name, pValue->hex);     break;
+        default:                writer.BoolAttribute(name, pValue->b);      break;
+        }
+    }
+    if (level == shape.depth)
+    {
+        writer.Text(*pText++);
+    }
+    else
+    {
+        for (int i = 0; i < shape.width; ++i)
+            writeElement(writer, shape, names, level + 1, i, pValue, pText);
+    }
+    writer.EndElement();
+}
+
+// Writes a document of trees with the values of another
+void writeDocument(Writer &                              writer,
+                   Shape const &                         shape,
+                   Names const &                         names,
+                   size_t                                trees,
+                   std::vector<Value> const &            values,
+                   std::vector<std::string_view> const & texts)
+{
+    Value const *            pValue = values.data();
+    std::string_view const * pText  = texts.data();
+    writer.StartElement("root");
+    for (size_t i = 0; i < trees; ++i)
+        writeElement(writer, shape, names, 0, 0, pValue, pText);
+    writer.Finish();
+}
+
+// Gets every attribute of every element of a document
+size_t sumAttributes(CompactDocument const & document, Shape const & shape, Names const & names)
+{
+    size_t sum = 0;
+    for (Index element = 1; element < Index(document.Size()); ++element)
+    {
+        for (int i = 0; i < shape.attributes; ++i)
+            sum += getAttribute(document, element, names.attributes[i], shape.TypeOf(i));
+    }
+    return sum;
+}
+
+// Prints a message and returns false if the results of two accessors do not agree
+bool check(char const * name, size_t result, size_t expected)
+{
+    if (result == expected)
+        return true;
+    printf("%s does not agree with the other accessors (%zu, not %zu)\n", name, result, expected);
+    return false;
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! The same values are read with each family of accessors of the portable backends: the attribute and sub-element
+//! accessors of CompactDocument, compiled paths, Reader and StreamReader, and the enumeration of sub-elements. The
+//! elements are then created again with Writer. The time of each is reported per operation (per value read, element
+//! enumerated or element written) and per byte of the document.
+//!
+//! @param    shape    Shape of the synthetic document
+//! @param    size     Size of the synthetic document
+//!
+//! @return        false, if the accessors do not return the same values
+
+bool AccessorBench(Shape const & shape, size_t size)
+{
+    Section("Accessors (width %d, depth %d, %d attributes, %s values)",
+            shape.width, shape.depth, shape.attributes, ValueTypeName(shape.values));
+
+    std::string     text = GenerateDocument(shape, size);
+    CompactDocument document;
+    if (!document.Parse(text))
+    {
+        printf("The synthetic document could not be parsed: %s\n", document.ErrorMessage());
+        return false;
+    }
+
+    Names names;
+    for (int i = 0; i < shape.width || i == 0; ++i)
+        names.elements.push_back(std::to_string(i).insert(0, 1, 'e'));
+    for (int i = 0; i < shape.attributes; ++i)
+        names.attributes.push_back(std::to_string(i).insert(0, 1, 'a'));
+
+    Index  end      = Index(document.Size());
+    size_t elements = document.Size() - 1;
+    size_t leaves   = 0;
+    for (Index element = 1; element < end; ++element)
+        leaves += (document.FirstChild(element) == CompactDocument::NONE) ? 1 : 0;
+    size_t attributes = elements * size_t(shape.attributes);
+    size_t parents    = elements - leaves;
+    bool   ok         = true;
+    size_t result     = 0;
+    double seconds;
+
+    // Attributes
+
+    size_t expected = 0;
+    if (attributes > 0)
+    {
+        seconds = Time([&] { result = sumAttributes(document, shape, names); });
+        ReportOperations("CompactDocument Get*Attribute", attributes, text.size(), seconds);
+        expected = result;
+
+        seconds = Time([&] {
+            result = 0;
+            for (Index element = 1; element < end; ++element)
+            {
+                CompactDocument::Attributes range = document.GetAttributes(element);
+                for (int i = 0; i < shape.attributes; ++i)
+                    result += getAttribute(document, range, names.attributes[i], shape.TypeOf(i));
+            }
+        });
+        ReportOperations("CompactDocument Get*Attribute (range)", attributes, text.size(), seconds);
+        ok = check("Get*Attribute (range)", result, expected) && ok;
+
+        seconds = Time([&] { result = readAttributes<Reader>(text, shape, names); });
+        ReportOperations("Reader Get*Attribute", attributes, text.size(), seconds);
+        ok = check("Reader Get*Attribute", result, expected) && ok;
+
+        seconds = Time([&] { result = readAttributes<StreamReader>(text, shape, names); });
+        ReportOperations("StreamReader Get*Attribute", attributes, text.size(), seconds);
+        ok = check("StreamReader Get*Attribute", result, expected) && ok;
+    }
+
+    // Sub-elements
+
+    if (shape.depth > 0 && shape.width > 0)
+    {
+        seconds = Time([&] {
+            result = 0;
+            for (Index element = 1; element < end; ++element)
+            {
+                if (document.FirstChild(element) == CompactDocument::NONE)
+                    continue;
+                for (int i = 0; i < shape.width; ++i)
+                    result += (document.GetSubElement(element, names.elements[i]) != CompactDocument::NONE) ? 1 : 0;
+            }
+        });
+        ReportOperations("CompactDocument GetSubElement", parents * size_t(shape.width), text.size(), seconds);
+        ok = check("GetSubElement", result, parents * size_t(shape.width)) && ok;
+
+        seconds = Time([&] {
+            result = 0;
+            for (Index element = 1; element < end; ++element)
+            {
+                Index child = document.FirstChild(element);
+                if (child == CompactDocument::NONE || document.FirstChild(child) != CompactDocument::NONE)
+                    continue;
+                for (int i = 0; i < shape.width; ++i)
+                    result += getSubElement(document, element, names.elements[i], shape.TypeOf(i));
+            }
+        });
+        ReportOperations("CompactDocument Get*SubElement", leaves, text.size(), seconds);
+        expected = result;
+
+        seconds = Time([&] {
+            Reader reader(text);
+            reader.Next();
+            result = readValues(reader, shape, names, 0);
+        });
+        ReportOperations("Reader Get*SubElement", leaves, text.size(), seconds);
+        ok = check("Reader Get*SubElement", result, expected) && ok;
+    }
+
+    std::vector<Path> paths;
+    addLeafPaths(shape, names, std::string(), 0, paths);
+    seconds = Time([&] {
+        result = 0;
+        document.ForEachSubElement(document.Root(), [&] (Index tree) {
+            for (size_t i = 0; i < paths.size(); ++i)
+                result += getPath(document, tree, paths[i], shape.TypeOf(int(i) % (shape.width > 0 ? shape.width : 1)));
+            return true;
+        });
+    });
+    ReportOperations("Get<T>(Path)", leaves, text.size(), seconds);
+    if (shape.depth > 0 && shape.width > 0)
+        ok = check("Get<T>(Path)", result, expected) && ok;
+
+    // Enumeration
+
+    seconds = Time([&] { result = countElements(document, document.Root()); });
+    ReportOperations("CompactDocument ForEachSubElement", elements, text.size(), seconds);
+    ok = check("CompactDocument ForEachSubElement", result, elements) && ok;
+
+    seconds = Time([&] {
+        Reader reader(text);
+        reader.Next();
+        result = countElements(reader);
+    });
+    ReportOperations("Reader ForEachSubElement", elements, text.size(), seconds);
+    ok = check("Reader ForEachSubElement", result, elements) && ok;
+
+    seconds = Time([&] {
+        StreamReader reader(text);
+        reader.Next();
+        result = countElements(reader);
+    });
+    ReportOperations("StreamReader ForEachSubElement", elements, text.size(), seconds);
+    ok = check("StreamReader ForEachSubElement", result, elements) && ok;
+
+    // Creation
+
+    std::vector<Value>            values;
+    std::vector<std::string_view> texts;
+    for (Index element = 1; element < end; ++element)
+    {
+        CompactDocument::Attributes range = document.GetAttributes(element);
+        for (int i = 0; i < shape.attributes; ++i)
+        {
+            values.push_back({ document.AttributeValue(range.first + uint32_t(i)),
+                               document.GetFloatAttribute(range, names.attributes[i]),
+                               document.GetIntAttribute(range, names.attributes[i]),
+                               document.GetHexAttribute(range, names.attributes[i]),
+                               document.GetBoolAttribute(range, names.attributes[i]) });
+        }
+        if (document.FirstChild(element) == CompactDocument::NONE)
+            texts.push_back(document.Value(element));
+    }
+    size_t trees = 0;
+    document.ForEachSubElement(document.Root(), [&trees] (Index) { return ++trees != 0; });
+
+    size_t written = 0;
+    seconds = Time([&] {
+        Writer writer;
+        writeDocument(writer, shape, names, trees, values, texts);
+        written = writer.Data().size();
+    });
+    ReportOperations("Writer elements", elements, written, seconds);
+
+    Writer writer;
+    writeDocument(writer, shape, names, trees, values, texts);
+    CompactDocument copy;
+    if (!copy.Parse(writer.Data()) || copy.Size() != document.Size())
+    {
+        printf("The output of the writer could not be read back\n");
+        return false;
+    }
+    if (attributes > 0)
+        ok = check("Writer", sumAttributes(copy, shape, names), sumAttributes(document, shape, names)) && ok;
+
+    return ok;
+}
+} // namespace Bench
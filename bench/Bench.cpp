@@ -0,0 +1,221 @@
+#include "Bench.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+// A result that has been reported
+struct Result
+{
+    std::string section;
+    std::string name;
+    double      seconds;
+    size_t      count;  // Number of operations, or 0
+    size_t      bytes;  // Number of bytes processed, or 0
+};
+
+volatile size_t s_sink;
+std::string s_section;
+std::vector<Result> s_results;
+
+// Writes a string as a JSON string
+void writeJsonString(FILE * pFile, std::string const & text)
+{
+    fputc('"', pFile);
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            fprintf(pFile, "\\%c", c);
+        else if (static_cast<unsigned char>(c) < 0x20)
+            fprintf(pFile, "\\u%04x", unsigned(c));
+        else
+            fputc(c, pFile);
+    }
+    fputc('"', pFile);
+}
+
+// Appends the text of a value of a type to a string
+void appendValue(std::string & document, Bench::ValueType type, int i)
+{
+    char buffer[64];
+    switch (type)
+    {
+    case Bench::ValueType::STRING: snprintf(buffer, sizeof(buffer), "value %d &amp; more", i); break;
+    case Bench::ValueType::INT:    snprintf(buffer, sizeof(buffer), "%d", i * 37 - 100000); break;
+    case Bench::ValueType::FLOAT:  snprintf(buffer, sizeof(buffer), "%d.125", i % 100000 - 50000); break;
+    case Bench::ValueType::HEX:    snprintf(buffer, sizeof(buffer), "0x%08x", unsigned(i) * 2654435761u); break;
+    default:                       snprintf(buffer, sizeof(buffer), "%s", (i & 1) ? "true" : "false"); break;
+    }
+    document += buffer;
+}
+
+// Appends an element of a generated document and its descendants. Returns the next element number.
+int appendElement(std::string & document, Bench::Shape const & shape, int level, int position, int number)
+{
+    document.append(size_t(level + 1) * 2, ' ');
+    document += "<e" + std::to_string(position);
+    for (int i = 0; i < shape.attributes; ++i)
+    {
+        document += " a" + std::to_string(i) + "=\"";
+        appendValue(document, shape.TypeOf(i), number + i);
+        document += '"';
+    }
+
+    if (level == shape.depth)
+    {
+        document += '>';
+        appendValue(document, shape.TypeOf(position), number);
+        document += "</e" + std::to_string(position) + ">\n";
+        return number + 1;
+    }
+
+    document += ">\n";
+    int next = number + 1;
+    for (int i = 0; i < shape.width; ++i)
+        next = appendElement(document, shape, level + 1, i, next);
+    document.append(size_t(level + 1) * 2, ' ');
+    document += "</e" + std::to_string(position) + ">\n";
+    return next;
+}
+} // anonymous namespace
+
+namespace Bench
+{
+void Consume(size_t value)
+{
+    s_sink = s_sink + value;
+}
+
+//! The bits of the value are consumed, since converting a negative or very large value to an integer is undefined.
+
+void Consume(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    s_sink = s_sink + size_t(bits);
+}
+
+void Section(char const * format, ...)
+{
+    char    buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    printf("%s\n", buffer);
+    s_section = buffer;
+}
+
+void ReportThroughput(char const * name, size_t bytes, double seconds)
+{
+    printf("%-40s %8.3f GB/s\n", name, double(bytes) / seconds / 1e9);
+    s_results.push_back({ s_section, name, seconds, 0, bytes });
+}
+
+void ReportRate(char const * name, size_t count, double seconds)
+{
+    printf("%-40s %8.3f M/s\n", name, double(count) / seconds / 1e6);
+    s_results.push_back({ s_section, name, seconds, count, 0 });
+}
+
+void ReportTime(char const * name, double seconds)
+{
+    printf("%-40s %8.3f us\n", name, seconds * 1e6);
+    s_results.push_back({ s_section, name, seconds, 0, 0 });
+}
+
+void ReportOperations(char const * name, size_t count, size_t bytes, double seconds)
+{
+    printf("%-40s %8.2f ns/op %8.3f GB/s\n", name, seconds * 1e9 / double(count), double(bytes) / seconds / 1e9);
+    s_results.push_back({ s_section, name, seconds, count, bytes });
+}
+
+//! Each result has the section and name under which it was reported and the time, and, if known, the number of
+//! operations and bytes, the time per operation and per byte, and the rates.
+//!
+//! @param    pFile    File to write to
+//! @param    label    Description of the build (e.g. the compiler and options), so that runs can be compared
+//! @param    size     Size of the synthetic documents
+//!
+//! @return        false, if the file could not be written
+
+bool WriteJson(FILE * pFile, char const * label, size_t size)
+{
+    fprintf(pFile, "{\n  \"label\": ");
+    writeJsonString(pFile, label);
+    fprintf(pFile, ",\n  \"size\": %zu,\n  \"results\": [", size);
+    for (size_t i = 0; i < s_results.size(); ++i)
+    {
+        Result const & result = s_results[i];
+        fprintf(pFile, "%s\n    { \"section\": ", (i > 0) ? "," : "");
+        writeJsonString(pFile, result.section);
+        fprintf(pFile, ", \"name\": ");
+        writeJsonString(pFile, result.name);
+        fprintf(pFile, ", \"seconds\": %.9g", result.seconds);
+        if (result.count > 0)
+        {
+            fprintf(pFile, ", \"count\": %zu, \"ns_per_op\": %.6g, \"ops_per_s\": %.6g",
+                    result.count, result.seconds * 1e9 / double(result.count), double(result.count) / result.seconds);
+        }
+        if (result.bytes > 0)
+        {
+            fprintf(pFile, ", \"bytes\": %zu, \"ns_per_byte\": %.6g, \"bytes_per_s\": %.6g",
+                    result.bytes, result.seconds * 1e9 / double(result.bytes), double(result.bytes) / result.seconds);
+        }
+        fprintf(pFile, " }");
+    }
+    fprintf(pFile, "\n  ]\n}\n");
+    return fflush(pFile) == 0 && !ferror(pFile);
+}
+
+//! The document is a list of entities with attributes, text and nested elements, similar to a typical
+//! configuration or level file.
+//!
+//! @param    size    Minimum size of the document in bytes
+
+std::string GenerateDocument(size_t size)
+{
+    std::string document = "<?xml version=\"1.0\"?>\n<world name=\"synthetic\" version=\"1\">\n";
+    char        buffer[512];
+    for (int i = 0; document.size() < size; ++i)
+    {
+        snprintf(buffer, sizeof(buffer),
+                 "  <entity id=\"%d\" type=\"prop_%d\" flags=\"0x%08x\" visible=\"true\">\n"
+                 "    <position x=\"%d.25\" y=\"%d.5\" z=\"-%d.75\"/>\n"
+                 "    <name>Entity number %d &amp; friends</name>\n"
+                 "    <health>%d</health>\n"
+                 "    <description><![CDATA[Some <free> text for entity %d]]></description>\n"
+                 "  </entity>\n",
+                 i, i % 97, unsigned(i) * 2654435761u, i, i * 2, i * 3, i, i % 1000, i);
+        document += buffer;
+    }
+    document += "</world>\n";
+    return document;
+}
+char const * ValueTypeName(ValueType type)
+{
+    static char const * const NAMES[] = { "string", "int", "float", "hex", "bool", "mixed" };
+    return (unsigned(type) <= unsigned(ValueType::MIXED)) ? NAMES[int(type)] : nullptr;
+}
+
+//! Trees of the shape are added to the root until the document is large enough. The values are different in each
+//! element, and are valid for their types.
+//!
+//! @param    shape    Shape of each tree
+//! @param    size     Minimum size of the document in bytes
+
+std::string GenerateDocument(Shape const & shape, size_t size)
+{
+    std::string document = "<?xml version=\"1.0\"?>\n<root>\n";
+    for (int number = 0; document.size() < size;)
+        number = appendElement(document, shape, 0, 0, number);
+    document += "</root>\n";
+    return document;
+}
+} // namespace Bench
@@ -0,0 +1,124 @@
+#pragma once
+
+#if !defined(MSXMLX_BENCH_BENCH_H)
+#define MSXMLX_BENCH_BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+//! Benchmark support.
+
+namespace Bench
+{
+//! Returns the shortest time (in seconds) taken by several calls to a function.
+template <typename F>
+double Time(F f, int runs = 5)
+{
+    double best = 0.0;
+    for (int i = 0; i < runs; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+//! Keeps the compiler from optimizing away the computation of a value.
+void Consume(size_t value);
+
+//! Keeps the compiler from optimizing away the computation of a value.
+void Consume(double value);
+
+//! Starts a group of results, printing its title (formatted as with printf).
+void Section(char const * format, ...);
+
+//! Prints the throughput of a benchmark.
+void ReportThroughput(char const * name, size_t bytes, double seconds);
+
+//! Prints the rate (in millions of operations per second) of a benchmark.
+void ReportRate(char const * name, size_t count, double seconds);
+
+//! Prints the time (in microseconds) taken by a benchmark.
+void ReportTime(char const * name, double seconds);
+
+//! Prints the time per operation (in nanoseconds) and the throughput of a benchmark that processes a document.
+void ReportOperations(char const * name, size_t count, size_t bytes, double seconds);
+
+//! Writes every result reported so far as JSON, labelled with a description of the build. Returns false on failure.
+bool WriteJson(FILE * pFile, char const * label, size_t size);
+
+//! Generates a synthetic document of at least the given size.
+std::string GenerateDocument(size_t size);
+
+//! The types of the values in a document generated by GenerateDocument(Shape, size)
+enum class ValueType
+{
+    STRING,
+    INT,
+    FLOAT,
+    HEX,
+    BOOL,
+    MIXED   //!< The types above in turn
+};
+
+//! The shape of a document generated by GenerateDocument(Shape, size)
+struct Shape
+{
+    int       width      = 4;               //!< Number of sub-elements of each element above the leaves
+    int       depth      = 3;               //!< Number of levels below each child of the root
+    int       attributes = 4;               //!< Number of attributes of each element
+    ValueType values     = ValueType::MIXED;
+
+    //! Returns the type of the nth attribute or leaf value.
+    ValueType TypeOf(int n) const
+    {
+        return (values == ValueType::MIXED) ? ValueType(n % int(ValueType::MIXED)) : values;
+    }
+};
+
+//! Returns the name of a value type, or nullptr if it is not valid.
+char const * ValueTypeName(ValueType type);
+
+//! Generates a synthetic document of at least the given size, made of trees of a given shape.
+//!
+//! The children of the root are named "e0", and each element of a tree has the attributes "a0", "a1", ... and, if it
+//! is not a leaf, the sub-elements "e0", "e1", ... A leaf has a value, whose type is that of its position among its
+//! siblings.
+std::string GenerateDocument(Shape const & shape, size_t size);
+
+//! Checks the scanning kernels against each other and measures their throughput. Returns false on a mismatch.
+bool ScanBench(size_t size);
+
+//! Checks the text conversions against the C runtime and compares their speed. Returns false on a mismatch.
+bool ConvertBench(size_t count);
+
+//! Compares the parallel algorithms with a serial loop for several thread counts. Returns false on a mismatch.
+bool ParallelBench(size_t size);
+
+//! Measures the writer against snprintf and checks that its output can be read back. Returns false on a mismatch.
+bool WriterBench(size_t count);
+
+//! Compares parsing a document with loading a snapshot of it and parsing it lazily. Returns false on a mismatch.
+bool SnapshotBench(size_t size);
+
+//! Measures each family of accessors on a document of a given shape. Returns false if the accessors do not agree.
+bool AccessorBench(Shape const & shape, size_t size);
+
+//! Compares loading many small files one at a time with LoadAll(). Returns false if they do not agree.
+bool LoaderBench(size_t size);
+
+#if defined(_WIN32)
+//! Compares the MSXML enumeration functions and ranges. Returns false if they do not agree.
+bool EnumerationBench(size_t count);
+
+//! Compares building text elements one at a time with building a fragment. Returns false if they do not agree.
+bool FragmentBench(size_t maxCount);
+#endif
+} // namespace Bench
+
+#endif // !defined(MSXMLX_BENCH_BENCH_H)
@@ -0,0 +1,323 @@
+#include "Bench.h"
+
+#include <Msxmlx/Convert.h>
+#include <Msxmlx/Scan.h>
+
+#include <cstdio>
+#include <cwchar>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <oleauto.h>
+#endif
+
+using namespace Msxmlx;
+
+namespace
+{
+Scan::Isa const ISAS[]      = { Scan::Isa::Scalar, Scan::Isa::Sse2, Scan::Isa::Avx2 };
+char const *    ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+
+// Generates attribute-like text: floats, integers and hex numbers as they typically appear in documents
+void generate(size_t count, std::vector<std::string> & floats, std::vector<std::string> & ints,
+              std::vector<std::string> & hexes)
+{
+    std::mt19937 random(12345);
+    char         buffer[64];
+    for (size_t i = 0; i < count; ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "%.*f", int(random() % 7), (double(random()) - 2147483648.0) / 1000.0);
+        floats.push_back(buffer);
+        snprintf(buffer, sizeof(buffer), "%d", int(random()) >> (random() % 24));
+        ints.push_back(buffer);
+        snprintf(buffer, sizeof(buffer), "0x%08x", unsigned(random()));
+        hexes.push_back(buffer);
+    }
+}
+
+std::vector<std::wstring> widen(std::vector<std::string> const & narrow)
+{
+    std::vector<std::wstring> wide;
+    wide.reserve(narrow.size());
+    for (std::string const & text : narrow)
+    {
+        wide.emplace_back(text.begin(), text.end());
+    }
+    return wide;
+}
+
+// Checks the conversions against the C runtime, which uses the "C" locale here
+bool verify(std::vector<std::string> const & floats, std::vector<std::string> const & ints,
+            std::vector<std::string> const & hexes)
+{
+    for (size_t i = 0; i < floats.size(); ++i)
+    {
+        float    f = 0.f, wf = 0.f;
+        int      n = 0, wn = 0;
+        uint32_t h = 0, wh = 0;
+        if (!ParseFloat(floats[i], f) || !ParseFloat(std::wstring(floats[i].begin(), floats[i].end()), wf) ||
+            f != wf || f != strtof(floats[i].c_str(), nullptr))
+        {
+            printf("ParseFloat does not match strtof for \"%s\"\n", floats[i].c_str());
+            return false;
+        }
+        if (!ParseInt(ints[i], n) || !ParseInt(std::wstring(ints[i].begin(), ints[i].end()), wn) || n != wn ||
+            n != int(strtol(ints[i].c_str(), nullptr, 10)))
+        {
+            printf("ParseInt does not match strtol for \"%s\"\n", ints[i].c_str());
+            return false;
+        }
+        if (!ParseHex(hexes[i], h) || !ParseHex(std::wstring(hexes[i].begin(), hexes[i].end()), wh) || h != wh ||
+            h != uint32_t(strtoul(hexes[i].c_str(), nullptr, 16)))
+        {
+            printf("ParseHex does not match strtoul for \"%s\"\n", hexes[i].c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Measures the conversion of UTF-8 text to wide text and back with each instruction set
+bool transcode(std::string const & text, char const * description)
+{
+    std::wstring wide(text.size(), L'\0');
+    std::string  narrow;
+    std::string  name;
+    for (Scan::Isa isa : ISAS)
+    {
+        if (int(isa) > int(Scan::Supported()))
+            continue;
+
+        Scan::Select(isa);
+        size_t length = 0;
+        double seconds = Bench::Time([&] { length = ToWide(text, &wide[0]); });
+        name = std::string("ToWide (") + description + ") " + ISA_NAMES[int(isa)];
+        Bench::ReportThroughput(name.c_str(), text.size(), seconds);
+
+        std::wstring_view converted(wide.data(), length);
+        seconds = Bench::Time([&] { ToUtf8(converted, narrow); });
+        name = std::string("ToUtf8 (") + description + ") " + ISA_NAMES[int(isa)];
+        Bench::ReportThroughput(name.c_str(), text.size(), seconds);
+
+        if (narrow != text)
+        {
+            printf("The %s text is not the same after conversion to wide text and back\n", description);
+            Scan::Select(Scan::Supported());
+            return false;
+        }
+    }
+    Scan::Select(Scan::Supported());
+    return true;
+}
+
+// Measures the conversion of a list of values to a vector with each instruction set, checking it against the values
+// converted one at a time
+template <typename T>
+bool parseList(std::vector<std::string> const & values,
+               char const *                     description,
+               bool (*parse)(std::string_view, T &),
+               bool (*parseArray)(std::string_view, std::vector<T> &))
+{
+    std::string    list;
+    std::vector<T> expected(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        list += values[i];
+        list += (i % 16 == 15) ? '\n' : ' ';
+        parse(values[i], expected[i]);
+    }
+
+    std::vector<T> parsed;
+    std::string    name;
+    for (Scan::Isa isa : ISAS)
+    {
+        if (int(isa) > int(Scan::Supported()))
+            continue;
+
+        Scan::Select(isa);
+        bool   valid   = false;
+        double seconds = Bench::Time([&] { valid = parseArray(list, parsed); });
+        name = std::string("Parse") + description + "Array " + ISA_NAMES[int(isa)];
+        Bench::ReportThroughput(name.c_str(), list.size(), seconds);
+
+        if (!valid || parsed != expected)
+        {
+            printf("The list of %s values is not the same as the values converted one at a time\n", description);
+            Scan::Select(Scan::Supported());
+            return false;
+        }
+    }
+    Scan::Select(Scan::Supported());
+    return true;
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! The MSXML accessors used to convert values with VARIANT::ChangeType (and wcstoul for hex values). On Windows,
+//! VariantChangeType is measured directly. Elsewhere, the locale-dependent C runtime functions stand in for it.
+//!
+//! @param    count    Number of values of each type to convert
+//!
+//! @return        false, if any conversion does not match the C runtime
+
+bool ConvertBench(size_t count)
+{
+    Section("Text conversions");
+
+    std::vector<std::string> floats, ints, hexes;
+    generate(count, floats, ints, hexes);
+    if (!verify(floats, ints, hexes))
+        return false;
+
+    std::vector<std::wstring> wideFloats = widen(floats);
+    std::vector<std::wstring> wideInts   = widen(ints);
+    std::vector<std::wstring> wideHexes  = widen(hexes);
+    double                    seconds;
+
+    seconds = Time([&] {
+        float sum = 0.f;
+        for (std::string const & text : floats)
+        {
+            float value = 0.f;
+            ParseFloat(text, value);
+            sum += value;
+        }
+        Consume(sum);
+    });
+    ReportRate("ParseFloat (narrow)", count, seconds);
+
+    seconds = Time([&] {
+        float sum = 0.f;
+        for (std::wstring const & text : wideFloats)
+        {
+            float value = 0.f;
+            ParseFloat(text, value);
+            sum += value;
+        }
+        Consume(sum);
+    });
+    ReportRate("ParseFloat (wide)", count, seconds);
+
+    seconds = Time([&] {
+        float sum = 0.f;
+        for (std::wstring const & text : wideFloats)
+        {
+            sum += wcstof(text.c_str(), nullptr);
+        }
+        Consume(sum);
+    });
+    ReportRate("wcstof", count, seconds);
+
+    seconds = Time([&] {
+        int64_t sum = 0;
+        for (std::wstring const & text : wideInts)
+        {
+            int value = 0;
+            ParseInt(text, value);
+            sum += value;
+        }
+        Consume(size_t(sum));
+    });
+    ReportRate("ParseInt (wide)", count, seconds);
+
+    seconds = Time([&] {
+        int64_t sum = 0;
+        for (std::wstring const & text : wideInts)
+        {
+            sum += wcstol(text.c_str(), nullptr, 10);
+        }
+        Consume(size_t(sum));
+    });
+    ReportRate("wcstol", count, seconds);
+
+    seconds = Time([&] {
+        uint32_t sum = 0;
+        for (std::wstring const & text : wideHexes)
+        {
+            uint32_t value = 0;
+            ParseHex(text, value);
+            sum += value;
+        }
+        Consume(size_t(sum));
+    });
+    ReportRate("ParseHex (wide)", count, seconds);
+
+    seconds = Time([&] {
+        unsigned long sum = 0;
+        for (std::wstring const & text : wideHexes)
+        {
+            sum += wcstoul(text.c_str(), nullptr, 16);
+        }
+        Consume(size_t(sum));
+    });
+    ReportRate("wcstoul", count, seconds);
+
+    // Documents are mostly ASCII, but a few non-ASCII characters interrupt the runs that are converted in bulk
+    std::string ascii = GenerateDocument(count * 16);
+    std::string mixed;
+    mixed.reserve(ascii.size() + ascii.size() / 16);
+    for (size_t i = 0; i < ascii.size(); ++i)
+    {
+        if (i % 64 == 63)
+            mixed += "\xc3\xa9"; // U+00E9
+        else
+            mixed += ascii[i];
+    }
+    if (!transcode(ascii, "ASCII") || !transcode(mixed, "mixed"))
+        return false;
+
+    if (!parseList<float>(floats, "Float", ParseFloat, ParseFloatArray) ||
+        !parseList<int>(ints, "Int", ParseInt, ParseIntArray) ||
+        !parseList<uint32_t>(hexes, "Hex", ParseHex, ParseHexArray))
+    {
+        return false;
+    }
+
+#if defined(_WIN32)
+    // The values are BSTRs, as returned by MSXML
+    std::vector<BSTR> bstrs;
+    for (std::wstring const & text : wideFloats)
+    {
+        bstrs.push_back(SysAllocStringLen(text.c_str(), UINT(text.size())));
+    }
+
+    seconds = Time([&] {
+        float sum = 0.f;
+        for (BSTR text : bstrs)
+        {
+            VARIANT source, value;
+            source.vt      = VT_BSTR;
+            source.bstrVal = text;
+            VariantInit(&value);
+            if (SUCCEEDED(VariantChangeType(&value, &source, 0, VT_R4)))
+                sum += value.fltVal;
+        }
+        Consume(sum);
+    });
+    ReportRate("VariantChangeType(VT_R4)", count, seconds);
+
+    seconds = Time([&] {
+        float sum = 0.f;
+        for (BSTR text : bstrs)
+        {
+            float value = 0.f;
+            ParseFloat(std::wstring_view(text, SysStringLen(text)), value);
+            sum += value;
+        }
+        Consume(sum);
+    });
+    ReportRate("ParseFloat (BSTR)", count, seconds);
+
+    for (BSTR text : bstrs)
+    {
+        SysFreeString(text);
+    }
+#endif // defined(_WIN32)
+
+    return true;
+}
+} // namespace Bench
@@ -0,0 +1,140 @@
+#include "Bench.h"
+
+#include <Msxmlx/Msxmlx.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Creates a document whose root has a wide list of children: alternating <a/> and <b/> elements separated by
+// whitespace text nodes.
+HRESULT createDocument(size_t count, IXMLDOMDocument2 ** ppDocument)
+{
+    HRESULT                   hr;
+    CComPtr<IXMLDOMDocument2> pDocument;
+    VARIANT_BOOL              loaded = VARIANT_FALSE;
+
+    if (FAILED(hr = pDocument.CoCreateInstance(L"Msxml2.DOMDocument.6.0")))
+        return hr;
+
+    std::wstring text = L"<root>";
+    for (size_t i = 0; i < count; ++i)
+    {
+        text += (i % 2 == 0) ? L"\n  <a x=\"1\"/>" : L"\n  <b/>";
+    }
+    text += L"\n</root>";
+
+    pDocument->put_preserveWhiteSpace(VARIANT_TRUE);
+    if (FAILED(hr = pDocument->loadXML(CComBSTR(text.c_str()), &loaded)) || loaded != VARIANT_TRUE)
+        return FAILED(hr) ? hr : E_FAIL;
+
+    *ppDocument = pDocument.Detach();
+    return S_OK;
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! The std::function overloads are compared with the template overloads and the ranges on a root element with a
+//! wide list of children.
+//!
+//! @param    count    Number of children
+//!
+//! @return        false, if the enumerations do not agree
+
+bool EnumerationBench(size_t count)
+{
+    static Name const A("a");
+
+    Section("MSXML enumeration (%zu children)", count);
+
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    bool ok = true;
+    {
+        CComPtr<IXMLDOMDocument2> pDocument;
+        CComPtr<IXMLDOMElement>   pRoot;
+        if (FAILED(createDocument(count, &pDocument)) || FAILED(pDocument->get_documentElement(&pRoot)))
+        {
+            printf("MSXML 6 is not available\n");
+            CoUninitialize();
+            return true;
+        }
+
+        size_t expected = count;
+        size_t nodes    = 0;
+        size_t elements = 0;
+        size_t named    = 0;
+        double seconds;
+
+        // The captures are larger than std::function's small-object buffer, as they often are in practice
+        seconds = Time([&] {
+            ForEachElementCB f = [&elements, &nodes, &named, &expected] (IXMLDOMElement *) {
+                ++elements;
+                return nodes + named + expected != 0;
+            };
+            elements = 0;
+            ForEachSubElement(static_cast<IXMLDOMNode *>(pRoot), f);
+        });
+        ReportRate("ForEachSubElement (std::function)", count, seconds);
+        ok = ok && elements == expected;
+
+        seconds = Time([&] {
+            elements = 0;
+            ForEachSubElement(pRoot, [&elements, &nodes, &named, &expected] (IXMLDOMElement *) {
+                ++elements;
+                return nodes + named + expected != 0;
+            });
+        });
+        ReportRate("ForEachSubElement (template)", count, seconds);
+        ok = ok && elements == expected;
+
+        seconds = Time([&] {
+            elements = 0;
+            for (IXMLDOMElement * pElement : ChildElements(pRoot))
+            {
+                elements += pElement != nullptr;
+            }
+        });
+        ReportRate("ChildElements", count, seconds);
+        ok = ok && elements == expected;
+
+        seconds = Time([&] {
+            ElementRange range = ChildElementsNamed(pRoot, A);
+            named = size_t(std::count_if(range.begin(), range.end(), [] (IXMLDOMElement * p) { return p != nullptr; }));
+        });
+        ReportRate("ChildElementsNamed + count_if", count, seconds);
+        ok = ok && named == (expected + 1) / 2;
+
+        seconds = Time([&] {
+            ForEachNodeCB f = [&nodes, &elements, &named, &expected] (IXMLDOMNode *) {
+                ++nodes;
+                return elements + named + expected != 0;
+            };
+            nodes = 0;
+            ForEachSubNode(static_cast<IXMLDOMNode *>(pRoot), f);
+        });
+        ReportRate("ForEachSubNode (std::function)", count, seconds);
+        size_t allNodes = nodes;
+
+        seconds = Time([&] {
+            nodes = 0;
+            ForEachSubNode(pRoot, [&nodes, &elements, &named, &expected] (IXMLDOMNode *) {
+                ++nodes;
+                return elements + named + expected != 0;
+            });
+        });
+        ReportRate("ForEachSubNode (template)", count, seconds);
+        ok = ok && nodes == allNodes;
+
+        if (!ok)
+            printf("The enumerations do not agree\n");
+    }
+    CoUninitialize();
+
+    return ok;
+}
+} // namespace Bench
@@ -0,0 +1,127 @@
+#include "Bench.h"
+
+#include <Msxmlx/Msxmlx.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Creates an empty document with a root element
+HRESULT createDocument(IXMLDOMDocument2 ** ppDocument, IXMLDOMElement ** ppRoot)
+{
+    HRESULT                   hr;
+    CComPtr<IXMLDOMDocument2> pDocument;
+    VARIANT_BOOL              loaded = VARIANT_FALSE;
+
+    if (FAILED(hr = pDocument.CoCreateInstance(L"Msxml2.DOMDocument.6.0")))
+        return hr;
+    if (FAILED(hr = pDocument->loadXML(CComBSTR(L"<root/>"), &loaded)) || loaded != VARIANT_TRUE)
+        return FAILED(hr) ? hr : E_FAIL;
+    if (FAILED(hr = pDocument->get_documentElement(ppRoot)))
+        return hr;
+
+    *ppDocument = pDocument.Detach();
+    return S_OK;
+}
+
+// Returns the number of children of a node
+long countChildren(IXMLDOMNode * pNode)
+{
+    CComPtr<IXMLDOMNodeList> pChildren;
+    long                     length = 0;
+
+    if (SUCCEEDED(pNode->get_childNodes(&pChildren)))
+        pChildren->get_length(&length);
+    return length;
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! Each child is created and appended with CreateTextElement() and appendChild(), and then all of them are created
+//! in a fragment with CreateTextElements(), which is appended once.
+//!
+//! @param    maxCount    Largest number of children. The counts are the powers of 10 from 1000 up to this.
+//!
+//! @return        false, if the two methods do not create the same number of children
+
+bool FragmentBench(size_t maxCount)
+{
+    static Name const VALUE("value");
+
+    Section("MSXML fragments");
+
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    bool ok = true;
+    for (size_t count = 1000; count <= maxCount && ok; count *= 10)
+    {
+        std::vector<std::string>      texts(count);
+        std::vector<TextElementValue> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            texts[i] = std::to_string(i * 7);
+            values.push_back(TextElementValue{ VALUE, texts[i] });
+        }
+
+        int    runs    = (count >= 100000) ? 1 : 5;
+        long   looped  = 0;
+        long   batched = 0;
+        bool   failed  = false;
+        double seconds;
+
+        seconds = Time([&] {
+            CComPtr<IXMLDOMDocument2> pDocument;
+            CComPtr<IXMLDOMElement>   pRoot;
+            if (FAILED(createDocument(&pDocument, &pRoot)))
+            {
+                failed = true;
+                return;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                CComPtr<IXMLDOMElement> pElement;
+                CComVariant             value(CComBSTR(texts[i].c_str()));
+                if (SUCCEEDED(CreateTextElement(pDocument, VALUE, value, &pElement)))
+                    pRoot->appendChild(pElement, NULL);
+            }
+            looped = countChildren(pRoot);
+        }, runs);
+        if (failed)
+        {
+            printf("MSXML 6 is not available\n");
+            break;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "CreateTextElement (%zu)", count);
+        ReportRate(name, count, seconds);
+
+        seconds = Time([&] {
+            CComPtr<IXMLDOMDocument2>        pDocument;
+            CComPtr<IXMLDOMElement>          pRoot;
+            CComPtr<IXMLDOMDocumentFragment> pFragment;
+            if (FAILED(createDocument(&pDocument, &pRoot)))
+                return;
+            if (SUCCEEDED(CreateTextElements(pDocument, values, &pFragment)))
+                pRoot->appendChild(pFragment, NULL);
+            batched = countChildren(pRoot);
+        }, runs);
+        snprintf(name, sizeof(name), "CreateTextElements (%zu)", count);
+        ReportRate(name, count, seconds);
+
+        if (looped != long(count) || batched != long(count))
+        {
+            printf("The fragment has %ld children instead of %zu\n", batched, count);
+            ok = false;
+        }
+    }
+    CoUninitialize();
+
+    return ok;
+}
+} // namespace Bench
@@ -0,0 +1,106 @@
+#include "Bench.h"
+
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/Loader.h>
+#include <Msxmlx/MappedFile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Loads the files with LoadAll(), returning the total number of elements, or 0 if a file could not be loaded
+size_t loadAll(std::vector<std::string> const & paths, bool bAsyncIo)
+{
+    LoadOptions options;
+    options.asyncIo = bAsyncIo;
+
+    std::atomic<size_t> elements{ 0 };
+    std::atomic<bool>   failed{ false };
+    LoadAll(paths, [&] (LoadResult & result) {
+        if (result.error != nullptr)
+            failed = true;
+        elements += result.document.Size();
+    }, options);
+    return failed ? 0 : elements.load();
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! Many small files are written and then loaded one at a time, and with LoadAll() using each way of reading them.
+//! The files are in the file system cache, so the benchmark measures the overlap of the system calls and parsing
+//! rather than the latency of the device.
+//!
+//! @param    size    Total size of the files
+//!
+//! @return        false, if the files could not be written or the loaders do not agree
+
+bool LoaderBench(size_t size)
+{
+    static size_t constexpr FILE_SIZE = 2048;
+
+    Section("Loading many files");
+
+    std::vector<std::string> paths;
+    size_t                   bytes = 0;
+    for (size_t i = 0; i < std::max<size_t>(size / FILE_SIZE, 1); ++i)
+    {
+        std::string text = GenerateDocument(FILE_SIZE);
+        paths.push_back("msxmlx_bench." + std::to_string(i) + ".xml");
+        FILE * pFile = fopen(paths.back().c_str(), "wb");
+        bool   ok    = pFile != nullptr && fwrite(text.data(), 1, text.size(), pFile) == text.size();
+        if (pFile != nullptr)
+            fclose(pFile);
+        if (!ok)
+        {
+            printf("The file %s could not be written\n", paths.back().c_str());
+            for (std::string const & path : paths)
+                remove(path.c_str());
+            return false;
+        }
+        bytes += text.size();
+    }
+    printf("%zu files, %zu bytes\n", paths.size(), bytes);
+
+    size_t expected = 0;
+    double seconds  = Time([&] {
+        expected = 0;
+        for (std::string const & path : paths)
+        {
+            MappedFile      file(path.c_str());
+            CompactDocument document;
+            document.Parse(file.View());
+            expected += document.Size();
+        }
+    });
+    ReportThroughput("serial", bytes, seconds);
+
+    bool   ok       = true;
+    size_t elements = 0;
+    seconds = Time([&] { elements = loadAll(paths, true); });
+    ReportThroughput("LoadAll (io_uring)", bytes, seconds);
+    if (elements != expected)
+    {
+        printf("LoadAll (io_uring) does not match\n");
+        ok = false;
+    }
+
+    seconds = Time([&] { elements = loadAll(paths, false); });
+    ReportThroughput("LoadAll (threads)", bytes, seconds);
+    if (elements != expected)
+    {
+        printf("LoadAll (threads) does not match\n");
+        ok = false;
+    }
+
+    for (std::string const & path : paths)
+        remove(path.c_str());
+    return ok;
+}
+} // namespace Bench
@@ -0,0 +1,95 @@
+#include "Bench.h"
+
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/Parallel.h>
+#include <Msxmlx/ThreadPool.h>
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+
+using namespace Msxmlx;
+
+namespace
+{
+// The work done for each entity: reads its attributes and those of its position
+double load(CompactDocument const & document, CompactDocument::Index entity)
+{
+    CompactDocument::Index position = document.GetSubElement(entity, "position");
+    return document.GetIntAttribute(entity, "id") + document.GetHexAttribute(entity, "flags") % 7 +
+           document.GetFloatAttribute(position, "x") + document.GetFloatAttribute(position, "y") +
+           document.GetFloatAttribute(position, "z") + document.GetIntSubElement(entity, "health");
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! @param    size    Size of the synthetic document
+//!
+//! @return        false, if a parallel result does not match the serial result
+
+bool ParallelBench(size_t size)
+{
+    Section("Parallel algorithms");
+
+    CompactDocument document;
+    if (!document.Parse(GenerateDocument(size)))
+    {
+        printf("The synthetic document could not be parsed: %s\n", document.ErrorMessage());
+        return false;
+    }
+
+    CompactDocument::Index root  = document.Root();
+    size_t                 count = 0;
+    document.ForEachSubElement(root, [&count] (CompactDocument::Index) {
+        ++count;
+        return true;
+    });
+
+    double expected = 0.0;
+    double seconds  = Time([&] {
+        expected = 0.0;
+        document.ForEachSubElement(root, [&] (CompactDocument::Index entity) {
+            expected += load(document, entity);
+            return true;
+        });
+    });
+    ReportRate("serial entities", count, seconds);
+
+    size_t      hardware       = std::thread::hardware_concurrency();
+    size_t      threadCounts[] = { 1, 2, 4, hardware > 4 ? hardware : 0 };
+    std::string name;
+    for (size_t threads : threadCounts)
+    {
+        if (threads == 0)
+            continue;
+
+        ThreadPool pool(threads);
+        double     result = 0.0;
+        seconds = Time([&] {
+            result = TransformReduceSubElements(document, root, 0.0, std::plus<>(),
+                                                [&] (CompactDocument::Index entity) { return load(document, entity); },
+                                                64, pool);
+        });
+        name = "TransformReduceSubElements " + std::to_string(threads) + " threads";
+        ReportRate(name.c_str(), count, seconds);
+
+        // Blocks are summed in a different order from the serial loop, so allow for rounding
+        if (result < expected * (1.0 - 1e-9) || result > expected * (1.0 + 1e-9))
+        {
+            printf("The parallel sum (%f) does not match the serial sum (%f)\n", result, expected);
+            return false;
+        }
+
+        size_t descendants = TransformReduceDescendants(document, root, size_t(0), std::plus<>(),
+                                                        [] (CompactDocument::Index) { return size_t(1); }, 256, pool);
+        if (descendants != document.Size() - 1)
+        {
+            printf("The parallel count of descendants (%zu) is not %zu\n", descendants, document.Size() - 1);
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace Bench
@@ -0,0 +1,247 @@
+#include "Bench.h"
+
+#include <Msxmlx/Elements.h>
+#include <Msxmlx/PushParser.h>
+#include <Msxmlx/Reader.h>
+#include <Msxmlx/Scan.h>
+#include <Msxmlx/StreamMatcher.h>
+#include <Msxmlx/StreamReader.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace Msxmlx;
+
+namespace
+{
+Scan::Isa const ISAS[]      = { Scan::Isa::Scalar, Scan::Isa::Sse2, Scan::Isa::Avx2 };
+char const *    ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+
+// Counts the tokens in a document
+size_t tokenize(std::string const & document)
+{
+    Reader reader(document);
+    size_t count = 0;
+    for (Reader::Token t = reader.Next(); t != Reader::Token::End && t != Reader::Token::Error; t = reader.Next())
+    {
+        ++count;
+    }
+    return count;
+}
+
+// Counts the tokens in a document read through the window of a stream reader
+size_t tokenizeStream(std::string const & document)
+{
+    size_t       offset = 0;
+    StreamReader reader([&] (char * pBuffer, size_t size) {
+        size = std::min(size, document.size() - offset);
+        memcpy(pBuffer, document.data() + offset, size);
+        offset += size;
+        return ptrdiff_t(size);
+    });
+
+    size_t count = 0;
+    for (Reader::Token t = reader.Next(); t != Reader::Token::End && t != Reader::Token::Error; t = reader.Next())
+    {
+        ++count;
+    }
+    return count;
+}
+
+// Counts the tokens in a document given to a push parser in pieces
+size_t tokenizePush(std::string const & document, size_t pieceSize)
+{
+    struct Counter : SaxHandler
+    {
+        size_t count = 0;
+        bool StartElement(StreamReader &) override { return ++count != 0; }
+        bool EndElement(StreamReader &) override { return ++count != 0; }
+        bool Text(StreamReader &) override { return ++count != 0; }
+    } counter;
+
+    PushParser parser(counter);
+    for (size_t offset = 0; offset < document.size(); offset += pieceSize)
+    {
+        parser.Feed(document.data() + offset, std::min(pieceSize, document.size() - offset));
+    }
+    parser.Finish();
+    return counter.count;
+}
+
+// Paths of the values in a synthetic document
+char const * const PATHS[] = {
+    "world/@name",
+    "world/entity/@id",
+    "world/entity/@type",
+    "world/entity/@flags",
+    "world/entity/@visible",
+    "world/entity/position/@x",
+    "world//position/@y",
+    "world//position/@z",
+    "world/entity/name",
+    "world/entity/health",
+    "world/*/description",
+    "//health",
+};
+
+// Matches a number of paths in a document in one pass, and returns the number of matches. Paths beyond the real ones
+// name elements that are not in the document.
+size_t match(std::string const & document, size_t count)
+{
+    StreamMatcher matcher;
+    size_t        matches = 0;
+    char          path[64];
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i < sizeof(PATHS) / sizeof(PATHS[0]))
+            snprintf(path, sizeof(path), "%s", PATHS[i]);
+        else
+            snprintf(path, sizeof(path), "world/entity/missing%zu", i);
+        matcher.Add(path, [&matches] (std::string_view) {
+            ++matches;
+            return true;
+        });
+    }
+
+    StreamReader reader{ std::string_view(document) };
+    matcher.Run(reader);
+    return matches;
+}
+
+#if defined(__cpp_impl_coroutine)
+// Counts the entities in a document with the Elements() generator
+size_t countEntities(std::string const & document)
+{
+    StreamReader reader{ std::string_view(document) };
+    size_t       count = 0;
+    for (ElementView entity : Elements(reader, "world/entity"))
+    {
+        count += (entity.attributes.GetIntAttribute("id", -1) >= 0) ? 1 : 0;
+    }
+    return count;
+}
+#endif
+} // anonymous namespace
+
+namespace Bench
+{
+//! The kernels are checked against each other by the tests (see test/ScanTest.cpp).
+//!
+//! @param    size    Size of the synthetic document used to measure throughput
+//!
+//! @return        false, if the readers do not return the same tokens
+
+bool ScanBench(size_t size)
+{
+    Section("Scanning kernels (best supported: %s)", ISA_NAMES[int(Scan::Supported())]);
+
+    std::string  document = GenerateDocument(size);
+    char const * begin    = document.data();
+    char const * end      = begin + document.size();
+    std::string  name;
+
+    for (Scan::Isa isa : ISAS)
+    {
+        if (int(isa) > int(Scan::Supported()))
+            continue;
+
+        Scan::Kernels const & kernels = Scan::GetKernels(isa);
+        char const *          isaName = ISA_NAMES[int(isa)];
+        double                seconds;
+
+        seconds = Time([&] {
+            size_t count = 0;
+            for (char const * p = kernels.findChar(begin, end, '<'); p < end; p = kernels.findChar(p + 1, end, '<'))
+            {
+                ++count;
+            }
+            Consume(count);
+        });
+        name = std::string("findChar('<') ") + isaName;
+        ReportThroughput(name.c_str(), document.size(), seconds);
+
+        seconds = Time([&] {
+            size_t count = 0;
+            for (char const * p = kernels.findEither(begin, end, '"', '&'); p < end;
+                 p = kernels.findEither(p + 1, end, '"', '&'))
+            {
+                ++count;
+            }
+            Consume(count);
+        });
+        name = std::string("findEither('\"', '&') ") + isaName;
+        ReportThroughput(name.c_str(), document.size(), seconds);
+
+        seconds = Time([&] {
+            size_t count = 0;
+            for (char const * p = kernels.findNameEnd(begin, end); p < end; p = kernels.findNameEnd(p + 1, end))
+            {
+                ++count;
+            }
+            Consume(count);
+        });
+        name = std::string("findNameEnd ") + isaName;
+        ReportThroughput(name.c_str(), document.size(), seconds);
+
+        seconds = Time([&] {
+            size_t count = 0;
+            for (char const * p = kernels.findEscape(begin, end); p < end; p = kernels.findEscape(p + 1, end))
+            {
+                ++count;
+            }
+            Consume(count);
+        });
+        name = std::string("findEscape ") + isaName;
+        ReportThroughput(name.c_str(), document.size(), seconds);
+
+        Scan::Select(isa);
+        seconds = Time([&] { Consume(tokenize(document)); });
+        name = std::string("Reader tokenize ") + isaName;
+        ReportThroughput(name.c_str(), document.size(), seconds);
+    }
+    Scan::Select(Scan::Supported());
+
+    if (tokenizeStream(document) != tokenize(document))
+    {
+        printf("StreamReader does not return the same tokens as Reader\n");
+        return false;
+    }
+    double seconds = Time([&] { Consume(tokenizeStream(document)); });
+    ReportThroughput("StreamReader tokenize", document.size(), seconds);
+
+    for (size_t pieceSize : { size_t(1500), size_t(64 * 1024) })
+    {
+        seconds = Time([&] { Consume(tokenizePush(document, pieceSize)); });
+        name    = "PushParser " + std::to_string(pieceSize) + " byte pieces";
+        ReportThroughput(name.c_str(), document.size(), seconds);
+    }
+
+    for (size_t count : { size_t(1), size_t(12), size_t(200) })
+    {
+        seconds = Time([&] { Consume(match(document, count)); });
+        name    = "StreamMatcher " + std::to_string(count) + " paths";
+        ReportThroughput(name.c_str(), document.size(), seconds);
+    }
+
+#if defined(__cpp_impl_coroutine)
+    Reader root(document);
+    size_t entities = 0;
+    root.Next();
+    root.ForEachSubElement([&entities] (Reader &) {
+        ++entities;
+        return true;
+    });
+    if (countEntities(document) != entities)
+    {
+        printf("Elements() does not find every entity\n");
+        return false;
+    }
+    seconds = Time([&] { Consume(countEntities(document)); });
+    ReportThroughput("Elements(\"world/entity\")", document.size(), seconds);
+#endif
+
+    return true;
+}
+} // namespace Bench
@@ -0,0 +1,114 @@
+#include "Bench.h"
+
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/LazyDocument.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Sums some values of the first entities (all of them by default), to check that two documents agree
+template <typename Document>
+double query(Document const & document, size_t limit = SIZE_MAX)
+{
+    double sum = 0.0;
+    size_t count = 0;
+    document.ForEachSubElement(document.Root(), [&] (typename Document::Index entity) {
+        sum += document.GetIntAttribute(entity, "id");
+        sum += document.GetFloatAttribute(document.GetSubElement(entity, "position"), "x");
+        sum += document.GetIntSubElement(entity, "health");
+        sum += double(document.GetStringSubElement(entity, "name").size());
+        return ++count < limit;
+    });
+    return sum;
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! Parsing a document is compared with loading a snapshot of it, from memory and from a file, followed by the same
+//! queries, and loading a snapshot with its contents checked is compared with loading it without the check. Parsing
+//! it lazily is compared too, both alone and followed by queries of a few of its elements.
+//!
+//! @param    size    Size of the document
+//!
+//! @return        false, if the queries of the loaded snapshots do not match those of the parsed document
+
+bool SnapshotBench(size_t size)
+{
+    static char const PATH[] = "msxmlx_bench.snapshot";
+
+    Section("Snapshots");
+
+    std::string     text = GenerateDocument(size);
+    CompactDocument document;
+    double          seconds = Time([&] { Consume(size_t(document.Parse(text))); });
+    ReportThroughput("CompactDocument::Parse", text.size(), seconds);
+
+    std::string           image = document.Snapshot();
+    std::vector<uint32_t> aligned((image.size() + 3) / 4);
+    memcpy(aligned.data(), image.data(), image.size());
+    printf("Text %zu bytes, snapshot %zu bytes\n", text.size(), image.size());
+
+    double expected = query(document);
+    bool   ok       = true;
+
+    CompactDocument loaded;
+    seconds = Time([&] { Consume(size_t(loaded.LoadSnapshot(aligned.data(), image.size()))); });
+    ReportTime("LoadSnapshot (memory)", seconds);
+    if (query(loaded) != expected)
+    {
+        printf("The snapshot loaded from memory does not match\n");
+        ok = false;
+    }
+    seconds = Time([&] { Consume(size_t(loaded.LoadTrustedSnapshot(aligned.data(), image.size()))); });
+    ReportTime("LoadTrustedSnapshot (memory)", seconds);
+
+    if (!document.SaveSnapshot(PATH))
+    {
+        printf("The snapshot could not be saved\n");
+        return false;
+    }
+    seconds = Time([&] { Consume(size_t(loaded.LoadSnapshot(PATH))); });
+    ReportTime("LoadSnapshot (file)", seconds);
+    if (query(loaded) != expected)
+    {
+        printf("The snapshot loaded from a file does not match\n");
+        ok = false;
+    }
+    loaded = CompactDocument();
+    remove(PATH);
+
+    LazyDocument lazy;
+    seconds = Time([&] { Consume(size_t(lazy.Parse(text))); });
+    ReportThroughput("LazyDocument::Parse", text.size(), seconds);
+    printf("Compact document %zu bytes, lazy document tape %zu bytes\n", document.Capacity(), lazy.Capacity());
+    if (query(lazy) != expected)
+    {
+        printf("The lazy document does not match\n");
+        ok = false;
+    }
+
+    // Most of the document is not touched, so the lazy document only pays for the pass over the text
+    seconds = Time([&] {
+        CompactDocument parsed;
+        parsed.Parse(text);
+        Consume(query(parsed, 16));
+    });
+    ReportTime("CompactDocument::Parse + 16 queries", seconds);
+    seconds = Time([&] {
+        LazyDocument parsed;
+        parsed.Parse(text);
+        Consume(query(parsed, 16));
+    });
+    ReportTime("LazyDocument::Parse + 16 queries", seconds);
+
+    return ok;
+}
+} // namespace Bench
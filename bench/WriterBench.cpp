@@ -0,0 +1,99 @@
+#include "Bench.h"
+
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/Writer.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Writes a document of records with the writer
+size_t writeRecords(Writer & writer, size_t count)
+{
+    writer.StartElement("world");
+    for (size_t i = 0; i < count; ++i)
+    {
+        writer.StartElement("entity");
+        writer.IntAttribute("id", int(i));
+        writer.HexAttribute("flags", uint32_t(i) * 2654435761u);
+        writer.StartElement("position");
+        writer.FloatAttribute("x", float(i) + 0.25f);
+        writer.FloatAttribute("y", float(i) * 2.f + 0.5f);
+        writer.FloatAttribute("z", -float(i) * 3.f - 0.75f);
+        writer.EndElement();
+        writer.StringElement("name", "Entity & friends");
+        writer.IntElement("health", int(i % 1000));
+        writer.EndElement();
+    }
+    writer.Finish();
+    return writer.Data().size();
+}
+
+// Writes the same document with snprintf, for comparison
+size_t printRecords(std::string & document, size_t count)
+{
+    char buffer[512];
+    document = "<world>";
+    for (size_t i = 0; i < count; ++i)
+    {
+        snprintf(buffer, sizeof(buffer),
+                 "<entity id=\"%d\" flags=\"0x%08x\"><position x=\"%g\" y=\"%g\" z=\"%g\"/>"
+                 "<name>Entity &amp; friends</name><health>%d</health></entity>",
+                 int(i), uint32_t(i) * 2654435761u, float(i) + 0.25f, float(i) * 2.f + 0.5f, -float(i) * 3.f - 0.75f,
+                 int(i % 1000));
+        document += buffer;
+    }
+    document += "</world>";
+    return document.size();
+}
+} // anonymous namespace
+
+namespace Bench
+{
+//! @param    count    Number of records to write
+//!
+//! @return        false, if the output of the writer cannot be read back
+
+bool WriterBench(size_t count)
+{
+    Section("Writer");
+
+    {
+        Writer writer;
+        writeRecords(writer, count);
+
+        CompactDocument document;
+        if (!document.Parse(writer.Data()) || document.Size() != 1 + count * 4)
+        {
+            printf("The output of the writer could not be read back\n");
+            return false;
+        }
+        CompactDocument::Index last = document.Size() - 4;
+        if (document.GetIntAttribute(last, "id", -1) != int(count - 1) ||
+            document.GetFloatAttribute(document.GetSubElement(last, "position"), "x") != float(count - 1) + 0.25f ||
+            document.GetStringSubElement(last, "name") != "Entity & friends")
+        {
+            printf("The values written by the writer do not match\n");
+            return false;
+        }
+    }
+
+    size_t size    = 0;
+    double seconds = Time([&] {
+        Writer writer;
+        size = writeRecords(writer, count);
+    });
+    ReportRate("Writer records", count, seconds);
+    ReportThroughput("Writer", size, seconds);
+
+    std::string document;
+    seconds = Time([&] { size = printRecords(document, count); });
+    ReportRate("snprintf records", count, seconds);
+    ReportThroughput("snprintf", size, seconds);
+
+    return true;
+}
+} // namespace Bench
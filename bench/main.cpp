@@ -0,0 +1,119 @@
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+char const USAGE[] =
+    "Usage: msxmlx_bench [size] [options]\n"
+    "  size                   Size of the synthetic documents in bytes (default 64 MB)\n"
+    "  --json <file>          Writes the results to a file as JSON\n"
+    "  --label <text>         Describes the build in the JSON results\n"
+    "  --width <n>            Sub-elements of each element in the accessor benchmarks (default 4)\n"
+    "  --depth <n>            Levels of each tree in the accessor benchmarks (default 3)\n"
+    "  --attributes <n>       Attributes of each element in the accessor benchmarks (default 4)\n"
+    "  --values <type>        Type of the values in the accessor benchmarks: string, int, float, hex, bool or mixed\n"
+    "                         (default mixed)\n";
+
+// Parses a non-negative count, returning false if it is not valid
+bool parseCount(char const * text, int & value)
+{
+    char * end;
+    long   parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0 || parsed > 1000)
+        return false;
+    value = int(parsed);
+    return true;
+}
+} // anonymous namespace
+
+int main(int argc, char ** argv)
+{
+    size_t       size  = size_t(64) << 20;
+    char const * json  = nullptr;
+    char const * label = "";
+    Bench::Shape shape;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        char const * option = argv[i];
+        char const * value  = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool         valid  = true;
+        if (option[0] != '-')
+        {
+            size = size_t(strtoull(option, nullptr, 10));
+            continue;
+        }
+        if (value == nullptr)
+            valid = false;
+        else if (strcmp(option, "--json") == 0)
+            json = value;
+        else if (strcmp(option, "--label") == 0)
+            label = value;
+        else if (strcmp(option, "--width") == 0)
+            valid = parseCount(value, shape.width) && shape.width > 0;
+        else if (strcmp(option, "--depth") == 0)
+            valid = parseCount(value, shape.depth) && shape.depth <= 32;
+        else if (strcmp(option, "--attributes") == 0)
+            valid = parseCount(value, shape.attributes);
+        else if (strcmp(option, "--values") == 0)
+        {
+            int type = 0;
+            while (Bench::ValueTypeName(Bench::ValueType(type)) != nullptr &&
+                   strcmp(Bench::ValueTypeName(Bench::ValueType(type)), value) != 0)
+            {
+                ++type;
+            }
+            shape.values = Bench::ValueType(type);
+            valid        = Bench::ValueTypeName(shape.values) != nullptr;
+        }
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            fputs(USAGE, stderr);
+            return EXIT_FAILURE;
+        }
+        ++i;
+    }
+
+    // Each tree of the accessor benchmarks is generated in full, so it must not be too large
+    double treeSize = 1.0;
+    for (int level = 0; level < shape.depth; ++level)
+        treeSize = treeSize * shape.width + 1.0;
+    if (treeSize > 1e6)
+    {
+        fprintf(stderr, "The trees of width %d and depth %d are too large\n", shape.width, shape.depth);
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    ok = Bench::ScanBench(size) && ok;
+    ok = Bench::ConvertBench(size / 64) && ok;
+    ok = Bench::ParallelBench(size / 4) && ok;
+    ok = Bench::WriterBench(size / 256) && ok;
+    ok = Bench::SnapshotBench(size / 4) && ok;
+    ok = Bench::AccessorBench(shape, size / 4) && ok;
+    ok = Bench::LoaderBench(size / 16) && ok;
+#if defined(_WIN32)
+    ok = Bench::EnumerationBench(size / 256) && ok;
+    ok = Bench::FragmentBench(size / 64) && ok;
+#endif
+
+    if (json != nullptr)
+    {
+        FILE * pFile = fopen(json, "w");
+        if (pFile == nullptr || !Bench::WriteJson(pFile, label, size))
+        {
+            printf("The results could not be written to %s\n", json);
+            ok = false;
+        }
+        if (pFile != nullptr)
+            fclose(pFile);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
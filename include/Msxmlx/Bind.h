@@ -0,0 +1,525 @@
+#pragma once
+
+#if !defined(MSXMLX_BIND_H)
+#define MSXMLX_BIND_H
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "CompactDocument.h"
+#include "Convert.h"
+#include "Name.h"
+#include "Reader.h"
+
+//! Schema-bound extraction of attributes and sub-elements into structs.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*													F I E L D S														*/
+/********************************************************************************************************************/
+
+//! The kind of a field.
+enum class FieldKind
+{
+    Attribute,  //!< The value of an attribute
+    SubElement, //!< The text of a sub-element
+    Nested      //!< A sub-element deserialized into a struct with its own Schema
+};
+
+//! Describes how the value of an attribute or sub-element is stored in an object. See Field() and SubElement().
+struct FieldDescriptor
+{
+    std::string_view name;                                  //!< Name of the attribute or sub-element
+    uint32_t hash;                                          //!< Name::Hash() of the name
+    FieldKind kind;                                         //!< Kind of field
+    bool (*set)(void * pObject, std::string_view text);     //!< Converts text and stores it in the object
+    bool (*setWide)(void * pObject, std::wstring_view text); //!< Converts wide text and stores it in the object
+    void * (*target)(void * pObject);                       //!< Returns the nested struct to fill (Nested only)
+    FieldDescriptor const * pFields;                        //!< Fields of the nested struct (Nested only)
+    size_t attributeCount;                                  //!< Number of attribute fields of the nested struct
+    size_t count;                                           //!< Number of fields of the nested struct
+    bool (*get)(void const * pObject, size_t index, std::string & text); //!< Formats an occurrence of the value
+};
+
+//! A field descriptor for a member of T.
+template <typename T>
+struct BoundField
+{
+    FieldDescriptor descriptor;
+};
+
+//! The binding used by Bind() and Deserialize() for T. Specialize it with a static constexpr member FIELDS (see
+//! Binding).
+template <typename T>
+struct Schema
+{
+};
+
+//! Returns the descriptor in a table with the name, or nullptr if there is none.
+FieldDescriptor const * FindField(FieldDescriptor const * pFields, size_t count, std::string_view name);
+
+//! Returns the descriptor in a table with the wide name, or nullptr if there is none.
+FieldDescriptor const * FindField(FieldDescriptor const * pFields, size_t count, wchar_t const * name, size_t length);
+
+namespace Detail
+{
+template <typename M>
+struct MemberTraits;
+
+template <typename C, typename V>
+struct MemberTraits<V C::*>
+{
+    using Class = C;
+    using Value = V;
+};
+
+// The type of a single occurrence of a member's value
+template <typename V>
+struct Unwrapped
+{
+    using Type = V;
+};
+
+template <typename V>
+struct Unwrapped<std::optional<V>>
+{
+    using Type = V;
+};
+
+template <typename V>
+struct Unwrapped<std::vector<V>>
+{
+    using Type = V;
+};
+
+template <typename V, typename = void>
+struct HasSchema : std::false_type
+{
+};
+
+template <typename V>
+struct HasSchema<V, std::void_t<decltype(Schema<V>::FIELDS)>> : std::true_type
+{
+};
+
+inline bool parseField(std::string_view text, float & value) { return ParseFloat(text, value); }
+inline bool parseField(std::string_view text, int & value) { return ParseInt(text, value); }
+inline bool parseField(std::string_view text, bool & value) { return ParseBool(text, value); }
+inline bool parseField(std::string_view text, std::string & value) { value.assign(text); return true; }
+inline bool parseField(std::wstring_view text, float & value) { return ParseFloat(text, value); }
+inline bool parseField(std::wstring_view text, int & value) { return ParseInt(text, value); }
+inline bool parseField(std::wstring_view text, bool & value) { return ParseBool(text, value); }
+inline bool parseField(std::wstring_view text, std::string & value) { return ToUtf8(text, value); }
+
+// An optional value is set only if the text is valid
+template <typename Text, typename V>
+bool parseField(Text text, std::optional<V> & value)
+{
+    V parsed{};
+    if (!parseField(text, parsed))
+        return false;
+    value = std::move(parsed);
+    return true;
+}
+
+// A repeated value is appended only if the text is valid
+template <typename Text, typename V>
+bool parseField(Text text, std::vector<V> & value)
+{
+    V parsed{};
+    if (!parseField(text, parsed))
+        return false;
+    value.push_back(std::move(parsed));
+    return true;
+}
+
+template <typename Text>
+bool parseHexField(Text text, uint32_t & value) { return ParseHex(text, value); }
+
+template <typename Text>
+bool parseHexField(Text text, std::optional<uint32_t> & value)
+{
+    uint32_t parsed;
+    if (!ParseHex(text, parsed))
+        return false;
+    value = parsed;
+    return true;
+}
+
+template <typename Text>
+bool parseHexField(Text text, std::vector<uint32_t> & value)
+{
+    uint32_t parsed;
+    if (!ParseHex(text, parsed))
+        return false;
+    value.push_back(parsed);
+    return true;
+}
+
+template <auto MEMBER, typename Text>
+bool setField(void * pObject, Text text)
+{
+    using Class = typename MemberTraits<decltype(MEMBER)>::Class;
+    return parseField(text, static_cast<Class *>(pObject)->*MEMBER);
+}
+
+template <auto MEMBER, typename Text>
+bool setHexField(void * pObject, Text text)
+{
+    using Class = typename MemberTraits<decltype(MEMBER)>::Class;
+    return parseHexField(text, static_cast<Class *>(pObject)->*MEMBER);
+}
+
+inline void formatField(float value, std::string & text)
+{
+    char buffer[32];
+    text.assign(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+inline void formatField(int value, std::string & text)
+{
+    char buffer[16];
+    text.assign(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+inline void formatField(bool value, std::string & text) { text = value ? "true" : "false"; }
+inline void formatField(std::string const & value, std::string & text) { text = value; }
+
+// Formats a hexadecimal value as 0x followed by 8 digits, as written by Writer
+inline void formatHexField(uint32_t value, std::string & text)
+{
+    static char const DIGITS[] = "0123456789abcdef";
+
+    text.assign("0x00000000");
+    for (int i = 0; i < 8; ++i)
+    {
+        text[2 + i] = DIGITS[(value >> (28 - 4 * i)) & 0xf];
+    }
+}
+
+// Returns an occurrence of a value, or nullptr if there is no such occurrence
+template <typename V>
+V const * occurrence(V const & value, size_t index) { return (index == 0) ? &value : nullptr; }
+
+template <typename V>
+V const * occurrence(std::optional<V> const & value, size_t index)
+{
+    return (index == 0 && value) ? &*value : nullptr;
+}
+
+template <typename V>
+V const * occurrence(std::vector<V> const & value, size_t index)
+{
+    return (index < value.size()) ? &value[index] : nullptr;
+}
+
+template <auto MEMBER>
+bool getField(void const * pObject, size_t index, std::string & text)
+{
+    using Class = typename MemberTraits<decltype(MEMBER)>::Class;
+    auto const * pValue = occurrence(static_cast<Class const *>(pObject)->*MEMBER, index);
+    if (pValue)
+        formatField(*pValue, text);
+    return pValue != nullptr;
+}
+
+template <auto MEMBER>
+bool getHexField(void const * pObject, size_t index, std::string & text)
+{
+    using Class = typename MemberTraits<decltype(MEMBER)>::Class;
+    auto const * pValue = occurrence(static_cast<Class const *>(pObject)->*MEMBER, index);
+    if (pValue)
+        formatHexField(*pValue, text);
+    return pValue != nullptr;
+}
+
+// Returns the storage for the next occurrence of a nested struct
+template <typename V>
+V * emplace(V & value) { return &value; }
+
+template <typename V>
+V * emplace(std::optional<V> & value) { return &value.emplace(); }
+
+template <typename V>
+V * emplace(std::vector<V> & value) { return &value.emplace_back(); }
+
+template <auto MEMBER>
+void * target(void * pObject)
+{
+    using Class = typename MemberTraits<decltype(MEMBER)>::Class;
+    return emplace(static_cast<Class *>(pObject)->*MEMBER);
+}
+} // namespace Detail
+
+//! Returns a descriptor binding an attribute to a member.
+//!
+//! The member may be a float, int, bool or std::string, or a std::optional of one of them, which is set only if the
+//! attribute is present and valid.
+template <auto MEMBER>
+constexpr BoundField<typename Detail::MemberTraits<decltype(MEMBER)>::Class> Field(std::string_view name)
+{
+    return { { name, Name::Hash(name), FieldKind::Attribute, Detail::setField<MEMBER, std::string_view>,
+               Detail::setField<MEMBER, std::wstring_view>, nullptr, nullptr, 0, 0, Detail::getField<MEMBER> } };
+}
+
+//! Returns a descriptor binding a hexadecimal attribute (as GetHexAttribute()) to a uint32_t member.
+template <auto MEMBER>
+constexpr BoundField<typename Detail::MemberTraits<decltype(MEMBER)>::Class> HexField(std::string_view name)
+{
+    return { { name, Name::Hash(name), FieldKind::Attribute, Detail::setHexField<MEMBER, std::string_view>,
+               Detail::setHexField<MEMBER, std::wstring_view>, nullptr, nullptr, 0, 0, Detail::getHexField<MEMBER> } };
+}
+
+//! Returns a descriptor binding a sub-element to a member.
+//!
+//! If the member's type has a Schema, the sub-element is deserialized into it. Otherwise the member is set from the
+//! text of the sub-element, as with Field(). A std::optional member is set if the sub-element is present, and each
+//! occurrence of a repeated sub-element is appended to a std::vector member.
+template <auto MEMBER>
+constexpr BoundField<typename Detail::MemberTraits<decltype(MEMBER)>::Class> SubElement(std::string_view name)
+{
+    using Value = typename Detail::Unwrapped<typename Detail::MemberTraits<decltype(MEMBER)>::Value>::Type;
+
+    if constexpr (Detail::HasSchema<Value>::value)
+    {
+        auto const & nested = Schema<Value>::FIELDS;
+        return { { name, Name::Hash(name), FieldKind::Nested, nullptr, nullptr, Detail::target<MEMBER>,
+                   nested.Data(), nested.AttributeCount(), nested.Size(), nullptr } };
+    }
+    else
+    {
+        return { { name, Name::Hash(name), FieldKind::SubElement, Detail::setField<MEMBER, std::string_view>,
+                   Detail::setField<MEMBER, std::wstring_view>, nullptr, nullptr, 0, 0, Detail::getField<MEMBER> } };
+    }
+}
+
+//! Returns a descriptor binding a hexadecimal sub-element (as GetHexSubElement()) to a uint32_t member.
+template <auto MEMBER>
+constexpr BoundField<typename Detail::MemberTraits<decltype(MEMBER)>::Class> HexSubElement(std::string_view name)
+{
+    return { { name, Name::Hash(name), FieldKind::SubElement, Detail::setHexField<MEMBER, std::string_view>,
+               Detail::setHexField<MEMBER, std::wstring_view>, nullptr, nullptr, 0, 0, Detail::getHexField<MEMBER> } };
+}
+
+/********************************************************************************************************************/
+/*													B I N D I N G													*/
+/********************************************************************************************************************/
+
+//! The fields of T that are bound to attributes and sub-elements.
+//!
+//! A binding is built at compile time by MakeBinding(). The attribute fields are sorted by the hashes of their names,
+//! followed by the sub-element fields, also sorted by hash. Binding an element walks its attributes (and
+//! deserializing an element walks its children) once, finding the field for each with a binary search of the hashes
+//! instead of looking up each field separately. Attributes and sub-elements without a field are ignored, and fields
+//! without an attribute or sub-element are not changed, so the initial values of the object serve as the defaults.
+//! The fields are also kept in the order in which they are declared, which is the order in which they are written.
+//!
+//! A binding is normally declared by specializing Schema, which lets Bind() and Deserialize() find it. A sub-element
+//! whose type has a Schema is deserialized recursively:
+//!
+//! @code
+//!     struct Light { std::string name; float intensity = 1.f; uint32_t color = 0xffffffff; bool shadows = false; };
+//!     struct Room  { std::string name; std::optional<float> height; std::vector<Light> lights; };
+//!
+//!     template <>
+//!     struct Msxmlx::Schema<Light>
+//!     {
+//!         static constexpr auto FIELDS = Msxmlx::MakeBinding(Msxmlx::Field<&Light::name>("name"),
+//!                                                            Msxmlx::Field<&Light::intensity>("intensity"),
+//!                                                            Msxmlx::HexField<&Light::color>("color"),
+//!                                                            Msxmlx::Field<&Light::shadows>("shadows"));
+//!     };
+//!
+//!     template <>
+//!     struct Msxmlx::Schema<Room>
+//!     {
+//!         static constexpr auto FIELDS = Msxmlx::MakeBinding(Msxmlx::Field<&Room::name>("name"),
+//!                                                            Msxmlx::SubElement<&Room::height>("height"),
+//!                                                            Msxmlx::SubElement<&Room::lights>("light"));
+//!     };
+//!
+//!     Room room;
+//!     Msxmlx::Deserialize(reader, room);
+//! @endcode
+
+template <typename T, size_t N>
+class Binding
+{
+public:
+
+    //! Constructor.
+    constexpr explicit Binding(std::array<FieldDescriptor, N> fields)
+        : fields_(sort(fields))
+        , declared_(fields)
+        , attributeCount_(0)
+    {
+        while (attributeCount_ < N && fields_[attributeCount_].kind == FieldKind::Attribute)
+        {
+            ++attributeCount_;
+        }
+    }
+
+    //! Returns the field descriptors: the attribute fields followed by the sub-element fields.
+    constexpr FieldDescriptor const * Data() const { return fields_.data(); }
+
+    //! Returns the field descriptors in the order in which they were declared.
+    constexpr FieldDescriptor const * Declared() const { return declared_.data(); }
+
+    //! Returns the number of fields.
+    constexpr size_t Size() const { return N; }
+
+    //! Returns the number of attribute fields.
+    constexpr size_t AttributeCount() const { return attributeCount_; }
+
+    //! Returns the descriptor for an attribute, or nullptr if the attribute is not bound.
+    FieldDescriptor const * FindAttribute(std::string_view name) const
+    {
+        return FindField(fields_.data(), attributeCount_, name);
+    }
+
+    //! Returns the descriptor for a sub-element, or nullptr if the sub-element is not bound.
+    FieldDescriptor const * FindSubElement(std::string_view name) const
+    {
+        return FindField(fields_.data() + attributeCount_, N - attributeCount_, name);
+    }
+
+private:
+
+    static constexpr bool before(FieldDescriptor const & a, FieldDescriptor const & b)
+    {
+        bool aIsAttribute = a.kind == FieldKind::Attribute;
+        bool bIsAttribute = b.kind == FieldKind::Attribute;
+        return (aIsAttribute != bIsAttribute) ? aIsAttribute : a.hash < b.hash;
+    }
+
+    static constexpr std::array<FieldDescriptor, N> sort(std::array<FieldDescriptor, N> fields)
+    {
+        for (size_t i = 1; i < N; ++i)
+        {
+            for (size_t j = i; j > 0 && before(fields[j], fields[j - 1]); --j)
+            {
+                FieldDescriptor swap = fields[j];
+                fields[j]            = fields[j - 1];
+                fields[j - 1]        = swap;
+            }
+        }
+        return fields;
+    }
+
+    std::array<FieldDescriptor, N> fields_;
+    std::array<FieldDescriptor, N> declared_; // Unsorted
+    size_t attributeCount_;
+};
+
+//! Returns a binding of the given fields, which must all be members of the same type.
+template <typename T, typename... Rest>
+constexpr Binding<T, 1 + sizeof...(Rest)> MakeBinding(BoundField<T> first, Rest... rest)
+{
+    static_assert(std::conjunction_v<std::is_same<Rest, BoundField<T>>...>, "All fields must be members of one type");
+    using Fields = std::array<FieldDescriptor, 1 + sizeof...(Rest)>;
+    return Binding<T, 1 + sizeof...(Rest)>(Fields{ { first.descriptor, rest.descriptor... } });
+}
+
+/********************************************************************************************************************/
+/*														B I N D														*/
+/********************************************************************************************************************/
+
+//! Stores the bound attributes of the current start tag in an object. Returns false if any value was invalid.
+bool BindAttributes(Reader const & reader, void * pObject, FieldDescriptor const * pFields, size_t count);
+
+//! Stores the bound attributes of an element in an object. Returns false if any value was invalid.
+bool BindAttributes(CompactDocument const & document,
+                    CompactDocument::Index  element,
+                    void *                  pObject,
+                    FieldDescriptor const * pFields,
+                    size_t                  count);
+
+//! Stores the attributes of the reader's current start tag in an object using a binding.
+template <typename T, size_t N>
+bool Bind(Reader const & reader, T & object, Binding<T, N> const & binding)
+{
+    return BindAttributes(reader, &object, binding.Data(), binding.AttributeCount());
+}
+
+//! Stores the attributes of the reader's current start tag in an object using Schema<T>.
+template <typename T>
+bool Bind(Reader const & reader, T & object)
+{
+    return Bind(reader, object, Schema<T>::FIELDS);
+}
+
+//! Stores the attributes of an element in an object using a binding.
+template <typename T, size_t N>
+bool Bind(CompactDocument const & document, CompactDocument::Index element, T & object, Binding<T, N> const & binding)
+{
+    return BindAttributes(document, element, &object, binding.Data(), binding.AttributeCount());
+}
+
+//! Stores the attributes of an element in an object using Schema<T>.
+template <typename T>
+bool Bind(CompactDocument const & document, CompactDocument::Index element, T & object)
+{
+    return Bind(document, element, object, Schema<T>::FIELDS);
+}
+
+/********************************************************************************************************************/
+/*												D E S E R I A L I Z E												*/
+/********************************************************************************************************************/
+
+//! Stores the bound attributes and sub-elements of the current element in an object. Returns false if any value
+//! was invalid or the element is not well-formed.
+bool DeserializeElement(Reader &                reader,
+                        void *                  pObject,
+                        FieldDescriptor const * pFields,
+                        size_t                  attributeCount,
+                        size_t                  count);
+
+//! Stores the bound attributes and sub-elements of an element in an object. Returns false if any value was invalid.
+bool DeserializeElement(CompactDocument const & document,
+                        CompactDocument::Index  element,
+                        void *                  pObject,
+                        FieldDescriptor const * pFields,
+                        size_t                  attributeCount,
+                        size_t                  count);
+
+//! Deserializes the reader's current element into an object using a binding. The reader is left on its end tag.
+template <typename T, size_t N>
+bool Deserialize(Reader & reader, T & object, Binding<T, N> const & binding)
+{
+    return DeserializeElement(reader, &object, binding.Data(), binding.AttributeCount(), binding.Size());
+}
+
+//! Deserializes the reader's current element into an object using Schema<T>. The reader is left on its end tag.
+template <typename T>
+bool Deserialize(Reader & reader, T & object)
+{
+    return Deserialize(reader, object, Schema<T>::FIELDS);
+}
+
+//! Deserializes an element into an object using a binding.
+template <typename T, size_t N>
+bool Deserialize(CompactDocument const & document,
+                 CompactDocument::Index  element,
+                 T &                     object,
+                 Binding<T, N> const &   binding)
+{
+    return DeserializeElement(document, element, &object, binding.Data(), binding.AttributeCount(), binding.Size());
+}
+
+//! Deserializes an element into an object using Schema<T>.
+template <typename T>
+bool Deserialize(CompactDocument const & document, CompactDocument::Index element, T & object)
+{
+    return Deserialize(document, element, object, Schema<T>::FIELDS);
+}
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_BIND_H)
@@ -0,0 +1,374 @@
+#pragma once
+
+#if !defined(MSXMLX_COMPACTDOCUMENT_H)
+#define MSXMLX_COMPACTDOCUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Instrumentation.h"
+#include "MappedFile.h"
+#include "Reader.h"
+
+//! Portable compact read-only document.
+
+namespace Msxmlx
+{
+//! A compact, read-only, in-memory document.
+//!
+//! Only elements are stored. Each element has a name, a value (its first non-whitespace text, as with
+//! GetSubElementValue()) and attributes. The elements are stored in document order as parallel arrays of 32-bit
+//! indices (parent, first child, next sibling, name, value, first attribute) and the strings are stored in a
+//! single pool, all in one allocation. Element and attribute names are interned, so name comparisons during lookups
+//! are integer comparisons. Entity references in values are expanded when the document is parsed.
+//!
+//! Because the arrays hold indices and offsets rather than pointers, a parsed document can be saved as a snapshot: a
+//! versioned binary image of the arrays and the pool, which is loaded again by pointing at it instead of parsing it.
+//! A snapshot loaded from a file is mapped into memory, so loading it parses and allocates nothing, and the pages are
+//! shared by every process that loads the same file. Its indices are checked in one pass over its arrays, unless it
+//! is loaded with LoadTrustedSnapshot(), which takes constant time.
+//!
+//! Elements are identified by their index. The accessors mirror the MSXML-based accessors in Msxmlx.h. An accessor
+//! given NONE as the element behaves as if the element has no attributes or sub-elements, so lookups can be chained.
+//!
+//! @code
+//!     Msxmlx::CompactDocument document;
+//!     if (document.Parse(text))
+//!     {
+//!         Msxmlx::CompactDocument::Index render = document.GetSubElement(document.Root(), "render");
+//!         int resolution = document.GetIntAttribute(document.GetSubElement(render, "shadows"), "resolution", 1024);
+//!     }
+//! @endcode
+
+class CompactDocument
+{
+public:
+
+    //! Index of an element
+    using Index = uint32_t;
+
+    //! Index of no element
+    static Index constexpr NONE = 0xffffffff;
+
+    //! The attributes of an element.
+    struct Attributes
+    {
+        uint32_t first; //!< Index of the first attribute
+        uint32_t count; //!< Number of attributes
+    };
+
+    class Builder;
+
+    CompactDocument() = default;
+    CompactDocument(CompactDocument &&) noexcept = default;
+    CompactDocument & operator =(CompactDocument &&) noexcept = default;
+
+    //! Parses a document, replacing the current contents. Returns false if the document is not well-formed.
+    bool Parse(std::string_view text);
+
+    //! Returns a binary image of the document for LoadSnapshot(). It is empty if there is no document.
+    std::string Snapshot() const;
+
+    //! Writes a snapshot of the document to a file. Returns false if there is no document or it could not be written.
+    bool SaveSnapshot(char const * sPath) const;
+
+    //! Loads a snapshot in memory, which must remain valid and unchanged while the document is used. Nothing is copied.
+    bool LoadSnapshot(void const * pData, size_t size);
+
+    //! Loads a snapshot in memory in constant time, without checking its contents. The snapshot must be trustworthy.
+    bool LoadTrustedSnapshot(void const * pData, size_t size);
+
+    //! Maps a snapshot file and loads it. The file remains mapped while the document is used.
+    bool LoadSnapshot(char const * sPath);
+
+    //! Returns a description of the error if Parse() or LoadSnapshot() failed.
+    char const * ErrorMessage() const { return error_; }
+
+    //! Returns the offset in the text of the error if Parse() failed.
+    size_t ErrorOffset() const { return errorOffset_; }
+
+    //! Returns the number of elements.
+    size_t Size() const { return nodeCount_; }
+
+    //! Returns the number of bytes allocated for the document. A loaded snapshot allocates nothing.
+    size_t Capacity() const { return arena_ ? arenaSize_ : 0; }
+
+    //! Returns the root element, or NONE if the document is empty.
+    Index Root() const { return nodeCount_ > 0 ? 0 : NONE; }
+
+    //! Returns the parent of an element, or NONE if it is the root.
+    Index Parent(Index element) const { return parent_[element]; }
+
+    //! Returns the first child of an element, or NONE if it has none.
+    Index FirstChild(Index element) const { return firstChild_[element]; }
+
+    //! Returns the next sibling of an element, or NONE if it has none.
+    Index NextSibling(Index element) const { return nextSibling_[element]; }
+
+    //! Returns the name of an element.
+    std::string_view Name(Index element) const { return name(nameId_[element]); }
+
+    //! Returns the value of an element (its first non-whitespace text), or an empty string if it has no text.
+    std::string_view Value(Index element) const { return string(valueOffset_[element], valueLength_[element]); }
+
+    //! Returns true if the element has text.
+    bool HasValue(Index element) const { return valueOffset_[element] != NONE; }
+
+    //! Returns the attributes of an element.
+    Attributes GetAttributes(Index element) const;
+
+    //! Returns the name of an attribute.
+    std::string_view AttributeName(uint32_t attribute) const { return name(attributeName_[attribute]); }
+
+    //! Returns the value of an attribute.
+    std::string_view AttributeValue(uint32_t attribute) const
+    {
+        return string(attributeValueOffset_[attribute], attributeValueLength_[attribute]);
+    }
+
+    //! Returns the id of an interned element or attribute name, or NONE if no element or attribute has the name.
+    uint32_t FindName(std::string_view sName) const;
+
+    //! Returns the id of the name of an element.
+    uint32_t NameId(Index element) const { return nameId_[element]; }
+
+    //! Returns the id of the name of an attribute.
+    uint32_t AttributeNameId(uint32_t attribute) const { return attributeName_[attribute]; }
+
+    //! Returns the named sub-element, or NONE if not found.
+    Index GetSubElement(Index element, std::string_view sName) const;
+
+    //! Returns the attributes of the named sub-element. If the sub-element is not found, the result is empty.
+    Attributes GetSubElementAttributes(Index element, std::string_view sName) const;
+
+    //! Returns the value of an attribute. Returns false if the attribute is not present.
+    bool FindAttribute(Attributes attributes, std::string_view sName, std::string_view & value) const;
+
+    //! Returns the value of a string attribute (or a default value, if the attribute is not present).
+    std::string GetStringAttribute(Index element, std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a string attribute (or a default value, if the attribute is not present).
+    std::string GetStringAttribute(Attributes attributes, std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+    float GetFloatAttribute(Index element, std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+    float GetFloatAttribute(Attributes attributes, std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+    int GetIntAttribute(Index element, std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+    int GetIntAttribute(Attributes attributes, std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex attribute (or a default value, if the attribute is not present or invalid).
+    uint32_t GetHexAttribute(Index element, std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a hex attribute (or a default value, if the attribute is not present or invalid).
+    uint32_t GetHexAttribute(Attributes attributes, std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool attribute (or a default value, if the attribute is not present or invalid).
+    bool GetBoolAttribute(Index element, std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the value of a bool attribute (or a default value, if the attribute is not present or invalid).
+    bool GetBoolAttribute(Attributes attributes, std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of an attribute that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArrayAttribute(Index element, std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of an attribute that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArrayAttribute(Attributes attributes, std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of an attribute that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArrayAttribute(Index element, std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArrayAttribute(Attributes attributes, std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArrayAttribute(Index element, std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of an attribute that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArrayAttribute(Attributes attributes, std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of an attribute that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArrayAttribute(Index element, std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArrayAttribute(Attributes attributes, std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArrayAttribute(Index element, std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArrayAttribute(Attributes attributes, std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArrayAttribute(Index element, std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArrayAttribute(Attributes attributes, std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Returns the value of a specific sub-element. Returns false if the sub-element is not found.
+    bool GetSubElementValue(Index element, std::string_view sName, std::string_view & value) const;
+
+    //! Returns the value of a string sub-element (or a default value, if the sub-element is not present).
+    std::string GetStringSubElement(Index element, std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float sub-element (or a default value, if the sub-element is not present or invalid).
+    float GetFloatSubElement(Index element, std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+    int GetIntSubElement(Index element, std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex sub-element (or a default value, if the sub-element is not present or invalid).
+    uint32_t GetHexSubElement(Index element, std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool sub-element (or a default value, if the sub-element is not present or invalid).
+    bool GetBoolSubElement(Index element, std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of a sub-element that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArraySubElement(Index element, std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of a sub-element that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArraySubElement(Index element, std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of a sub-element that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArraySubElement(Index element, std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of a sub-element that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArraySubElement(Index element, std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of a sub-element that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArraySubElement(Index element, std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of a sub-element that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArraySubElement(Index element, std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Calls a function for each sub-element and returns false if the function aborted.
+    template <typename F>
+    bool ForEachSubElement(Index element, F f) const;
+
+private:
+
+    bool validate() const;
+    void place(std::byte const * pArena, size_t attributeCount);
+    std::string_view name(uint32_t id) const { return string(nameOffset_[id], nameLength_[id]); }
+    std::string_view string(uint32_t offset, uint32_t length) const
+    {
+        return (offset != NONE) ? std::string_view(pool_ + offset, length) : std::string_view();
+    }
+
+    std::unique_ptr<std::byte[]> arena_; // All of the arrays below, unless they are in a snapshot
+    MappedFile file_;                    // The snapshot file, if the document was loaded from one
+    size_t arenaSize_   = 0;
+    size_t nodeCount_   = 0;
+    size_t nameCount_   = 0;
+
+    Index const *    parent_               = nullptr;
+    Index const *    firstChild_           = nullptr;
+    Index const *    nextSibling_          = nullptr;
+    uint32_t const * nameId_               = nullptr;
+    uint32_t const * valueOffset_          = nullptr;
+    uint32_t const * valueLength_          = nullptr;
+    uint32_t const * firstAttribute_       = nullptr; // One extra entry marks the end of the last attributes
+    uint32_t const * attributeName_        = nullptr;
+    uint32_t const * attributeValueOffset_ = nullptr;
+    uint32_t const * attributeValueLength_ = nullptr;
+    uint32_t const * nameOffset_           = nullptr; // Sorted by name
+    uint32_t const * nameLength_           = nullptr;
+    char const *     pool_                 = nullptr;
+
+    char const * error_  = nullptr;
+    size_t errorOffset_  = 0;
+};
+
+/********************************************************************************************************************/
+/*													B U I L D E R													*/
+/********************************************************************************************************************/
+
+//! Builds a CompactDocument from the events of a parser.
+//!
+//! Parse() uses a builder with Reader. A builder can also be given the events of a parser that receives the document
+//! in pieces (see PushParser), so that the document is built as the data arrives and the text is never held in full.
+//! The events must be those of a well-formed document, and the strings are copied, so they need only be valid during
+//! each call.
+class CompactDocument::Builder
+{
+public:
+
+    //! Starts an element. Returns false if the document is too large.
+    bool StartElement(std::string_view name, AttributeRange attributes);
+
+    //! Ends the current element.
+    void EndElement() { open_.pop_back(); }
+
+    //! Adds character data (raw, as in the document) or a CDATA section to the current element. A continued text is
+    //! the rest of the previous one (see StreamReader::IsTextContinued()). Returns false if the document is too large.
+    bool Text(std::string_view text, bool bCData, bool bContinued);
+
+    //! Moves the built document into a document, replacing its contents. The builder is left empty.
+    bool Finish(CompactDocument & document);
+
+    //! Returns a description of the error if a call failed.
+    char const * ErrorMessage() const { return error_; }
+
+private:
+
+    uint32_t intern(std::string_view name);
+    bool checkSize();
+
+    std::vector<Index>    parent_;
+    std::vector<Index>    firstChild_;
+    std::vector<Index>    nextSibling_;
+    std::vector<Index>    lastChild_;
+    std::vector<uint32_t> nameId_;
+    std::vector<uint32_t> valueOffset_;
+    std::vector<uint32_t> valueLength_;
+    std::vector<uint32_t> firstAttribute_;
+    std::vector<uint32_t> attributeName_;
+    std::vector<uint32_t> attributeValueOffset_;
+    std::vector<uint32_t> attributeValueLength_;
+    std::string           pool_;
+    std::vector<Index>    open_;
+
+    // Names are assigned ids in the order they are first seen, and then renumbered in sorted order by Finish()
+    std::deque<std::string>                        names_; // Stable storage for the keys of ids_
+    std::unordered_map<std::string_view, uint32_t> ids_;
+
+    std::string  whitespace_;        // Leading whitespace of a text that may continue with the value
+    bool         extending_ = false; // True if a continued text extends the value of the current element
+    char const * error_     = nullptr;
+};
+
+//! @param    element    The element whose sub-elements are to be enumerated
+//! @param    f          The function to call for each sub-element. It is called with the index of the sub-element
+//!                      and returns false to abort the enumeration.
+//!
+//! @return        false, if the function aborted the enumeration
+
+template <typename F>
+bool CompactDocument::ForEachSubElement(Index element, F f) const
+{
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    if (element == NONE)
+        return true;
+
+    for (Index child = firstChild_[element]; child != NONE; child = nextSibling_[child])
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (!f(child))
+            return false;
+    }
+    return true;
+}
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_COMPACTDOCUMENT_H)
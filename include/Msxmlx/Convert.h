@@ -0,0 +1,107 @@
+#pragma once
+
+#if !defined(MSXMLX_CONVERT_H)
+#define MSXMLX_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Locale-independent conversion of attribute and element text to typed values.
+//!
+//! The conversions are built on std::from_chars, so they do not allocate and do not depend on the current locale. The
+//! wide versions accept the text returned by MSXML directly. Wide text that is not ASCII is never a valid value.
+//!
+//! Arrays are lists of values separated by whitespace, as used for coordinates and other bulk data. They are converted
+//! to a vector, which is allocated once, or to an array provided by the caller.
+//!
+//! The conversions between UTF-8 and wide text are the only ones used by the library. Runs of ASCII characters are
+//! converted with the scanning kernels (see Scan.h), so ASCII text is converted many characters at a time.
+
+namespace Msxmlx
+{
+//! Removes leading and trailing XML whitespace (space, tab, CR and LF).
+std::string_view TrimWhitespace(std::string_view text);
+
+//! Converts text to a float. Returns false if the text is not a number.
+bool ParseFloat(std::string_view text, float & value);
+
+//! Converts text to an int. Returns false if the text is not an integer or is out of range.
+bool ParseInt(std::string_view text, int & value);
+
+//! Converts hexadecimal text (with an optional 0x prefix) to an unsigned int. Returns false if the text is not valid.
+bool ParseHex(std::string_view text, uint32_t & value);
+
+//! Converts text to a bool. Returns false if the text is not "true", "false" or a finite number.
+bool ParseBool(std::string_view text, bool & value);
+
+//! Removes leading and trailing XML whitespace (space, tab, CR and LF).
+std::wstring_view TrimWhitespace(std::wstring_view text);
+
+//! Converts wide text to a float. Returns false if the text is not a number.
+bool ParseFloat(std::wstring_view text, float & value);
+
+//! Converts wide text to an int. Returns false if the text is not an integer or is out of range.
+bool ParseInt(std::wstring_view text, int & value);
+
+//! Converts wide hexadecimal text (with an optional 0x prefix) to an unsigned int. Returns false if it is not valid.
+bool ParseHex(std::wstring_view text, uint32_t & value);
+
+//! Converts wide text to a bool. Returns false if the text is not "true", "false" or a finite number.
+bool ParseBool(std::wstring_view text, bool & value);
+
+//! Returns the number of values in a list separated by whitespace.
+size_t CountValues(std::string_view text);
+
+//! Converts a list of floats to a vector. Returns false if a value is not valid.
+bool ParseFloatArray(std::string_view text, std::vector<float> & values);
+
+//! Converts a list of floats to an array. Returns false if a value is not valid or there are too many.
+bool ParseFloatArray(std::string_view text, float * pValues, size_t & count);
+
+//! Converts a list of integers to a vector. Returns false if a value is not valid.
+bool ParseIntArray(std::string_view text, std::vector<int> & values);
+
+//! Converts a list of integers to an array. Returns false if a value is not valid or there are too many.
+bool ParseIntArray(std::string_view text, int * pValues, size_t & count);
+
+//! Converts a list of hexadecimal numbers to a vector. Returns false if a value is not valid.
+bool ParseHexArray(std::string_view text, std::vector<uint32_t> & values);
+
+//! Converts a list of hexadecimal numbers to an array. Returns false if a value is not valid or there are too many.
+bool ParseHexArray(std::string_view text, uint32_t * pValues, size_t & count);
+
+//! Returns the number of values in a list of wide text separated by whitespace.
+size_t CountValues(std::wstring_view text);
+
+//! Converts a wide list of floats to a vector. Returns false if a value is not valid.
+bool ParseFloatArray(std::wstring_view text, std::vector<float> & values);
+
+//! Converts a wide list of floats to an array. Returns false if a value is not valid or there are too many.
+bool ParseFloatArray(std::wstring_view text, float * pValues, size_t & count);
+
+//! Converts a wide list of integers to a vector. Returns false if a value is not valid.
+bool ParseIntArray(std::wstring_view text, std::vector<int> & values);
+
+//! Converts a wide list of integers to an array. Returns false if a value is not valid or there are too many.
+bool ParseIntArray(std::wstring_view text, int * pValues, size_t & count);
+
+//! Converts a wide list of hexadecimal numbers to a vector. Returns false if a value is not valid.
+bool ParseHexArray(std::wstring_view text, std::vector<uint32_t> & values);
+
+//! Converts a wide list of hexadecimal numbers to an array. Returns false if a value is not valid or too many.
+bool ParseHexArray(std::wstring_view text, uint32_t * pValues, size_t & count);
+
+//! Converts wide text to UTF-8, replacing the contents of a string. Returns false if unpaired surrogates were replaced.
+bool ToUtf8(std::wstring_view text, std::string & value);
+
+//! Converts wide text to UTF-8 in a buffer. Returns the length of the converted text, which may exceed the size.
+size_t ToUtf8(std::wstring_view text, char * pBuffer, size_t size);
+
+//! Converts UTF-8 to wide text in a buffer of at least text.size() characters. Returns the number of wide characters.
+size_t ToWide(std::string_view text, wchar_t * pBuffer);
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_CONVERT_H)
@@ -0,0 +1,148 @@
+#pragma once
+
+#if !defined(MSXMLX_DOCUMENTCACHE_H)
+#define MSXMLX_DOCUMENTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "CompactDocument.h"
+
+//! Shared cache of parsed documents.
+
+namespace Msxmlx
+{
+//! A cache of documents parsed from files, shared by every part of a process that reads the same files.
+//!
+//! Documents are keyed by path and identified by the modification time and size of the file. Get() returns a
+//! shared read-only handle, so a document stays valid for as long as any caller holds it, even if the cache has
+//! since replaced or evicted it. Concurrent requests for a file that is not yet cached wait for a single load.
+//!
+//! On Linux, the directories of the cached files are watched with inotify. When a file changes, a background thread
+//! parses it again and swaps the new document in, so callers neither block on the reload nor check the file on each
+//! request. Elsewhere (or if watching fails), each request checks the file's modification time and size, and a
+//! changed file is reloaded by the request that notices it. Requests also check the files if the watcher may have
+//! missed a change, because its queue overflowed or a watched directory was deleted or moved.
+//!
+//! The memory used by the cached documents is limited. When it is exceeded, the least recently requested documents
+//! are evicted.
+//!
+//! @code
+//!     static Msxmlx::DocumentCache cache(64 << 20);
+//!
+//!     Msxmlx::DocumentCache::Handle pConfig = cache.Get("config/render.xml");
+//!     if (pConfig)
+//!         resolution = pConfig->GetIntAttribute(pConfig->GetSubElement(pConfig->Root(), "shadows"), "size");
+//! @endcode
+
+class DocumentCache
+{
+public:
+
+    //! A shared read-only document
+    using Handle = std::shared_ptr<CompactDocument const>;
+
+    //! Counters describing the use of the cache.
+    struct Statistics
+    {
+        uint64_t hits;      //!< Requests served by a cached document
+        uint64_t misses;    //!< Requests that loaded a file
+        uint64_t reloads;   //!< Files reloaded in the background after they changed
+        uint64_t evictions; //!< Documents evicted to stay within the memory limit
+        size_t   count;     //!< Number of cached documents
+        size_t   bytes;     //!< Memory used by the cached documents
+    };
+
+    //! Default limit on the memory used by the cached documents
+    static size_t constexpr DEFAULT_MAX_BYTES = 256 * 1024 * 1024;
+
+    //! Constructor. If watching is enabled and supported, changed files are reloaded in the background.
+    explicit DocumentCache(size_t maxBytes = DEFAULT_MAX_BYTES, bool bWatch = true);
+
+    //! Destructor. Stops watching. Handles to the documents remain valid.
+    ~DocumentCache();
+
+    DocumentCache(DocumentCache const &) = delete;
+    DocumentCache & operator =(DocumentCache const &) = delete;
+
+    //! Returns the document in a file, loading it if necessary. Returns nullptr if it cannot be read or parsed.
+    Handle Get(std::string const & path);
+
+    //! Removes a file's document from the cache.
+    void Remove(std::string const & path);
+
+    //! Removes all documents from the cache.
+    void Clear();
+
+    //! Returns the counters.
+    Statistics GetStatistics() const;
+
+    //! Returns true if changed files are reloaded in the background.
+    bool IsWatching() const { return watchFd_ >= 0; }
+
+private:
+
+    // Identifies a version of a file
+    struct Stamp
+    {
+        int64_t  modified; // Modification time in nanoseconds
+        uint64_t size;
+
+        bool operator ==(Stamp const & rhs) const { return modified == rhs.modified && size == rhs.size; }
+        bool operator !=(Stamp const & rhs) const { return !(*this == rhs); }
+    };
+
+    // A cached file
+    struct Entry
+    {
+        Stamp                            stamp;
+        std::shared_future<Handle>       document;
+        size_t                           bytes   = 0;
+        uint64_t                         load    = 0;     // Identifies the load in progress, or 0 if there is none
+        bool                             watched = false; // True if changes are reported by the watcher
+        bool                             check   = false; // True if the file changed while it was being loaded
+        std::list<std::string>::iterator recent;          // Position in recent_
+    };
+
+    // A watched directory. The same directory may be named differently by different paths (e.g. "a" and "./a").
+    struct Directory
+    {
+        std::unordered_map<std::string, size_t> prefixes; // Prefixes of the paths of its cached files, with counts
+    };
+
+    static bool getStamp(std::string const & path, Stamp & stamp);
+    bool watch(std::string const & path);
+    void unwatch(std::string const & path);
+    void forget(int wd);
+    void erase(std::unordered_map<std::string, Entry>::iterator i);
+    void evict();
+    void watcher();
+    void reload(std::string const & path);
+
+    mutable std::mutex                     mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string>                 recent_; // Paths of the cached files, most recently requested first
+    size_t                                 maxBytes_;
+    size_t                                 bytes_     = 0;
+    uint64_t                               nextLoad_  = 0;
+    uint64_t                               hits_      = 0;
+    uint64_t                               misses_    = 0;
+    uint64_t                               reloads_   = 0;
+    uint64_t                               evictions_ = 0;
+
+    int                                    watchFd_    = -1;           // The inotify instance
+    int                                    stopFds_[2] = { -1, -1 };   // A pipe that stops the watcher thread
+    std::unordered_map<int, Directory>     directories_;               // Watched directories by watch descriptor
+    std::unordered_map<std::string, int>   watches_;                   // Watch descriptors by directory
+    std::thread                            thread_;
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_DOCUMENTCACHE_H)
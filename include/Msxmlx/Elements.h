@@ -0,0 +1,180 @@
+#pragma once
+
+#if !defined(MSXMLX_ELEMENTS_H)
+#define MSXMLX_ELEMENTS_H
+
+#include "StreamReader.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//! Lazy enumeration of the elements of a stream with C++20 coroutines.
+
+// This header requires C++20. The library itself only requires C++17, so the contents are omitted when coroutines
+// are not available.
+//
+//      Msxmlx::StreamReader reader(fd);
+//      for (Msxmlx::ElementView entity : Msxmlx::Elements(reader, "world/entity"))
+//      {
+//          if (entity.attributes.GetIntAttribute("id") == wanted)
+//              break; // The rest of the stream is not read
+//      }
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*												G E N E R A T O R													*/
+/********************************************************************************************************************/
+
+//! A coroutine that yields a sequence of values on demand, usable with range-for.
+//!
+//! The coroutine runs only when the next value is requested, so a consumer that stops early stops the producer too.
+//! Each value is valid until the iterator is incremented. An exception thrown by the coroutine is rethrown by begin()
+//! or the increment that resumed it, and ends the sequence.
+template <typename T>
+class Generator
+{
+public:
+
+    struct promise_type
+    {
+        T const *          pValue = nullptr;
+        std::exception_ptr error; // Thrown by the coroutine, and not yet rethrown
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T const & value) noexcept
+        {
+            pValue = std::addressof(value);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+
+        // Rethrows the exception thrown by the coroutine, if any
+        void rethrow()
+        {
+            if (error)
+                std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    };
+
+    //! Input iterator over the values.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+
+        explicit Iterator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+        T const & operator *() const { return *handle_.promise().pValue; }
+        T const * operator ->() const { return handle_.promise().pValue; }
+
+        Iterator & operator ++()
+        {
+            handle_.resume();
+            handle_.promise().rethrow();
+            return *this;
+        }
+        void operator ++(int) { ++*this; }
+
+        bool operator ==(std::default_sentinel_t) const { return handle_.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    Generator(Generator && rhs) noexcept : handle_(std::exchange(rhs.handle_, nullptr)) {}
+    Generator & operator =(Generator && rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(rhs.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Generator()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    //! Runs the coroutine to its first value. It must be called only once.
+    Iterator begin()
+    {
+        handle_.resume();
+        handle_.promise().rethrow();
+        return Iterator(handle_);
+    }
+
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/********************************************************************************************************************/
+/*												E L E M E N T S														*/
+/********************************************************************************************************************/
+
+//! An element found by Elements(). It is valid until the next element is requested.
+struct ElementView
+{
+    std::string_view name;       //!< Name of the element
+    AttributeRange   attributes; //!< Attributes of the element, with the typed accessors
+    int              depth;      //!< Number of ancestors of the element
+    StreamReader *   pReader;    //!< The reader, positioned on the start tag of the element
+};
+
+//! Returns the elements at a path (e.g. "world/entity"), parsing the stream only as far as they are requested.
+//!
+//! The path starts with the root element, as with StreamReader::IsAt(). The consumer may advance the reader within a
+//! yielded element (for example, with StreamReader::ForEachSubElement()). Otherwise, the rest of the element is
+//! skipped when the next element is requested. The sequence ends at the end of the document, or at an error, which
+//! is reported by the reader.
+//!
+//! The sequence also ends if the reader's source has no data yet (StreamReader::PENDING), since a generator cannot
+//! wait without yielding. Once there is more data, Elements() can be called again with the same reader and path to
+//! continue with the elements that follow. The rest of an element that was being skipped cannot match the path, so
+//! none is repeated or lost.
+//!
+//! @param    reader    The reader, before its first token, or where a previous sequence ended. It must outlive the
+//!                     generator.
+//! @param    path      The path of the elements
+//!
+//! @return        The elements
+
+inline Generator<ElementView> Elements(StreamReader & reader, std::string path)
+{
+    using Token = StreamReader::Token;
+
+    for (Token t = reader.Next(); t != Token::End && t != Token::Error && t != Token::None; t = reader.Next())
+    {
+        if (t != Token::StartElement || !reader.IsAt(path))
+            continue;
+
+        co_yield ElementView{ reader.Name(), reader.Attributes(), reader.Depth(), &reader };
+
+        // The descendants of a matching element are deeper than the path, so none of them can match
+        reader.Skip();
+    }
+}
+} // namespace Msxmlx
+
+#endif // defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#endif // !defined(MSXMLX_ELEMENTS_H)
@@ -0,0 +1,152 @@
+#pragma once
+
+#if !defined(MSXMLX_INSTRUMENTATION_H)
+#define MSXMLX_INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//! Optional counters of the work done by the accessors.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*											I N S T R U M E N T A T I O N											*/
+/********************************************************************************************************************/
+
+//! Counters of the calls to each family of accessors and of the work that they do.
+//!
+//! Instrumentation is compiled out unless the library is built with the CMake option Msxmlx_INSTRUMENTATION, which
+//! defines MSXMLX_INSTRUMENTATION for the library and for everything that uses it. Otherwise the counters are always
+//! zero and the accessors are unchanged. When it is compiled in, the counters are shared by all threads and updated
+//! atomically, so they are intended for finding the costly paths in a program rather than for measuring them.
+//!
+//! Only the outermost accessor is counted when one accessor calls another (for example, GetIntSubElement() calls
+//! GetSubElement()), and the work done by the inner accessor is counted in the family of the outer one. Enumeration
+//! is counted without a scope, so the accessors called by the callbacks of ForEach*() are counted in their own
+//! families, and enumeration has no latencies.
+//!
+//! @code
+//!     Msxmlx::Instrumentation::MeasureLatency(true);
+//!     LoadLevel(document);
+//!     fputs(Msxmlx::Instrumentation::ToJson(Msxmlx::Instrumentation::GetSnapshot()).c_str(), log);
+//! @endcode
+
+namespace Instrumentation
+{
+#if defined(MSXMLX_INSTRUMENTATION)
+bool constexpr ENABLED = true;  //!< True if the library is built with instrumentation
+#else
+bool constexpr ENABLED = false; //!< True if the library is built with instrumentation
+#endif
+
+//! A family of accessors
+enum class Family
+{
+    GET_ATTRIBUTE,         //!< Get*Attribute() and Query*Attribute()
+    GET_SUB_ELEMENT_VALUE, //!< Get*SubElement(), Query*SubElement(), GetSubElementValue() and paths to values
+    GET_SUB_ELEMENT,       //!< GetSubElement(), GetSubElementAttributes() and paths to elements
+    FOR_EACH,              //!< ForEach*() and element ranges
+    CREATE_TEXT_ELEMENT,   //!< CreateTextElement() and CreateTextElements()
+    COUNT
+};
+
+//! A counter of a family
+enum class Counter
+{
+    CALLS,       //!< Calls
+    SCANNED,     //!< Child nodes or attributes examined by lookups and enumerations
+    COERCIONS,   //!< Values converted to another type
+    CONVERSIONS, //!< Strings converted between UTF-8 and UTF-16
+    ALLOCATED,   //!< Bytes of the strings, BSTRs and names created
+    COUNT
+};
+
+//! Number of buckets of a latency histogram. Bucket n counts the calls that took from 2^n to 2^(n+1) ns.
+int constexpr LATENCY_BUCKETS = 32;
+
+//! The counters of a family
+struct Counters
+{
+    uint64_t counts[size_t(Counter::COUNT)];  //!< Indexed by Counter
+    uint64_t latency[LATENCY_BUCKETS];        //!< Calls by duration, if latencies are measured
+};
+
+//! The counters of all families at one time
+struct Snapshot
+{
+    Counters families[size_t(Family::COUNT)]; //!< Indexed by Family
+};
+
+//! Returns the current values of the counters. They are all zero if instrumentation is compiled out.
+Snapshot GetSnapshot();
+
+//! Sets all of the counters to zero.
+void Reset();
+
+//! Enables or disables the measurement of the latency of each call, which is disabled by default.
+void MeasureLatency(bool bEnable);
+
+//! Returns the name of a family, as used in ToJson().
+char const * FamilyName(Family family);
+
+//! Returns the name of a counter, as used in ToJson().
+char const * CounterName(Counter counter);
+
+//! Returns a snapshot as JSON. Families that have not been called are omitted.
+std::string ToJson(Snapshot const & snapshot);
+
+namespace Detail
+{
+int64_t beginCall(Family family);
+void endCall(int64_t start);
+void add(Counter counter, uint64_t n);
+void add(Family family, Counter counter, uint64_t n);
+} // namespace Detail
+
+//! Counts a call to an accessor for its lifetime, if it is the outermost one on its thread.
+class Call
+{
+public:
+
+    explicit Call(Family family)
+    {
+        if constexpr (ENABLED)
+            start_ = Detail::beginCall(family);
+    }
+
+    ~Call()
+    {
+        if constexpr (ENABLED)
+        {
+            if (start_ >= 0)
+                Detail::endCall(start_);
+        }
+    }
+
+    Call(Call const &) = delete;
+    Call & operator =(Call const &) = delete;
+
+private:
+
+    int64_t start_ = -1; // Start time in ns, 0 if latency is not measured, or -1 if this is not the outermost call
+};
+
+//! Adds to a counter of the family of the current call. Nothing is counted outside of a call.
+inline void Add(Counter counter, uint64_t n = 1)
+{
+    if constexpr (ENABLED)
+        Detail::add(counter, n);
+}
+
+//! Adds to a counter of a family.
+inline void Add(Family family, Counter counter, uint64_t n = 1)
+{
+    if constexpr (ENABLED)
+        Detail::add(family, counter, n);
+}
+} // namespace Instrumentation
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_INSTRUMENTATION_H)
@@ -0,0 +1,239 @@
+#pragma once
+
+#if !defined(MSXMLX_LAZYDOCUMENT_H)
+#define MSXMLX_LAZYDOCUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Instrumentation.h"
+#include "MappedFile.h"
+#include "Reader.h"
+
+//! Read-only document over a structural tape of its text.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*											L A Z Y   D O C U M E N T												*/
+/********************************************************************************************************************/
+
+//! A read-only document that refers to its text instead of copying it.
+//!
+//! Parsing makes a single pass over the text with a Reader and records a tape with an entry for each element: the
+//! offset of its name, its parent, the end of its sub-tree, and the offset of its first non-whitespace text. Nothing
+//! else is extracted. Names, attributes and values are read from the text only when an accessor touches them, so
+//! opening a large document to read a few of its sections costs a pass over the text and 20 bytes per element,
+//! rather than copying, interning and expanding everything as CompactDocument does. The sub-tree of an element that
+//! is not wanted is skipped in one step.
+//!
+//! The text must remain valid and unchanged while the document is used, unless the document is opened from a file,
+//! in which case the file remains mapped. The accessors mirror those of CompactDocument, but names are compared as
+//! strings and values are expanded each time they are read, so a document whose every value is read many times is
+//! better parsed as a CompactDocument. An accessor given NONE as the element behaves as if the element has no name,
+//! value, attributes or relatives, so lookups can be chained.
+//!
+//! @code
+//!     Msxmlx::LazyDocument document;
+//!     if (document.Open("level.xml"))
+//!     {
+//!         Msxmlx::LazyDocument::Index render = document.GetSubElement(document.Root(), "render");
+//!         int resolution = document.GetIntAttribute(document.GetSubElement(render, "shadows"), "resolution", 1024);
+//!     }
+//! @endcode
+
+class LazyDocument
+{
+public:
+
+    //! Index of an element
+    using Index = uint32_t;
+
+    //! Index of no element
+    static Index constexpr NONE = 0xffffffff;
+
+    LazyDocument() = default;
+    LazyDocument(LazyDocument &&) noexcept = default;
+    LazyDocument & operator =(LazyDocument &&) noexcept = default;
+
+    //! Parses a document, replacing the current contents. The text is not copied. Returns false if not well-formed.
+    bool Parse(std::string_view text);
+
+    //! Maps a file and parses it. The file remains mapped while the document is used.
+    bool Open(char const * sPath);
+
+    //! Returns a description of the error if Parse() or Open() failed.
+    char const * ErrorMessage() const { return error_; }
+
+    //! Returns the offset in the text of the error if Parse() or Open() failed.
+    size_t ErrorOffset() const { return errorOffset_; }
+
+    //! Returns the text of the document.
+    std::string_view Text() const { return text_; }
+
+    //! Returns the number of elements.
+    size_t Size() const { return tape_.size(); }
+
+    //! Returns the number of bytes allocated for the tape.
+    size_t Capacity() const { return tape_.capacity() * sizeof(Entry); }
+
+    //! Returns the root element, or NONE if the document is empty.
+    Index Root() const { return tape_.empty() ? NONE : 0; }
+
+    //! Returns the parent of an element, or NONE if it is the root.
+    Index Parent(Index element) const { return (element != NONE) ? tape_[element].parent : NONE; }
+
+    //! Returns the first child of an element, or NONE if it has none.
+    Index FirstChild(Index element) const
+    {
+        return (element != NONE && element + 1 < tape_[element].end) ? element + 1 : NONE;
+    }
+
+    //! Returns the next sibling of an element, or NONE if it has none.
+    Index NextSibling(Index element) const;
+
+    //! Returns the name of an element.
+    std::string_view Name(Index element) const;
+
+    //! Returns the first non-whitespace text of an element as it is in the document. Returns false if it is CDATA.
+    bool RawValue(Index element, std::string_view & raw) const;
+
+    //! Returns the value of an element (its first non-whitespace text) with references expanded.
+    std::string Value(Index element) const;
+
+    //! Returns true if the element has text.
+    bool HasValue(Index element) const { return element != NONE && tape_[element].value != NONE; }
+
+    //! Returns the attributes of an element. The range is empty if element is NONE.
+    AttributeRange GetAttributes(Index element) const;
+
+    //! Returns the named sub-element, or NONE if not found.
+    Index GetSubElement(Index element, std::string_view sName) const;
+
+    //! Returns the raw value of an attribute. Returns false if the attribute is not present.
+    bool FindAttribute(Index element, std::string_view sName, std::string_view & value) const;
+
+    //! Returns the value of a string attribute (or a default value, if the attribute is not present).
+    std::string GetStringAttribute(Index element, std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+    float GetFloatAttribute(Index element, std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+    int GetIntAttribute(Index element, std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex attribute (or a default value, if the attribute is not present or invalid).
+    uint32_t GetHexAttribute(Index element, std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool attribute (or a default value, if the attribute is not present or invalid).
+    bool GetBoolAttribute(Index element, std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of an attribute that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArrayAttribute(Index element, std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of an attribute that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArrayAttribute(Index element, std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArrayAttribute(Index element, std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of an attribute that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArrayAttribute(Index element, std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArrayAttribute(Index element, std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArrayAttribute(Index element, std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Returns the value of a sub-element with references expanded. Returns false if the sub-element is not found.
+    bool GetSubElementValue(Index element, std::string_view sName, std::string & value) const;
+
+    //! Returns the value of a string sub-element (or a default value, if the sub-element is not present).
+    std::string GetStringSubElement(Index element, std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float sub-element (or a default value, if the sub-element is not present or invalid).
+    float GetFloatSubElement(Index element, std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+    int GetIntSubElement(Index element, std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex sub-element (or a default value, if the sub-element is not present or invalid).
+    uint32_t GetHexSubElement(Index element, std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool sub-element (or a default value, if the sub-element is not present or invalid).
+    bool GetBoolSubElement(Index element, std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of a sub-element that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArraySubElement(Index element, std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of a sub-element that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArraySubElement(Index element, std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of a sub-element that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArraySubElement(Index element, std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of a sub-element that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArraySubElement(Index element, std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of a sub-element that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArraySubElement(Index element, std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of a sub-element that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArraySubElement(Index element, std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Calls a function for each sub-element of an element and returns false if the function aborted.
+    template <typename F>
+    bool ForEachSubElement(Index element, F f) const;
+
+private:
+
+    // An element on the tape. The elements are in document order, so the sub-tree of an element is the range of
+    // entries from the element to its end.
+    struct Entry
+    {
+        uint32_t name;        // Offset of the name in the text
+        uint32_t value;       // Offset of the first non-whitespace text, or NONE
+        uint32_t valueLength; // Length of the text, with CDATA_FLAG set if it is a CDATA section
+        Index    parent;
+        Index    end;         // Index of the first element after the sub-tree
+    };
+
+    static uint32_t constexpr CDATA_FLAG = 0x80000000;
+
+    bool build(std::string_view text);
+
+    std::vector<Entry> tape_;
+    std::string_view   text_;
+    MappedFile         file_;
+    char const *       error_       = nullptr;
+    size_t             errorOffset_ = 0;
+};
+
+//! @param    element    The element whose sub-elements are to be enumerated
+//! @param    f          The function to call for each sub-element. It is called with the index of the sub-element
+//!                      and returns false to abort the enumeration.
+//!
+//! @return        false, if the function aborted the enumeration
+
+template <typename F>
+bool LazyDocument::ForEachSubElement(Index element, F f) const
+{
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    if (element == NONE)
+        return true;
+
+    for (Index child = element + 1; child < tape_[element].end; child = tape_[child].end)
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (!f(child))
+            return false;
+    }
+    return true;
+}
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_LAZYDOCUMENT_H)
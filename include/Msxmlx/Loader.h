@@ -0,0 +1,53 @@
+#pragma once
+
+#if !defined(MSXMLX_LOADER_H)
+#define MSXMLX_LOADER_H
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "CompactDocument.h"
+#include "ThreadPool.h"
+
+//! Parallel loading of many documents.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*													L O A D E R														*/
+/********************************************************************************************************************/
+
+//! How LoadAll() reads and parses files.
+struct LoadOptions
+{
+    ThreadPool * pool        = nullptr; //!< Threads that parse the documents, or nullptr for ThreadPool::Default()
+    size_t       readAhead   = 64;      //!< Largest number of files being read or waiting to be parsed at once
+    size_t       readThreads = 8;       //!< Number of threads that read the files if io_uring is not used
+    bool         asyncIo     = true;    //!< If true, the files are read with io_uring on Linux if it is available
+};
+
+//! A document loaded by LoadAll().
+struct LoadResult
+{
+    size_t          index = 0;       //!< Index of the file's path
+    CompactDocument document;        //!< The document, if it was loaded
+    char const *    error = nullptr; //!< A description of the error if the file could not be read or parsed
+};
+
+//! Called by LoadAll() with each document as it is loaded. The result may be moved from.
+using LoadCallback = std::function<void(LoadResult & result)>;
+
+//! Loads many files at once, calling a function with each document as it is loaded. Returns when all are done.
+void LoadAll(std::vector<std::string> const & paths,
+             LoadCallback const &             callback,
+             LoadOptions const &              options = LoadOptions());
+
+//! Starts loading many files at once in the background, and returns a future for each one in the order of the paths.
+std::vector<std::future<LoadResult>> LoadAll(std::vector<std::string> paths,
+                                             LoadOptions const &      options = LoadOptions());
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_LOADER_H)
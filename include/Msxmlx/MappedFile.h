@@ -0,0 +1,54 @@
+#pragma once
+
+#if !defined(MSXMLX_MAPPEDFILE_H)
+#define MSXMLX_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string_view>
+
+//! Read-only memory-mapped files.
+
+namespace Msxmlx
+{
+//! A read-only memory-mapped file.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    //! Constructor. Opens and maps the file. Use IsOpen() to check for success.
+    explicit MappedFile(char const * sPath) { Open(sPath); }
+
+    ~MappedFile() { Close(); }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator =(MappedFile const &) = delete;
+    MappedFile(MappedFile && rhs) noexcept;
+    MappedFile & operator =(MappedFile && rhs) noexcept;
+
+    //! Opens and maps a file. Returns false if the file could not be opened or mapped.
+    bool Open(char const * sPath);
+
+    //! Unmaps and closes the file.
+    void Close();
+
+    //! Returns true if a file is mapped.
+    bool IsOpen() const { return open_; }
+
+    //! Returns the contents of the file.
+    char const * Data() const { return data_; }
+
+    //! Returns the size of the file.
+    size_t Size() const { return size_; }
+
+    //! Returns the contents of the file.
+    std::string_view View() const { return std::string_view(data_, size_); }
+
+private:
+    char const * data_ = nullptr;
+    size_t size_       = 0;
+    bool open_         = false;
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_MAPPEDFILE_H)
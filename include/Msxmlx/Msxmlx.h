@@ -7,10 +7,22 @@
 #include <atlcomcli.h>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <msxml2.h>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Bind.h"
+#include "Instrumentation.h"
+#include "Name.h"
+#include "Path.h"
 
 //! Miscellaneous functions supporting MSXML.
+//!
+//! Every function that takes the name of an attribute or element has an overload taking a Msxmlx::Name instead. A
+//! Name is converted once, so these overloads do not allocate or convert the name on each call.
 
 namespace Msxmlx
 {
@@ -27,16 +39,78 @@ bool IsNodeType(IXMLDOMNode * pNode, DOMNodeType type);
 //! Returns the named sub-element, or NULL if error or not found.
 HRESULT GetSubElement(IXMLDOMElement * pElement, char const * sName, IXMLDOMElement ** ppResult);
 
+//! Returns the named sub-element, or NULL if error or not found.
+HRESULT GetSubElement(IXMLDOMElement * pElement, Name const & name, IXMLDOMElement ** ppResult);
+
 //! Returns attributes for a specific sub-element or NULL if error or not found.
 HRESULT GetSubElementAttributes(IXMLDOMElement *       pElement,
                                 char const *           sName,
                                 IXMLDOMNamedNodeMap ** ppAttributes);
 
+//! Returns attributes for a specific sub-element or NULL if error or not found.
+HRESULT GetSubElementAttributes(IXMLDOMElement *       pElement,
+                                Name const &           name,
+                                IXMLDOMNamedNodeMap ** ppAttributes);
+
 //! Creates a node with a text sub-node. Returns an HRESULT.
 HRESULT CreateTextElement(IXMLDOMDocument2 * pDocument,
                           char const * sName, VARIANT const & value,
                           IXMLDOMElement ** ppResult);
 
+//! Creates a node with a text sub-node. Returns an HRESULT.
+HRESULT CreateTextElement(IXMLDOMDocument2 * pDocument,
+                          Name const & name, VARIANT const & value,
+                          IXMLDOMElement ** ppResult);
+
+//! The name and value of an element created by CreateTextElements().
+//!
+//! The name is referenced, not copied, so it must outlive the value.
+struct TextElementValue
+{
+    TextElementValue(Name const & name, std::string_view value) : name(name), value(value) {}
+
+    //! A temporary name would be destroyed before CreateTextElements() reads it.
+    TextElementValue(Name && name, std::string_view value) = delete;
+
+    Name const &     name;  //!< Name of the element
+    std::string_view value; //!< Value of the text (UTF-8)
+};
+
+//! Creates a fragment of elements, each with a text sub-node. Returns an HRESULT.
+HRESULT CreateTextElements(IXMLDOMDocument2 *         pDocument,
+                           TextElementValue const *   pValues,
+                           size_t                     count,
+                           IXMLDOMDocumentFragment ** ppResult);
+
+//! Creates a fragment of elements, each with a text sub-node. Returns an HRESULT.
+HRESULT CreateTextElements(IXMLDOMDocument2 *                    pDocument,
+                           std::vector<TextElementValue> const & values,
+                           IXMLDOMDocumentFragment **            ppResult);
+
+//! Creates a fragment of text elements for the bound sub-elements of an object. Returns an HRESULT.
+HRESULT CreateTextElements(IXMLDOMDocument2 *         pDocument,
+                           void const *               pObject,
+                           FieldDescriptor const *    pFields,
+                           size_t                     count,
+                           IXMLDOMDocumentFragment ** ppResult);
+
+//! Creates a fragment of text elements for the sub-elements of an object using a binding (see Msxmlx::Binding).
+template <typename T, size_t N>
+HRESULT CreateTextElements(IXMLDOMDocument2 *         pDocument,
+                           T const &                  object,
+                           Binding<T, N> const &      binding,
+                           IXMLDOMDocumentFragment ** ppResult)
+{
+    return CreateTextElements(pDocument, &object, binding.Declared(), N, ppResult);
+}
+
+//! Creates a fragment of text elements for the sub-elements of an object using Schema<T>.
+template <typename T>
+HRESULT CreateTextElements(IXMLDOMDocument2 * pDocument, T const & object, IXMLDOMDocumentFragment ** ppResult)
+{
+    return CreateTextElements(pDocument, object, Schema<T>::FIELDS, ppResult);
+}
+
 /********************************************************************************************************************/
 /*											A T T R I B U T E   V A L U E S											*/
 /********************************************************************************************************************/
@@ -44,35 +118,168 @@ HRESULT CreateTextElement(IXMLDOMDocument2 * pDocument,
 //! Returns the value of a string attribute (or a default value, if the attribute is not present).
 std::string GetStringAttribute(IXMLDOMElement * pElement, char const * sName, char const * sDefault = "");
 
+//! Returns the value of a string attribute (or a default value, if the attribute is not present).
+std::string GetStringAttribute(IXMLDOMElement * pElement, Name const & name, char const * sDefault = "");
+
 //! Returns the value of a string attribute (or a default value, if the attribute is not present).
 std::string GetStringAttribute(IXMLDOMNamedNodeMap * pAttributes,
                                char const *          sName,
                                char const *          sDefault = "");
 
-//! Returns the value of a float attribute (or a default value, if the attribute is not present).
+//! Returns the value of a string attribute (or a default value, if the attribute is not present).
+std::string GetStringAttribute(IXMLDOMNamedNodeMap * pAttributes,
+                               Name const &          name,
+                               char const *          sDefault = "");
+
+//! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
 float GetFloatAttribute(IXMLDOMElement * pElement, char const * sName, float fDefault = 0.f);
 
-//! Returns the value of a float attribute (or a default value, if the attribute is not present).
+//! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+float GetFloatAttribute(IXMLDOMElement * pElement, Name const & name, float fDefault = 0.f);
+
+//! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
 float GetFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, float fDefault = 0.f);
 
-//! Returns the value of an integer attribute (or a default value, if the attribute is not present).
+//! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+float GetFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, float fDefault = 0.f);
+
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
 int GetIntAttribute(IXMLDOMElement * pElement, char const * sName, int iDefault = 0);
 
-//! Returns the value of an integer attribute (or a default value, if the attribute is not present).
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+int GetIntAttribute(IXMLDOMElement * pElement, Name const & name, int iDefault = 0);
+
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
 int GetIntAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, int iDefault = 0);
 
-//! Returns the value of an integer attribute (or a default value, if the attribute is not present).
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+int GetIntAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, int iDefault = 0);
+
+//! Returns the value of a hexadecimal attribute (or a default value, if the attribute is not present or invalid).
 uint32_t GetHexAttribute(IXMLDOMElement * pElement, char const * sName, uint32_t iDefault = 0);
 
-//! Returns the value of an integer attribute (or a default value, if the attribute is not present).
+//! Returns the value of a hexadecimal attribute (or a default value, if the attribute is not present or invalid).
+uint32_t GetHexAttribute(IXMLDOMElement * pElement, Name const & name, uint32_t iDefault = 0);
+
+//! Returns the value of a hexadecimal attribute (or a default value, if the attribute is not present or invalid).
 uint32_t GetHexAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, uint32_t iDefault = 0);
 
-//! Returns the value of an integer attribute (or a default value, if the attribute is not present).
+//! Returns the value of a hexadecimal attribute (or a default value, if the attribute is not present or invalid).
+uint32_t GetHexAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, uint32_t iDefault = 0);
+
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
 bool GetBoolAttribute(IXMLDOMElement * pElement, char const * sName, bool bDefault = false);
 
-//! Returns the value of an integer attribute (or a default value, if the attribute is not present).
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+bool GetBoolAttribute(IXMLDOMElement * pElement, Name const & name, bool bDefault = false);
+
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
 bool GetBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, bool bDefault = false);
 
+//! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+bool GetBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, bool bDefault = false);
+
+//! Gets the value of a string attribute, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringAttribute(IXMLDOMElement * pElement, char const * sName, std::string * pValue);
+
+//! Gets the value of a string attribute, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringAttribute(IXMLDOMElement * pElement, Name const & name, std::string * pValue);
+
+//! Gets the value of a string attribute in a buffer. Returns S_FALSE if not present or E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryStringAttribute(IXMLDOMElement * pElement,
+                             Name const &     name,
+                             char *           pBuffer,
+                             size_t           size,
+                             size_t *         pLength = NULL);
+
+//! Gets the value of a string attribute, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, std::string * pValue);
+
+//! Gets the value of a string attribute, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, std::string * pValue);
+
+//! Gets the value of a string attribute in a buffer. Returns S_FALSE if not present or E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryStringAttribute(IXMLDOMNamedNodeMap * pAttributes,
+                             Name const &          name,
+                             char *                pBuffer,
+                             size_t                size,
+                             size_t *              pLength = NULL);
+
+//! Gets the value of a float attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatAttribute(IXMLDOMElement * pElement, char const * sName, float * pValue);
+
+//! Gets the value of a float attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatAttribute(IXMLDOMElement * pElement, Name const & name, float * pValue);
+
+//! Gets the value of a float attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, float * pValue);
+
+//! Gets the value of a float attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, float * pValue);
+
+//! Gets the value of an integer attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntAttribute(IXMLDOMElement * pElement, char const * sName, int * pValue);
+
+//! Gets the value of an integer attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntAttribute(IXMLDOMElement * pElement, Name const & name, int * pValue);
+
+//! Gets the value of an integer attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, int * pValue);
+
+//! Gets the value of an integer attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, int * pValue);
+
+//! Gets the value of a hex attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexAttribute(IXMLDOMElement * pElement, char const * sName, uint32_t * pValue);
+
+//! Gets the value of a hex attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexAttribute(IXMLDOMElement * pElement, Name const & name, uint32_t * pValue);
+
+//! Gets the value of a hex attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, uint32_t * pValue);
+
+//! Gets the value of a hex attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, uint32_t * pValue);
+
+//! Gets the value of a bool attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolAttribute(IXMLDOMElement * pElement, char const * sName, bool * pValue);
+
+//! Gets the value of a bool attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolAttribute(IXMLDOMElement * pElement, Name const & name, bool * pValue);
+
+//! Gets the value of a bool attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, bool * pValue);
+
+//! Gets the value of a bool attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, Name const & name, bool * pValue);
+
+//! Gets a list of floats from an attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatArrayAttribute(IXMLDOMElement * pElement, char const * sName, std::vector<float> * pValues);
+
+//! Gets a list of floats from an attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatArrayAttribute(IXMLDOMElement * pElement, Name const & name, std::vector<float> * pValues);
+
+//! Gets a list of floats from an attribute in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryFloatArrayAttribute(IXMLDOMElement * pElement, Name const & name, float * pValues, size_t * pCount);
+
+//! Gets a list of integers from an attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntArrayAttribute(IXMLDOMElement * pElement, char const * sName, std::vector<int> * pValues);
+
+//! Gets a list of integers from an attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntArrayAttribute(IXMLDOMElement * pElement, Name const & name, std::vector<int> * pValues);
+
+//! Gets a list of integers from an attribute in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryIntArrayAttribute(IXMLDOMElement * pElement, Name const & name, int * pValues, size_t * pCount);
+
+//! Gets a list of hex numbers from an attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexArrayAttribute(IXMLDOMElement * pElement, char const * sName, std::vector<uint32_t> * pValues);
+
+//! Gets a list of hex numbers from an attribute. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexArrayAttribute(IXMLDOMElement * pElement, Name const & name, std::vector<uint32_t> * pValues);
+
+//! Gets a list of hex numbers from an attribute in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryHexArrayAttribute(IXMLDOMElement * pElement, Name const & name, uint32_t * pValues, size_t * pCount);
+
 /********************************************************************************************************************/
 /*											E L E M E N T   V A L U E S												*/
 /********************************************************************************************************************/
@@ -80,21 +287,129 @@ bool GetBoolAttribute(IXMLDOMNamedNodeMap * pAttributes, char const * sName, boo
 //! Returns the first occurrence of text for a specific sub-element or nothing if error or not found.
 HRESULT GetSubElementValue(IXMLDOMElement * pElement, char const * sName, VARIANT * pValue);
 
+//! Returns the first occurrence of text for a specific sub-element or nothing if error or not found.
+HRESULT GetSubElementValue(IXMLDOMElement * pElement, Name const & name, VARIANT * pValue);
+
 //! Returns the value of a string sub-element (or a default value, if the sub-element is not present).
 std::string GetStringSubElement(IXMLDOMElement * pElement, char const * sName, char const * sDefault = "");
 
-//! Returns the value of a float sub-element (or a default value, if the sub-element is not present).
+//! Returns the value of a string sub-element (or a default value, if the sub-element is not present).
+std::string GetStringSubElement(IXMLDOMElement * pElement, Name const & name, char const * sDefault = "");
+
+//! Returns the value of a float sub-element (or a default value, if the sub-element is not present or invalid).
 float GetFloatSubElement(IXMLDOMElement * pElement, char const * sName, float fDefault = 0.f);
 
-//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present).
+//! Returns the value of a float sub-element (or a default value, if the sub-element is not present or invalid).
+float GetFloatSubElement(IXMLDOMElement * pElement, Name const & name, float fDefault = 0.f);
+
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
 int GetIntSubElement(IXMLDOMElement * pElement, char const * sName, int iDefault = 0);
 
-//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present).
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+int GetIntSubElement(IXMLDOMElement * pElement, Name const & name, int iDefault = 0);
+
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
 uint32_t GetHexSubElement(IXMLDOMElement * pElement, char const * sName, uint32_t iDefault = 0);
 
-//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present).
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+uint32_t GetHexSubElement(IXMLDOMElement * pElement, Name const & name, uint32_t iDefault = 0);
+
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
 bool GetBoolSubElement(IXMLDOMElement * pElement, char const * sName, bool bDefault = false);
 
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+bool GetBoolSubElement(IXMLDOMElement * pElement, Name const & name, bool bDefault = false);
+
+//! Gets the value of a string sub-element, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringSubElement(IXMLDOMElement * pElement, char const * sName, std::string * pValue);
+
+//! Gets the value of a string sub-element, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringSubElement(IXMLDOMElement * pElement, Name const & name, std::string * pValue);
+
+//! Gets the value of a string sub-element in a buffer. Returns S_FALSE if not present or E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryStringSubElement(IXMLDOMElement * pElement,
+                              Name const &     name,
+                              char *           pBuffer,
+                              size_t           size,
+                              size_t *         pLength = NULL);
+
+//! Gets the value of a float sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatSubElement(IXMLDOMElement * pElement, char const * sName, float * pValue);
+
+//! Gets the value of a float sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatSubElement(IXMLDOMElement * pElement, Name const & name, float * pValue);
+
+//! Gets the value of an integer sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntSubElement(IXMLDOMElement * pElement, char const * sName, int * pValue);
+
+//! Gets the value of an integer sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntSubElement(IXMLDOMElement * pElement, Name const & name, int * pValue);
+
+//! Gets the value of a hex sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexSubElement(IXMLDOMElement * pElement, char const * sName, uint32_t * pValue);
+
+//! Gets the value of a hex sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexSubElement(IXMLDOMElement * pElement, Name const & name, uint32_t * pValue);
+
+//! Gets the value of a bool sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolSubElement(IXMLDOMElement * pElement, char const * sName, bool * pValue);
+
+//! Gets the value of a bool sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolSubElement(IXMLDOMElement * pElement, Name const & name, bool * pValue);
+
+//! Gets a list of floats from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatArraySubElement(IXMLDOMElement * pElement, char const * sName, std::vector<float> * pValues);
+
+//! Gets a list of floats from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatArraySubElement(IXMLDOMElement * pElement, Name const & name, std::vector<float> * pValues);
+
+//! Gets a list of floats from a sub-element in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryFloatArraySubElement(IXMLDOMElement * pElement, Name const & name, float * pValues, size_t * pCount);
+
+//! Gets a list of integers from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntArraySubElement(IXMLDOMElement * pElement, char const * sName, std::vector<int> * pValues);
+
+//! Gets a list of integers from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntArraySubElement(IXMLDOMElement * pElement, Name const & name, std::vector<int> * pValues);
+
+//! Gets a list of integers from a sub-element in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryIntArraySubElement(IXMLDOMElement * pElement, Name const & name, int * pValues, size_t * pCount);
+
+//! Gets a list of hex numbers from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexArraySubElement(IXMLDOMElement * pElement, char const * sName, std::vector<uint32_t> * pValues);
+
+//! Gets a list of hex numbers from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexArraySubElement(IXMLDOMElement * pElement, Name const & name, std::vector<uint32_t> * pValues);
+
+//! Gets a list of hex numbers from a sub-element in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryHexArraySubElement(IXMLDOMElement * pElement, Name const & name, uint32_t * pValues, size_t * pCount);
+
+/********************************************************************************************************************/
+/*													P A T H S														*/
+/********************************************************************************************************************/
+
+//! Returns the element at a path (see Msxmlx::Path), or S_FALSE and NULL if not found. A final attribute is ignored.
+HRESULT SelectElement(IXMLDOMElement * pElement, Path const & path, IXMLDOMElement ** ppResult);
+
+//! Returns the value at a path: an attribute value, or the first text of an element. Returns S_FALSE if not found.
+HRESULT GetPathValue(IXMLDOMElement * pElement, Path const & path, VARIANT * pValue);
+
+//! Returns the value at a path converted to a type (or a default value, if it is not found or invalid).
+//!
+//! The type may be std::string, float, int, bool, or uint32_t, which is converted from hexadecimal text as with
+//! GetHexAttribute().
+template <typename T>
+T Get(IXMLDOMElement * pElement, Path const & path, T const & defaultValue)
+{
+    CComVariant value;
+    if (GetPathValue(pElement, path, &value) != S_OK ||
+        FAILED(VariantChangeTypeEx(&value, &value, LOCALE_INVARIANT, 0, VT_BSTR)))
+    {
+        return defaultValue;
+    }
+    return Detail::convertValue(std::wstring_view(value.bstrVal, SysStringLen(value.bstrVal)), defaultValue);
+}
+
 /********************************************************************************************************************/
 /*												E N U M E R A T I O N												*/
 /********************************************************************************************************************/
@@ -131,6 +446,419 @@ bool ForEachSubNode(IXMLDOMNode * pNode, ForEachNodeCB f);
 
 //! Calls a function for each element subnode and returns false if the function was aborted.
 bool ForEachSubElement(IXMLDOMNode * pNode, ForEachElementCB f);
+
+//! Calls a callable for each node in the list and returns false if it aborted the enumeration.
+template <typename F>
+bool ForEachNode(IXMLDOMNodeList * pNodeList, F && f);
+
+//! Calls a callable for each element in the list and returns false if it aborted the enumeration.
+template <typename F>
+bool ForEachElement(IXMLDOMNodeList * pNodeList, F && f);
+
+//! Calls a callable for each subnode and returns false if it aborted the enumeration.
+template <typename F>
+bool ForEachSubNode(IXMLDOMNode * pNode, F && f);
+
+//! Calls a callable for each element subnode and returns false if it aborted the enumeration.
+template <typename F>
+bool ForEachSubElement(IXMLDOMNode * pNode, F && f);
+
+/********************************************************************************************************************/
+/*													R A N G E S														*/
+/********************************************************************************************************************/
+
+//! Input iterator over the nodes of a node list.
+class NodeIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = IXMLDOMNode *;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = IXMLDOMNode * const *;
+    using reference         = IXMLDOMNode *;
+
+    //! Constructor. The iterator is the end of any list.
+    NodeIterator() = default;
+
+    //! Constructor. The iterator starts at the list's current position.
+    explicit NodeIterator(IXMLDOMNodeList * pNodeList);
+
+    IXMLDOMNode * operator *() const { return pNode_; }
+
+    NodeIterator & operator ++();
+
+    bool operator ==(NodeIterator const & rhs) const { return pNode_.p == rhs.pNode_.p; }
+    bool operator !=(NodeIterator const & rhs) const { return pNode_.p != rhs.pNode_.p; }
+
+private:
+    CComPtr<IXMLDOMNodeList> pNodeList_;
+    CComPtr<IXMLDOMNode>     pNode_;
+};
+
+//! The nodes of a node list, usable with range-for and standard algorithms. Iteration starts at the beginning.
+class NodeRange
+{
+public:
+    explicit NodeRange(IXMLDOMNodeList * pNodeList) : pNodeList_(pNodeList) {}
+
+    NodeIterator begin() const;
+    NodeIterator end() const { return NodeIterator(); }
+
+private:
+    CComPtr<IXMLDOMNodeList> pNodeList_;
+};
+
+//! Input iterator over the element children of a node, optionally only those with a specific name.
+//!
+//! The children are walked as siblings, so no node list is created. Only element nodes are converted to
+//! IXMLDOMElement.
+class ElementIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = IXMLDOMElement *;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = IXMLDOMElement * const *;
+    using reference         = IXMLDOMElement *;
+
+    //! Constructor. The iterator is the end of any range.
+    ElementIterator() = default;
+
+    //! Constructor. The iterator starts at the first matching node at or after the given node.
+    ElementIterator(IXMLDOMNode * pFirst, Name const * pName);
+
+    IXMLDOMElement * operator *() const { return pElement_; }
+
+    ElementIterator & operator ++();
+
+    bool operator ==(ElementIterator const & rhs) const { return pNode_.p == rhs.pNode_.p; }
+    bool operator !=(ElementIterator const & rhs) const { return pNode_.p != rhs.pNode_.p; }
+
+private:
+    void settle();
+
+    CComPtr<IXMLDOMNode>    pNode_;
+    CComPtr<IXMLDOMElement> pElement_;
+    Name const *            pName_ = nullptr;
+};
+
+//! The element children of a node, usable with range-for and standard algorithms.
+class ElementRange
+{
+public:
+    ElementRange(IXMLDOMNode * pParent, Name const * pName) : pParent_(pParent), pName_(pName) {}
+
+    ElementIterator begin() const;
+    ElementIterator end() const { return ElementIterator(); }
+
+private:
+    CComPtr<IXMLDOMNode> pParent_;
+    Name const *         pName_;
+};
+
+//! Returns the nodes of a list as a range.
+inline NodeRange Nodes(IXMLDOMNodeList * pNodeList)
+{
+    return NodeRange(pNodeList);
+}
+
+//! Returns the element children of a node as a range.
+inline ElementRange ChildElements(IXMLDOMNode * pNode)
+{
+    return ElementRange(pNode, nullptr);
+}
+
+//! Returns the element children of a node with a specific name as a range. The name must outlive the range.
+inline ElementRange ChildElementsNamed(IXMLDOMNode * pNode, Name const & name)
+{
+    return ElementRange(pNode, &name);
+}
+
+//! A temporary name would be destroyed before a range-for loop over the range starts.
+ElementRange ChildElementsNamed(IXMLDOMNode * pNode, Name && name) = delete;
+
+/********************************************************************************************************************/
+/*												C H I L D   I N D E X												*/
+/********************************************************************************************************************/
+
+//! An index of the sub-elements of an element by name.
+//!
+//! GetSubElement() scans the child list of an element each time it is called, so reading N sub-elements of an
+//! element with M children takes O(N*M) COM calls. A ChildIndex scans the child list once, on the first lookup, and
+//! then finds sub-elements with a hash lookup. It is opt-in: construct one for an element whose sub-elements are
+//! read repeatedly, and pass it to the ChildIndex overloads of the sub-element accessors.
+//!
+//! The index is not updated when the element's children change. Call Invalidate() after modifying them, and the
+//! index is rebuilt on the next lookup. A ChildIndex is not thread-safe.
+//!
+//! @code
+//!     Msxmlx::ChildIndex index(pEntity);
+//!     float x = Msxmlx::GetFloatSubElement(index, X, 0.f);
+//!     float y = Msxmlx::GetFloatSubElement(index, Y, 0.f);
+//! @endcode
+
+class ChildIndex
+{
+public:
+
+    //! Constructor. The index is built on the first lookup.
+    explicit ChildIndex(IXMLDOMElement * pElement) : pElement_(pElement) {}
+
+    //! Returns the indexed element.
+    IXMLDOMElement * Element() const { return pElement_; }
+
+    //! Discards the index. It will be rebuilt on the next lookup.
+    void Invalidate();
+
+    //! Discards the index and changes the indexed element.
+    void Reset(IXMLDOMElement * pElement);
+
+    //! Returns the first sub-element with the name, or NULL if not found.
+    HRESULT GetSubElement(Name const & name, IXMLDOMElement ** ppResult);
+
+    //! Calls a function for each sub-element with the name. Returns the error if the index could not be built.
+    HRESULT ForEachSubElement(Name const & name, ForEachElementCB f, bool * pCompleted = NULL);
+
+    //! Returns the number of element children, or the error if the index could not be built.
+    HRESULT Size(size_t * pCount);
+
+private:
+
+    static uint32_t constexpr NONE = 0xffffffff;
+
+    // A sub-element. Entries are in document order, and entries with the same hash are chained.
+    struct Entry
+    {
+        uint32_t                hash;
+        CComBSTR                tag;
+        CComPtr<IXMLDOMElement> pElement;
+        uint32_t                next; // Next entry with the same hash, or NONE
+    };
+
+    // First and last entries with a hash
+    struct Chain
+    {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    HRESULT build();
+
+    CComPtr<IXMLDOMElement>             pElement_;
+    bool                                built_ = false;
+    std::vector<Entry>                  entries_;
+    std::unordered_map<uint32_t, Chain> chains_;
+};
+
+//! Returns attributes for a specific sub-element or NULL if error or not found.
+HRESULT GetSubElementAttributes(ChildIndex & index, Name const & name, IXMLDOMNamedNodeMap ** ppAttributes);
+
+//! Returns the first occurrence of text for a specific sub-element or nothing if error or not found.
+HRESULT GetSubElementValue(ChildIndex & index, Name const & name, VARIANT * pValue);
+
+//! Returns the value of a string sub-element (or a default value, if the sub-element is not present).
+std::string GetStringSubElement(ChildIndex & index, Name const & name, char const * sDefault = "");
+
+//! Returns the value of a float sub-element (or a default value, if the sub-element is not present or invalid).
+float GetFloatSubElement(ChildIndex & index, Name const & name, float fDefault = 0.f);
+
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+int GetIntSubElement(ChildIndex & index, Name const & name, int iDefault = 0);
+
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+uint32_t GetHexSubElement(ChildIndex & index, Name const & name, uint32_t iDefault = 0);
+
+//! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+bool GetBoolSubElement(ChildIndex & index, Name const & name, bool bDefault = false);
+
+//! Gets the value of a string sub-element, reusing the memory of the string. Returns S_FALSE if not present.
+HRESULT QueryStringSubElement(ChildIndex & index, Name const & name, std::string * pValue);
+
+//! Gets the value of a string sub-element in a buffer. Returns S_FALSE if not present or E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryStringSubElement(ChildIndex &  index,
+                              Name const &  name,
+                              char *        pBuffer,
+                              size_t        size,
+                              size_t *      pLength = NULL);
+
+//! Gets the value of a float sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatSubElement(ChildIndex & index, Name const & name, float * pValue);
+
+//! Gets the value of an integer sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntSubElement(ChildIndex & index, Name const & name, int * pValue);
+
+//! Gets the value of a hex sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexSubElement(ChildIndex & index, Name const & name, uint32_t * pValue);
+
+//! Gets the value of a bool sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryBoolSubElement(ChildIndex & index, Name const & name, bool * pValue);
+
+//! Gets a list of floats from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryFloatArraySubElement(ChildIndex & index, Name const & name, std::vector<float> * pValues);
+
+//! Gets a list of floats from a sub-element in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryFloatArraySubElement(ChildIndex & index, Name const & name, float * pValues, size_t * pCount);
+
+//! Gets a list of integers from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryIntArraySubElement(ChildIndex & index, Name const & name, std::vector<int> * pValues);
+
+//! Gets a list of integers from a sub-element in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryIntArraySubElement(ChildIndex & index, Name const & name, int * pValues, size_t * pCount);
+
+//! Gets a list of hex numbers from a sub-element. Returns S_FALSE if not present or DISP_E_TYPEMISMATCH if invalid.
+HRESULT QueryHexArraySubElement(ChildIndex & index, Name const & name, std::vector<uint32_t> * pValues);
+
+//! Gets a list of hex numbers from a sub-element in an array. Also returns E_NOT_SUFFICIENT_BUFFER.
+HRESULT QueryHexArraySubElement(ChildIndex & index, Name const & name, uint32_t * pValues, size_t * pCount);
+
+/********************************************************************************************************************/
+/*													B I N D I N G													*/
+/********************************************************************************************************************/
+
+//! Stores the bound attributes of an element in an object. Returns DISP_E_TYPEMISMATCH if any value was invalid.
+HRESULT BindAttributes(IXMLDOMElement * pElement, void * pObject, FieldDescriptor const * pFields, size_t count);
+
+//! Stores the attributes of an element in an object using a binding (see Msxmlx::Binding).
+template <typename T, size_t N>
+HRESULT Bind(IXMLDOMElement * pElement, T & object, Binding<T, N> const & binding)
+{
+    return BindAttributes(pElement, &object, binding.Data(), binding.AttributeCount());
+}
+
+//! Stores the attributes of an element in an object using Schema<T>.
+template <typename T>
+HRESULT Bind(IXMLDOMElement * pElement, T & object)
+{
+    return Bind(pElement, object, Schema<T>::FIELDS);
+}
+
+//! Stores the bound attributes and sub-elements of an element in an object. Returns DISP_E_TYPEMISMATCH if any value
+//! was invalid.
+HRESULT DeserializeElement(IXMLDOMElement *        pElement,
+                           void *                  pObject,
+                           FieldDescriptor const * pFields,
+                           size_t                  attributeCount,
+                           size_t                  count);
+
+//! Deserializes an element into an object using a binding (see Msxmlx::Binding).
+template <typename T, size_t N>
+HRESULT Deserialize(IXMLDOMElement * pElement, T & object, Binding<T, N> const & binding)
+{
+    return DeserializeElement(pElement, &object, binding.Data(), binding.AttributeCount(), binding.Size());
+}
+
+//! Deserializes an element into an object using Schema<T>.
+template <typename T>
+HRESULT Deserialize(IXMLDOMElement * pElement, T & object)
+{
+    return Deserialize(pElement, object, Schema<T>::FIELDS);
+}
+
+//! Unlike the std::function overload, the callable can be inlined and nothing is allocated for its captures.
+//!
+//! @param    pNodeList    The node list to be enumerated.
+//! @param    f            The callable to call with each node (IXMLDOMNode *). It returns false to abort the
+//!                        enumeration.
+//!
+//! @return        false if the callable aborted the enumeration.
+
+template <typename F>
+bool ForEachNode(IXMLDOMNodeList * pNodeList, F && f)
+{
+    CComPtr<IXMLDOMNode> pNode;
+
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    for (pNodeList->nextNode(&pNode); pNode; pNodeList->nextNode(&pNode))
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (!f(static_cast<IXMLDOMNode *>(pNode)))
+            return false;
+
+        pNode.Release();
+    }
+
+    return true;
+}
+
+//! Unlike the std::function overload, the callable can be inlined and nothing is allocated for its captures.
+//!
+//! @param    pNodeList    The node list to be enumerated.
+//! @param    f            The callable to call with each element (IXMLDOMElement *). It returns false to abort the
+//!                        enumeration.
+//!
+//! @return        false if the callable aborted the enumeration.
+
+template <typename F>
+bool ForEachElement(IXMLDOMNodeList * pNodeList, F && f)
+{
+    CComPtr<IXMLDOMNode> pNode;
+
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    for (pNodeList->nextNode(&pNode); pNode; pNodeList->nextNode(&pNode))
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (IsElementNode(pNode))
+        {
+            CComQIPtr<IXMLDOMElement> pElement(pNode);
+            if (!f(static_cast<IXMLDOMElement *>(pElement)))
+                return false;
+        }
+
+        pNode.Release();
+    }
+
+    return true;
+}
+
+//! Unlike the std::function overload, the callable can be inlined and nothing is allocated for its captures. The
+//! subnodes are walked as siblings, so no node list is created.
+//!
+//! @param    pNode    The node whose subnodes are to be enumerated.
+//! @param    f        The callable to call with each subnode (IXMLDOMNode *). It returns false to abort the
+//!                    enumeration.
+//!
+//! @return        false if the callable aborted the enumeration.
+
+template <typename F>
+bool ForEachSubNode(IXMLDOMNode * pNode, F && f)
+{
+    CComPtr<IXMLDOMNode> pSubNode;
+    CComPtr<IXMLDOMNode> pNext;
+
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    for (pNode->get_firstChild(&pSubNode); pSubNode; pSubNode = pNext)
+    {
+        Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+        if (!f(static_cast<IXMLDOMNode *>(pSubNode)))
+            return false;
+
+        pNext.Release();
+        pSubNode->get_nextSibling(&pNext);
+    }
+
+    return true;
+}
+
+//! Unlike the std::function overload, the callable can be inlined and nothing is allocated for its captures. The
+//! subnodes are walked as siblings, so no node list is created.
+//!
+//! @param    pNode    The node whose subnodes are to be enumerated.
+//! @param    f        The callable to call with each element subnode (IXMLDOMElement *). It returns false to abort
+//!                    the enumeration.
+//!
+//! @return        false if the callable aborted the enumeration.
+
+template <typename F>
+bool ForEachSubElement(IXMLDOMNode * pNode, F && f)
+{
+    for (IXMLDOMElement * pElement : ChildElements(pNode))
+    {
+        if (!f(pElement))
+            return false;
+    }
+
+    return true;
+}
 } // namespace Msxmlx
 
 #endif // !defined(MSXMLX_MSXMLX_H)
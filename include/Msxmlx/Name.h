@@ -0,0 +1,87 @@
+#pragma once
+
+#if !defined(MSXMLX_NAME_H)
+#define MSXMLX_NAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//! Pre-converted element and attribute names.
+
+namespace Msxmlx
+{
+//! An element or attribute name, converted once for repeated lookups.
+//!
+//! A name holds the original (UTF-8) text, a wide version and a hash. The wide version is laid out like a BSTR (a
+//! 32-bit byte count followed by the characters and a terminating 0), so it can be passed to MSXML as an [in] BSTR
+//! parameter without allocating a CComBSTR for each call. Names are intended to be constructed once and reused:
+//!
+//! @code
+//!     static Msxmlx::Name const RESOLUTION("resolution");
+//!     int resolution = Msxmlx::GetIntAttribute(pShadows, RESOLUTION, 1024);
+//! @endcode
+//!
+//! The hash is a constexpr function, so a hash can also be computed at compile time from a string literal, for
+//! example to switch on names: @code case Msxmlx::Name::Hash("entity"): @endcode
+//!
+//! A name that has been moved from is empty.
+
+class Name
+{
+public:
+
+    //! Constructor.
+    explicit Name(std::string_view name);
+
+    Name(Name const & rhs) : Name(rhs.narrow_) {}
+    Name(Name && rhs) noexcept;
+    Name & operator =(Name const & rhs);
+    Name & operator =(Name && rhs) noexcept;
+
+    //! Returns the name.
+    std::string_view Narrow() const { return narrow_; }
+
+    //! Returns the wide version of the name. It is a valid BSTR, which is empty if the name has been moved from.
+    wchar_t const * Wide() const;
+
+    //! Returns the number of characters in the wide version of the name.
+    size_t WideLength() const { return wideLength_; }
+
+    //! Returns the hash of the name.
+    uint32_t Hash() const { return hash_; }
+
+    //! Returns true if the wide text matches the name.
+    bool Matches(wchar_t const * wide, size_t length) const;
+
+    //! Returns the name, so that a Name can be used wherever a std::string_view is expected.
+    operator std::string_view() const { return narrow_; }
+
+    //! Computes the hash of a name (32-bit FNV-1a of the UTF-8 text).
+    static constexpr uint32_t Hash(std::string_view name)
+    {
+        uint32_t hash = 2166136261u;
+        for (char c : name)
+        {
+            hash = (hash ^ uint8_t(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    //! Computes the hash of a wide name. The result is the same as the hash of the name's UTF-8 text.
+    static uint32_t Hash(wchar_t const * wide, size_t length);
+
+    bool operator ==(Name const & rhs) const { return hash_ == rhs.hash_ && narrow_ == rhs.narrow_; }
+    bool operator !=(Name const & rhs) const { return !(*this == rhs); }
+
+private:
+    std::string narrow_;
+    std::unique_ptr<std::byte[]> wide_; // Byte count followed by the characters, as in a BSTR
+    size_t wideLength_;
+    uint32_t hash_;
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_NAME_H)
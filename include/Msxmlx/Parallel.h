@@ -0,0 +1,319 @@
+#pragma once
+
+#if !defined(MSXMLX_PARALLEL_H)
+#define MSXMLX_PARALLEL_H
+
+#include "CompactDocument.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//! Parallel algorithms over the elements of a CompactDocument.
+
+// A CompactDocument is immutable once it has been parsed and its accessors do not modify it, so any number of threads
+// may read it at once. The functions below distribute the children or the descendants of an element over the
+// threads of a ThreadPool.
+//
+// The grain size is the number of elements processed by a thread before it looks for more work. Larger grains reduce
+// the overhead of scheduling, and smaller grains balance the load better when the work per element varies.
+//
+//      Msxmlx::CompactDocument document;
+//      document.Parse(text);
+//
+//      std::vector<Mesh> meshes = Msxmlx::TransformSubElements(document, document.Root(), [&] (auto mesh) {
+//          return LoadMesh(document, mesh);
+//      });
+//
+//      size_t count = Msxmlx::TransformReduceDescendants(document, document.Root(), size_t(0), std::plus<>(),
+//          [&] (auto element) { return size_t(document.Name(element) == "light"); }, 256);
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*													E N U M E R A T I O N													*/
+/********************************************************************************************************************/
+
+//! Calls a function for each sub-element in parallel and returns false if the function aborted.
+template <typename F>
+bool ForEachSubElementParallel(CompactDocument const & document,
+                               CompactDocument::Index  element,
+                               F                       f,
+                               size_t                  grain = 1,
+                               ThreadPool &            pool  = ThreadPool::Default());
+
+//! Calls a function for each descendant of an element in parallel and returns false if the function aborted.
+template <typename F>
+bool ForEachDescendantParallel(CompactDocument const & document,
+                               CompactDocument::Index  element,
+                               F                       f,
+                               size_t                  grain = 64,
+                               ThreadPool &            pool  = ThreadPool::Default());
+
+/********************************************************************************************************************/
+/*													T R A N S F O R M   /   R E D U C E													*/
+/********************************************************************************************************************/
+
+//! Transforms each sub-element in parallel and returns the results in document order.
+template <typename Transform>
+auto TransformSubElements(CompactDocument const & document,
+                          CompactDocument::Index  element,
+                          Transform               transform,
+                          size_t                  grain = 1,
+                          ThreadPool &            pool  = ThreadPool::Default())
+    -> std::vector<std::decay_t<std::invoke_result_t<Transform &, CompactDocument::Index>>>;
+
+//! Transforms each sub-element and combines the results in parallel.
+template <typename T, typename Reduce, typename Transform>
+T TransformReduceSubElements(CompactDocument const & document,
+                             CompactDocument::Index  element,
+                             T                       init,
+                             Reduce                  reduce,
+                             Transform               transform,
+                             size_t                  grain = 1,
+                             ThreadPool &            pool  = ThreadPool::Default());
+
+//! Transforms each descendant of an element and combines the results in parallel.
+template <typename T, typename Reduce, typename Transform>
+T TransformReduceDescendants(CompactDocument const & document,
+                             CompactDocument::Index  element,
+                             T                       init,
+                             Reduce                  reduce,
+                             Transform               transform,
+                             size_t                  grain = 64,
+                             ThreadPool &            pool  = ThreadPool::Default());
+
+/********************************************************************************************************************/
+/*													I M P L E M E N T A T I O N													*/
+/********************************************************************************************************************/
+
+namespace Detail
+{
+// Returns the sub-elements of an element
+inline std::vector<CompactDocument::Index> subElements(CompactDocument const & document, CompactDocument::Index element)
+{
+    std::vector<CompactDocument::Index> children;
+    document.ForEachSubElement(element, [&children] (CompactDocument::Index child) {
+        children.push_back(child);
+        return true;
+    });
+    return children;
+}
+
+// Returns the index following the last descendant of an element. Elements are stored in document order, so the
+// descendants of an element are the elements between it and this index.
+inline CompactDocument::Index subtreeEnd(CompactDocument const & document, CompactDocument::Index element)
+{
+    for (CompactDocument::Index e = element; e != CompactDocument::NONE; e = document.Parent(e))
+    {
+        if (document.NextSibling(e) != CompactDocument::NONE)
+            return document.NextSibling(e);
+    }
+    return CompactDocument::Index(document.Size());
+}
+
+// Calls f(element(i)) for i in [0, count) in parallel, until f returns false
+template <typename Element, typename F>
+bool forEachParallel(size_t count, Element element, F & f, size_t grain, ThreadPool & pool)
+{
+    std::atomic<bool> aborted{ false };
+    pool.ParallelFor(0, count, grain, [&] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !aborted.load(std::memory_order_relaxed); ++i)
+        {
+            if (!f(element(i)))
+                aborted.store(true, std::memory_order_relaxed);
+        }
+    });
+    return !aborted.load();
+}
+
+// Reduces transform(element(i)) for i in [0, count). Each block of grain elements is reduced in order by one thread
+// and the results of the blocks are combined in order, so the result does not depend on the scheduling.
+template <typename T, typename Element, typename Reduce, typename Transform>
+T transformReduceParallel(size_t       count,
+                          Element      element,
+                          T            init,
+                          Reduce &     reduce,
+                          Transform &  transform,
+                          size_t       grain,
+                          ThreadPool & pool)
+{
+    if (grain == 0)
+        grain = 1;
+
+    std::vector<std::optional<T>> partials((count + grain - 1) / grain);
+    pool.ParallelFor(0, partials.size(), 1, [&] (size_t first, size_t last) {
+        for (size_t block = first; block < last; ++block)
+        {
+            size_t begin = block * grain;
+            size_t end   = (count - begin > grain) ? begin + grain : count;
+
+            T partial = transform(element(begin));
+            for (size_t i = begin + 1; i < end; ++i)
+            {
+                partial = reduce(std::move(partial), transform(element(i)));
+            }
+            partials[block].emplace(std::move(partial));
+        }
+    });
+
+    for (std::optional<T> & partial : partials)
+    {
+        init = reduce(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+} // namespace Detail
+
+//! The function may be called for several sub-elements at once, in any order. If it aborts, sub-elements that have
+//! not been started are skipped.
+//!
+//! @param    document    The document
+//! @param    element     The element whose sub-elements are to be enumerated
+//! @param    f           The function to call for each sub-element. It is called with the index of the sub-element
+//!                       and returns false to abort the enumeration.
+//! @param    grain       Number of sub-elements processed by a thread at a time
+//! @param    pool        The threads
+//!
+//! @return        false, if the function aborted the enumeration
+
+template <typename F>
+bool ForEachSubElementParallel(CompactDocument const & document,
+                               CompactDocument::Index  element,
+                               F                       f,
+                               size_t                  grain /* = 1*/,
+                               ThreadPool &            pool /* = ThreadPool::Default()*/)
+{
+    std::vector<CompactDocument::Index> children = Detail::subElements(document, element);
+    return Detail::forEachParallel(children.size(), [&children] (size_t i) { return children[i]; }, f, grain, pool);
+}
+
+//! The function may be called for several descendants at once, in any order. If it aborts, descendants that have not
+//! been started are skipped.
+//!
+//! @param    document    The document
+//! @param    element     The element whose descendants are to be enumerated
+//! @param    f           The function to call for each descendant. It is called with the index of the descendant
+//!                       and returns false to abort the enumeration.
+//! @param    grain       Number of descendants processed by a thread at a time
+//! @param    pool        The threads
+//!
+//! @return        false, if the function aborted the enumeration
+
+template <typename F>
+bool ForEachDescendantParallel(CompactDocument const & document,
+                               CompactDocument::Index  element,
+                               F                       f,
+                               size_t                  grain /* = 64*/,
+                               ThreadPool &            pool /* = ThreadPool::Default()*/)
+{
+    if (element == CompactDocument::NONE)
+        return true;
+
+    CompactDocument::Index first = element + 1;
+    CompactDocument::Index end   = Detail::subtreeEnd(document, element);
+    auto descendant = [first] (size_t i) { return CompactDocument::Index(first + i); };
+    return Detail::forEachParallel(end - first, descendant, f, grain, pool);
+}
+
+//! @param    document     The document
+//! @param    element      The element whose sub-elements are to be transformed
+//! @param    transform    The function to call for each sub-element. It is called with the index of the sub-element
+//!                        and may be called for several sub-elements at once.
+//! @param    grain        Number of sub-elements processed by a thread at a time
+//! @param    pool         The threads
+//!
+//! @return        The result of the function for each sub-element, in document order
+
+template <typename Transform>
+auto TransformSubElements(CompactDocument const & document,
+                          CompactDocument::Index  element,
+                          Transform               transform,
+                          size_t                  grain /* = 1*/,
+                          ThreadPool &            pool /* = ThreadPool::Default()*/)
+    -> std::vector<std::decay_t<std::invoke_result_t<Transform &, CompactDocument::Index>>>
+{
+    using Result = std::decay_t<std::invoke_result_t<Transform &, CompactDocument::Index>>;
+
+    std::vector<CompactDocument::Index> children = Detail::subElements(document, element);
+
+    // The results are not written directly into the vector, because std::vector<bool> packs its elements into bits
+    // and threads writing neighbouring elements would race.
+    std::unique_ptr<Result[]> buffer(new Result[children.size()]);
+    pool.ParallelFor(0, children.size(), grain, [&] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            buffer[i] = transform(children[i]);
+        }
+    });
+    return std::vector<Result>(std::make_move_iterator(buffer.get()),
+                               std::make_move_iterator(buffer.get() + children.size()));
+}
+
+//! The sub-elements are combined in document order, though not sequentially, so the reduction must be associative,
+//! but it need not be commutative. The result does not depend on the number of threads.
+//!
+//! @param    document     The document
+//! @param    element      The element whose sub-elements are to be transformed
+//! @param    init         The initial value
+//! @param    reduce       The function that combines two values
+//! @param    transform    The function to call for each sub-element. It is called with the index of the sub-element
+//!                        and may be called for several sub-elements at once.
+//! @param    grain        Number of sub-elements processed by a thread at a time
+//! @param    pool         The threads
+//!
+//! @return        The initial value combined with the result of the transform for each sub-element
+
+template <typename T, typename Reduce, typename Transform>
+T TransformReduceSubElements(CompactDocument const & document,
+                             CompactDocument::Index  element,
+                             T                       init,
+                             Reduce                  reduce,
+                             Transform               transform,
+                             size_t                  grain /* = 1*/,
+                             ThreadPool &            pool /* = ThreadPool::Default()*/)
+{
+    std::vector<CompactDocument::Index> children = Detail::subElements(document, element);
+    return Detail::transformReduceParallel(children.size(), [&children] (size_t i) { return children[i]; },
+                                           std::move(init), reduce, transform, grain, pool);
+}
+
+//! The descendants are combined in document order, though not sequentially, so the reduction must be associative,
+//! but it need not be commutative. The result does not depend on the number of threads.
+//!
+//! @param    document     The document
+//! @param    element      The element whose descendants are to be transformed
+//! @param    init         The initial value
+//! @param    reduce       The function that combines two values
+//! @param    transform    The function to call for each descendant. It is called with the index of the descendant
+//!                        and may be called for several descendants at once.
+//! @param    grain        Number of descendants processed by a thread at a time
+//! @param    pool         The threads
+//!
+//! @return        The initial value combined with the result of the transform for each descendant
+
+template <typename T, typename Reduce, typename Transform>
+T TransformReduceDescendants(CompactDocument const & document,
+                             CompactDocument::Index  element,
+                             T                       init,
+                             Reduce                  reduce,
+                             Transform               transform,
+                             size_t                  grain /* = 64*/,
+                             ThreadPool &            pool /* = ThreadPool::Default()*/)
+{
+    if (element == CompactDocument::NONE)
+        return init;
+
+    CompactDocument::Index first = element + 1;
+    CompactDocument::Index end   = Detail::subtreeEnd(document, element);
+    auto descendant = [first] (size_t i) { return CompactDocument::Index(first + i); };
+    return Detail::transformReduceParallel(end - first, descendant, std::move(init), reduce, transform, grain, pool);
+}
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_PARALLEL_H)
@@ -0,0 +1,227 @@
+#pragma once
+
+#if !defined(MSXMLX_PATH_H)
+#define MSXMLX_PATH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "CompactDocument.h"
+#include "Convert.h"
+#include "Name.h"
+
+//! Precompiled paths to elements and attributes.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*														P A T H														*/
+/********************************************************************************************************************/
+
+//! A compiled path from an element to a sub-element or an attribute, such as "render/shadows/@resolution".
+//!
+//! A path is a sequence of steps separated by '/', each naming a sub-element of the previous one. A step may select
+//! the nth sub-element with the name (counting from 1, as in XPath) with a position, as in "light[2]". The last step
+//! may instead name an attribute, as in "@resolution". An empty path refers to the element itself.
+//!
+//! The path is parsed and its names are converted once, when it is compiled, so a path is intended to be compiled once
+//! and evaluated many times. Evaluating it against a CompactDocument looks each name up once and then compares
+//! sub-elements and attributes by their interned name ids, with no string comparisons. Get() replaces a chain of
+//! GetSubElement() and Get*Attribute() calls:
+//!
+//! @code
+//!     static Msxmlx::Path const RESOLUTION = Msxmlx::Path::Compile("render/shadows/@resolution");
+//!     int resolution = Msxmlx::Get<int>(document, document.Root(), RESOLUTION, 1024);
+//! @endcode
+
+class Path
+{
+public:
+
+    //! A step to a sub-element.
+    struct Step
+    {
+        Name     name;     //!< Name of the sub-element
+        uint32_t position; //!< Position among the sub-elements with the name, counting from 1
+    };
+
+    //! Compiles a path. If the path is not valid, the result is never found (see IsValid()).
+    static Path Compile(std::string_view text);
+
+    //! Returns true if the path compiled successfully.
+    bool IsValid() const { return error_ == nullptr; }
+
+    //! Returns a description of the error if the path did not compile.
+    char const * ErrorMessage() const { return error_; }
+
+    //! Returns the text of the path.
+    std::string_view Text() const { return text_; }
+
+    //! Returns the steps to sub-elements.
+    std::vector<Step> const & Steps() const { return steps_; }
+
+    //! Returns true if the path ends with an attribute.
+    bool HasAttribute() const { return attribute_.has_value(); }
+
+    //! Returns the name of the attribute at the end of the path. It must have one.
+    Name const & Attribute() const { return *attribute_; }
+
+private:
+
+    std::string text_;
+    std::vector<Step> steps_;
+    std::optional<Name> attribute_;
+    char const * error_ = nullptr;
+};
+
+namespace Detail
+{
+// Converts the text of a value to a type supported by Get(). A uint32_t is hexadecimal, as with GetHexAttribute().
+// Returns false, leaving the value unchanged, if the text is not valid. Any text is a valid string.
+template <typename T, typename Text>
+bool parseValue(Text text, T & value)
+{
+    if constexpr (std::is_same_v<T, std::string>)
+    {
+        if constexpr (std::is_same_v<Text, std::string_view>)
+            value.assign(text);
+        else
+            ToUtf8(text, value);
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, float>)
+    {
+        return ParseFloat(text, value);
+    }
+    else if constexpr (std::is_same_v<T, int>)
+    {
+        return ParseInt(text, value);
+    }
+    else if constexpr (std::is_same_v<T, uint32_t>)
+    {
+        return ParseHex(text, value);
+    }
+    else if constexpr (std::is_same_v<T, bool>)
+    {
+        return ParseBool(text, value);
+    }
+    else
+    {
+        static_assert(std::is_same_v<T, void>, "Get() supports std::string, float, int, uint32_t (hex) and bool");
+        return false;
+    }
+}
+
+// Converts the text of a value to a type supported by Get(), or returns a default value if the text is not valid
+template <typename T, typename Text>
+T convertValue(Text text, T const & defaultValue)
+{
+    T value = defaultValue;
+    parseValue(text, value);
+    return value;
+}
+} // namespace Detail
+
+//! Returns the element at a path, or NONE if it is not found. An attribute at the end of the path is ignored.
+CompactDocument::Index Select(CompactDocument const & document, CompactDocument::Index element, Path const & path);
+
+//! Returns the raw value at a path: an attribute value, or the value of an element. Returns false if not found.
+bool Find(CompactDocument const & document,
+          CompactDocument::Index  element,
+          Path const &            path,
+          std::string_view &      value);
+
+//! Returns the value at a path converted to a type (or a default value, if it is not found or invalid).
+//!
+//! The type may be std::string, float, int, bool, or uint32_t, which is converted from hexadecimal text as with
+//! GetHexAttribute().
+template <typename T>
+T Get(CompactDocument const & document, CompactDocument::Index element, Path const & path, T const & defaultValue)
+{
+    std::string_view text;
+    return Find(document, element, path, text) ? Detail::convertValue(text, defaultValue) : defaultValue;
+}
+
+/********************************************************************************************************************/
+/*													P A T H   S E T													*/
+/********************************************************************************************************************/
+
+//! A set of paths evaluated together in one traversal of a document.
+//!
+//! The paths are merged into a tree, so steps shared by several paths are taken once. Evaluating the set looks up
+//! each distinct name once, visits each element on the paths once, and scans the sub-elements and attributes of each
+//! visited element once for all of the paths that pass through it.
+//!
+//! @code
+//!     Msxmlx::PathSet settings;
+//!     size_t const RESOLUTION = settings.Add(Msxmlx::Path::Compile("render/shadows/@resolution"));
+//!     size_t const DISTANCE   = settings.Add(Msxmlx::Path::Compile("render/shadows/distance"));
+//!
+//!     std::vector<Msxmlx::PathSet::Result> results;
+//!     settings.Evaluate(document, document.Root(), results);
+//!     int   resolution = results[RESOLUTION].As<int>(1024);
+//!     float distance   = results[DISTANCE].As<float>(100.f);
+//! @endcode
+
+class PathSet
+{
+public:
+
+    //! The result of a path.
+    struct Result
+    {
+        CompactDocument::Index element; //!< The element at the path (or that has the attribute), or NONE
+        std::string_view       value;   //!< The attribute value, or the value of the element
+        bool                   found;   //!< True if the path was found
+
+        //! Returns the value converted to a type supported by Get() (or a default value, if not found or invalid).
+        template <typename T>
+        T As(T const & defaultValue) const
+        {
+            return found ? Detail::convertValue(value, defaultValue) : defaultValue;
+        }
+    };
+
+    //! Adds a path and returns the index of its result. A path that is not valid is never found.
+    size_t Add(Path const & path);
+
+    //! Returns the number of paths.
+    size_t Size() const { return resultCount_; }
+
+    //! Evaluates all of the paths from an element. The results are in the order in which the paths were added.
+    void Evaluate(CompactDocument const & document,
+                  CompactDocument::Index  element,
+                  std::vector<Result> &   results) const;
+
+private:
+
+    // A step shared by one or more paths
+    struct Node
+    {
+        uint32_t              name;       // Index in names_
+        uint32_t              position;
+        std::vector<uint32_t> children;   // Indices in nodes_
+        std::vector<uint32_t> results;    // Results of the paths that end at this element
+        std::vector<uint32_t> attributes; // Pairs of an index in names_ and a result, for paths ending in attributes
+    };
+
+    uint32_t intern(std::string_view name);
+    void visit(CompactDocument const & document,
+               uint32_t                node,
+               CompactDocument::Index  element,
+               uint32_t const *        pIds,
+               uint32_t *              pCounts,
+               Result *                pResults) const;
+
+    std::vector<Node> nodes_ = std::vector<Node>(1); // The first node is the element the paths start from
+    std::vector<std::string> names_;
+    size_t resultCount_ = 0;
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_PATH_H)
@@ -0,0 +1,96 @@
+#pragma once
+
+#if !defined(MSXMLX_PUSHPARSER_H)
+#define MSXMLX_PUSHPARSER_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include "CompactDocument.h"
+#include "StreamReader.h"
+
+//! Incremental parsing of documents that arrive in pieces.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*												P U S H   P A R S E R												*/
+/********************************************************************************************************************/
+
+//! A parser that is given a document in pieces, split anywhere, as they arrive.
+//!
+//! Each call to Feed() parses as much of the document as it can and reports the events to a handler, exactly as
+//! ParseStream() would for the whole document. Alternatively, the parser builds a CompactDocument as the data
+//! arrives, which is the same as one built by CompactDocument::Parse() from the whole document. Either way, the
+//! document is never held in full: only an incomplete token at the end of a piece and the names of the open elements
+//! are kept from one call to the next. A piece is not referenced after Feed() returns.
+//!
+//! Long text may be reported in several parts, as with StreamReader. A handler may skip an element with
+//! StreamReader::Skip(), even if the rest of the element has not arrived yet, but must not use ForEachSubElement().
+//!
+//! @code
+//!     Msxmlx::CompactDocument document;
+//!     Msxmlx::PushParser      parser(document);
+//!     while ((n = recv(socket, buffer, sizeof(buffer), 0)) > 0)
+//!     {
+//!         if (!parser.Feed(buffer, size_t(n)))
+//!             return parser.ErrorMessage();
+//!     }
+//!     if (!parser.Finish())
+//!         return parser.ErrorMessage();
+//! @endcode
+
+class PushParser
+{
+public:
+
+    //! Constructor. Events are reported to a handler.
+    explicit PushParser(SaxHandler & handler,
+                        size_t        bufferSize    = StreamReader::DEFAULT_BUFFER_SIZE,
+                        size_t        maxBufferSize = StreamReader::DEFAULT_MAX_BUFFER_SIZE);
+
+    //! Constructor. A document is built, and replaces the contents of the given document when Finish() succeeds.
+    explicit PushParser(CompactDocument & document,
+                        size_t            bufferSize    = StreamReader::DEFAULT_BUFFER_SIZE,
+                        size_t            maxBufferSize = StreamReader::DEFAULT_MAX_BUFFER_SIZE);
+
+    ~PushParser();
+
+    PushParser(PushParser const &) = delete;
+    PushParser & operator =(PushParser const &) = delete;
+
+    //! Parses the next piece of the document. Returns false if the handler stopped or there was an error.
+    bool Feed(char const * pData, size_t size);
+
+    //! Parses the next piece of the document. Returns false if the handler stopped or there was an error.
+    bool Feed(std::string_view data) { return Feed(data.data(), data.size()); }
+
+    //! Ends the document. Returns false if the handler stopped, there was an error, or the document is incomplete.
+    bool Finish();
+
+    //! Returns a description of the error if the document is not well-formed or the document could not be built.
+    char const * ErrorMessage() const;
+
+    //! Returns the offset in the document of the current position.
+    uint64_t Offset() const { return reader_.Offset(); }
+
+private:
+
+    class DocumentHandler;
+
+    StreamReader::Source source();
+    bool run();
+
+    StreamReader                     reader_;
+    std::unique_ptr<DocumentHandler> pDocumentHandler_; // Builds the document, if there is one
+    SaxHandler &                     handler_;
+    char const *                     pData_    = nullptr; // The rest of the current piece
+    size_t                           size_     = 0;
+    bool                             finished_ = false;
+    bool                             stopped_  = false;
+    int                              skipping_ = -1;      // Depth of an element being skipped by the handler, or -1
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_PUSHPARSER_H)
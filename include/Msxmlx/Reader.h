@@ -0,0 +1,347 @@
+#pragma once
+
+#if !defined(MSXMLX_READER_H)
+#define MSXMLX_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Instrumentation.h"
+
+//! Portable zero-copy XML pull parser.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*												A T T R I B U T E S													*/
+/********************************************************************************************************************/
+
+//! An attribute of a start tag.
+//!
+//! The value is the raw text between the quotes. Entity references are not expanded (see Unescape()).
+struct Attribute
+{
+    std::string_view name;  //!< Name of the attribute
+    std::string_view value; //!< Raw value of the attribute
+};
+
+//! Forward iterator over the attributes of a start tag.
+class AttributeIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Attribute;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = Attribute const *;
+    using reference         = Attribute const &;
+
+    //! Constructor. The range must be the validated attribute section of a start tag.
+    AttributeIterator(char const * pBegin, char const * pEnd);
+
+    reference operator *() const { return current_; }
+    pointer   operator ->() const { return &current_; }
+
+    AttributeIterator & operator ++();
+    AttributeIterator   operator ++(int);
+
+    bool operator ==(AttributeIterator const & rhs) const { return cursor_ == rhs.cursor_; }
+    bool operator !=(AttributeIterator const & rhs) const { return cursor_ != rhs.cursor_; }
+
+private:
+    void load(char const * pNext);
+
+    char const * cursor_; // Start of the current attribute, or end_ if there are no more
+    char const * next_;   // Start of the text following the current attribute
+    char const * end_;
+    Attribute current_;
+};
+
+//! The attributes of a start tag, usable with range-for.
+//!
+//! The typed accessors are those of Reader, so that attributes can be converted wherever a start tag is reported.
+class AttributeRange
+{
+public:
+    AttributeRange(char const * pBegin, char const * pEnd) : begin_(pBegin), end_(pEnd) {}
+
+    AttributeIterator begin() const { return AttributeIterator(begin_, end_); }
+    AttributeIterator end() const { return AttributeIterator(end_, end_); }
+
+    //! Returns the raw value of an attribute. Returns false if not found.
+    bool FindAttribute(std::string_view sName, std::string_view & value) const;
+
+    //! Returns the value of a string attribute (or a default value, if the attribute is not present).
+    std::string GetStringAttribute(std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+    float GetFloatAttribute(std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+    int GetIntAttribute(std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex attribute (or a default value, if the attribute is not present or invalid).
+    uint32_t GetHexAttribute(std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool attribute (or a default value, if the attribute is not present or invalid).
+    bool GetBoolAttribute(std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of an attribute that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArrayAttribute(std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of an attribute that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArrayAttribute(std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArrayAttribute(std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of an attribute that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArrayAttribute(std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArrayAttribute(std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArrayAttribute(std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+private:
+    char const * begin_;
+    char const * end_;
+};
+
+//! Expands the entity and character references in raw text, appending the result to a string.
+bool Unescape(std::string_view raw, std::string & out);
+
+/********************************************************************************************************************/
+/*													R E A D E R														*/
+/********************************************************************************************************************/
+
+//! A zero-copy pull parser.
+//!
+//! The reader parses a document held in a caller-owned buffer (possibly a memory-mapped file, see MappedFile) one
+//! token at a time. Names, attribute values and text are returned as slices of the buffer, so the buffer must
+//! outlive the reader and anything returned by it. Nothing is allocated per node.
+//!
+//! Comments, processing instructions, the XML declaration and the DOCTYPE are skipped. Whitespace-only text is
+//! reported by Next(), but ignored by the sub-element accessors, which matches MSXML's default of not preserving
+//! whitespace.
+//!
+//! The typed accessors mirror the MSXML-based accessors in Msxmlx.h. Attribute accessors apply to the current
+//! start tag. Sub-element accessors look ahead into the content of the current element without moving the reader.
+//!
+//! @code
+//!     Msxmlx::Reader reader(text);
+//!     if (reader.Next() == Msxmlx::Reader::Token::StartElement)
+//!     {
+//!         int version = reader.GetIntAttribute("version");
+//!         reader.ForEachSubElement([] (Msxmlx::Reader & entity) { ...; return true; });
+//!     }
+//! @endcode
+
+class Reader
+{
+public:
+
+    //! Type of token returned by Next()
+    enum class Token
+    {
+        None,           //!< Next() has not been called yet
+        StartElement,   //!< A start tag or an empty-element tag
+        EndElement,     //!< An end tag (also reported after an empty-element tag)
+        Text,           //!< Character data
+        CData,          //!< A CDATA section
+        End,            //!< The end of the document
+        Error           //!< The document is not well-formed. See ErrorMessage().
+    };
+
+    //! Constructor.
+    explicit Reader(std::string_view document);
+
+    //! Constructor.
+    Reader(char const * pData, size_t size) : Reader(std::string_view(pData, size)) {}
+
+    //! Advances to the next token and returns its type.
+    Token Next();
+
+    //! Returns the type of the current token.
+    Token Current() const { return token_; }
+
+    //! Returns the name of the current element (StartElement and EndElement only).
+    std::string_view Name() const { return name_; }
+
+    //! Returns the raw content of the current Text or CData token.
+    std::string_view Value() const { return value_; }
+
+    //! Returns the content of the current Text or CData token with references expanded.
+    std::string GetText() const;
+
+    //! Returns true if the current start tag is an empty-element tag (e.g. <a/>).
+    bool IsEmptyElement() const { return empty_; }
+
+    //! Returns the number of open ancestor elements of the current token.
+    int Depth() const { return depth_; }
+
+    //! Returns the attributes of the current start tag.
+    AttributeRange Attributes() const;
+
+    //! Returns the raw value of an attribute of the current start tag. Returns false if not found.
+    bool FindAttribute(std::string_view sName, std::string_view & value) const;
+
+    //! Skips the rest of the current element. The reader is left on its end tag.
+    void Skip();
+
+    //! Calls a function for each sub-element of the current element and returns false if the function aborted.
+    template <typename F>
+    bool ForEachSubElement(F f);
+
+    //! Returns a description of the error if the document is not well-formed.
+    char const * ErrorMessage() const { return error_; }
+
+    //! Returns the offset in the document of the current position.
+    size_t Offset() const { return size_t(cursor_ - begin_); }
+
+    //! Returns the value of a string attribute (or a default value, if the attribute is not present).
+    std::string GetStringAttribute(std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+    float GetFloatAttribute(std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+    int GetIntAttribute(std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex attribute (or a default value, if the attribute is not present or invalid).
+    uint32_t GetHexAttribute(std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool attribute (or a default value, if the attribute is not present or invalid).
+    bool GetBoolAttribute(std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of an attribute that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArrayAttribute(std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of an attribute that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArrayAttribute(std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArrayAttribute(std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of an attribute that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArrayAttribute(std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArrayAttribute(std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArrayAttribute(std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Returns the first text of a specific sub-element. Returns false if the sub-element is not found.
+    bool GetSubElementValue(std::string_view sName, std::string & value) const;
+
+    //! Returns the value of a string sub-element (or a default value, if the sub-element is not present).
+    std::string GetStringSubElement(std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float sub-element (or a default value, if the sub-element is not present or invalid).
+    float GetFloatSubElement(std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer sub-element (or a default value, if the sub-element is not present or invalid).
+    int GetIntSubElement(std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex sub-element (or a default value, if the sub-element is not present or invalid).
+    uint32_t GetHexSubElement(std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool sub-element (or a default value, if the sub-element is not present or invalid).
+    bool GetBoolSubElement(std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of a sub-element that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArraySubElement(std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of a sub-element that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArraySubElement(std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of a sub-element that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArraySubElement(std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of a sub-element that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArraySubElement(std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of a sub-element that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArraySubElement(std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of a sub-element that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArraySubElement(std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+private:
+
+    // The result of lexing a single token
+    struct Lexeme
+    {
+        Token token;
+        char const * start;         // Start of the token, after any skipped comments and declarations
+        std::string_view name;      // Element name
+        std::string_view value;     // Text or CDATA content
+        char const * attributes;    // Start of the attribute section of a start tag
+        char const * attributesEnd; // End of the attribute section of a start tag
+        bool empty;                 // True if the start tag is an empty-element tag
+        bool truncated;             // True if the token reached the end of the text, so it may be incomplete
+    };
+
+    friend class StreamReader; // Uses the lexer on a window of a stream
+
+    static Token lex(char const *& cursor, char const * end, Lexeme & lexeme, char const *& error);
+    bool findSubElementText(std::string_view sName, std::string_view & text, bool & raw) const;
+    bool skipTo(int depth);
+    Token fail(char const * message);
+
+    char const * begin_;
+    char const * end_;
+    char const * cursor_;
+    Token token_ = Token::None;
+    std::string_view name_;
+    std::string_view value_;
+    char const * attributes_    = nullptr;
+    char const * attributesEnd_ = nullptr;
+    bool empty_                 = false;
+    bool pendingEnd_            = false; // An EndElement is owed for an empty-element tag
+    bool rootClosed_            = false;
+    int depth_                  = 0;
+    char const * error_         = nullptr;
+    std::vector<std::string_view> open_; // Names of the open elements
+};
+
+//! @param    f    The function to call for each sub-element. It is called with the reader positioned on the
+//!                sub-element's start tag, and it may advance the reader anywhere within the sub-element.
+//!                The function returns false to abort the enumeration.
+//!
+//! @return        false, if the function aborted the enumeration or the document is not well-formed. Otherwise, the
+//!                reader is left on the end tag of the current element.
+
+template <typename F>
+bool Reader::ForEachSubElement(F f)
+{
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    if (token_ != Token::StartElement)
+        return false;
+
+    int depth = depth_;
+    for (Token t = Next(); t != Token::EndElement || depth_ != depth; t = Next())
+    {
+        if (t == Token::Error || t == Token::End)
+            return false;
+
+        if (t == Token::StartElement)
+        {
+            Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+            if (!f(*this))
+                return false;
+            if (!skipTo(depth + 1))
+                return false;
+        }
+    }
+
+    return true;
+}
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_READER_H)
@@ -0,0 +1,91 @@
+#pragma once
+
+#if !defined(MSXMLX_SCAN_H)
+#define MSXMLX_SCAN_H
+
+#include <cstddef>
+
+//! Scanning kernels used by the tokenizers, the conversions between UTF-8 and wide text, and the array conversions.
+//!
+//! Each kernel has a scalar implementation and, on x86-64, SSE2 and AVX2 implementations. The best implementation
+//! supported by the CPU is selected at run time. All implementations return identical results.
+
+namespace Msxmlx
+{
+namespace Scan
+{
+//! Instruction sets for which kernels are implemented
+enum class Isa
+{
+    Scalar, //!< Portable C++
+    Sse2,   //!< SSE2 (16 bytes at a time)
+    Avx2    //!< AVX2 (32 bytes at a time)
+};
+
+//! The set of kernels for one instruction set.
+struct Kernels
+{
+    //! Returns the first occurrence of c, or end if not found.
+    char const * (*findChar)(char const * p, char const * end, char c);
+
+    //! Returns the first occurrence of a or b, or end if neither is found.
+    char const * (*findEither)(char const * p, char const * end, char a, char b);
+
+    //! Returns the first character that ends a name (whitespace, control characters, '>', '/' or '='), or end.
+    char const * (*findNameEnd)(char const * p, char const * end);
+
+    //! Returns the first character that may need to be escaped ('<', '>', '&', '"' or a control character), or end.
+    char const * (*findEscape)(char const * p, char const * end);
+
+    //! Returns the first byte that is not ASCII, or end.
+    char const * (*findNonAscii)(char const * p, char const * end);
+
+    //! Copies the leading ASCII characters to wide characters. Returns the first byte that is not ASCII, or end.
+    char const * (*widenAscii)(char const * p, char const * end, wchar_t * pOut);
+
+    //! Copies the leading ASCII wide characters to bytes. Returns the first character that is not ASCII, or end.
+    wchar_t const * (*narrowAscii)(wchar_t const * p, wchar_t const * end, char * pOut);
+
+    //! Returns the number of tokens separated by whitespace (space, tab, CR and LF).
+    size_t (*countTokens)(char const * p, char const * end);
+};
+
+//! Returns the best instruction set supported by the CPU.
+Isa Supported();
+
+//! Returns the instruction set used by the functions below.
+Isa Selected();
+
+//! Selects the instruction set used by the functions below. It is limited to the ones supported by the CPU.
+void Select(Isa isa);
+
+//! Returns the kernels for an instruction set, or the scalar kernels if it is not supported by the CPU.
+Kernels const & GetKernels(Isa isa);
+
+//! Returns the first occurrence of c, or end if not found.
+char const * FindChar(char const * p, char const * end, char c);
+
+//! Returns the first occurrence of a or b, or end if neither is found.
+char const * FindEither(char const * p, char const * end, char a, char b);
+
+//! Returns the first character that ends a name (whitespace, control characters, '>', '/' or '='), or end.
+char const * FindNameEnd(char const * p, char const * end);
+
+//! Returns the first character that may need to be escaped ('<', '>', '&', '"' or a control character), or end.
+char const * FindEscape(char const * p, char const * end);
+
+//! Returns the first byte that is not ASCII, or end.
+char const * FindNonAscii(char const * p, char const * end);
+
+//! Copies the leading ASCII characters to wide characters. Returns the first byte that is not ASCII, or end.
+char const * WidenAscii(char const * p, char const * end, wchar_t * pOut);
+
+//! Copies the leading ASCII wide characters to bytes. Returns the first character that is not ASCII, or end.
+wchar_t const * NarrowAscii(wchar_t const * p, wchar_t const * end, char * pOut);
+
+//! Returns the number of tokens separated by whitespace (space, tab, CR and LF).
+size_t CountTokens(char const * p, char const * end);
+} // namespace Scan
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_SCAN_H)
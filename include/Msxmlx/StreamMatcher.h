@@ -0,0 +1,166 @@
+#pragma once
+
+#if !defined(MSXMLX_STREAMMATCHER_H)
+#define MSXMLX_STREAMMATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Path.h"
+#include "StreamReader.h"
+
+//! Single-pass matching of many paths in a stream.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*											S T R E A M   M A T C H E R												*/
+/********************************************************************************************************************/
+
+//! A set of paths matched together in one pass over a stream.
+//!
+//! A path starts at the root element. Its steps are separated by '/' for a child or "//" for a descendant at any
+//! depth, each step is a name or '*' for any element, and the last step may be an attribute. For example,
+//! "feed/entry/@id", "feed//price" and "//*/@href" are paths. The values are the attribute values, or the values of
+//! the elements (their first non-whitespace text, as with CompactDocument), with references expanded.
+//!
+//! The paths are compiled into a single automaton whose states are built as the stream is read and then reused, so
+//! each start tag costs one table lookup however many paths there are. Elements that no path can reach are skipped
+//! without being examined. A handler is called as soon as a value is known, so values are available before the end
+//! of the document.
+//!
+//! @code
+//!     Msxmlx::StreamMatcher matcher;
+//!     std::string source;
+//!     float       total = 0.f;
+//!     matcher.Add("telemetry/@source", &source);
+//!     matcher.Add<float>("telemetry//sample/@value", [&] (float value) { total += value; return true; });
+//!
+//!     Msxmlx::StreamReader reader(fd);
+//!     if (!matcher.Run(reader))
+//!         return reader.ErrorMessage();
+//! @endcode
+
+class StreamMatcher
+{
+public:
+
+    //! Called with the value of each match of a path. Returns false to stop.
+    using Handler = std::function<bool(std::string_view value)>;
+
+    //! Adds a path whose handler is called for each match. Returns false if the path is not valid.
+    bool Add(std::string_view path, Handler handler);
+
+    //! Adds a path whose first match in each Run() is stored in a variable, which is unchanged if the value is invalid.
+    //!
+    //! The type may be std::string, float, int, bool, or uint32_t, which is converted from hexadecimal text as with
+    //! GetHexAttribute().
+    template <typename T>
+    bool Add(std::string_view path, T * pValue)
+    {
+        return add(path, [pValue] (std::string_view value) { Detail::parseValue(value, *pValue); return true; }, true);
+    }
+
+    //! Adds a path whose handler is called with each valid value converted to a type, as with Add(path, pValue).
+    template <typename T, typename F>
+    bool Add(std::string_view path, F f)
+    {
+        return add(path, [f] (std::string_view text) mutable {
+            T value{};
+            return !Detail::parseValue(text, value) || f(value);
+        }, false);
+    }
+
+    //! Returns the number of paths.
+    size_t Size() const { return queries_.size(); }
+
+    //! Returns a description of the error if Add() failed.
+    char const * ErrorMessage() const { return error_; }
+
+    //! Reads a document, calling the handlers as the paths match. Returns false if a handler stopped or there was an
+    //! error (see StreamReader::ErrorMessage()).
+    bool Run(StreamReader & reader);
+
+    //! Returns the number of states of the automaton built so far.
+    size_t StateCount() const { return states_.size(); }
+
+private:
+
+    static uint32_t constexpr NONE = 0xffffffff;
+
+    // A path being matched
+    struct Query
+    {
+        Handler handler;
+        bool    once; // True if only the first match in each run is reported
+    };
+
+    // A step shared by one or more paths. The steps form a tree rooted at the document.
+    struct Step
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> children;   // Name and step of each named child step
+        uint32_t                                   any;        // The wildcard child step
+        uint32_t                                   descendant; // The step for a following "//"
+        bool                                       loop;       // True if this is the step for a "//"
+        std::vector<uint32_t>                      queries;    // Paths ending at the element
+        std::vector<std::pair<uint32_t, uint32_t>> attributes; // Name and query of paths ending at an attribute
+    };
+
+    // A state of the automaton: the set of steps that are active at an element
+    struct State
+    {
+        std::vector<uint32_t>                      steps;      // Sorted
+        std::vector<uint32_t>                      next;       // The state after each name, or NONE if not built yet
+        std::vector<uint32_t>                      queries;
+        std::vector<std::pair<uint32_t, uint32_t>> attributes; // Name and query, sorted by name
+    };
+
+    // The value of an element that is being read
+    struct Capture
+    {
+        uint32_t    state;
+        size_t      element; // Index in open_
+        std::string text;
+        bool        reading; // True if the value has started and may continue in the next token
+        bool        done;    // True if the value has been reported
+    };
+
+    bool add(std::string_view path, Handler handler, bool once);
+    uint32_t intern(std::string_view name);
+    uint32_t findName(std::string_view name) const;
+    uint32_t addStep(bool loop);
+    uint32_t addState(std::vector<uint32_t> steps);
+    uint32_t transition(uint32_t state, uint32_t name);
+    bool report(uint32_t query, std::string_view value);
+    bool startElement(StreamReader & reader, uint32_t state);
+    bool endElement();
+    bool finishValue(Capture & capture);
+
+    std::vector<Query> queries_;
+    std::vector<Step> steps_ = std::vector<Step>(1, Step{ {}, NONE, NONE, false, {}, {} }); // The document
+    std::deque<std::string> names_;                   // Stable storage for the keys of ids_
+    std::unordered_map<std::string_view, uint32_t> ids_;
+    char const * error_ = nullptr;
+
+    // The automaton, which is built as it is used
+    std::vector<State> states_;
+    std::map<std::vector<uint32_t>, uint32_t> stateIds_; // States by their steps
+
+    // The state of a run
+    std::vector<uint32_t> open_;     // The state at each open element
+    std::vector<Capture> captures_;  // Reused, so that the strings keep their capacity
+    size_t captureCount_ = 0;
+    std::vector<bool> matched_;
+    std::string scratch_;
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_STREAMMATCHER_H)
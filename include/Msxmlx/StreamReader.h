@@ -0,0 +1,260 @@
+#pragma once
+
+#if !defined(MSXMLX_STREAMREADER_H)
+#define MSXMLX_STREAMREADER_H
+
+#include "Instrumentation.h"
+#include "Reader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Portable streaming XML parser with bounded memory.
+
+namespace Msxmlx
+{
+/********************************************************************************************************************/
+/*											S T R E A M   R E A D E R												*/
+/********************************************************************************************************************/
+
+//! A pull parser for documents too large to hold in memory.
+//!
+//! The reader reads a document from a file descriptor (or any other source) through a fixed-size window, so the
+//! memory it uses does not depend on the size of the document. The window only grows if a single tag is larger than
+//! it, up to a limit. Long text is reported as several consecutive Text tokens instead. A document already in memory
+//! can also be read, in which case nothing is copied.
+//!
+//! The tokens and accessors are those of Reader, but names, values and attributes are slices of the window, so they
+//! are only valid until the next call to Next(). Sub-element accessors, which need to look ahead, are not available.
+//!
+//! @code
+//!     Msxmlx::StreamReader reader(fd);
+//!     for (auto t = reader.Next(); t != Msxmlx::StreamReader::Token::End; t = reader.Next())
+//!     {
+//!         if (t == Msxmlx::StreamReader::Token::StartElement && reader.IsAt("telemetry/sample"))
+//!             total += reader.GetFloatAttribute("value");
+//!     }
+//! @endcode
+
+class StreamReader
+{
+public:
+
+    //! Type of token returned by Next()
+    using Token = Reader::Token;
+
+    //! A source of data. It is called with a buffer and its size, and returns the number of bytes read, 0 at the end
+    //! of the data, PENDING if no data is available yet, or another negative number if there is an error.
+    using Source = std::function<ptrdiff_t(char * pBuffer, size_t size)>;
+
+    //! Returned by a source that has no data yet. Next() then returns Token::None, and can be called again later.
+    static ptrdiff_t constexpr PENDING = -2;
+
+    //! Default size of the window
+    static size_t constexpr DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    //! Default limit on the size of the window, and so of a single tag
+    static size_t constexpr DEFAULT_MAX_BUFFER_SIZE = 16 * 1024 * 1024;
+
+    //! Constructor. Reads a document in memory, which must remain valid for the lifetime of the reader.
+    explicit StreamReader(std::string_view document);
+
+    //! Constructor. Reads a document from a file descriptor, which is not closed by the reader.
+    explicit StreamReader(int fd,
+                          size_t bufferSize    = DEFAULT_BUFFER_SIZE,
+                          size_t maxBufferSize = DEFAULT_MAX_BUFFER_SIZE);
+
+    //! Constructor. Reads a document from a source.
+    explicit StreamReader(Source source,
+                          size_t bufferSize    = DEFAULT_BUFFER_SIZE,
+                          size_t maxBufferSize = DEFAULT_MAX_BUFFER_SIZE);
+
+    StreamReader(StreamReader const &) = delete;
+    StreamReader & operator =(StreamReader const &) = delete;
+
+    //! Advances to the next token and returns its type, or None if the source has no data yet.
+    Token Next();
+
+    //! Returns the type of the current token.
+    Token Current() const { return token_; }
+
+    //! Returns the name of the current element (StartElement and EndElement only).
+    std::string_view Name() const { return name_; }
+
+    //! Returns the raw content of the current Text or CData token.
+    std::string_view Value() const { return value_; }
+
+    //! Returns the content of the current Text or CData token with references expanded.
+    std::string GetText() const;
+
+    //! Returns true if the current Text token continues the text of the previous one (see Next()).
+    bool IsTextContinued() const { return continued_; }
+
+    //! Returns true if the current start tag is an empty-element tag (e.g. <a/>).
+    bool IsEmptyElement() const { return empty_; }
+
+    //! Returns the number of open ancestor elements of the current token.
+    int Depth() const { return depth_; }
+
+    //! Returns the name of the open ancestor element at a depth, which must be less than Depth().
+    std::string_view Ancestor(int depth) const;
+
+    //! Returns true if the names of the ancestors and the current element match a path (e.g. "world/entity").
+    bool IsAt(std::string_view path) const;
+
+    //! Returns the attributes of the current start tag.
+    AttributeRange Attributes() const;
+
+    //! Returns the raw value of an attribute of the current start tag. Returns false if not found.
+    bool FindAttribute(std::string_view sName, std::string_view & value) const;
+
+    //! Returns the value of a string attribute (or a default value, if the attribute is not present).
+    std::string GetStringAttribute(std::string_view sName, char const * sDefault = "") const;
+
+    //! Returns the value of a float attribute (or a default value, if the attribute is not present or invalid).
+    float GetFloatAttribute(std::string_view sName, float fDefault = 0.f) const;
+
+    //! Returns the value of an integer attribute (or a default value, if the attribute is not present or invalid).
+    int GetIntAttribute(std::string_view sName, int iDefault = 0) const;
+
+    //! Returns the value of a hex attribute (or a default value, if the attribute is not present or invalid).
+    uint32_t GetHexAttribute(std::string_view sName, uint32_t iDefault = 0) const;
+
+    //! Returns the value of a bool attribute (or a default value, if the attribute is not present or invalid).
+    bool GetBoolAttribute(std::string_view sName, bool bDefault = false) const;
+
+    //! Returns the values of an attribute that is a list of floats. Returns false if not present or invalid.
+    bool GetFloatArrayAttribute(std::string_view sName, std::vector<float> & values) const;
+
+    //! Returns the values of an attribute that is a list of floats in an array (see ParseFloatArray()).
+    bool GetFloatArrayAttribute(std::string_view sName, float * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of integers. Returns false if not present or invalid.
+    bool GetIntArrayAttribute(std::string_view sName, std::vector<int> & values) const;
+
+    //! Returns the values of an attribute that is a list of integers in an array (see ParseIntArray()).
+    bool GetIntArrayAttribute(std::string_view sName, int * pValues, size_t & count) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers. Returns false if not present or invalid.
+    bool GetHexArrayAttribute(std::string_view sName, std::vector<uint32_t> & values) const;
+
+    //! Returns the values of an attribute that is a list of hex numbers in an array (see ParseHexArray()).
+    bool GetHexArrayAttribute(std::string_view sName, uint32_t * pValues, size_t & count) const;
+
+    //! Skips the rest of the current element. The reader is left on its end tag.
+    void Skip();
+
+    //! Calls a function for each sub-element of the current element and returns false if the function aborted.
+    template <typename F>
+    bool ForEachSubElement(F f);
+
+    //! Returns a description of the error if the document is not well-formed or could not be read.
+    char const * ErrorMessage() const { return error_; }
+
+    //! Returns the offset in the document of the current position.
+    uint64_t Offset() const { return consumed_ + uint64_t(cursor_ - window_); }
+
+    //! Returns the current size of the window.
+    size_t BufferSize() const { return bufferSize_; }
+
+private:
+
+    using Lexeme = Reader::Lexeme;
+
+    Token lex(Lexeme & lexeme);
+    bool fill(bool & pending);
+    bool skipTo(int depth);
+    Token fail(char const * message);
+
+    Source source_;
+    std::unique_ptr<char[]> buffer_;
+    size_t bufferSize_    = 0;
+    size_t maxBufferSize_ = 0;
+    char const * window_  = nullptr; // Start of the data in memory
+    char const * end_     = nullptr; // End of the data in memory
+    char const * cursor_  = nullptr;
+    uint64_t consumed_    = 0;       // Number of bytes discarded before the window
+    bool eof_             = false;   // True if all of the data is in memory
+
+    Token token_ = Token::None;
+    std::string_view name_;
+    std::string_view value_;
+    char const * attributes_    = nullptr;
+    char const * attributesEnd_ = nullptr;
+    bool empty_                 = false;
+    bool pendingEnd_            = false; // An EndElement is owed for an empty-element tag
+    bool rootClosed_            = false;
+    bool split_                 = false; // The last Text token was split, so the next token continues it
+    bool continued_             = false;
+    int depth_                  = 0;
+    char const * error_         = nullptr;
+    std::string openNames_;              // Names of the open elements, concatenated
+    std::vector<size_t> openEnds_;       // End of each name in openNames_
+};
+
+//! @param    f    The function to call for each sub-element. It is called with the reader positioned on the
+//!                sub-element's start tag, and it may advance the reader anywhere within the sub-element.
+//!                The function returns false to abort the enumeration.
+//!
+//! @return        false, if the function aborted the enumeration, the document is not well-formed, or the source has
+//!                no more data yet. Otherwise, the reader is left on the end tag of the current element.
+
+template <typename F>
+bool StreamReader::ForEachSubElement(F f)
+{
+    Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::CALLS);
+    if (token_ != Token::StartElement)
+        return false;
+
+    int depth = depth_;
+    for (Token t = Next(); t != Token::EndElement || depth_ != depth; t = Next())
+    {
+        if (t == Token::Error || t == Token::End || t == Token::None)
+            return false;
+
+        if (t == Token::StartElement)
+        {
+            Instrumentation::Add(Instrumentation::Family::FOR_EACH, Instrumentation::Counter::SCANNED);
+            if (!f(*this))
+                return false;
+            if (!skipTo(depth + 1))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/********************************************************************************************************************/
+/*													S A X															*/
+/********************************************************************************************************************/
+
+//! Receives the events of a document from ParseStream().
+//!
+//! Each function is called with the reader positioned on the token, so the accessors of StreamReader (for example,
+//! the typed attribute accessors and IsAt()) can be used. Each function returns false to stop parsing.
+class SaxHandler
+{
+public:
+    virtual ~SaxHandler() = default;
+
+    //! Called for a start tag or an empty-element tag. The attributes are available from the reader.
+    virtual bool StartElement(StreamReader & /*reader*/) { return true; }
+
+    //! Called for an end tag, and after an empty-element tag.
+    virtual bool EndElement(StreamReader & /*reader*/) { return true; }
+
+    //! Called for character data (possibly in several parts) and for CDATA sections within the root element.
+    virtual bool Text(StreamReader & /*reader*/) { return true; }
+};
+
+//! Parses a document, calling a handler for each event. Returns false if the handler stopped or there was an error.
+bool ParseStream(StreamReader & reader, SaxHandler & handler);
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_STREAMREADER_H)
@@ -0,0 +1,125 @@
+#pragma once
+
+#if !defined(MSXMLX_THREADPOOL_H)
+#define MSXMLX_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//! Work-stealing thread pool.
+
+namespace Msxmlx
+{
+//! A work-stealing thread pool for data-parallel loops.
+//!
+//! Each worker thread has its own queue of ranges. A worker splits the range it is executing in half until it is no
+//! larger than the grain size, pushing the upper halves onto its own queue, and takes work from the back of its own
+//! queue. An idle worker steals from the front of another worker's queue, which holds the largest remaining ranges.
+//! The thread calling ParallelFor() works on the loop too, so a pool of N threads has N - 1 worker threads, and a
+//! pool of one thread runs loops serially on the caller. Loops may be nested.
+//!
+//! @code
+//!     Msxmlx::ThreadPool pool(8);
+//!     pool.ParallelFor(0, entities.size(), 16, [&] (size_t begin, size_t end) {
+//!         for (size_t i = begin; i < end; ++i)
+//!             load(entities[i]);
+//!     });
+//! @endcode
+
+class ThreadPool
+{
+public:
+
+    //! Constructor. If the thread count is 0, the number of hardware threads is used.
+    explicit ThreadPool(size_t threadCount = 0);
+
+    //! Destructor. Waits for the worker threads to finish.
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool & operator =(ThreadPool const &) = delete;
+
+    //! Returns the number of threads that execute loops, including the calling thread.
+    size_t Size() const { return workers_.size() + 1; }
+
+    //! Calls a function for subranges of [begin, end) in parallel and returns when all of them are done.
+    template <typename F>
+    void ParallelFor(size_t begin, size_t end, size_t grain, F && f);
+
+    //! Returns a pool shared by the library, with one thread for each hardware thread.
+    static ThreadPool & Default();
+
+private:
+
+    // A loop
+    struct Job
+    {
+        void (*run)(void * pContext, size_t begin, size_t end);
+        void * pContext;
+        size_t grain;
+        std::atomic<size_t> remaining; // Number of iterations not yet completed or skipped
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;      // The first exception thrown by the function
+    };
+
+    // A range of a loop
+    struct Task
+    {
+        Job * pJob;
+        size_t begin;
+        size_t end;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void parallelFor(size_t begin, size_t end, size_t grain, void (*run)(void *, size_t, size_t), void * pContext);
+    size_t queueIndex() const;
+    void push(size_t queue, Task const & task);
+    bool pop(size_t queue, Task & task);
+    bool steal(size_t thief, Task & task);
+    void execute(size_t queue, Task task);
+    void finish(Job & job, size_t count);
+    void work(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_; // One for each worker, and one shared by other threads
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{ 0 };            // Number of tasks in all queues
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+//! The function is called with subranges [first, last) that cover the range exactly once. Each subrange is at most
+//! the grain size, unless the grain size is 0, which is treated as 1.
+//!
+//! If the function throws, the subranges that have not started are skipped, and the first exception is rethrown on
+//! the calling thread once the subranges that had started are done.
+//!
+//! @param    begin    Start of the range
+//! @param    end      End of the range
+//! @param    grain    The largest subrange to execute without splitting it
+//! @param    f        The function to call for each subrange. It must be safe to call from several threads at once.
+
+template <typename F>
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain, F && f)
+{
+    using Function = std::remove_reference_t<F>;
+
+    auto run = [] (void * pContext, size_t first, size_t last) { (*static_cast<Function *>(pContext))(first, last); };
+    parallelFor(begin, end, grain, run, const_cast<void *>(static_cast<void const *>(&f)));
+}
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_THREADPOOL_H)
@@ -0,0 +1,166 @@
+#pragma once
+
+#if !defined(MSXMLX_WRITER_H)
+#define MSXMLX_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Portable streaming XML writer.
+
+namespace Msxmlx
+{
+//! Serializes a document directly into a buffer, a file descriptor or any other sink.
+//!
+//! Elements, attributes and text are written as they are added, with no intermediate document. Text and attribute
+//! values are escaped, and numbers are formatted with std::to_chars, so the typed functions mirror the typed
+//! accessors of Reader and Msxmlx.h. An element with no content is written as an empty-element tag.
+//!
+//! By default, the output is collected in a buffer that grows as needed (see Data()). Given a file descriptor or a
+//! sink, the output is written in chunks of a fixed size instead.
+//!
+//! @code
+//!     Msxmlx::Writer writer(fd);
+//!     writer.SetIndentation(2);
+//!     writer.Declaration();
+//!     writer.StartElement("world");
+//!     for (Entity const & entity : entities)
+//!     {
+//!         writer.StartElement("entity");
+//!         writer.IntAttribute("id", entity.id);
+//!         writer.StringElement("name", entity.name);
+//!         writer.FloatElement("health", entity.health);
+//!         writer.EndElement();
+//!     }
+//!     bool ok = writer.Finish();
+//! @endcode
+
+class Writer
+{
+public:
+
+    //! A sink for the output. It is called with a chunk of the output, and returns false if it could not be written.
+    using Sink = std::function<bool(char const * pData, size_t size)>;
+
+    //! Default size of the chunks written to a file descriptor or a sink
+    static size_t constexpr DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    //! Constructor. The output is collected in a buffer.
+    Writer();
+
+    //! Constructor. The output is written to a file descriptor, which is not closed by the writer.
+    explicit Writer(int fd, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    //! Constructor. The output is written to a sink.
+    explicit Writer(Sink sink, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    Writer(Writer const &) = delete;
+    Writer & operator =(Writer const &) = delete;
+
+    //! Sets the number of spaces by which each level of elements is indented. 0 (the default) disables indentation.
+    void SetIndentation(int spaces) { indentation_ = spaces; }
+
+    //! Writes the XML declaration. It must be written first.
+    void Declaration();
+
+    //! Writes a start tag.
+    void StartElement(std::string_view sName);
+
+    //! Writes the end tag of the current element.
+    void EndElement();
+
+    //! Writes a string attribute of the current element.
+    void StringAttribute(std::string_view sName, std::string_view value);
+
+    //! Writes a float attribute of the current element.
+    void FloatAttribute(std::string_view sName, float fValue);
+
+    //! Writes an integer attribute of the current element.
+    void IntAttribute(std::string_view sName, int iValue);
+
+    //! Writes a hex attribute (e.g. 0x0000ffff) of the current element.
+    void HexAttribute(std::string_view sName, uint32_t iValue);
+
+    //! Writes a bool attribute of the current element.
+    void BoolAttribute(std::string_view sName, bool bValue);
+
+    //! Writes text.
+    void Text(std::string_view text);
+
+    //! Writes a CDATA section.
+    void CData(std::string_view text);
+
+    //! Writes a comment.
+    void Comment(std::string_view text);
+
+    //! Writes an element containing only a string.
+    void StringElement(std::string_view sName, std::string_view value);
+
+    //! Writes an element containing only a float.
+    void FloatElement(std::string_view sName, float fValue);
+
+    //! Writes an element containing only an integer.
+    void IntElement(std::string_view sName, int iValue);
+
+    //! Writes an element containing only a hex value.
+    void HexElement(std::string_view sName, uint32_t iValue);
+
+    //! Writes an element containing only a bool.
+    void BoolElement(std::string_view sName, bool bValue);
+
+    //! Writes any buffered output to the file descriptor or sink. Returns false if any output could not be written.
+    bool Flush();
+
+    //! Ends any open elements and flushes the output. Returns false if the document is not valid or not written.
+    bool Finish();
+
+    //! Returns the number of open elements.
+    int Depth() const { return int(open_.size()); }
+
+    //! Returns the output collected so far, if there is no file descriptor or sink.
+    std::string_view Data() const { return std::string_view(buffer_.get(), size_); }
+
+    //! Returns a description of the first error, or nullptr if there has been none.
+    char const * ErrorMessage() const { return error_; }
+
+private:
+
+    // An open element
+    struct Open
+    {
+        size_t nameEnd;   // End of the name in names_
+        bool   children;  // True if it has content
+        bool   text;      // True if it has text, so its content is not indented
+    };
+
+    void closeStartTag();
+    void indent(size_t depth);
+    void escape(std::string_view text, bool attribute);
+    void attribute(std::string_view sName, std::string_view value);
+    void append(char const * pData, size_t size);
+    void append(std::string_view text) { append(text.data(), text.size()); }
+    void append(char c);
+    char * reserve(size_t size);
+    void fail(char const * message);
+
+    Sink sink_;
+    std::unique_ptr<char[]> buffer_;
+    size_t size_        = 0;
+    size_t capacity_    = 0;
+    bool growable_      = false; // True if the output is collected in the buffer
+    int indentation_    = 0;
+    bool inStartTag_    = false; // True if the current start tag has not been closed, so attributes may be added
+    bool started_       = false; // True if anything has been written
+    bool rootClosed_    = false;
+    char const * error_ = nullptr;
+    std::string names_;          // Names of the open elements, concatenated
+    std::vector<Open> open_;
+};
+} // namespace Msxmlx
+
+#endif // !defined(MSXMLX_WRITER_H)
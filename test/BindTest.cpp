@@ -0,0 +1,291 @@
+#include <Msxmlx/Bind.h>
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/Reader.h>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+struct Light
+{
+    std::string        name;
+    float              intensity = 1.f;
+    uint32_t           color     = 0xffffffff;
+    std::optional<int> range;
+    std::vector<int>   channels;
+};
+
+struct Room
+{
+    std::string          name;
+    int                  floor = -1;
+    std::optional<float> height;
+    Light                main;
+    std::optional<Light> spare;
+    std::vector<Light>   lights;
+};
+
+char const ROOM[] = "<room name='hall' floor='2'>"
+                    "<height>3.5</height>"
+                    "<main name='ceiling' intensity='4'><range>12</range></main>"
+                    "<light name='a' color='ff'><channel>1</channel></light>"
+                    "<ignored><light name='deep'/></ignored>"
+                    "<light name='b'><channel>2</channel><channel>3</channel></light>"
+                    "</room>";
+} // anonymous namespace
+
+template <>
+struct Msxmlx::Schema<Light>
+{
+    static constexpr auto FIELDS = MakeBinding(SubElement<&Light::range>("range"),
+                                               Field<&Light::name>("name"),
+                                               SubElement<&Light::channels>("channel"),
+                                               HexField<&Light::color>("color"),
+                                               Field<&Light::intensity>("intensity"));
+};
+
+template <>
+struct Msxmlx::Schema<Room>
+{
+    static constexpr auto FIELDS = MakeBinding(Field<&Room::name>("name"),
+                                               Field<&Room::floor>("floor"),
+                                               SubElement<&Room::height>("height"),
+                                               SubElement<&Room::main>("main"),
+                                               SubElement<&Room::spare>("spare"),
+                                               SubElement<&Room::lights>("light"));
+};
+
+namespace
+{
+// Checks a room deserialized from ROOM
+void checkRoom(Room const & room)
+{
+    EXPECT_EQ(room.name, "hall");
+    EXPECT_EQ(room.floor, 2);
+    EXPECT_EQ(room.height, 3.5f);
+
+    // A nested struct, whose fields that are not in the document keep their initial values
+    EXPECT_EQ(room.main.name, "ceiling");
+    EXPECT_EQ(room.main.intensity, 4.f);
+    EXPECT_EQ(room.main.color, 0xffffffffu);
+    EXPECT_EQ(room.main.range, 12);
+    EXPECT_TRUE(room.main.channels.empty());
+    EXPECT_FALSE(room.spare.has_value());
+
+    // Only the children of the element are deserialized, not the deeper descendants
+    ASSERT_EQ(room.lights.size(), 2u);
+    EXPECT_EQ(room.lights[0].name, "a");
+    EXPECT_EQ(room.lights[0].color, 0xffu);
+    EXPECT_EQ(room.lights[0].intensity, 1.f);
+    EXPECT_EQ(room.lights[0].channels, (std::vector<int>{ 1 }));
+    EXPECT_FALSE(room.lights[0].range.has_value());
+    EXPECT_EQ(room.lights[1].name, "b");
+    EXPECT_EQ(room.lights[1].channels, (std::vector<int>{ 2, 3 }));
+}
+} // anonymous namespace
+
+TEST(BindTest, DeclaredOrder)
+{
+    auto const & binding = Schema<Light>::FIELDS;
+    ASSERT_EQ(binding.Size(), 5u);
+    ASSERT_EQ(binding.AttributeCount(), 3u);
+
+    char const * const DECLARED[] = { "range", "name", "channel", "color", "intensity" };
+    for (size_t i = 0; i < binding.Size(); ++i)
+    {
+        EXPECT_EQ(binding.Declared()[i].name, DECLARED[i]);
+    }
+
+    // The lookup table has the attributes first, each group sorted by hash
+    for (size_t i = 1; i < binding.Size(); ++i)
+    {
+        if (i != binding.AttributeCount())
+        {
+            EXPECT_LT(binding.Data()[i - 1].hash, binding.Data()[i].hash);
+        }
+    }
+    EXPECT_NE(binding.FindAttribute("color"), nullptr);
+    EXPECT_EQ(binding.FindAttribute("range"), nullptr);
+    EXPECT_NE(binding.FindSubElement("channel"), nullptr);
+}
+
+TEST(BindTest, Deserialize)
+{
+    Reader reader("<light name='key' color='ff8000' intensity='2.5'><channel>1</channel><range>10</range>"
+                  "<channel>3</channel><ignored/></light>");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    Light light;
+    EXPECT_TRUE(Deserialize(reader, light));
+    EXPECT_EQ(light.name, "key");
+    EXPECT_EQ(light.color, 0xff8000u);
+    EXPECT_EQ(light.intensity, 2.5f);
+    EXPECT_EQ(light.range, 10);
+    EXPECT_EQ(light.channels, (std::vector<int>{ 1, 3 }));
+}
+
+TEST(BindTest, DeserializeNested)
+{
+    Reader reader(ROOM);
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    Room room;
+    EXPECT_TRUE(Deserialize(reader, room));
+    checkRoom(room);
+
+    // The reader is left on the end tag of the element
+    EXPECT_EQ(reader.Current(), Reader::Token::EndElement);
+    EXPECT_EQ(reader.Name(), "room");
+    EXPECT_EQ(reader.Next(), Reader::Token::End);
+}
+
+TEST(BindTest, AbsentFieldsAreUnchanged)
+{
+    Reader reader("<light><other>1</other></light>");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    Light light;
+    light.name     = "previous";
+    light.range    = 5;
+    light.channels = { 9 };
+    EXPECT_TRUE(Deserialize(reader, light));
+    EXPECT_EQ(light.name, "previous");
+    EXPECT_EQ(light.intensity, 1.f);
+    EXPECT_EQ(light.color, 0xffffffffu);
+    EXPECT_EQ(light.range, 5);
+    EXPECT_EQ(light.channels, (std::vector<int>{ 9 }));
+}
+
+TEST(BindTest, InvalidValues)
+{
+    // The invalid values are not stored, but the valid ones are, and the rest of the element is deserialized
+    Reader reader("<light name='bad' color='xyz' intensity='2'><channel>1</channel><channel>two</channel>"
+                  "<range>far</range><channel>3</channel></light>");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    Light light;
+    EXPECT_FALSE(Bind(reader, light));
+    EXPECT_EQ(light.name, "bad");
+    EXPECT_EQ(light.color, 0xffffffffu);
+    EXPECT_EQ(light.intensity, 2.f);
+
+    light = Light();
+    EXPECT_FALSE(Deserialize(reader, light));
+    EXPECT_EQ(light.name, "bad");
+    EXPECT_EQ(light.color, 0xffffffffu);
+    EXPECT_EQ(light.intensity, 2.f);
+    EXPECT_FALSE(light.range.has_value());
+    EXPECT_EQ(light.channels, (std::vector<int>{ 1, 3 }));
+    EXPECT_EQ(reader.Current(), Reader::Token::EndElement);
+
+    // An invalid value in a nested struct makes the whole element invalid
+    Reader nested("<room><light intensity='bright'/><light name='ok'/></room>");
+    ASSERT_EQ(nested.Next(), Reader::Token::StartElement);
+    Room room;
+    EXPECT_FALSE(Deserialize(nested, room));
+    ASSERT_EQ(room.lights.size(), 2u);
+    EXPECT_EQ(room.lights[0].intensity, 1.f);
+    EXPECT_EQ(room.lights[1].name, "ok");
+}
+
+TEST(BindTest, NotAStartTag)
+{
+    // Binding needs a start tag, and nothing is stored without one
+    Reader reader("<light name='a'>text</light>");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    ASSERT_EQ(reader.Next(), Reader::Token::Text);
+
+    Light light;
+    EXPECT_TRUE(Bind(reader, light));
+    EXPECT_FALSE(Deserialize(reader, light));
+    EXPECT_TRUE(light.name.empty());
+
+    // An element that is not well-formed
+    Reader broken("<light name='a'><channel>1</channel><range>2</light>");
+    ASSERT_EQ(broken.Next(), Reader::Token::StartElement);
+    EXPECT_FALSE(Deserialize(broken, light));
+    EXPECT_EQ(light.name, "a");
+}
+
+TEST(BindTest, DocumentBind)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse("<light name='a &amp; b' color='0x00ff00' intensity='x' other='1'><range>3</range>"
+                               "</light>"));
+    CompactDocument::Index root = document.Root();
+
+    // Only the attributes are bound, and the references in them are expanded
+    Light light;
+    EXPECT_FALSE(Bind(document, root, light));
+    EXPECT_EQ(light.name, "a & b");
+    EXPECT_EQ(light.color, 0xff00u);
+    EXPECT_EQ(light.intensity, 1.f);
+    EXPECT_FALSE(light.range.has_value());
+
+    // The same with an explicit binding, and with no element
+    Light other;
+    EXPECT_FALSE(Bind(document, root, other, Schema<Light>::FIELDS));
+    EXPECT_EQ(other.name, "a & b");
+    Light none;
+    EXPECT_TRUE(Bind(document, CompactDocument::NONE, none));
+    EXPECT_TRUE(none.name.empty());
+}
+
+TEST(BindTest, DocumentDeserialize)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(ROOM));
+
+    Room room;
+    EXPECT_TRUE(Deserialize(document, document.Root(), room));
+    checkRoom(room);
+
+    // The document and the reader give the same object
+    Reader reader(ROOM);
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    Room fromReader;
+    EXPECT_TRUE(Deserialize(reader, fromReader));
+    EXPECT_EQ(room.main.range, fromReader.main.range);
+    ASSERT_EQ(room.lights.size(), fromReader.lights.size());
+    for (size_t i = 0; i < room.lights.size(); ++i)
+    {
+        EXPECT_EQ(room.lights[i].name, fromReader.lights[i].name);
+        EXPECT_EQ(room.lights[i].channels, fromReader.lights[i].channels);
+    }
+
+    // Deserializing a sub-element on its own
+    Light main;
+    EXPECT_TRUE(Deserialize(document, document.GetSubElement(document.Root(), "main"), main));
+    EXPECT_EQ(main.name, "ceiling");
+    EXPECT_EQ(main.range, 12);
+
+    // No element leaves the object unchanged
+    Light none;
+    none.name = "unchanged";
+    EXPECT_TRUE(Deserialize(document, CompactDocument::NONE, none));
+    EXPECT_EQ(none.name, "unchanged");
+}
+
+TEST(BindTest, DocumentInvalidValues)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse("<room floor='first'><height>high</height><main><channel>x</channel></main>"
+                               "<light><range> 7 </range><channel>4</channel><channel>-</channel></light></room>"));
+
+    // The invalid values are not stored, and the fields keep their values
+    Room room;
+    room.height = 2.f;
+    EXPECT_FALSE(Deserialize(document, document.Root(), room));
+    EXPECT_EQ(room.floor, -1);
+    EXPECT_EQ(room.height, 2.f);
+    EXPECT_TRUE(room.main.channels.empty());
+    ASSERT_EQ(room.lights.size(), 1u);
+    EXPECT_EQ(room.lights[0].range, 7);
+    EXPECT_EQ(room.lights[0].channels, (std::vector<int>{ 4 }));
+}
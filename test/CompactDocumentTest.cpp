@@ -0,0 +1,255 @@
+#include <Msxmlx/CompactDocument.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+char const DOCUMENT[] = R"(<world name="test" version="3">
+  <entity id="1" type="light"><name>lamp</name><health>100</health></entity>
+  <entity id="2"><name>a &amp; b</name><position x="1.5" y="-2"/></entity>
+  <empty/>
+</world>)";
+
+// Copies a snapshot to memory aligned for loading
+std::vector<uint32_t> aligned(std::string const & image)
+{
+    std::vector<uint32_t> memory((image.size() + 3) / 4);
+    memcpy(memory.data(), image.data(), image.size());
+    return memory;
+}
+
+// Reads every element, name, value and attribute of a document, returning a summary that is the same for equal
+// documents
+std::string summarize(CompactDocument const & document)
+{
+    std::string summary;
+    for (CompactDocument::Index i = 0; i < document.Size(); ++i)
+    {
+        summary += std::string(document.Name(i)) + "(" + std::string(document.Value(i)) + ")";
+        summary += std::to_string(document.Parent(i)) + "," + std::to_string(document.FirstChild(i)) + ",";
+        summary += std::to_string(document.NextSibling(i)) + "[";
+        CompactDocument::Attributes attributes = document.GetAttributes(i);
+        summary += std::to_string(attributes.count) + "]";
+        for (CompactDocument::Index child = document.FirstChild(i); child != CompactDocument::NONE;
+             child = document.NextSibling(child))
+        {
+            summary += '.';
+        }
+    }
+    summary += document.GetStringAttribute(document.Root(), "name");
+    return summary;
+}
+} // anonymous namespace
+
+TEST(CompactDocumentTest, Accessors)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    EXPECT_EQ(document.Size(), 8u);
+
+    CompactDocument::Index root = document.Root();
+    EXPECT_EQ(document.Name(root), "world");
+    EXPECT_EQ(document.GetIntAttribute(root, "version"), 3);
+
+    CompactDocument::Index entity = document.GetSubElement(root, "entity");
+    EXPECT_EQ(document.GetStringSubElement(entity, "name"), "lamp");
+    entity = document.NextSibling(entity);
+    EXPECT_EQ(document.GetStringSubElement(entity, "name"), "a & b");
+    EXPECT_EQ(document.GetFloatAttribute(document.GetSubElement(entity, "position"), "y"), -2.f);
+    EXPECT_EQ(document.GetIntAttribute(document.GetSubElement(root, "missing"), "id", -1), -1);
+}
+
+TEST(CompactDocumentTest, ArrayAccessors)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse("<mesh points='0 1.5 -2e1' ids=' 1 2\t3 ' colors='ff 0x00ff00 DEADBEEF' bad='1 x'>"
+                               "<points> 1 2\n3 </points><ids>7 8</ids><colors>a 0xB</colors><bad>1 2 z</bad></mesh>"));
+    CompactDocument::Index      mesh       = document.Root();
+    CompactDocument::Attributes attributes = document.GetAttributes(mesh);
+
+    std::vector<float>    floats;
+    std::vector<int>      ints;
+    std::vector<uint32_t> hex;
+    EXPECT_TRUE(document.GetFloatArrayAttribute(mesh, "points", floats));
+    EXPECT_EQ(floats, (std::vector<float>{ 0.f, 1.5f, -20.f }));
+    EXPECT_TRUE(document.GetIntArrayAttribute(attributes, "ids", ints));
+    EXPECT_EQ(ints, (std::vector<int>{ 1, 2, 3 }));
+    EXPECT_TRUE(document.GetHexArrayAttribute(mesh, "colors", hex));
+    EXPECT_EQ(hex, (std::vector<uint32_t>{ 0xff, 0xff00, 0xdeadbeef }));
+
+    // Missing and malformed attributes empty the vector
+    EXPECT_FALSE(document.GetIntArrayAttribute(mesh, "bad", ints));
+    EXPECT_TRUE(ints.empty());
+    floats = { 1.f };
+    EXPECT_FALSE(document.GetFloatArrayAttribute(attributes, "missing", floats));
+    EXPECT_TRUE(floats.empty());
+
+    // Arrays of a fixed size report the number of values, even if they do not fit
+    int    array[2] = {};
+    size_t count    = 2;
+    EXPECT_FALSE(document.GetIntArrayAttribute(mesh, "ids", array, count));
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(array[1], 2);
+    uint32_t colors[3] = {};
+    count              = 3;
+    EXPECT_TRUE(document.GetHexArrayAttribute(attributes, "colors", colors, count));
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(colors[2], 0xdeadbeefu);
+    float points[3] = {};
+    count           = 3;
+    EXPECT_FALSE(document.GetFloatArrayAttribute(attributes, "bad", points, count));
+    EXPECT_EQ(count, 0u);
+
+    // Sub-elements
+    EXPECT_TRUE(document.GetFloatArraySubElement(mesh, "points", floats));
+    EXPECT_EQ(floats, (std::vector<float>{ 1.f, 2.f, 3.f }));
+    EXPECT_TRUE(document.GetIntArraySubElement(mesh, "ids", ints));
+    EXPECT_EQ(ints, (std::vector<int>{ 7, 8 }));
+    EXPECT_TRUE(document.GetHexArraySubElement(mesh, "colors", hex));
+    EXPECT_EQ(hex, (std::vector<uint32_t>{ 0xa, 0xb }));
+    EXPECT_FALSE(document.GetIntArraySubElement(mesh, "bad", ints));
+    EXPECT_TRUE(ints.empty());
+    count = 2;
+    EXPECT_FALSE(document.GetIntArraySubElement(mesh, "points", array, count));
+    EXPECT_EQ(count, 3u);
+    count = 3;
+    EXPECT_TRUE(document.GetHexArraySubElement(mesh, "colors", colors, count));
+    EXPECT_EQ(count, 2u);
+    count = 3;
+    EXPECT_TRUE(document.GetFloatArraySubElement(mesh, "ids", points, count));
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(points[1], 8.f);
+    EXPECT_FALSE(document.GetFloatArraySubElement(mesh, "missing", points, count));
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(CompactDocumentTest, SnapshotRoundTrip)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    std::string           image  = document.Snapshot();
+    std::vector<uint32_t> memory = aligned(image);
+
+    CompactDocument loaded;
+    ASSERT_TRUE(loaded.LoadSnapshot(memory.data(), image.size())) << loaded.ErrorMessage();
+    EXPECT_EQ(loaded.Capacity(), 0u);
+    EXPECT_EQ(summarize(loaded), summarize(document));
+
+    CompactDocument trusted;
+    ASSERT_TRUE(trusted.LoadTrustedSnapshot(memory.data(), image.size()));
+    EXPECT_EQ(summarize(trusted), summarize(document));
+}
+
+TEST(CompactDocumentTest, SnapshotHeaderErrors)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    std::string image = document.Snapshot();
+
+    CompactDocument loaded;
+    std::vector<uint32_t> memory = aligned(image);
+    EXPECT_FALSE(loaded.LoadSnapshot(memory.data(), 8));
+    EXPECT_FALSE(loaded.LoadSnapshot(memory.data(), image.size() - 1));
+    EXPECT_STREQ(loaded.ErrorMessage(), "Snapshot is truncated or corrupt");
+
+    std::string bad = image;
+    bad[0]          = 'X';
+    memory          = aligned(bad);
+    EXPECT_FALSE(loaded.LoadSnapshot(memory.data(), bad.size()));
+    EXPECT_STREQ(loaded.ErrorMessage(), "Not a snapshot");
+    EXPECT_EQ(loaded.Size(), 0u);
+}
+
+TEST(CompactDocumentTest, CorruptSnapshotIsRejected)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    std::string image    = document.Snapshot();
+    std::string expected = summarize(document);
+
+    // Each word after the header is replaced by values that are out of range, so that a load that succeeds must
+    // still be safe to read
+    size_t constexpr HEADER = 32;
+    std::mt19937     random(1);
+    for (size_t offset = HEADER; offset + 4 <= image.size(); offset += 4)
+    {
+        uint32_t const values[] = { 0xffffffff, 0xfffffffe, 0x7fffffff, uint32_t(image.size()), 0, 5, uint32_t(random()) };
+        for (uint32_t value : values)
+        {
+            std::string corrupt = image;
+            memcpy(&corrupt[offset], &value, sizeof(value));
+            std::vector<uint32_t> memory = aligned(corrupt);
+
+            CompactDocument loaded;
+            if (loaded.LoadSnapshot(memory.data(), corrupt.size()))
+                summarize(loaded);
+        }
+    }
+
+    // The header counts must agree with the size
+    for (size_t offset = 16; offset < HEADER; offset += 4)
+    {
+        std::string corrupt = image;
+        uint32_t    value;
+        memcpy(&value, &corrupt[offset], sizeof(value));
+        ++value;
+        memcpy(&corrupt[offset], &value, sizeof(value));
+        std::vector<uint32_t> memory = aligned(corrupt);
+
+        CompactDocument loaded;
+        EXPECT_FALSE(loaded.LoadSnapshot(memory.data(), corrupt.size())) << "offset " << offset;
+    }
+}
+
+TEST(CompactDocumentTest, CycleIsRejected)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse("<a><b/><c/></a>"));
+    std::string image = document.Snapshot();
+
+    // The next sibling of c (element 2) is set to b (element 1), which would make the children of a endless
+    size_t constexpr HEADER      = 32;
+    size_t constexpr NEXTSIBLING = HEADER + 2 * 3 * sizeof(uint32_t);
+    uint32_t         b           = 1;
+    memcpy(&image[NEXTSIBLING + 2 * sizeof(uint32_t)], &b, sizeof(b));
+    std::vector<uint32_t> memory = aligned(image);
+
+    CompactDocument loaded;
+    EXPECT_FALSE(loaded.LoadSnapshot(memory.data(), image.size()));
+}
+
+TEST(CompactDocumentTest, SaveSnapshotReplacesAMappedFile)
+{
+    std::string path = testing::TempDir() + "msxmlx_snapshot_test.snap";
+
+    CompactDocument first;
+    ASSERT_TRUE(first.Parse(DOCUMENT));
+    ASSERT_TRUE(first.SaveSnapshot(path.c_str()));
+
+    CompactDocument mapped;
+    ASSERT_TRUE(mapped.LoadSnapshot(path.c_str())) << mapped.ErrorMessage();
+    std::string before = summarize(mapped);
+
+    // The mapped document is not changed by saving another snapshot over its file
+    CompactDocument second;
+    ASSERT_TRUE(second.Parse("<other a='1'><b>text</b></other>"));
+    ASSERT_TRUE(second.SaveSnapshot(path.c_str()));
+    EXPECT_EQ(summarize(mapped), before);
+
+    CompactDocument reloaded;
+    ASSERT_TRUE(reloaded.LoadSnapshot(path.c_str()));
+    EXPECT_EQ(summarize(reloaded), summarize(second));
+
+    mapped   = CompactDocument();
+    reloaded = CompactDocument();
+    EXPECT_EQ(remove(path.c_str()), 0);
+}
@@ -0,0 +1,317 @@
+#include <Msxmlx/Convert.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Returns the wide version of ASCII text
+std::wstring widen(std::string_view text)
+{
+    return std::wstring(text.begin(), text.end());
+}
+} // anonymous namespace
+
+TEST(ConvertTest, Whitespace)
+{
+    // Leading and trailing XML whitespace is ignored, but not whitespace inside the value
+    float    f = 0.f;
+    int      i = 0;
+    uint32_t h = 0;
+    bool     b = false;
+    EXPECT_TRUE(ParseFloat(" \t1.5\r\n", f));
+    EXPECT_EQ(f, 1.5f);
+    EXPECT_TRUE(ParseInt("\n -7 ", i));
+    EXPECT_EQ(i, -7);
+    EXPECT_TRUE(ParseHex("  0xff\t", h));
+    EXPECT_EQ(h, 0xffu);
+    EXPECT_TRUE(ParseBool(" TRUE ", b));
+    EXPECT_TRUE(b);
+    EXPECT_FALSE(ParseInt("1 2", i));
+    EXPECT_FALSE(ParseFloat("- 1", f));
+    EXPECT_FALSE(ParseBool("tr ue", b));
+
+    // Other whitespace is not ignored
+    EXPECT_FALSE(ParseInt("\v1", i));
+    EXPECT_FALSE(ParseInt(L"1\x00a0", i));
+    EXPECT_EQ(i, -7);
+}
+
+TEST(ConvertTest, EmptyText)
+{
+    float    f = 1.f;
+    int      i = 1;
+    uint32_t h = 1;
+    bool     b = true;
+    for (char const * text : { "", "   ", "+", "-" })
+    {
+        EXPECT_FALSE(ParseFloat(text, f)) << text;
+        EXPECT_FALSE(ParseInt(text, i)) << text;
+        EXPECT_FALSE(ParseHex(text, h)) << text;
+        EXPECT_FALSE(ParseBool(text, b)) << text;
+        EXPECT_FALSE(ParseFloat(widen(text), f)) << text;
+        EXPECT_FALSE(ParseInt(widen(text), i)) << text;
+        EXPECT_FALSE(ParseHex(widen(text), h)) << text;
+        EXPECT_FALSE(ParseBool(widen(text), b)) << text;
+    }
+
+    // The values are not changed when the conversion fails
+    EXPECT_EQ(f, 1.f);
+    EXPECT_EQ(i, 1);
+    EXPECT_EQ(h, 1u);
+    EXPECT_TRUE(b);
+}
+
+TEST(ConvertTest, Overflow)
+{
+    float    f = 1.f;
+    int      i = 1;
+    uint32_t h = 1;
+    EXPECT_TRUE(ParseInt("2147483647", i));
+    EXPECT_EQ(i, 2147483647);
+    EXPECT_TRUE(ParseInt("-2147483648", i));
+    EXPECT_EQ(i, -2147483647 - 1);
+    EXPECT_FALSE(ParseInt("2147483648", i));
+    EXPECT_FALSE(ParseInt("-2147483649", i));
+    EXPECT_FALSE(ParseInt("99999999999999999999", i));
+    EXPECT_EQ(i, -2147483647 - 1);
+
+    EXPECT_TRUE(ParseHex("ffffffff", h));
+    EXPECT_EQ(h, 0xffffffffu);
+    EXPECT_FALSE(ParseHex("100000000", h));
+    EXPECT_FALSE(ParseHex("0x100000000", h));
+    EXPECT_EQ(h, 0xffffffffu);
+
+    EXPECT_TRUE(ParseFloat("3.4e38", f));
+    EXPECT_FALSE(ParseFloat("1e40", f));
+    EXPECT_FALSE(ParseFloat(L"-1e40", f));
+    EXPECT_EQ(f, 3.4e38f);
+}
+
+TEST(ConvertTest, HexPrefixAndSign)
+{
+    uint32_t h = 0;
+    EXPECT_TRUE(ParseHex("0x1F", h));
+    EXPECT_EQ(h, 0x1fu);
+    EXPECT_TRUE(ParseHex("0XaB", h));
+    EXPECT_EQ(h, 0xabu);
+    EXPECT_TRUE(ParseHex("0x0", h));
+    EXPECT_EQ(h, 0u);
+
+    // "0x" alone is not a prefix, and the digits after a prefix must be hexadecimal
+    EXPECT_FALSE(ParseHex("0x", h));
+    EXPECT_FALSE(ParseHex("0x 1", h));
+    EXPECT_FALSE(ParseHex("0x0x1", h));
+    EXPECT_FALSE(ParseHex("x1", h));
+    EXPECT_FALSE(ParseHex("1g", h));
+
+    // A sign is not allowed, even though wcstoul() accepts "-1" as 0xffffffff
+    EXPECT_FALSE(ParseHex("-1", h));
+    EXPECT_FALSE(ParseHex("+1", h));
+    EXPECT_FALSE(ParseHex("0x-1", h));
+    EXPECT_FALSE(ParseHex(L"-1", h));
+    EXPECT_EQ(h, 0u);
+
+    // A decimal int does not take the prefix
+    int i = 0;
+    EXPECT_FALSE(ParseInt("0x10", i));
+}
+
+TEST(ConvertTest, Bool)
+{
+    bool b = false;
+    for (char const * text : { "true", "True", "TRUE", "1", "-1", "0.5", "+2", "1e3" })
+    {
+        b = false;
+        EXPECT_TRUE(ParseBool(text, b)) << text;
+        EXPECT_TRUE(b) << text;
+    }
+    for (char const * text : { "false", "FALSE", "0", "-0", "0.0", "0e9" })
+    {
+        b = true;
+        EXPECT_TRUE(ParseBool(text, b)) << text;
+        EXPECT_FALSE(b) << text;
+    }
+
+    // Infinities and NaNs are not valid, like any other text that is not a finite number
+    for (char const * text : { "nan", "NaN", "inf", "-inf", "infinity", "1e40", "yes", "t", "truefalse", "0x1" })
+    {
+        b = true;
+        EXPECT_FALSE(ParseBool(text, b)) << text;
+        EXPECT_FALSE(ParseBool(widen(text), b)) << text;
+        EXPECT_TRUE(b) << text;
+    }
+}
+
+TEST(ConvertTest, NarrowAndWideAgree)
+{
+    char const * const TEXTS[] = { "",     " 12 ", "-3",   "+4",  "1.5",        "-2e3",     "ff",        "0x1F",
+                                   "0x",   "-1",   "true", "FALSE", "nan",       "inf",      "1e40",      "1 2",
+                                   "\t0\n", "0.0",  "+",    "x",     "2147483648", "ffffffff", "100000000" };
+    for (char const * text : TEXTS)
+    {
+        std::wstring wide = widen(text);
+        EXPECT_EQ(TrimWhitespace(wide), widen(TrimWhitespace(text))) << text;
+
+        float narrowFloat = -1.f, wideFloat = -1.f;
+        EXPECT_EQ(ParseFloat(text, narrowFloat), ParseFloat(wide, wideFloat)) << text;
+        EXPECT_EQ(std::isnan(narrowFloat), std::isnan(wideFloat)) << text;
+        if (!std::isnan(narrowFloat))
+        {
+            EXPECT_EQ(narrowFloat, wideFloat) << text;
+        }
+
+        int narrowInt = -1, wideInt = -1;
+        EXPECT_EQ(ParseInt(text, narrowInt), ParseInt(wide, wideInt)) << text;
+        EXPECT_EQ(narrowInt, wideInt) << text;
+
+        uint32_t narrowHex = 1, wideHex = 1;
+        EXPECT_EQ(ParseHex(text, narrowHex), ParseHex(wide, wideHex)) << text;
+        EXPECT_EQ(narrowHex, wideHex) << text;
+
+        bool narrowBool = true, wideBool = true;
+        EXPECT_EQ(ParseBool(text, narrowBool), ParseBool(wide, wideBool)) << text;
+        EXPECT_EQ(narrowBool, wideBool) << text;
+    }
+
+    // Wide text that is not ASCII is not valid
+    int i = 0;
+    EXPECT_FALSE(ParseInt(L"\x0661", i));
+    EXPECT_FALSE(ParseInt(L"\xff11", i));
+}
+
+TEST(ConvertTest, FloatArray)
+{
+    std::vector<float> values;
+    EXPECT_TRUE(ParseFloatArray(" 1 -2.5\t+3e2\r\n.5 ", values));
+    EXPECT_EQ(values, std::vector<float>({ 1.f, -2.5f, 300.f, .5f }));
+    EXPECT_EQ(CountValues(" 1 -2.5\t+3e2\r\n.5 "), 4u);
+
+    EXPECT_TRUE(ParseFloatArray("", values));
+    EXPECT_TRUE(values.empty());
+    EXPECT_TRUE(ParseFloatArray(" \t ", values));
+    EXPECT_TRUE(values.empty());
+}
+
+TEST(ConvertTest, IntArray)
+{
+    std::vector<int> values;
+    EXPECT_TRUE(ParseIntArray("1 -2 +3 2147483647 -2147483648", values));
+    EXPECT_EQ(values, std::vector<int>({ 1, -2, 3, 2147483647, -2147483647 - 1 }));
+}
+
+TEST(ConvertTest, HexArray)
+{
+    std::vector<uint32_t> values;
+    EXPECT_TRUE(ParseHexArray("ff 0x10 0XaB DEADbeef 0", values));
+    EXPECT_EQ(values, std::vector<uint32_t>({ 0xff, 0x10, 0xab, 0xdeadbeef, 0 }));
+}
+
+TEST(ConvertTest, MalformedArrays)
+{
+    // A list with any invalid value is invalid, and the vector is emptied
+    std::vector<float> floats = { 9.f };
+    for (char const * text : { "1 x 3", "1,2", "1 2-", "- 1", "1..2", "1 +-2", "1e" })
+    {
+        EXPECT_FALSE(ParseFloatArray(text, floats)) << text;
+        EXPECT_TRUE(floats.empty()) << text;
+        EXPECT_FALSE(ParseFloatArray(widen(text), floats)) << text;
+    }
+
+    std::vector<int> ints = { 9 };
+    for (char const * text : { "1.5", "1 2147483648", "1 -2147483649", "0x10", "1 2 a", "++1" })
+    {
+        EXPECT_FALSE(ParseIntArray(text, ints)) << text;
+        EXPECT_TRUE(ints.empty()) << text;
+        EXPECT_FALSE(ParseIntArray(widen(text), ints)) << text;
+    }
+
+    std::vector<uint32_t> hex = { 9 };
+    for (char const * text : { "fg", "0x", "1 100000000", "-1", "0x-1", "1 0x 2" })
+    {
+        EXPECT_FALSE(ParseHexArray(text, hex)) << text;
+        EXPECT_TRUE(hex.empty()) << text;
+        EXPECT_FALSE(ParseHexArray(widen(text), hex)) << text;
+    }
+
+    // Wide text that is not ASCII is never valid, even where it looks like a digit or a separator
+    std::vector<int> wide;
+    EXPECT_FALSE(ParseIntArray(L"1 \x0662 3", wide));
+    EXPECT_FALSE(ParseIntArray(L"1\x00a0" L"2", wide));
+    EXPECT_EQ(CountValues(L"1\x00a0" L"2"), 1u);
+}
+
+TEST(ConvertTest, ArrayWithCount)
+{
+    // The values fit
+    float  floats[4] = {};
+    size_t count     = 4;
+    EXPECT_TRUE(ParseFloatArray("1 2 3", floats, count));
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(floats[2], 3.f);
+    EXPECT_EQ(floats[3], 0.f);
+
+    // Too many values: the array is filled, and the count is the number of values in the text
+    int ints[3] = {};
+    count       = 3;
+    EXPECT_FALSE(ParseIntArray("1 2 3 4 5", ints, count));
+    EXPECT_EQ(count, 5u);
+    EXPECT_EQ(ints[0], 1);
+    EXPECT_EQ(ints[2], 3);
+
+    // An empty array counts the values
+    count = 0;
+    EXPECT_FALSE(ParseHexArray("a b c", static_cast<uint32_t *>(nullptr), count));
+    EXPECT_EQ(count, 3u);
+    count = 0;
+    EXPECT_TRUE(ParseHexArray("  ", static_cast<uint32_t *>(nullptr), count));
+    EXPECT_EQ(count, 0u);
+
+    // An invalid value gives a count of 0, even past the end of the array
+    uint32_t hex[2] = {};
+    count           = 2;
+    EXPECT_FALSE(ParseHexArray("1 2 3 z", hex, count));
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(ConvertTest, NarrowAndWideArraysAgree)
+{
+    char const * const LISTS[] = { "",        " 1 2 3 ",   "1.5 -2e3 +4", "ff 0x1F 10", "1 x",
+                                   "2147483648", "-0 +0 0", "\t7\r\n8",    "0x",         "1e40 1" };
+    for (char const * text : LISTS)
+    {
+        std::wstring wide = widen(text);
+        EXPECT_EQ(CountValues(text), CountValues(wide)) << text;
+
+        std::vector<float> narrowFloats, wideFloats;
+        EXPECT_EQ(ParseFloatArray(text, narrowFloats), ParseFloatArray(wide, wideFloats)) << text;
+        EXPECT_EQ(narrowFloats, wideFloats) << text;
+
+        std::vector<int> narrowInts, wideInts;
+        EXPECT_EQ(ParseIntArray(text, narrowInts), ParseIntArray(wide, wideInts)) << text;
+        EXPECT_EQ(narrowInts, wideInts) << text;
+
+        std::vector<uint32_t> narrowHex, wideHex;
+        EXPECT_EQ(ParseHexArray(text, narrowHex), ParseHexArray(wide, wideHex)) << text;
+        EXPECT_EQ(narrowHex, wideHex) << text;
+
+        // The values written before an invalid value are not specified, so they are only compared on success
+        int    narrowArray[2] = {}, wideArray[2] = {};
+        size_t narrowCount = 2, wideCount = 2;
+        bool   narrowResult = ParseIntArray(text, narrowArray, narrowCount);
+        EXPECT_EQ(narrowResult, ParseIntArray(wide, wideArray, wideCount)) << text;
+        EXPECT_EQ(narrowCount, wideCount) << text;
+        if (narrowResult)
+        {
+            EXPECT_EQ(narrowArray[0], wideArray[0]) << text;
+            EXPECT_EQ(narrowArray[1], wideArray[1]) << text;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#include <Msxmlx/DocumentCache.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Msxmlx;
+
+namespace
+{
+// Writes a file, returning false on failure
+bool writeFile(std::string const & path, std::string const & text)
+{
+    FILE * pFile = fopen(path.c_str(), "wb");
+    if (pFile == nullptr)
+        return false;
+    bool written = fwrite(text.data(), 1, text.size(), pFile) == text.size();
+    return (fclose(pFile) == 0) && written;
+}
+
+// Returns the version attribute of a file's document, or -1 if it is not loaded
+int version(DocumentCache & cache, std::string const & path)
+{
+    DocumentCache::Handle pDocument = cache.Get(path);
+    return pDocument ? pDocument->GetIntAttribute(pDocument->Root(), "version", -1) : -1;
+}
+
+// Waits for a file's document to have a version, returning false if it does not within a few seconds
+bool waitForVersion(DocumentCache & cache, std::string const & path, int expected)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (version(cache, path) != expected)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+std::string const VERSION_1 = "<config version='1'/>";
+std::string const VERSION_2 = "<config version='2' changed='yes'/>";
+} // anonymous namespace
+
+TEST(DocumentCacheTest, CachesAndChecksFiles)
+{
+    std::string path = testing::TempDir() + "msxmlx_cache_test.xml";
+    ASSERT_TRUE(writeFile(path, VERSION_1));
+
+    DocumentCache         cache(DocumentCache::DEFAULT_MAX_BYTES, false);
+    DocumentCache::Handle pFirst = cache.Get(path);
+    ASSERT_TRUE(pFirst);
+    EXPECT_EQ(cache.Get(path), pFirst);
+    EXPECT_EQ(cache.GetStatistics().hits, 1u);
+    EXPECT_EQ(cache.GetStatistics().misses, 1u);
+
+    // The size differs, so the change is noticed however coarse the modification times are
+    ASSERT_TRUE(writeFile(path, VERSION_2));
+    EXPECT_EQ(version(cache, path), 2);
+    EXPECT_EQ(pFirst->GetIntAttribute(pFirst->Root(), "version"), 1);
+
+    cache.Remove(path);
+    EXPECT_EQ(cache.GetStatistics().count, 0u);
+    remove(path.c_str());
+}
+
+TEST(DocumentCacheTest, FailuresAreNotCached)
+{
+    std::string path = testing::TempDir() + "msxmlx_cache_bad.xml";
+    ASSERT_TRUE(writeFile(path, "<config version='1'>"));
+
+    DocumentCache cache;
+    EXPECT_FALSE(cache.Get(path));
+    EXPECT_EQ(cache.GetStatistics().count, 0u);
+
+    ASSERT_TRUE(writeFile(path, VERSION_1));
+    EXPECT_EQ(version(cache, path), 1);
+    remove(path.c_str());
+    EXPECT_FALSE(cache.Get(testing::TempDir() + "msxmlx_cache_missing.xml"));
+}
+
+TEST(DocumentCacheTest, EvictsLeastRecentlyRequested)
+{
+    std::string first  = testing::TempDir() + "msxmlx_cache_1.xml";
+    std::string second = testing::TempDir() + "msxmlx_cache_2.xml";
+    ASSERT_TRUE(writeFile(first, VERSION_1));
+    ASSERT_TRUE(writeFile(second, VERSION_2));
+
+    DocumentCache cache(1, false);
+    ASSERT_TRUE(cache.Get(first));
+    ASSERT_TRUE(cache.Get(second));
+    EXPECT_EQ(cache.GetStatistics().evictions, 2u);
+    EXPECT_EQ(cache.GetStatistics().count, 0u);
+    remove(first.c_str());
+    remove(second.c_str());
+}
+
+#if !defined(_WIN32)
+TEST(DocumentCacheTest, WatchedFileIsReloaded)
+{
+    DocumentCache cache;
+    if (!cache.IsWatching())
+        GTEST_SKIP() << "Watching is not supported";
+
+    std::string path = testing::TempDir() + "msxmlx_cache_watched.xml";
+    ASSERT_TRUE(writeFile(path, VERSION_1));
+    EXPECT_EQ(version(cache, path), 1);
+
+    ASSERT_TRUE(writeFile(path, VERSION_2));
+    EXPECT_TRUE(waitForVersion(cache, path, 2));
+    EXPECT_EQ(cache.GetStatistics().misses, 1u);
+
+    remove(path.c_str());
+    EXPECT_TRUE(waitForVersion(cache, path, -1));
+}
+
+TEST(DocumentCacheTest, MovedDirectoryIsNoLongerTrusted)
+{
+    DocumentCache cache;
+    if (!cache.IsWatching())
+        GTEST_SKIP() << "Watching is not supported";
+
+    std::string directory = testing::TempDir() + "msxmlx_cache_" + std::to_string(getpid());
+    std::string moved     = directory + ".moved";
+    std::string path      = directory + "/config.xml";
+    ASSERT_EQ(mkdir(directory.c_str(), 0777), 0);
+    ASSERT_TRUE(writeFile(path, VERSION_1));
+    EXPECT_EQ(version(cache, path), 1);
+
+    // The watch follows the moved directory, so a new file at the same path is found only if the watch is dropped
+    ASSERT_EQ(rename(directory.c_str(), moved.c_str()), 0);
+    ASSERT_EQ(mkdir(directory.c_str(), 0777), 0);
+    ASSERT_TRUE(writeFile(path, VERSION_2));
+    EXPECT_TRUE(waitForVersion(cache, path, 2));
+
+    cache.Clear();
+    remove(path.c_str());
+    remove((moved + "/config.xml").c_str());
+    rmdir(directory.c_str());
+    rmdir(moved.c_str());
+}
+#endif
@@ -0,0 +1,175 @@
+#include <Msxmlx/Elements.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Elements.h is empty without C++20 coroutines
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+using namespace Msxmlx;
+
+namespace
+{
+// Entities at world/entity are 1, 2 and 4. The others are nested more deeply, and one is named like the root.
+char const DOCUMENT[] = "<world>"
+                        "<entity id='1'><part/><part/></entity>"
+                        "<group><entity id='9'/></group>"
+                        "<entity id='2'><entity id='3'/></entity>"
+                        "<world><entity id='8'/></world>"
+                        "<entity id='4'/>"
+                        "</world>";
+
+// Returns the ids of the elements at a path
+std::vector<int> ids(StreamReader & reader, std::string const & path)
+{
+    std::vector<int> result;
+    for (ElementView const & element : Elements(reader, path))
+    {
+        result.push_back(element.attributes.GetIntAttribute("id"));
+    }
+    return result;
+}
+
+// A source that returns a document a few bytes at a time, and counts the bytes returned
+struct ChunkedSource
+{
+    std::string_view document;
+    size_t           chunk;
+    size_t *         pRead;
+
+    ptrdiff_t operator ()(char * pBuffer, size_t size)
+    {
+        size_t n = std::min({ size, chunk, document.size() - *pRead });
+        memcpy(pBuffer, document.data() + *pRead, n);
+        *pRead += n;
+        return ptrdiff_t(n);
+    }
+};
+} // anonymous namespace
+
+TEST(ElementsTest, PathMatching)
+{
+    StreamReader reader{ std::string_view(DOCUMENT) };
+    EXPECT_EQ(ids(reader, "world/entity"), std::vector<int>({ 1, 2, 4 }));
+    EXPECT_EQ(reader.Current(), StreamReader::Token::End);
+
+    StreamReader nested{ std::string_view(DOCUMENT) };
+    EXPECT_EQ(ids(nested, "world/group/entity"), std::vector<int>({ 9 }));
+
+    StreamReader none{ std::string_view(DOCUMENT) };
+    EXPECT_TRUE(ids(none, "entity").empty());
+}
+
+TEST(ElementsTest, DepthAndName)
+{
+    StreamReader reader{ std::string_view(DOCUMENT) };
+    for (ElementView const & element : Elements(reader, "world/group/entity"))
+    {
+        EXPECT_EQ(element.name, "entity");
+        EXPECT_EQ(element.depth, 2);
+        EXPECT_EQ(element.pReader, &reader);
+    }
+}
+
+TEST(ElementsTest, StopsEarly)
+{
+    // The rest of the document is not read once the consumer stops
+    std::string document = "<world>";
+    for (int i = 0; i < 1000; ++i)
+        document += "<entity id='" + std::to_string(i) + "'/>";
+    document += "</world>";
+
+    size_t       read = 0;
+    StreamReader reader(ChunkedSource{ document, 64, &read }, 256);
+    int          found = -1;
+    for (ElementView const & element : Elements(reader, "world/entity"))
+    {
+        found = element.attributes.GetIntAttribute("id");
+        if (found == 5)
+            break;
+    }
+    EXPECT_EQ(found, 5);
+    EXPECT_LT(read, 1024u);
+}
+
+TEST(ElementsTest, ConsumerAdvancesInsideElement)
+{
+    // Each entity's parts are read by the consumer, and the next entity is still found
+    StreamReader     reader{ std::string_view(DOCUMENT) };
+    std::vector<int> parts;
+    for (ElementView const & element : Elements(reader, "world/entity"))
+    {
+        int count = 0;
+        element.pReader->ForEachSubElement([&] (StreamReader &) {
+            ++count;
+            return true;
+        });
+        parts.push_back(count);
+    }
+    EXPECT_EQ(parts, std::vector<int>({ 2, 1, 0 }));
+
+    // A consumer that stops part of the way through an element
+    StreamReader     partial{ std::string_view(DOCUMENT) };
+    std::vector<int> found;
+    for (ElementView const & element : Elements(partial, "world/entity"))
+    {
+        found.push_back(element.attributes.GetIntAttribute("id"));
+        element.pReader->Next();
+    }
+    EXPECT_EQ(found, std::vector<int>({ 1, 2, 4 }));
+}
+
+TEST(ElementsTest, PendingSourceEndsSequence)
+{
+    // The source has no data after the first entity. A second sequence continues where the first ended.
+    std::string_view document(DOCUMENT);
+    size_t           split   = document.find("<entity id='2'>") + 5;
+    size_t           read    = 0;
+    bool             pending = true;
+    StreamReader     reader([&] (char * pBuffer, size_t size) -> ptrdiff_t {
+        size_t limit = pending ? split : document.size();
+        if (read == limit)
+            return (read < document.size()) ? StreamReader::PENDING : 0;
+        size_t n = std::min(size, limit - read);
+        memcpy(pBuffer, document.data() + read, n);
+        read += n;
+        return ptrdiff_t(n);
+    }, 16);
+
+    EXPECT_EQ(ids(reader, "world/entity"), std::vector<int>({ 1 }));
+    EXPECT_EQ(reader.Current(), StreamReader::Token::None);
+    pending = false;
+    EXPECT_EQ(ids(reader, "world/entity"), std::vector<int>({ 2, 4 }));
+    EXPECT_EQ(reader.Current(), StreamReader::Token::End);
+}
+
+TEST(ElementsTest, ExceptionIsRethrown)
+{
+    // The source throws after the first entity, which is rethrown by the increment
+    std::string_view document(DOCUMENT);
+    size_t           split = document.find("<group>");
+    size_t           read  = 0;
+    StreamReader     reader([&] (char * pBuffer, size_t size) -> ptrdiff_t {
+        if (read == split)
+            throw std::runtime_error("source");
+        size_t n = std::min(size, split - read);
+        memcpy(pBuffer, document.data() + read, n);
+        read += n;
+        return ptrdiff_t(n);
+    }, 16);
+
+    std::vector<int> found;
+    EXPECT_THROW({
+        for (ElementView const & element : Elements(reader, "world/entity"))
+            found.push_back(element.attributes.GetIntAttribute("id"));
+    }, std::runtime_error);
+    EXPECT_EQ(found, std::vector<int>({ 1 }));
+}
+
+#endif // defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
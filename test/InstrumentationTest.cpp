@@ -0,0 +1,294 @@
+#include <Msxmlx/Instrumentation.h>
+
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/Name.h>
+#if defined(_WIN32)
+#include <Msxmlx/Msxmlx.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Msxmlx;
+using namespace Msxmlx::Instrumentation;
+
+static_assert(ENABLED, "These tests are only built with the CMake option Msxmlx_INSTRUMENTATION");
+
+namespace
+{
+char const DOCUMENT[] = "<r a='1' b='2.5' c='x'><p>1</p><q/><s>7</s></r>";
+
+// Returns a counter of a family in a snapshot
+uint64_t count(Snapshot const & snapshot, Family family, Counter counter)
+{
+    return snapshot.families[size_t(family)].counts[size_t(counter)];
+}
+
+// Returns the number of calls of a family whose latencies were measured
+uint64_t measured(Snapshot const & snapshot, Family family)
+{
+    uint64_t calls = 0;
+    for (uint64_t n : snapshot.families[size_t(family)].latency)
+        calls += n;
+    return calls;
+}
+
+// Returns true if every counter of a snapshot is zero
+bool isZero(Snapshot const & snapshot)
+{
+    for (size_t family = 0; family < size_t(Family::COUNT); ++family)
+    {
+        for (size_t counter = 0; counter < size_t(Counter::COUNT); ++counter)
+        {
+            if (count(snapshot, Family(family), Counter(counter)) != 0)
+                return false;
+        }
+        if (measured(snapshot, Family(family)) != 0)
+            return false;
+    }
+    return true;
+}
+
+class InstrumentationTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(document_.Parse(DOCUMENT));
+        MeasureLatency(false);
+        Reset();
+    }
+
+    void TearDown() override { MeasureLatency(false); }
+
+    CompactDocument document_;
+};
+} // anonymous namespace
+
+TEST_F(InstrumentationTest, Counters)
+{
+    CompactDocument::Index root = document_.Root();
+    EXPECT_EQ(document_.GetFloatAttribute(root, "b"), 2.5f);
+    EXPECT_EQ(document_.GetIntAttribute(root, "missing", 3), 3);
+
+    // A name that is not in the document is not looked for, so only the first call scans attributes
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::CALLS), 2u);
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::SCANNED), 2u);
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::COERCIONS), 1u);
+
+    // A string is allocated for the value
+    EXPECT_EQ(document_.GetStringAttribute(root, "c"), "x");
+    EXPECT_EQ(count(GetSnapshot(), Family::GET_ATTRIBUTE, Counter::ALLOCATED), 1u);
+}
+
+TEST_F(InstrumentationTest, OnlyTheOutermostCallIsCounted)
+{
+    // GetIntSubElement() calls GetSubElementValue(), which calls GetSubElement(). The sub-elements scanned by the
+    // innermost call are counted in the family of the outermost one.
+    EXPECT_EQ(document_.GetIntSubElement(document_.Root(), "s"), 7);
+
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT_VALUE, Counter::CALLS), 1u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT_VALUE, Counter::SCANNED), 3u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT_VALUE, Counter::COERCIONS), 1u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT, Counter::CALLS), 0u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT, Counter::SCANNED), 0u);
+
+    // The same lookup on its own is counted in its own family
+    EXPECT_NE(document_.GetSubElement(document_.Root(), "q"), CompactDocument::NONE);
+    snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT, Counter::CALLS), 1u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT, Counter::SCANNED), 2u);
+}
+
+TEST_F(InstrumentationTest, NamesAreCountedInTheCurrentCall)
+{
+    // Nothing is counted outside of a call
+    Name outside("abc");
+    EXPECT_TRUE(isZero(GetSnapshot()));
+
+    {
+        Call outer(Family::GET_ATTRIBUTE);
+        Name first("abc");
+        {
+            Call inner(Family::GET_SUB_ELEMENT);
+            Name second("de");
+        }
+    }
+
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::CALLS), 1u);
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::CONVERSIONS), 2u);
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::ALLOCATED),
+              2 * sizeof(uint32_t) + (4 + 3) * sizeof(wchar_t));
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT, Counter::CALLS), 0u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT, Counter::CONVERSIONS), 0u);
+}
+
+TEST_F(InstrumentationTest, EnumerationHasNoScope)
+{
+    // The accessors called by the callback are counted in their own families
+    int sum = 0;
+    EXPECT_TRUE(document_.ForEachSubElement(document_.Root(), [&] (CompactDocument::Index child) {
+        sum += document_.GetIntAttribute(child, "n", 1);
+        return true;
+    }));
+    EXPECT_EQ(sum, 3);
+
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::CALLS), 1u);
+    EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::SCANNED), 3u);
+    EXPECT_EQ(count(snapshot, Family::GET_ATTRIBUTE, Counter::CALLS), 3u);
+    EXPECT_EQ(measured(snapshot, Family::FOR_EACH), 0u);
+}
+
+#if defined(_WIN32)
+TEST_F(InstrumentationTest, MsxmlEnumerationTemplates)
+{
+    // A lambda resolves to the template overloads rather than to the std::function overloads, and they are counted
+    // the same way
+    ASSERT_TRUE(SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED)));
+    {
+        CComPtr<IXMLDOMDocument2> pDocument;
+        ASSERT_TRUE(SUCCEEDED(pDocument.CoCreateInstance(__uuidof(DOMDocument60))));
+        VARIANT_BOOL loaded = VARIANT_FALSE;
+        ASSERT_TRUE(SUCCEEDED(pDocument->loadXML(CComBSTR(L"<r>t<p/><q/></r>"), &loaded)));
+        ASSERT_EQ(loaded, VARIANT_TRUE);
+        CComPtr<IXMLDOMElement> pRoot;
+        ASSERT_TRUE(SUCCEEDED(pDocument->get_documentElement(&pRoot)));
+
+        int  nodes    = 0;
+        int  elements = 0;
+        auto node     = [&] (IXMLDOMNode *) { ++nodes; return true; };
+        auto element  = [&] (IXMLDOMElement *) { ++elements; return true; };
+
+        Reset();
+        CComPtr<IXMLDOMNodeList> pNodes;
+        ASSERT_TRUE(SUCCEEDED(pRoot->get_childNodes(&pNodes)));
+        EXPECT_TRUE(ForEachNode(pNodes, node));
+        EXPECT_EQ(nodes, 3);
+        Snapshot snapshot = GetSnapshot();
+        EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::CALLS), 1u);
+        EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::SCANNED), 3u);
+
+        // Every node is scanned, though the callable is only called for the elements
+        Reset();
+        CComPtr<IXMLDOMNodeList> pElements;
+        ASSERT_TRUE(SUCCEEDED(pRoot->get_childNodes(&pElements)));
+        EXPECT_TRUE(ForEachElement(pElements, element));
+        EXPECT_EQ(elements, 2);
+        snapshot = GetSnapshot();
+        EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::CALLS), 1u);
+        EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::SCANNED), 3u);
+
+        Reset();
+        nodes = 0;
+        EXPECT_TRUE(ForEachSubNode(pRoot, node));
+        EXPECT_EQ(nodes, 3);
+        snapshot = GetSnapshot();
+        EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::CALLS), 1u);
+        EXPECT_EQ(count(snapshot, Family::FOR_EACH, Counter::SCANNED), 3u);
+    }
+    CoUninitialize();
+}
+#endif // defined(_WIN32)
+
+TEST_F(InstrumentationTest, SnapshotAndReset)
+{
+    document_.GetIntAttribute(document_.Root(), "a");
+    Snapshot before = GetSnapshot();
+    Reset();
+    Snapshot after = GetSnapshot();
+
+    // A snapshot is a copy, so it is not changed by a reset
+    EXPECT_EQ(count(before, Family::GET_ATTRIBUTE, Counter::CALLS), 1u);
+    EXPECT_TRUE(isZero(after));
+
+    document_.GetIntAttribute(document_.Root(), "a");
+    EXPECT_EQ(count(GetSnapshot(), Family::GET_ATTRIBUTE, Counter::CALLS), 1u);
+}
+
+TEST_F(InstrumentationTest, Latency)
+{
+    // Latency is measured for the outermost calls only, while it is enabled
+    document_.GetIntSubElement(document_.Root(), "s");
+    MeasureLatency(true);
+    for (int i = 0; i < 5; ++i)
+        document_.GetIntSubElement(document_.Root(), "s");
+    MeasureLatency(false);
+    document_.GetIntSubElement(document_.Root(), "s");
+
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT_VALUE, Counter::CALLS), 7u);
+    EXPECT_EQ(measured(snapshot, Family::GET_SUB_ELEMENT_VALUE), 5u);
+    EXPECT_EQ(measured(snapshot, Family::GET_SUB_ELEMENT), 0u);
+}
+
+TEST_F(InstrumentationTest, Threads)
+{
+    // The counters are shared, and each thread has its own outermost call
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([this] {
+            for (int j = 0; j < 1000; ++j)
+                document_.GetIntSubElement(document_.Root(), "p");
+        });
+    }
+    {
+        Call call(Family::CREATE_TEXT_ELEMENT);
+        for (std::thread & thread : threads)
+            thread.join();
+    }
+
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT_VALUE, Counter::CALLS), 4000u);
+    EXPECT_EQ(count(snapshot, Family::GET_SUB_ELEMENT_VALUE, Counter::SCANNED), 4000u);
+    EXPECT_EQ(count(snapshot, Family::CREATE_TEXT_ELEMENT, Counter::CALLS), 1u);
+    EXPECT_EQ(count(snapshot, Family::CREATE_TEXT_ELEMENT, Counter::SCANNED), 0u);
+}
+
+TEST_F(InstrumentationTest, Names)
+{
+    EXPECT_STREQ(FamilyName(Family::GET_ATTRIBUTE), "Get*Attribute");
+    EXPECT_STREQ(FamilyName(Family::CREATE_TEXT_ELEMENT), "CreateTextElement");
+    EXPECT_STREQ(FamilyName(Family::COUNT), "");
+    EXPECT_STREQ(CounterName(Counter::CALLS), "calls");
+    EXPECT_STREQ(CounterName(Counter::ALLOCATED), "allocated");
+    EXPECT_STREQ(CounterName(Counter::COUNT), "");
+}
+
+TEST_F(InstrumentationTest, Json)
+{
+    // Families that have not been called are omitted
+    Snapshot snapshot = GetSnapshot();
+    EXPECT_EQ(ToJson(snapshot), "{ \"enabled\": true, \"families\": {} }");
+
+    // Empty latency buckets are omitted, and each bucket is given by its lower bound
+    Counters & subElement = snapshot.families[size_t(Family::GET_SUB_ELEMENT)];
+    subElement.counts[size_t(Counter::CALLS)]       = 12;
+    subElement.counts[size_t(Counter::SCANNED)]     = 840;
+    subElement.counts[size_t(Counter::CONVERSIONS)] = 12;
+    subElement.counts[size_t(Counter::ALLOCATED)]   = 1536;
+    subElement.latency[0]                           = 1;
+    subElement.latency[8]                           = 3;
+    subElement.latency[9]                           = 8;
+    Counters & forEach                              = snapshot.families[size_t(Family::FOR_EACH)];
+    forEach.counts[size_t(Counter::CALLS)]          = 2;
+    forEach.counts[size_t(Counter::SCANNED)]        = 10;
+    EXPECT_EQ(ToJson(snapshot),
+              "{ \"enabled\": true, \"families\": {"
+              " \"GetSubElement\": { \"calls\": 12, \"scanned\": 840, \"coercions\": 0, \"conversions\": 12,"
+              " \"allocated\": 1536, \"latency\": [ [0, 1], [256, 3], [512, 8] ] },"
+              " \"ForEach*\": { \"calls\": 2, \"scanned\": 10, \"coercions\": 0, \"conversions\": 0, \"allocated\": 0 }"
+              " } }");
+
+    // A family with counters but no calls is omitted
+    snapshot.families[size_t(Family::FOR_EACH)].counts[size_t(Counter::CALLS)] = 0;
+    EXPECT_EQ(ToJson(snapshot).find("ForEach*"), std::string::npos);
+}
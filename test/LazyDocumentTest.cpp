@@ -0,0 +1,170 @@
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/LazyDocument.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+char const DOCUMENT[] = R"(<?xml version="1.0"?>
+<mesh name="a &amp; b" scale="1.5" flags="0x1f" visible="true" ids="3 1 2" masks="ff 0x10" weights="0.5 0.25">
+  <vertices>0 1.5 -2 3e2</vertices>
+  <indices> 0 1 2 </indices>
+  <colors><![CDATA[ffffff 00ff00]]></colors>
+  <bad>1 x</bad>
+  <empty/>
+  <child id="1"><leaf>one</leaf></child>
+  <child id="2"><leaf>two &lt;</leaf></child>
+</mesh>)";
+} // anonymous namespace
+
+TEST(LazyDocumentTest, MatchesCompactDocument)
+{
+    LazyDocument    lazy;
+    CompactDocument compact;
+    ASSERT_TRUE(lazy.Parse(DOCUMENT)) << lazy.ErrorMessage();
+    ASSERT_TRUE(compact.Parse(DOCUMENT));
+    ASSERT_EQ(lazy.Size(), compact.Size());
+
+    // Both documents number the elements in document order
+    for (LazyDocument::Index i = 0; i < lazy.Size(); ++i)
+    {
+        EXPECT_EQ(lazy.Name(i), compact.Name(i));
+        EXPECT_EQ(lazy.Parent(i), compact.Parent(i));
+        EXPECT_EQ(lazy.FirstChild(i), compact.FirstChild(i));
+        EXPECT_EQ(lazy.NextSibling(i), compact.NextSibling(i));
+        EXPECT_EQ(lazy.HasValue(i), compact.HasValue(i));
+        EXPECT_EQ(lazy.Value(i), compact.Value(i));
+    }
+    EXPECT_EQ(lazy.GetStringAttribute(lazy.Root(), "name"), "a & b");
+    EXPECT_EQ(lazy.GetStringSubElement(lazy.NextSibling(lazy.GetSubElement(lazy.Root(), "child")), "leaf"), "two <");
+}
+
+TEST(LazyDocumentTest, NoneIsAnEmptyElement)
+{
+    LazyDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+
+    LazyDocument::Index none = LazyDocument::NONE;
+    EXPECT_EQ(document.Parent(none), none);
+    EXPECT_EQ(document.FirstChild(none), none);
+    EXPECT_EQ(document.NextSibling(none), none);
+    EXPECT_EQ(document.Name(none), "");
+    EXPECT_FALSE(document.HasValue(none));
+    EXPECT_EQ(document.Value(none), "");
+
+    std::string_view raw = "x";
+    EXPECT_TRUE(document.RawValue(none, raw));
+    EXPECT_TRUE(raw.empty());
+
+    LazyDocument::Index missing = document.GetSubElement(document.Root(), "missing");
+    EXPECT_EQ(missing, none);
+    EXPECT_EQ(document.GetSubElement(missing, "leaf"), none);
+    EXPECT_EQ(document.GetIntAttribute(missing, "id", -1), -1);
+    EXPECT_EQ(document.GetStringSubElement(missing, "leaf", "default"), "default");
+
+    std::vector<int> values = { 1 };
+    EXPECT_FALSE(document.GetIntArraySubElement(missing, "indices", values));
+    EXPECT_TRUE(values.empty());
+    EXPECT_TRUE(document.ForEachSubElement(missing, [] (LazyDocument::Index) { return false; }));
+
+    LazyDocument empty;
+    EXPECT_EQ(empty.Root(), none);
+    EXPECT_EQ(empty.FirstChild(empty.Root()), none);
+}
+
+TEST(LazyDocumentTest, ArrayAttributes)
+{
+    LazyDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    LazyDocument::Index root = document.Root();
+
+    std::vector<int> ids;
+    EXPECT_TRUE(document.GetIntArrayAttribute(root, "ids", ids));
+    EXPECT_EQ(ids, (std::vector<int>{ 3, 1, 2 }));
+
+    std::vector<float> weights;
+    EXPECT_TRUE(document.GetFloatArrayAttribute(root, "weights", weights));
+    EXPECT_EQ(weights, (std::vector<float>{ 0.5f, 0.25f }));
+
+    std::vector<uint32_t> masks;
+    EXPECT_TRUE(document.GetHexArrayAttribute(root, "masks", masks));
+    EXPECT_EQ(masks, (std::vector<uint32_t>{ 0xff, 0x10 }));
+
+    int    array[2];
+    size_t count = 2;
+    EXPECT_FALSE(document.GetIntArrayAttribute(root, "ids", array, count));
+    EXPECT_EQ(count, 3u);
+
+    float  floats[4];
+    count = 4;
+    EXPECT_TRUE(document.GetFloatArrayAttribute(root, "weights", floats, count));
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(floats[1], 0.25f);
+
+    uint32_t hex[2];
+    count = 2;
+    EXPECT_TRUE(document.GetHexArrayAttribute(root, "masks", hex, count));
+    EXPECT_EQ(hex[0], 0xffu);
+
+    count = 2;
+    EXPECT_FALSE(document.GetHexArrayAttribute(root, "missing", hex, count));
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(LazyDocumentTest, ArraySubElements)
+{
+    LazyDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    LazyDocument::Index root = document.Root();
+
+    std::vector<float> vertices;
+    EXPECT_TRUE(document.GetFloatArraySubElement(root, "vertices", vertices));
+    EXPECT_EQ(vertices, (std::vector<float>{ 0.f, 1.5f, -2.f, 300.f }));
+
+    std::vector<int> indices;
+    EXPECT_TRUE(document.GetIntArraySubElement(root, "indices", indices));
+    EXPECT_EQ(indices, (std::vector<int>{ 0, 1, 2 }));
+    EXPECT_FALSE(document.GetIntArraySubElement(root, "bad", indices));
+
+    std::vector<uint32_t> colors;
+    EXPECT_TRUE(document.GetHexArraySubElement(root, "colors", colors));
+    EXPECT_EQ(colors, (std::vector<uint32_t>{ 0xffffff, 0x00ff00 }));
+
+    std::vector<int> none = { 1 };
+    EXPECT_TRUE(document.GetIntArraySubElement(root, "empty", none));
+    EXPECT_TRUE(none.empty());
+
+    float  floats[2];
+    size_t count = 2;
+    EXPECT_FALSE(document.GetFloatArraySubElement(root, "vertices", floats, count));
+    EXPECT_EQ(count, 4u);
+
+    int ints[3];
+    count = 3;
+    EXPECT_TRUE(document.GetIntArraySubElement(root, "indices", ints, count));
+    EXPECT_EQ(ints[2], 2);
+
+    uint32_t hex[2];
+    count = 2;
+    EXPECT_TRUE(document.GetHexArraySubElement(root, "colors", hex, count));
+    EXPECT_EQ(hex[1], 0x00ff00u);
+
+    count = 2;
+    EXPECT_FALSE(document.GetHexArraySubElement(root, "missing", hex, count));
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(LazyDocumentTest, Errors)
+{
+    LazyDocument document;
+    EXPECT_FALSE(document.Parse("<a><b></a>"));
+    EXPECT_NE(document.ErrorMessage(), nullptr);
+    EXPECT_EQ(document.Size(), 0u);
+    EXPECT_FALSE(document.Parse("<!-- nothing -->"));
+    EXPECT_FALSE(document.Open("msxmlx_missing_file.xml"));
+}
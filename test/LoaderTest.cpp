@@ -0,0 +1,214 @@
+#include <Msxmlx/Loader.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Msxmlx;
+
+namespace
+{
+size_t const FILE_COUNT = 40;
+
+// Writes files whose documents have i + 1 elements, except that every tenth one is malformed, and adds the path of
+// a file that does not exist
+class LoaderTest : public testing::TestWithParam<bool>
+{
+protected:
+    void SetUp() override
+    {
+        // The tests may run at once in separate processes, so the files of each test and process are named uniquely
+        testing::TestInfo const * pInfo = testing::UnitTest::GetInstance()->current_test_info();
+        std::string name = std::string(pInfo->test_suite_name()) + "." + pInfo->name();
+        for (char & c : name)
+        {
+            if (c == '/')
+                c = '.';
+        }
+        prefix_ = testing::TempDir() + "msxmlx_loader_test." + std::to_string(getpid()) + "." + name + ".";
+
+        for (size_t i = 0; i < FILE_COUNT; ++i)
+        {
+            paths_.push_back(prefix_ + std::to_string(i) + ".xml");
+            std::string text = "<file index='" + std::to_string(i) + "'>";
+            for (size_t j = 0; j < i; ++j)
+                text += "<child/>";
+            text += (i % 10 == 9) ? "</wrong>" : "</file>";
+
+            FILE * pFile = fopen(paths_.back().c_str(), "wb");
+            ASSERT_NE(pFile, nullptr);
+            fwrite(text.data(), 1, text.size(), pFile);
+            fclose(pFile);
+        }
+        paths_.push_back(prefix_ + "missing.xml");
+    }
+
+    void TearDown() override
+    {
+        for (std::string const & path : paths_)
+            remove(path.c_str());
+    }
+
+    // Checks the result for a file
+    static void check(LoadResult const & result)
+    {
+        if (result.index == FILE_COUNT)
+        {
+            EXPECT_STREQ(result.error, "The file could not be opened");
+        }
+        else if (result.index % 10 == 9)
+        {
+            EXPECT_NE(result.error, nullptr) << result.index;
+        }
+        else
+        {
+            ASSERT_EQ(result.error, nullptr) << result.index;
+            EXPECT_EQ(result.document.Size(), result.index + 1);
+            EXPECT_EQ(size_t(result.document.GetIntAttribute(result.document.Root(), "index")), result.index);
+        }
+    }
+
+    LoadOptions options(ThreadPool & pool) const
+    {
+        LoadOptions options;
+        options.pool        = &pool;
+        options.readAhead   = 2;
+        options.readThreads = 3;
+        options.asyncIo     = GetParam();
+        return options;
+    }
+
+    std::string              prefix_;
+    std::vector<std::string> paths_;
+};
+
+std::string ioName(testing::TestParamInfo<bool> const & info)
+{
+    return info.param ? "AsyncIo" : "Threads";
+}
+} // anonymous namespace
+
+TEST_P(LoaderTest, LoadsEveryFile)
+{
+    ThreadPool          pool(4);
+    std::mutex          mutex;
+    std::vector<size_t> counts(paths_.size(), 0);
+    LoadAll(paths_, [&] (LoadResult & result) {
+        check(result);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counts[result.index];
+    }, options(pool));
+    EXPECT_EQ(counts, std::vector<size_t>(paths_.size(), 1));
+}
+
+TEST_P(LoaderTest, CallbackExceptionIsRethrown)
+{
+    ThreadPool pool(4);
+    EXPECT_THROW(LoadAll(paths_, [&] (LoadResult & result) {
+        if (result.index == 3)
+            throw std::runtime_error("callback");
+    }, options(pool)), std::runtime_error);
+
+    // The pool and the reader are left in a state to load again
+    size_t count = 0;
+    std::mutex mutex;
+    LoadAll(paths_, [&] (LoadResult &) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+    }, options(pool));
+    EXPECT_EQ(count, paths_.size());
+}
+
+TEST_P(LoaderTest, Futures)
+{
+    LoadOptions settings;
+    settings.readAhead = 2;
+    settings.asyncIo   = GetParam();
+
+    std::vector<std::future<LoadResult>> futures = LoadAll(paths_, settings);
+    ASSERT_EQ(futures.size(), paths_.size());
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        LoadResult result = futures[i].get();
+        EXPECT_EQ(result.index, i);
+        check(result);
+    }
+}
+
+TEST_P(LoaderTest, NoFiles)
+{
+    ThreadPool pool(2);
+    size_t     count = 0;
+    LoadAll({}, [&] (LoadResult &) { ++count; }, options(pool));
+    EXPECT_EQ(count, 0u);
+    EXPECT_TRUE(LoadAll(std::vector<std::string>()).empty());
+}
+
+#if !defined(_WIN32)
+TEST_P(LoaderTest, HugeFileIsAnError)
+{
+    // The file is sparse, and the allocation for it must fail rather than succeed and be filled
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    GTEST_SKIP() << "The sanitizer aborts on a failed allocation";
+#endif
+    std::ifstream overcommit("/proc/sys/vm/overcommit_memory");
+    int           mode = 1;
+    if (!(overcommit >> mode) || mode == 1)
+        GTEST_SKIP() << "Allocations are not checked against the memory available";
+
+    std::string path = prefix_ + "huge.xml";
+    int         fd   = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    bool sized = ftruncate(fd, off_t(1) << 40) == 0;
+    close(fd);
+    paths_.push_back(path);
+    if (!sized)
+        GTEST_SKIP() << "The file system does not allow a file of 1 TiB";
+
+    ThreadPool pool(2);
+    std::mutex mutex;
+    size_t     count = 0;
+    LoadAll(paths_, [&] (LoadResult & result) {
+        if (result.index == paths_.size() - 1)
+            EXPECT_STREQ(result.error, "The file is too large to be read");
+        else
+            check(result);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+    }, options(pool));
+    EXPECT_EQ(count, paths_.size());
+}
+#endif
+
+#if defined(__linux__)
+TEST_P(LoaderTest, FileLargerThanItsSize)
+{
+    // Files in procfs have a size of 0, but are read to their end like any other
+    std::ifstream input("/proc/version", std::ios::binary);
+    std::string   text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(text.empty());
+    CompactDocument expected;
+    ASSERT_FALSE(expected.Parse(text));
+
+    ThreadPool pool(2);
+    LoadAll({ "/proc/version" }, [&] (LoadResult & result) {
+        EXPECT_STREQ(result.error, expected.ErrorMessage());
+    }, options(pool));
+}
+#endif
+
+INSTANTIATE_TEST_SUITE_P(Io, LoaderTest, testing::Bool(), ioName);
@@ -0,0 +1,76 @@
+#include <Msxmlx/Name.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Returns the byte count that precedes the characters of a BSTR
+uint32_t bstrByteCount(wchar_t const * bstr)
+{
+    uint32_t count;
+    memcpy(&count, reinterpret_cast<char const *>(bstr) - sizeof(uint32_t), sizeof(count));
+    return count;
+}
+} // anonymous namespace
+
+TEST(NameTest, Wide)
+{
+    Name name("r\xc3\xa9sum\xc3\xa9");
+    EXPECT_EQ(std::wstring(name.Wide()), L"résumé");
+    EXPECT_EQ(name.WideLength(), 6u);
+    EXPECT_EQ(bstrByteCount(name.Wide()), 6 * sizeof(wchar_t));
+    EXPECT_TRUE(name.Matches(L"résumé", 6));
+    EXPECT_FALSE(name.Matches(L"resume", 6));
+    EXPECT_FALSE(name.Matches(L"résum", 5));
+}
+
+TEST(NameTest, Hash)
+{
+    static_assert(Name::Hash("") == 2166136261u, "The hash is constexpr");
+
+    Name name("r\xc3\xa9sum\xc3\xa9\xf0\x9f\x98\x80");
+    EXPECT_EQ(name.Hash(), Name::Hash(name.Narrow()));
+    EXPECT_EQ(name.Hash(), Name::Hash(name.Wide(), name.WideLength()));
+    EXPECT_NE(Name("a").Hash(), Name("b").Hash());
+}
+
+TEST(NameTest, Copy)
+{
+    Name name("entity");
+    Name copy(name);
+    EXPECT_EQ(copy, name);
+    EXPECT_NE(copy.Wide(), name.Wide());
+
+    Name assigned("other");
+    assigned = name;
+    EXPECT_EQ(assigned, name);
+    EXPECT_TRUE(assigned.Matches(L"entity", 6));
+}
+
+TEST(NameTest, MovedFromIsEmpty)
+{
+    Name name("entity");
+    Name moved(std::move(name));
+    EXPECT_EQ(moved.Narrow(), "entity");
+    EXPECT_TRUE(moved.Matches(L"entity", 6));
+
+    EXPECT_EQ(name.Narrow(), "");
+    EXPECT_EQ(name.WideLength(), 0u);
+    ASSERT_NE(name.Wide(), nullptr);
+    EXPECT_EQ(name.Wide()[0], L'\0');
+    EXPECT_EQ(bstrByteCount(name.Wide()), 0u);
+    EXPECT_EQ(name.Hash(), Name::Hash(""));
+    EXPECT_TRUE(name.Matches(L"", 0));
+
+    Name assigned("other");
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.Narrow(), "entity");
+    EXPECT_EQ(moved, name);
+}
@@ -0,0 +1,232 @@
+#include <Msxmlx/Parallel.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+using Index = CompactDocument::Index;
+
+// Generates a random document whose elements have the numbers of their start tags as attributes. The root has
+// several sub-elements, and the other elements have a few or none.
+void generate(std::mt19937 & random, std::string & text, int depth, int & count)
+{
+    text += "<e n='" + std::to_string(count++) + "'>";
+    int children = (depth == 0) ? 8 : (depth < 5) ? int(random() % 5) : 0;
+    for (int i = 0; i < children; ++i)
+        generate(random, text, depth + 1, count);
+    text += "</e>";
+}
+
+// Returns the sub-elements of an element, serially
+std::vector<Index> children(CompactDocument const & document, Index element)
+{
+    std::vector<Index> result;
+    for (Index child = document.FirstChild(element); child != CompactDocument::NONE;
+         child       = document.NextSibling(child))
+    {
+        result.push_back(child);
+    }
+    return result;
+}
+
+// Returns the descendants of an element in document order, serially, by walking the tree
+void descendants(CompactDocument const & document, Index element, std::vector<Index> & result)
+{
+    for (Index child : children(document, element))
+    {
+        result.push_back(child);
+        descendants(document, child, result);
+    }
+}
+
+// The thread count and the grain size
+class ParallelTest : public testing::TestWithParam<std::tuple<size_t, size_t>>
+{
+protected:
+    void SetUp() override
+    {
+        std::mt19937 random(7);
+        std::string  text;
+        int          count = 0;
+        generate(random, text, 0, count);
+        ASSERT_TRUE(document_.Parse(text));
+        pool_ = std::make_unique<ThreadPool>(std::get<0>(GetParam()));
+
+        // The root, an element with children, the last element, and leaves
+        elements_ = { document_.Root(), document_.FirstChild(document_.Root()), Index(document_.Size() - 1) };
+        for (Index i = 0; i < document_.Size(); i += 37)
+            elements_.push_back(i);
+    }
+
+    size_t grain() const { return std::get<1>(GetParam()); }
+
+    // Returns the elements visited by a parallel enumeration, counting the visits to each
+    template <typename Enumerate>
+    std::vector<int> visits(Enumerate enumerate)
+    {
+        std::unique_ptr<std::atomic<int>[]> counts(new std::atomic<int>[document_.Size()]);
+        for (size_t i = 0; i < document_.Size(); ++i)
+            counts[i] = 0;
+        EXPECT_TRUE(enumerate([&] (Index element) {
+            ++counts[element];
+            return true;
+        }));
+        return std::vector<int>(counts.get(), counts.get() + document_.Size());
+    }
+
+    // Returns the visits expected for a list of elements
+    std::vector<int> expected(std::vector<Index> const & elements) const
+    {
+        std::vector<int> counts(document_.Size(), 0);
+        for (Index element : elements)
+            ++counts[element];
+        return counts;
+    }
+
+    CompactDocument             document_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<Index>          elements_;
+};
+
+std::string poolName(testing::TestParamInfo<std::tuple<size_t, size_t>> const & info)
+{
+    return "Threads" + std::to_string(std::get<0>(info.param)) + "Grain" + std::to_string(std::get<1>(info.param));
+}
+} // anonymous namespace
+
+TEST_P(ParallelTest, SubtreeEnd)
+{
+    for (Index element = 0; element < document_.Size(); ++element)
+    {
+        std::vector<Index> all;
+        descendants(document_, element, all);
+        EXPECT_EQ(Detail::subtreeEnd(document_, element), element + 1 + all.size()) << element;
+    }
+}
+
+TEST_P(ParallelTest, ForEachSubElement)
+{
+    for (Index element : elements_)
+    {
+        EXPECT_EQ(visits([&] (auto f) { return ForEachSubElementParallel(document_, element, f, grain(), *pool_); }),
+                  expected(children(document_, element)))
+            << element;
+    }
+}
+
+TEST_P(ParallelTest, ForEachDescendant)
+{
+    for (Index element : elements_)
+    {
+        std::vector<Index> all;
+        descendants(document_, element, all);
+        EXPECT_EQ(visits([&] (auto f) { return ForEachDescendantParallel(document_, element, f, grain(), *pool_); }),
+                  expected(all))
+            << element;
+    }
+}
+
+TEST_P(ParallelTest, Abort)
+{
+    // Aborting at one element returns false, and the element is visited
+    Index             target = Index(document_.Size() / 2);
+    std::atomic<bool> seen{ false };
+    EXPECT_FALSE(ForEachDescendantParallel(document_, document_.Root(), [&] (Index element) {
+        if (element != target)
+            return true;
+        seen = true;
+        return false;
+    }, grain(), *pool_));
+    EXPECT_TRUE(seen);
+
+    Index last = children(document_, document_.Root()).back();
+    EXPECT_FALSE(ForEachSubElementParallel(document_, document_.Root(), [&] (Index element) {
+        return element != last;
+    }, grain(), *pool_));
+}
+
+TEST_P(ParallelTest, Transform)
+{
+    auto number = [&] (Index element) { return document_.GetIntAttribute(element, "n"); };
+    for (Index element : elements_)
+    {
+        std::vector<int> serial;
+        for (Index child : children(document_, element))
+            serial.push_back(number(child));
+        EXPECT_EQ(TransformSubElements(document_, element, number, grain(), *pool_), serial) << element;
+    }
+}
+
+TEST_P(ParallelTest, TransformToBool)
+{
+    // std::vector<bool> packs its elements, so neighbouring results must not be written by different threads
+    auto odd = [&] (Index element) { return document_.GetIntAttribute(element, "n") % 2 != 0; };
+    for (Index element : elements_)
+    {
+        std::vector<bool> serial;
+        for (Index child : children(document_, element))
+            serial.push_back(odd(child));
+        EXPECT_EQ(TransformSubElements(document_, element, odd, grain(), *pool_), serial) << element;
+    }
+}
+
+TEST_P(ParallelTest, TransformReduce)
+{
+    // Concatenation is associative but not commutative, so the order of the results is checked too
+    auto name   = [&] (Index element) { return std::to_string(document_.GetIntAttribute(element, "n")) + ","; };
+    auto concat = [] (std::string a, std::string const & b) { return a + b; };
+    for (Index element : elements_)
+    {
+        std::string serialChildren = "init,";
+        for (Index child : children(document_, element))
+            serialChildren += name(child);
+        EXPECT_EQ(TransformReduceSubElements(document_, element, std::string("init,"), concat, name, grain(), *pool_),
+                  serialChildren)
+            << element;
+
+        std::vector<Index> all;
+        descendants(document_, element, all);
+        std::string serialDescendants = "init,";
+        for (Index descendant : all)
+            serialDescendants += name(descendant);
+        EXPECT_EQ(TransformReduceDescendants(document_, element, std::string("init,"), concat, name, grain(), *pool_),
+                  serialDescendants)
+            << element;
+    }
+}
+
+TEST_P(ParallelTest, EmptyRanges)
+{
+    // A leaf has no sub-elements or descendants, and NONE has none either
+    Index leaf = Index(document_.Size() - 1);
+    ASSERT_EQ(document_.FirstChild(leaf), CompactDocument::NONE);
+
+    int  calls = 0;
+    auto count = [&] (Index) { ++calls; return true; };
+    auto one   = [] (Index) { return 1; };
+    for (Index element : { leaf, CompactDocument::NONE })
+    {
+        EXPECT_TRUE(ForEachSubElementParallel(document_, element, count, grain(), *pool_));
+        EXPECT_TRUE(ForEachDescendantParallel(document_, element, count, grain(), *pool_));
+        EXPECT_TRUE(TransformSubElements(document_, element, one, grain(), *pool_).empty());
+        EXPECT_EQ(TransformReduceSubElements(document_, element, 5, std::plus<>(), one, grain(), *pool_), 5);
+        EXPECT_EQ(TransformReduceDescendants(document_, element, 5, std::plus<>(), one, grain(), *pool_), 5);
+    }
+    EXPECT_EQ(calls, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Pools,
+                         ParallelTest,
+                         testing::Combine(testing::Values<size_t>(1, 2, 4, 8),
+                                          testing::Values<size_t>(0, 1, 3, 64, 100000)),
+                         poolName);
@@ -0,0 +1,217 @@
+#include <Msxmlx/Path.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+char const DOCUMENT[] = R"(<world name="test" version="3">
+  <entity id="1" type="light"><name>lamp</name><health>100</health></entity>
+  <entity id="2"><name>a &amp; b</name><position x="1.5" y="-2"/></entity>
+  <entity id="3" color="ff8000"><name>third</name><light/><light on="true"/></entity>
+  <settings><render><shadows resolution="2048" enabled="1">high</shadows></render></settings>
+</world>)";
+
+// Paths that are found in the document, that are not, and that are not valid
+char const * const PATHS[] = {
+    "",
+    "@name",
+    "@version",
+    "@missing",
+    "entity",
+    "entity/@id",
+    "entity[1]/name",
+    "entity[2]/name",
+    "entity[2]/position/@x",
+    "entity[2]/position/@y",
+    "entity[3]/@color",
+    "entity[3]/light[2]/@on",
+    "entity[3]/light[3]",
+    "entity[4]/name",
+    "entity/health",
+    "entity/missing",
+    "settings/render/shadows",
+    "settings/render/shadows/@resolution",
+    "settings/render/shadows/@enabled",
+    "settings/render/shadows/@missing",
+    "settings/render/lights",
+    "missing/name",
+    "name",
+    "entity[",        // Not valid
+    "entity[2]/@id",
+    "entity//name",   // Not valid
+    "entity/@id",     // The same path again
+};
+} // anonymous namespace
+
+TEST(PathTest, CompileErrors)
+{
+    struct Case
+    {
+        char const * text;
+        char const * error;
+    };
+    Case const cases[] = {
+        { "a[0]", "A position must be a number from 1, as in name[2]" },
+        { "a[", "A position must be a number from 1, as in name[2]" },
+        { "a[]", "A position must be a number from 1, as in name[2]" },
+        { "a[x]", "A position must be a number from 1, as in name[2]" },
+        { "a[1", "A position must be a number from 1, as in name[2]" },
+        { "a[-1]", "A position must be a number from 1, as in name[2]" },
+        { "a[99999999999]", "A position must be a number from 1, as in name[2]" },
+        { "/a", "A step must have a name" },
+        { "a//b", "A step must have a name" },
+        { "[1]", "A step must have a name" },
+        { "a/", "A path cannot end with '/'" },
+        { "a[1]b", "Steps must be separated by '/'" },
+        { "a b", "Steps must be separated by '/'" },
+        { "@", "An attribute must be the last step and must have a name" },
+        { "a/@", "An attribute must be the last step and must have a name" },
+        { "@id/a", "An attribute must be the last step and must have a name" },
+        { "a/@id/", "An attribute must be the last step and must have a name" },
+        { "a/@id[1]", "An attribute must be the last step and must have a name" },
+    };
+    for (Case const & c : cases)
+    {
+        Path path = Path::Compile(c.text);
+        EXPECT_FALSE(path.IsValid()) << c.text;
+        EXPECT_STREQ(path.ErrorMessage(), c.error) << c.text;
+        EXPECT_EQ(path.Text(), c.text);
+    }
+}
+
+TEST(PathTest, CompileSteps)
+{
+    Path path = Path::Compile("render/light[12]/@color");
+    ASSERT_TRUE(path.IsValid());
+    EXPECT_EQ(path.ErrorMessage(), nullptr);
+    ASSERT_EQ(path.Steps().size(), 2u);
+    EXPECT_EQ(std::string_view(path.Steps()[0].name), "render");
+    EXPECT_EQ(path.Steps()[0].position, 1u);
+    EXPECT_EQ(std::string_view(path.Steps()[1].name), "light");
+    EXPECT_EQ(path.Steps()[1].position, 12u);
+    ASSERT_TRUE(path.HasAttribute());
+    EXPECT_EQ(std::string_view(path.Attribute()), "color");
+
+    Path empty = Path::Compile("");
+    EXPECT_TRUE(empty.IsValid());
+    EXPECT_TRUE(empty.Steps().empty());
+    EXPECT_FALSE(empty.HasAttribute());
+}
+
+TEST(PathTest, PositionalSteps)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    CompactDocument::Index root = document.Root();
+
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("entity/name"), ""), "lamp");
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("entity[1]/name"), ""), "lamp");
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("entity[2]/name"), ""), "a & b");
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("entity[3]/name"), ""), "third");
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("entity[4]/name"), "none"), "none");
+
+    // The position counts only the sub-elements with the name
+    CompactDocument::Index third = Select(document, root, Path::Compile("entity[3]"));
+    EXPECT_EQ(Select(document, root, Path::Compile("entity[3]/light[2]")),
+              document.NextSibling(document.GetSubElement(third, "light")));
+    EXPECT_EQ(Select(document, root, Path::Compile("entity[3]/light[3]")), CompactDocument::NONE);
+
+    // An empty path is the element itself
+    EXPECT_EQ(Select(document, third, Path::Compile("")), third);
+}
+
+TEST(PathTest, AttributeTerminals)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    CompactDocument::Index root = document.Root();
+
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("@name"), ""), "test");
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("@version"), 0), 3);
+    EXPECT_EQ(Get<float>(document, root, Path::Compile("entity[2]/position/@x"), 0.f), 1.5f);
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("entity[2]/position/@y"), 0), -2);
+    EXPECT_EQ(Get<uint32_t>(document, root, Path::Compile("entity[3]/@color"), 0u), 0xff8000u);
+    EXPECT_TRUE(Get<bool>(document, root, Path::Compile("entity[3]/light[2]/@on"), false));
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("settings/render/shadows/@resolution"), 0), 2048);
+
+    // Select() ignores the attribute, and returns the element that has it
+    CompactDocument::Index second = Select(document, root, Path::Compile("entity[2]"));
+    EXPECT_EQ(Select(document, root, Path::Compile("entity[2]/@id")), second);
+
+    // The value of the element, rather than an attribute
+    std::string_view value;
+    EXPECT_TRUE(Find(document, root, Path::Compile("settings/render/shadows"), value));
+    EXPECT_EQ(value, "high");
+}
+
+TEST(PathTest, DefaultsOnMiss)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    CompactDocument::Index root = document.Root();
+
+    // A missing element, a missing attribute, a name that is not in the document, an invalid value, and an invalid
+    // path all give the default value
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("entity/missing"), 7), 7);
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("entity/@missing"), 7), 7);
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("entity/@type"), 7), 7);
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("nowhere/nothing/@none"), 7), 7);
+    EXPECT_EQ(Get<int>(document, root, Path::Compile("entity/name"), 7), 7);
+    EXPECT_EQ(Get<float>(document, root, Path::Compile("entity[x]/@id"), 1.f), 1.f);
+    EXPECT_EQ(Get<std::string>(document, root, Path::Compile("entity/@missing"), "default"), "default");
+    EXPECT_EQ(Get<int>(document, CompactDocument::NONE, Path::Compile("entity/@id"), 7), 7);
+
+    // An element without text has an empty value, which is found
+    std::string_view value = "unchanged";
+    EXPECT_TRUE(Find(document, root, Path::Compile("entity[3]/light"), value));
+    EXPECT_TRUE(value.empty());
+    EXPECT_FALSE(Find(document, root, Path::Compile("entity/missing"), value));
+}
+
+TEST(PathTest, PathSetMatchesGet)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+
+    PathSet           set;
+    std::vector<Path> paths;
+    for (char const * text : PATHS)
+    {
+        paths.push_back(Path::Compile(text));
+        EXPECT_EQ(set.Add(paths.back()), paths.size() - 1);
+    }
+    EXPECT_EQ(set.Size(), paths.size());
+
+    // From every element, and from no element
+    std::vector<PathSet::Result> results;
+    for (CompactDocument::Index element = 0; element <= document.Size(); ++element)
+    {
+        CompactDocument::Index from = (element < document.Size()) ? element : CompactDocument::NONE;
+        set.Evaluate(document, from, results);
+        ASSERT_EQ(results.size(), paths.size());
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            SCOPED_TRACE(std::string(paths[i].Text()) + " from " + std::to_string(element));
+            std::string_view value;
+            bool             found = from != CompactDocument::NONE && Find(document, from, paths[i], value);
+            ASSERT_EQ(results[i].found, found);
+            if (found)
+            {
+                EXPECT_EQ(results[i].value, value);
+                EXPECT_EQ(results[i].element, Select(document, from, paths[i]));
+            }
+            EXPECT_EQ(results[i].As<std::string>("none"), Get<std::string>(document, from, paths[i], "none"));
+            EXPECT_EQ(results[i].As<int>(-1), Get<int>(document, from, paths[i], -1));
+            EXPECT_EQ(results[i].As<float>(-1.f), Get<float>(document, from, paths[i], -1.f));
+            EXPECT_EQ(results[i].As<uint32_t>(1u), Get<uint32_t>(document, from, paths[i], 1u));
+            EXPECT_EQ(results[i].As<bool>(true), Get<bool>(document, from, paths[i], true));
+        }
+    }
+}
@@ -0,0 +1,244 @@
+#include <Msxmlx/CompactDocument.h>
+#include <Msxmlx/PushParser.h>
+#include <Msxmlx/StreamReader.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Documents that are parsed whole and in pieces. The long text and tags are larger than the small window.
+std::vector<std::string> const CORPUS = {
+    R"(<?xml version="1.0" encoding="UTF-8"?>
+<!DOCTYPE world>
+<!-- A world -->
+<world name="test &amp; more" version='3'>
+  <?editor layout="wide"?>
+  <entity id="1" type="light"><name>lamp</name><health>100</health></entity>
+  <entity id="2"><name>a &lt;b&gt; &#x41;&#66; caf&#xe9; &#x1F600;</name><position x="1.5" y="-2" z="0"/></entity>
+  <skip><deep><deeper a="1">text</deeper></deep><![CDATA[x]]></skip>
+  <script><![CDATA[if (a < b && c > d) { return "]]]]><![CDATA[>"; }]]></script>
+  <mixed>one<!-- split -->two<b/>three</mixed>
+  <empty/><blank>   </blank>
+  <utf8>Größe ≤ 10 µm — 日本語</utf8>
+</world>
+)",
+    "<a/>",
+    "<a b='1'\n   c=\"2\"\t/>",
+    "<long>" + std::string(200, 'x') + "&amp;" + std::string(100, 'y') + "</long>",
+    "<tag " + std::string(40, 'n') + "='" + std::string(60, 'v') + "'><" + std::string(50, 'e') + "/></tag>",
+    "<a><b><c><d><e><f>deep</f></e></d></c></b></a>",
+};
+
+// Documents that are not well-formed
+std::vector<std::string> const MALFORMED = {
+    "",
+    "<a>",
+    "<a><b></a></b>",
+    "x<a/>",
+    "<a/><b/>",
+    "<a/>x",
+    "<a x=1/>",
+    "<a x='<'/>",
+    "<a><!-- </a>",
+    "<a><![CDATA[x</a>",
+    "<a><?pi </a>",
+    "<a>text",
+};
+
+// Records the events of a document as text, joining continued text. Elements named "skip" are skipped.
+class Recorder : public SaxHandler
+{
+public:
+    bool StartElement(StreamReader & reader) override
+    {
+        // Appended piece by piece, since GCC 12 warns wrongly (-Wrestrict) about "<" + std::string in C++20
+        events_ += '<';
+        events_ += reader.Name();
+        events_ += ' ';
+        events_ += std::to_string(reader.Depth());
+        for (Attribute const & attribute : reader.Attributes())
+        {
+            events_ += ' ';
+            events_ += attribute.name;
+            events_ += '=';
+            events_ += attribute.value;
+        }
+        events_ += reader.IsEmptyElement() ? "/>\n" : ">\n";
+        if (reader.Name() == "skip")
+            reader.Skip();
+        return true;
+    }
+
+    bool EndElement(StreamReader & reader) override
+    {
+        events_ += "</" + std::string(reader.Name()) + ">\n";
+        return true;
+    }
+
+    bool Text(StreamReader & reader) override
+    {
+        if (!reader.IsTextContinued())
+            events_ += (reader.Current() == StreamReader::Token::CData) ? "\nCDATA " : "\nText ";
+        events_ += std::string(reader.Value());
+        return true;
+    }
+
+    std::string const & Events() const { return events_; }
+
+private:
+    std::string events_;
+};
+
+// The events and result of parsing a document
+struct Parsed
+{
+    std::string events;
+    bool        ok;
+};
+
+// Parses a whole document with ParseStream()
+Parsed parseWhole(std::string const & text)
+{
+    Recorder     recorder;
+    StreamReader reader{ std::string_view(text) };
+    bool         ok = ParseStream(reader, recorder);
+    return Parsed{ recorder.Events(), ok };
+}
+
+// Parses a document given to a push parser in pieces that end at the given offsets
+Parsed parsePieces(std::string const & text, std::vector<size_t> const & ends, size_t bufferSize)
+{
+    Recorder   recorder;
+    PushParser parser(recorder, bufferSize);
+    bool       ok    = true;
+    size_t     start = 0;
+    for (size_t end : ends)
+    {
+        ok    = ok && parser.Feed(text.data() + start, end - start);
+        start = end;
+    }
+    ok = ok && parser.Feed(text.data() + start, text.size() - start);
+    ok = parser.Finish() && ok;
+    return Parsed{ recorder.Events(), ok };
+}
+
+// Builds a document from pieces that end at the given offsets. Returns an empty string if it is not well-formed,
+// or its snapshot, which is the same for identical documents.
+std::string buildPieces(std::string const & text, std::vector<size_t> const & ends, size_t bufferSize)
+{
+    CompactDocument document;
+    PushParser      parser(document, bufferSize);
+    size_t          start = 0;
+    for (size_t end : ends)
+    {
+        parser.Feed(text.data() + start, end - start);
+        start = end;
+    }
+    parser.Feed(text.data() + start, text.size() - start);
+    return parser.Finish() ? document.Snapshot() : std::string();
+}
+
+// Builds a document with CompactDocument::Parse()
+std::string buildWhole(std::string const & text)
+{
+    CompactDocument document;
+    return document.Parse(text) ? document.Snapshot() : std::string();
+}
+
+// Windows that are large enough for every document, and small enough to be filled by a tag or text
+size_t const BUFFER_SIZES[] = { StreamReader::DEFAULT_BUFFER_SIZE, 16 };
+} // anonymous namespace
+
+TEST(PushParserTest, EventsMatchAtEveryOffset)
+{
+    for (std::vector<std::string> const * pDocuments : { &CORPUS, &MALFORMED })
+    {
+        for (std::string const & text : *pDocuments)
+        {
+            Parsed expected = parseWhole(text);
+            EXPECT_EQ(expected.ok, pDocuments == &CORPUS) << text;
+            for (size_t bufferSize : BUFFER_SIZES)
+            {
+                for (size_t split = 0; split <= text.size(); ++split)
+                {
+                    Parsed parsed = parsePieces(text, { split }, bufferSize);
+                    ASSERT_EQ(parsed.ok, expected.ok) << text << "\nsplit at " << split << ", window " << bufferSize;
+                    ASSERT_EQ(parsed.events, expected.events) << "split at " << split << ", window " << bufferSize;
+                }
+            }
+        }
+    }
+}
+
+TEST(PushParserTest, EventsMatchByteByByte)
+{
+    for (std::string const & text : CORPUS)
+    {
+        std::vector<size_t> ends;
+        for (size_t end = 1; end < text.size(); ++end)
+            ends.push_back(end);
+
+        Parsed expected = parseWhole(text);
+        for (size_t bufferSize : BUFFER_SIZES)
+        {
+            Parsed parsed = parsePieces(text, ends, bufferSize);
+            EXPECT_TRUE(parsed.ok) << text;
+            EXPECT_EQ(parsed.events, expected.events) << "window " << bufferSize;
+        }
+    }
+}
+
+TEST(PushParserTest, DocumentsMatchAtEveryOffset)
+{
+    for (std::vector<std::string> const * pDocuments : { &CORPUS, &MALFORMED })
+    {
+        for (std::string const & text : *pDocuments)
+        {
+            std::string expected = buildWhole(text);
+            EXPECT_EQ(expected.empty(), pDocuments == &MALFORMED) << text;
+            for (size_t bufferSize : BUFFER_SIZES)
+            {
+                for (size_t split = 0; split <= text.size(); ++split)
+                {
+                    ASSERT_EQ(buildPieces(text, { split }, bufferSize), expected)
+                        << text << "\nsplit at " << split << ", window " << bufferSize;
+                }
+            }
+        }
+    }
+}
+
+TEST(PushParserTest, DocumentIsReplacedOnlyWhenFinished)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse("<old/>"));
+
+    PushParser parser(document);
+    ASSERT_TRUE(parser.Feed("<new><a/>"));
+    EXPECT_EQ(document.Name(document.Root()), "old");
+    ASSERT_TRUE(parser.Feed("</new>"));
+    ASSERT_TRUE(parser.Finish());
+    EXPECT_EQ(document.Name(document.Root()), "new");
+    EXPECT_FALSE(parser.Feed("<more/>"));
+}
+
+TEST(PushParserTest, ErrorsAreReported)
+{
+    Recorder   recorder;
+    PushParser parser(recorder);
+    ASSERT_TRUE(parser.Feed("<a><b>"));
+    EXPECT_FALSE(parser.Feed("</a>"));
+    EXPECT_NE(parser.ErrorMessage(), nullptr);
+    EXPECT_FALSE(parser.Finish());
+
+    PushParser incomplete(recorder);
+    ASSERT_TRUE(incomplete.Feed("<a><b/>"));
+    EXPECT_FALSE(incomplete.Finish());
+    EXPECT_NE(incomplete.ErrorMessage(), nullptr);
+}
@@ -0,0 +1,302 @@
+#include <Msxmlx/Reader.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+char const DOCUMENT[] = R"(<?xml version="1.0"?>
+<!DOCTYPE config>
+<!-- comment -->
+<config version="3" scale=' 1.5 ' mask="0xff" on="TRUE" name="a &amp; b &#x41;&#66;" list="1 2 3">
+  <render><shadows resolution="2048"/><quality>  high &lt;x&gt; </quality></render>
+  <count>42</count><flag><![CDATA[true]]></flag><hex>DEADbeef</hex><f>2.5e1</f>
+  <empty/><blank>   </blank>
+  <entity id="1"/><entity id="2"><sub>x</sub></entity><entity id="3"/>
+</config>)";
+
+// Reads a document to its end, returning the last token
+Reader::Token readAll(char const * text)
+{
+    Reader         reader(text);
+    Reader::Token  token;
+    while ((token = reader.Next()) != Reader::Token::End && token != Reader::Token::Error)
+    {
+    }
+    return token;
+}
+} // anonymous namespace
+
+TEST(ReaderTest, Tokens)
+{
+    Reader reader("<a x='1'>text<b/><![CDATA[<raw>]]></a>");
+    EXPECT_EQ(reader.Current(), Reader::Token::None);
+
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.Name(), "a");
+    EXPECT_EQ(reader.Depth(), 0);
+    EXPECT_FALSE(reader.IsEmptyElement());
+
+    ASSERT_EQ(reader.Next(), Reader::Token::Text);
+    EXPECT_EQ(reader.Value(), "text");
+
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.Name(), "b");
+    EXPECT_EQ(reader.Depth(), 1);
+    EXPECT_TRUE(reader.IsEmptyElement());
+    ASSERT_EQ(reader.Next(), Reader::Token::EndElement);
+    EXPECT_EQ(reader.Name(), "b");
+
+    ASSERT_EQ(reader.Next(), Reader::Token::CData);
+    EXPECT_EQ(reader.Value(), "<raw>");
+    EXPECT_EQ(reader.GetText(), "<raw>");
+
+    ASSERT_EQ(reader.Next(), Reader::Token::EndElement);
+    EXPECT_EQ(reader.Name(), "a");
+    EXPECT_EQ(reader.Next(), Reader::Token::End);
+}
+
+TEST(ReaderTest, Attributes)
+{
+    Reader reader("<a x='1'  y = \"2\" z='&lt;'/>");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+    for (Attribute const & attribute : reader.Attributes())
+    {
+        names.emplace_back(attribute.name);
+        values.emplace_back(attribute.value);
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{ "x", "y", "z" }));
+    EXPECT_EQ(values, (std::vector<std::string>{ "1", "2", "&lt;" }));
+
+    std::string_view value;
+    EXPECT_TRUE(reader.FindAttribute("y", value));
+    EXPECT_EQ(value, "2");
+    EXPECT_FALSE(reader.FindAttribute("w", value));
+}
+
+TEST(ReaderTest, SkipsMarkup)
+{
+    Reader reader(DOCUMENT);
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.Name(), "config");
+}
+
+TEST(ReaderTest, MalformedInput)
+{
+    char const * const documents[] =
+    {
+        "",
+        "<a>",
+        "<a><b></a></b>",
+        "x<a/>",
+        "<a/><b/>",
+        "<a/>x",
+        "<a x=1/>",
+        "<a x='1'y='2'/>",
+        "<a x='<'/>",
+        "<a><!-- </a>",
+        "<a><![CDATA[x</a>",
+        "<a><?pi </a>"
+    };
+    for (char const * document : documents)
+    {
+        EXPECT_EQ(readAll(document), Reader::Token::Error) << document;
+    }
+}
+
+TEST(ReaderTest, ErrorMessage)
+{
+    Reader reader("<a><b></a>");
+    Reader::Token token;
+    while ((token = reader.Next()) != Reader::Token::End && token != Reader::Token::Error)
+    {
+    }
+    ASSERT_EQ(token, Reader::Token::Error);
+    EXPECT_STREQ(reader.ErrorMessage(), "Mismatched end tag");
+    EXPECT_EQ(reader.Next(), Reader::Token::Error);
+}
+
+TEST(ReaderTest, Unescape)
+{
+    std::string out;
+    EXPECT_TRUE(Unescape("&lt;&gt;&amp;&quot;&apos;", out));
+    EXPECT_EQ(out, "<>&\"'");
+
+    out.clear();
+    EXPECT_TRUE(Unescape("&#65;&#x42;&#x3b1;&#x1F600;", out));
+    EXPECT_EQ(out, "AB\xce\xb1\xf0\x9f\x98\x80");
+
+    out.clear();
+    EXPECT_TRUE(Unescape("no references", out));
+    EXPECT_EQ(out, "no references");
+
+    for (char const * raw : { "&", "&amp", "&unknown;", "&#;", "&#x;", "&#xZZ;", "&#1114112;" })
+    {
+        out.clear();
+        EXPECT_FALSE(Unescape(raw, out)) << raw;
+    }
+}
+
+TEST(ReaderTest, TypedAttributes)
+{
+    Reader reader(DOCUMENT);
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    EXPECT_EQ(reader.GetIntAttribute("version"), 3);
+    EXPECT_EQ(reader.GetFloatAttribute("scale"), 1.5f);
+    EXPECT_EQ(reader.GetHexAttribute("mask"), 0xffu);
+    EXPECT_TRUE(reader.GetBoolAttribute("on"));
+    EXPECT_EQ(reader.GetStringAttribute("name"), "a & b AB");
+
+    EXPECT_EQ(reader.GetStringAttribute("missing", "default"), "default");
+    EXPECT_EQ(reader.GetIntAttribute("missing", 7), 7);
+    EXPECT_EQ(reader.GetIntAttribute("name", 7), 7);
+    EXPECT_EQ(reader.GetFloatAttribute("name", 2.f), 2.f);
+    EXPECT_EQ(reader.GetHexAttribute("name", 5), 5u);
+    EXPECT_TRUE(reader.GetBoolAttribute("name", true));
+
+    std::vector<int> list;
+    EXPECT_TRUE(reader.GetIntArrayAttribute("list", list));
+    EXPECT_EQ(list, (std::vector<int>{ 1, 2, 3 }));
+}
+
+TEST(ReaderTest, ArrayAccessors)
+{
+    Reader reader("<mesh points='0 1.5 -2e1' ids=' 1 2\t3 ' colors='ff 0x00ff00 DEADBEEF' bad='1 x'>"
+                  "<points> 1 2\n3 </points><ids>7 8</ids><colors>a 0xB</colors><bad>1 2 z</bad></mesh>");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    std::vector<float>    floats;
+    std::vector<int>      ints;
+    std::vector<uint32_t> hex;
+    EXPECT_TRUE(reader.GetFloatArrayAttribute("points", floats));
+    EXPECT_EQ(floats, (std::vector<float>{ 0.f, 1.5f, -20.f }));
+    EXPECT_TRUE(reader.GetIntArrayAttribute("ids", ints));
+    EXPECT_EQ(ints, (std::vector<int>{ 1, 2, 3 }));
+    EXPECT_TRUE(reader.GetHexArrayAttribute("colors", hex));
+    EXPECT_EQ(hex, (std::vector<uint32_t>{ 0xff, 0xff00, 0xdeadbeef }));
+
+    // Missing and malformed attributes empty the vector
+    EXPECT_FALSE(reader.GetIntArrayAttribute("bad", ints));
+    EXPECT_TRUE(ints.empty());
+    hex = { 1 };
+    EXPECT_FALSE(reader.GetHexArrayAttribute("missing", hex));
+    EXPECT_TRUE(hex.empty());
+
+    // Arrays of a fixed size report the number of values, even if they do not fit
+    int    array[2] = {};
+    size_t count    = 2;
+    EXPECT_FALSE(reader.GetIntArrayAttribute("ids", array, count));
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(array[1], 2);
+    float points[3] = {};
+    count           = 3;
+    EXPECT_TRUE(reader.GetFloatArrayAttribute("points", points, count));
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(points[2], -20.f);
+    count = 2;
+    EXPECT_FALSE(reader.GetFloatArrayAttribute("bad", points, count));
+    EXPECT_EQ(count, 0u);
+    uint32_t colors[3] = {};
+    count              = 3;
+    EXPECT_FALSE(reader.GetHexArrayAttribute("missing", colors, count));
+    EXPECT_EQ(count, 0u);
+
+    // Sub-elements
+    EXPECT_TRUE(reader.GetFloatArraySubElement("points", floats));
+    EXPECT_EQ(floats, (std::vector<float>{ 1.f, 2.f, 3.f }));
+    EXPECT_TRUE(reader.GetIntArraySubElement("ids", ints));
+    EXPECT_EQ(ints, (std::vector<int>{ 7, 8 }));
+    EXPECT_TRUE(reader.GetHexArraySubElement("colors", hex));
+    EXPECT_EQ(hex, (std::vector<uint32_t>{ 0xa, 0xb }));
+    EXPECT_FALSE(reader.GetIntArraySubElement("bad", ints));
+    EXPECT_TRUE(ints.empty());
+    count = 2;
+    EXPECT_FALSE(reader.GetIntArraySubElement("points", array, count));
+    EXPECT_EQ(count, 3u);
+    count = 3;
+    EXPECT_TRUE(reader.GetHexArraySubElement("colors", colors, count));
+    EXPECT_EQ(count, 2u);
+    count = 3;
+    EXPECT_FALSE(reader.GetFloatArraySubElement("missing", points, count));
+    EXPECT_EQ(count, 0u);
+
+    // The reader does not move
+    EXPECT_EQ(reader.Name(), "mesh");
+}
+
+TEST(ReaderTest, TypedSubElements)
+{
+    Reader reader(DOCUMENT);
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    EXPECT_EQ(reader.GetIntSubElement("count"), 42);
+    EXPECT_TRUE(reader.GetBoolSubElement("flag"));
+    EXPECT_EQ(reader.GetHexSubElement("hex"), 0xdeadbeefu);
+    EXPECT_EQ(reader.GetFloatSubElement("f"), 25.f);
+    EXPECT_EQ(reader.GetStringSubElement("empty", "z"), "");
+    EXPECT_EQ(reader.GetStringSubElement("blank", "z"), "");
+    EXPECT_EQ(reader.GetIntSubElement("blank", 7), 7);
+
+    // Only the children are searched
+    EXPECT_EQ(reader.GetStringSubElement("sub", "none"), "none");
+    EXPECT_EQ(reader.GetStringSubElement("missing", "none"), "none");
+
+    // The reader does not move
+    EXPECT_EQ(reader.Current(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.Name(), "config");
+}
+
+TEST(ReaderTest, ForEachSubElement)
+{
+    Reader reader(DOCUMENT);
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+
+    int  count = 0;
+    int  ids   = 0;
+    bool ok    = reader.ForEachSubElement([&] (Reader & element) {
+        ++count;
+        if (element.Name() == "entity")
+            ids += element.GetIntAttribute("id");
+        if (element.Name() == "render")
+        {
+            EXPECT_EQ(element.GetStringSubElement("quality"), "  high <x> ");
+            EXPECT_EQ(element.Next(), Reader::Token::StartElement);
+            EXPECT_EQ(element.GetIntAttribute("resolution"), 2048);
+        }
+        return true;
+    });
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(count, 10);
+    EXPECT_EQ(ids, 6);
+    EXPECT_EQ(reader.Current(), Reader::Token::EndElement);
+    EXPECT_EQ(reader.Name(), "config");
+    EXPECT_EQ(reader.Next(), Reader::Token::End);
+
+    Reader aborted(DOCUMENT);
+    aborted.Next();
+    count = 0;
+    EXPECT_FALSE(aborted.ForEachSubElement([&] (Reader &) { return ++count < 2; }));
+    EXPECT_EQ(count, 2);
+}
+
+TEST(ReaderTest, Skip)
+{
+    Reader reader("<a><b><c/><d>x</d></b><e/></a>");
+    reader.Next();
+    reader.Next();
+    ASSERT_EQ(reader.Name(), "b");
+    reader.Skip();
+    EXPECT_EQ(reader.Current(), Reader::Token::EndElement);
+    EXPECT_EQ(reader.Name(), "b");
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.Name(), "e");
+}
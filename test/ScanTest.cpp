@@ -0,0 +1,178 @@
+#include <Msxmlx/Scan.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+using namespace Msxmlx;
+
+namespace
+{
+// Characters that the kernels look for, and characters next to them
+char const ALPHABET[] = "abcdefgh<>&\"'/= \t\r\n\x01\x1f\x21\x7f\x80\xa0\xff";
+
+// Bytes on either side of the scanned range. They are delimiters, so a kernel that reads past either end is caught.
+char const GUARD = '<';
+
+// Largest offset from an aligned address, and largest length of the scanned range. The lengths cover several whole
+// AVX2 blocks followed by every tail length 0..63.
+size_t constexpr ALIGNMENTS = 64;
+size_t constexpr LENGTHS    = 4 * 64;
+
+class ScanTest : public ::testing::TestWithParam<Scan::Isa>
+{
+protected:
+
+    void SetUp() override
+    {
+        if (int(GetParam()) > int(Scan::Supported()))
+            GTEST_SKIP() << "The instruction set is not supported by this CPU";
+    }
+
+    // Fills the scanned range with random characters. A higher sparseness leaves longer runs without delimiters.
+    void fill(char * p, size_t length, int sparseness)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            p[i] = (random_() % sparseness == 0) ? ALPHABET[random_() % (sizeof(ALPHABET) - 1)] : 'x';
+        }
+    }
+
+    std::mt19937 random_{ 12345 };
+};
+
+// Compares the search kernels with the scalar kernels
+void expectSameSearches(Scan::Kernels const & kernels, char const * p, char const * end)
+{
+    Scan::Kernels const & reference = Scan::GetKernels(Scan::Isa::Scalar);
+    EXPECT_EQ(kernels.findChar(p, end, '<'), reference.findChar(p, end, '<'));
+    EXPECT_EQ(kernels.findChar(p, end, '\xff'), reference.findChar(p, end, '\xff'));
+    EXPECT_EQ(kernels.findEither(p, end, '"', '<'), reference.findEither(p, end, '"', '<'));
+    EXPECT_EQ(kernels.findEither(p, end, '\'', '&'), reference.findEither(p, end, '\'', '&'));
+    EXPECT_EQ(kernels.findNameEnd(p, end), reference.findNameEnd(p, end));
+    EXPECT_EQ(kernels.findEscape(p, end), reference.findEscape(p, end));
+    EXPECT_EQ(kernels.findNonAscii(p, end), reference.findNonAscii(p, end));
+    EXPECT_EQ(kernels.countTokens(p, end), reference.countTokens(p, end));
+}
+
+// Names the instantiations of the tests
+std::string isaName(::testing::TestParamInfo<Scan::Isa> const & info)
+{
+    char const * const NAMES[] = { "Scalar", "Sse2", "Avx2" };
+    return NAMES[int(info.param)];
+}
+} // anonymous namespace
+
+TEST_P(ScanTest, SearchesMatchScalar)
+{
+    Scan::Kernels const & kernels = Scan::GetKernels(GetParam());
+
+    alignas(64) char buffer[ALIGNMENTS + LENGTHS + 64];
+    for (size_t alignment = 0; alignment < ALIGNMENTS; ++alignment)
+    {
+        for (size_t length = 0; length < LENGTHS; ++length)
+        {
+            for (int sparseness : { 1, 4, 64, 1000 })
+            {
+                std::fill(std::begin(buffer), std::end(buffer), GUARD);
+                char * p = buffer + alignment;
+                fill(p, length, sparseness);
+                expectSameSearches(kernels, p, p + length);
+                if (HasFailure())
+                    FAIL() << "alignment " << alignment << ", length " << length << ", sparseness " << sparseness;
+            }
+        }
+    }
+}
+
+TEST_P(ScanTest, EveryPosition)
+{
+    Scan::Kernels const & kernels = Scan::GetKernels(GetParam());
+
+    // A single delimiter at each position, so each lane of each block is checked
+    alignas(64) char buffer[ALIGNMENTS + LENGTHS + 64];
+    for (size_t alignment = 0; alignment < ALIGNMENTS; alignment += 7)
+    {
+        for (size_t length = 1; length < LENGTHS; length += 13)
+        {
+            for (size_t position = 0; position < length; ++position)
+            {
+                for (char c : { '<', '"', '&', '>', ' ', '\x01', '\x80' })
+                {
+                    std::fill(std::begin(buffer), std::end(buffer), GUARD);
+                    char * p = buffer + alignment;
+                    std::fill(p, p + length, 'x');
+                    p[position] = c;
+                    expectSameSearches(kernels, p, p + length);
+                    if (HasFailure())
+                        FAIL() << "alignment " << alignment << ", length " << length << ", position " << position;
+                }
+            }
+        }
+    }
+}
+
+TEST_P(ScanTest, ConversionsMatchScalar)
+{
+    Scan::Kernels const & kernels   = Scan::GetKernels(GetParam());
+    Scan::Kernels const & reference = Scan::GetKernels(Scan::Isa::Scalar);
+
+    alignas(64) char    buffer[ALIGNMENTS + LENGTHS + 64];
+    alignas(64) wchar_t wide[ALIGNMENTS + LENGTHS + 64];
+    std::wstring        widened, expectedWidened;
+    std::string         narrowed, expectedNarrowed;
+    for (size_t alignment = 0; alignment < ALIGNMENTS; ++alignment)
+    {
+        for (size_t length = 0; length < LENGTHS; ++length)
+        {
+            for (int sparseness : { 1, 64 })
+            {
+                std::fill(std::begin(buffer), std::end(buffer), '\x80');
+                std::fill(std::begin(wide), std::end(wide), wchar_t(0x100));
+                char *    p  = buffer + alignment;
+                wchar_t * wp = wide + alignment;
+                fill(p, length, sparseness);
+
+                // The wide text has the same characters, including some beyond the range of a byte
+                for (size_t i = 0; i < length; ++i)
+                {
+                    uint8_t c = uint8_t(p[i]);
+                    wp[i] = (c == 0xa0) ? wchar_t(0x100 | (random_() & 0xff)) : wchar_t(c);
+                }
+
+                // The conversions must stop at the same place and write the same characters
+                widened.assign(length, L'?');
+                expectedWidened.assign(length, L'?');
+                narrowed.assign(length, '?');
+                expectedNarrowed.assign(length, '?');
+                EXPECT_EQ(kernels.widenAscii(p, p + length, &widened[0]),
+                          reference.widenAscii(p, p + length, &expectedWidened[0]));
+                EXPECT_EQ(kernels.narrowAscii(wp, wp + length, &narrowed[0]),
+                          reference.narrowAscii(wp, wp + length, &expectedNarrowed[0]));
+                EXPECT_EQ(widened, expectedWidened);
+                EXPECT_EQ(narrowed, expectedNarrowed);
+                if (HasFailure())
+                    FAIL() << "alignment " << alignment << ", length " << length << ", sparseness " << sparseness;
+            }
+        }
+    }
+}
+
+TEST_P(ScanTest, Select)
+{
+    Scan::Select(GetParam());
+    EXPECT_EQ(Scan::Selected(), GetParam());
+
+    char const text[] = "name attribute='value'>";
+    EXPECT_EQ(Scan::FindNameEnd(text, text + 22), text + 4);
+    EXPECT_EQ(Scan::FindChar(text, text + 22, '\''), text + 15);
+    EXPECT_EQ(Scan::CountTokens(text, text + 22), 2u);
+    Scan::Select(Scan::Supported());
+}
+
+INSTANTIATE_TEST_SUITE_P(Isas,
+                         ScanTest,
+                         ::testing::Values(Scan::Isa::Scalar, Scan::Isa::Sse2, Scan::Isa::Avx2),
+                         isaName);
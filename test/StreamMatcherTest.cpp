@@ -0,0 +1,319 @@
+#include <Msxmlx/StreamMatcher.h>
+
+#include <Msxmlx/CompactDocument.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Msxmlx;
+
+namespace
+{
+using Index = CompactDocument::Index;
+
+char const DOCUMENT[] = R"(<feed version="2">
+  <entry id="1"><title>First &amp; best</title><price>1.5</price></entry>
+  <entry id="2"><title>  Second</title><group><price>2.5</price></group></entry>
+  <entry id="x"><title><![CDATA[<third>]]></title></entry>
+  <price>9</price>
+</feed>)";
+
+// Returns the elements below a set of elements: the children, or the descendants at any depth. The parent of the
+// root is NONE.
+std::vector<Index> below(CompactDocument const & document, std::vector<Index> const & elements, bool bDescendants)
+{
+    std::vector<Index> result;
+    for (Index element : elements)
+    {
+        if (element == CompactDocument::NONE && !bDescendants)
+        {
+            result.push_back(document.Root());
+            continue;
+        }
+        Index              first = (element == CompactDocument::NONE) ? document.Root() : document.FirstChild(element);
+        std::vector<Index> pending(1, first);
+        while (!pending.empty())
+        {
+            Index child = pending.back();
+            pending.pop_back();
+            for (; child != CompactDocument::NONE; child = document.NextSibling(child))
+            {
+                result.push_back(child);
+                if (bDescendants)
+                    pending.push_back(document.FirstChild(child));
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// Returns the values at a path with the serial lookups of CompactDocument, sorted. This is the reference that the
+// matcher is compared with.
+std::vector<std::string> lookup(CompactDocument const & document, std::string_view path)
+{
+    std::vector<Index> elements(1, CompactDocument::NONE);
+    bool               descendant = path.substr(0, 2) == "//";
+    path.remove_prefix(descendant ? 2 : (path.substr(0, 1) == "/") ? 1 : 0);
+
+    std::vector<std::string> values;
+    for (;;)
+    {
+        size_t           end  = path.find('/');
+        std::string_view step = path.substr(0, end);
+        if (step[0] == '@')
+        {
+            // "//@name" applies to the element and all of its descendants
+            if (descendant)
+            {
+                std::vector<Index> all = below(document, elements, true);
+                elements.erase(std::remove(elements.begin(), elements.end(), CompactDocument::NONE), elements.end());
+                elements.insert(elements.end(), all.begin(), all.end());
+                std::sort(elements.begin(), elements.end());
+                elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+            }
+            for (Index element : elements)
+            {
+                std::string_view value;
+                if (document.FindAttribute(document.GetAttributes(element), step.substr(1), value))
+                    values.emplace_back(value);
+            }
+            break;
+        }
+
+        std::vector<Index> next;
+        for (Index element : below(document, elements, descendant))
+        {
+            if (step == "*" || document.Name(element) == step)
+                next.push_back(element);
+        }
+        elements = std::move(next);
+        if (end == std::string_view::npos)
+        {
+            for (Index element : elements)
+                values.emplace_back(document.Value(element));
+            break;
+        }
+        path.remove_prefix(end + 1);
+        descendant = path.substr(0, 1) == "/";
+        path.remove_prefix(descendant ? 1 : 0);
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+// Matches paths in a stream, collecting the values of each path, sorted
+class Collector
+{
+public:
+    explicit Collector(std::vector<std::string> const & paths) : values_(paths.size())
+    {
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            EXPECT_TRUE(matcher_.Add(paths[i], [this, i] (std::string_view value) {
+                values_[i].emplace_back(value);
+                return true;
+            })) << paths[i];
+        }
+    }
+
+    std::vector<std::vector<std::string>> Run(StreamReader & reader)
+    {
+        for (std::vector<std::string> & values : values_)
+            values.clear();
+        EXPECT_TRUE(matcher_.Run(reader)) << reader.ErrorMessage();
+        for (std::vector<std::string> & values : values_)
+            std::sort(values.begin(), values.end());
+        return values_;
+    }
+
+private:
+    StreamMatcher                         matcher_;
+    std::vector<std::vector<std::string>> values_;
+};
+
+// Checks the values of the paths in a document against the serial lookups, reading the document whole and in small
+// pieces through a small window
+void check(std::string const & text, std::vector<std::string> const & paths)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(text)) << document.ErrorMessage();
+    std::vector<std::vector<std::string>> expected;
+    for (std::string const & path : paths)
+        expected.push_back(lookup(document, path));
+
+    Collector    collector(paths);
+    StreamReader whole{ std::string_view(text) };
+    std::vector<std::vector<std::string>> actual = collector.Run(whole);
+    for (size_t i = 0; i < paths.size(); ++i)
+        EXPECT_EQ(actual[i], expected[i]) << paths[i];
+
+    for (size_t chunk : { 1, 3, 7 })
+    {
+        size_t       read = 0;
+        StreamReader split([&] (char * pBuffer, size_t size) {
+            size_t n = std::min({ size, chunk, text.size() - read });
+            memcpy(pBuffer, text.data() + read, n);
+            read += n;
+            return ptrdiff_t(n);
+        }, 16, 4096);
+        actual = collector.Run(split);
+        for (size_t i = 0; i < paths.size(); ++i)
+            EXPECT_EQ(actual[i], expected[i]) << paths[i] << " in pieces of " << chunk;
+    }
+}
+
+// Generates a random document of elements a, b and c with attributes, text, references and CDATA
+void generate(std::mt19937 & random, std::string & text, int depth)
+{
+    static char const * const NAMES[]  = { "a", "b", "c" };
+    static char const * const VALUES[] = { "1", "two", "&lt;3&gt;", "  4  ", "a long value that fills a window" };
+
+    std::string name = NAMES[random() % 3];
+    text += "<" + name;
+    if (random() % 2 == 0)
+        text += std::string(" id='") + VALUES[random() % 5] + "'";
+    if (random() % 3 == 0)
+        text += std::string(" x=\"") + VALUES[random() % 5] + "\"";
+    text += ">";
+
+    int children = (depth < 4) ? int(random() % 4) : 0;
+    for (int i = 0; i <= children; ++i)
+    {
+        switch (random() % 6)
+        {
+        case 0: text += "  \n "; break;
+        case 1: text += VALUES[random() % 5]; break;
+        case 2: text += "<![CDATA[ <c> ]]>"; break;
+        case 3: text += "<!-- comment -->"; break;
+        default: break;
+        }
+        if (i < children)
+            generate(random, text, depth + 1);
+    }
+    text += "</" + name + ">";
+}
+} // anonymous namespace
+
+TEST(StreamMatcherTest, ChildSteps)
+{
+    check(DOCUMENT, { "feed/entry/title", "feed/price", "feed/entry/group/price", "feed/missing", "entry" });
+}
+
+TEST(StreamMatcherTest, DescendantAndWildcardSteps)
+{
+    check(DOCUMENT, { "feed//price", "//price", "//title", "feed/*/title", "feed/*", "//*", "feed//group/*", "/feed" });
+}
+
+TEST(StreamMatcherTest, Attributes)
+{
+    check(DOCUMENT, { "feed/@version", "feed/entry/@id", "//@id", "feed//@id", "feed/*/@id", "//entry/@missing" });
+}
+
+TEST(StreamMatcherTest, InvalidPaths)
+{
+    StreamMatcher matcher;
+    for (char const * path : { "", "feed/", "feed//", "@id", "feed/@id/title", "feed/@", "feed/@*", "feed[1]", "a b" })
+    {
+        EXPECT_FALSE(matcher.Add(path, [] (std::string_view) { return true; })) << path;
+        EXPECT_NE(matcher.ErrorMessage(), nullptr) << path;
+    }
+    EXPECT_EQ(matcher.Size(), 0u);
+    EXPECT_TRUE(matcher.Add("//@id", [] (std::string_view) { return true; }));
+    EXPECT_EQ(matcher.ErrorMessage(), nullptr);
+}
+
+TEST(StreamMatcherTest, HandlersAndOutputSlots)
+{
+    CompactDocument document;
+    ASSERT_TRUE(document.Parse(DOCUMENT));
+    Index entry = document.FirstChild(document.Root());
+
+    // An output slot takes the first match in each run, as the serial lookup does. A handler sees every match.
+    std::string      title;
+    int              id      = -1;
+    float            price   = 0.f;
+    int              invalid = 7;
+    std::vector<int> ids;
+    StreamMatcher    matcher;
+    ASSERT_TRUE(matcher.Add("feed/entry/title", &title));
+    ASSERT_TRUE(matcher.Add("feed/entry/@id", &id));
+    ASSERT_TRUE(matcher.Add("feed//price", &price));
+    ASSERT_TRUE(matcher.Add("feed/@missing", &invalid));
+    ASSERT_TRUE(matcher.Add<int>("feed/entry/@id", [&] (int value) { ids.push_back(value); return true; }));
+
+    StreamReader reader{ std::string_view(DOCUMENT) };
+    ASSERT_TRUE(matcher.Run(reader));
+    EXPECT_EQ(title, document.GetStringSubElement(entry, "title"));
+    EXPECT_EQ(id, document.GetIntAttribute(entry, "id"));
+    EXPECT_EQ(price, document.GetFloatSubElement(entry, "price"));
+    EXPECT_EQ(invalid, 7);
+
+    // The value "x" is not an integer, so the typed handler skips it
+    EXPECT_EQ(ids, std::vector<int>({ 1, 2 }));
+
+    // A slot whose value is not valid is left unchanged
+    int entryId = -1;
+    StreamMatcher last;
+    ASSERT_TRUE(last.Add("feed/entry/title", &entryId));
+    StreamReader again{ std::string_view(DOCUMENT) };
+    ASSERT_TRUE(last.Run(again));
+    EXPECT_EQ(entryId, -1);
+}
+
+TEST(StreamMatcherTest, HandlerStops)
+{
+    int           count = 0;
+    StreamMatcher matcher;
+    ASSERT_TRUE(matcher.Add("//title", [&] (std::string_view) { return ++count < 2; }));
+    StreamReader reader{ std::string_view(DOCUMENT) };
+    EXPECT_FALSE(matcher.Run(reader));
+    EXPECT_EQ(count, 2);
+    EXPECT_EQ(reader.ErrorMessage(), nullptr);
+}
+
+TEST(StreamMatcherTest, ManyOverlappingPaths)
+{
+    // Every path of up to three steps, in all their combinations, added to one matcher
+    std::vector<std::string> paths;
+    for (char const * first : { "a", "*", "/a", "//a", "//*" })
+    {
+        paths.push_back(first);
+        for (char const * second : { "/b", "//b", "/*", "//*", "/@id", "//@x" })
+        {
+            std::string path = std::string(first) + second;
+            paths.push_back(path);
+            if (path.find('@') != std::string::npos)
+                continue;
+            for (char const * third : { "/c", "//a", "/*", "/@id", "//@id" })
+                paths.push_back(path + third);
+        }
+    }
+    paths.push_back("a/b");
+    paths.push_back("a/b"); // The same path twice
+
+    std::mt19937 random(3);
+    for (int i = 0; i < 20; ++i)
+    {
+        std::string text;
+        generate(random, text, 0);
+        SCOPED_TRACE(text);
+        check(text, paths);
+    }
+}
+
+TEST(StreamMatcherTest, ValuesSplitAcrossWindows)
+{
+    // Values longer than the window, with references and leading whitespace across the splits
+    std::string value(100, 'v');
+    std::string text = "<r><v>  \n" + value + "&amp;" + value + "</v><w a='" + value + "&lt;" + value + "'/>";
+    text += "<x>   <!-- c -->" + value + "</x><y><![CDATA[" + value + "]]>" + value + "</y><z>   </z></r>";
+    check(text, { "r/v", "r/w/@a", "r/x", "r/y", "r/z", "//*" });
+}
@@ -0,0 +1,425 @@
+#include <Msxmlx/StreamReader.h>
+
+#include <Msxmlx/Convert.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace Msxmlx;
+
+namespace
+{
+using Token = StreamReader::Token;
+
+char const DOCUMENT[] = R"(<world version="3" scale="1.5" mask="ff" on="true" name="a &amp; b" list="1 2 3">
+  <entity id="1"><name>lamp</name></entity>
+  <entity id="2"><part/><part><deep/></part></entity>
+  <render><shadows resolution="2048"/></render>
+</world>)";
+
+// Returns a source that returns a document a few bytes at a time
+StreamReader::Source chunks(std::string_view document, size_t chunk)
+{
+    auto pRead = std::make_shared<size_t>(0);
+    return [document, chunk, pRead] (char * pBuffer, size_t size) {
+        size_t n = std::min({ size, chunk, document.size() - *pRead });
+        memcpy(pBuffer, document.data() + *pRead, n);
+        *pRead += n;
+        return ptrdiff_t(n);
+    };
+}
+
+// Returns true if a piece of text is complete UTF-8, with no sequence cut at either end
+bool isCompleteUtf8(std::string_view text)
+{
+    for (size_t i = 0; i < text.size();)
+    {
+        uint8_t c      = uint8_t(text[i]);
+        size_t  length = (c < 0x80) ? 1 : (c >= 0xf0) ? 4 : (c >= 0xe0) ? 3 : (c >= 0xc0) ? 2 : 0;
+        if (length == 0 || i + length > text.size())
+            return false;
+        for (size_t j = 1; j < length; ++j)
+        {
+            if ((uint8_t(text[i + j]) & 0xc0) != 0x80)
+                return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+// Counts the elements of a document and sums their "id" attributes
+void summarize(StreamReader & reader, int & count, int & ids)
+{
+    count = 0;
+    ids   = 0;
+    for (Token t = reader.Next(); t != Token::End; t = reader.Next())
+    {
+        ASSERT_NE(t, Token::Error) << reader.ErrorMessage();
+        if (t == Token::StartElement)
+        {
+            ++count;
+            ids += reader.GetIntAttribute("id");
+        }
+    }
+}
+
+// Records the events of ParseStream() and stops at a given element
+class Stopper : public SaxHandler
+{
+public:
+    explicit Stopper(std::string_view stop) : stop_(stop) {}
+
+    bool StartElement(StreamReader & reader) override
+    {
+        events += '<';
+        events += reader.Name();
+        return reader.Name() != stop_;
+    }
+
+    bool EndElement(StreamReader & reader) override
+    {
+        events += '/';
+        events += reader.Name();
+        return true;
+    }
+
+    bool Text(StreamReader & reader) override
+    {
+        events += TrimWhitespace(reader.GetText());
+        return true;
+    }
+
+    std::string events;
+
+private:
+    std::string_view stop_;
+};
+} // anonymous namespace
+
+#if !defined(_WIN32)
+TEST(StreamReaderTest, FileDescriptor)
+{
+    // The document is larger than the pipe's buffer, so it is written while it is read
+    std::string document = "<list>";
+    for (int i = 0; i < 20000; ++i)
+        document += "<item id='" + std::to_string(i) + "'>text</item>";
+    document += "</list>";
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::thread writer([&] {
+        for (size_t written = 0; written < document.size();)
+        {
+            ssize_t n = write(fds[1], document.data() + written, document.size() - written);
+            if (n <= 0)
+                break;
+            written += size_t(n);
+        }
+        close(fds[1]);
+    });
+
+    StreamReader reader(fds[0], 256);
+    int          count = 0;
+    int          ids   = 0;
+    summarize(reader, count, ids);
+    writer.join();
+    close(fds[0]);
+
+    EXPECT_EQ(count, 20001);
+    EXPECT_EQ(ids, 20000 * 19999 / 2);
+    EXPECT_EQ(reader.Offset(), document.size());
+    EXPECT_EQ(reader.BufferSize(), 256u);
+}
+
+TEST(StreamReaderTest, FileDescriptorError)
+{
+    // A descriptor that cannot be read is an error, not the end of the document
+    StreamReader reader(-1);
+    EXPECT_EQ(reader.Next(), Token::Error);
+    EXPECT_STREQ(reader.ErrorMessage(), "The document could not be read");
+}
+#endif
+
+TEST(StreamReaderTest, WindowGrowsForLargeTags)
+{
+    std::string value(1000, 'v');
+    std::string document = "<a><b x='" + value + "'/><c>" + std::string(5000, 't') + "</c></a>";
+
+    StreamReader reader(chunks(document, 7), 16);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+    EXPECT_EQ(reader.BufferSize(), 16u);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+    EXPECT_EQ(reader.GetStringAttribute("x"), value);
+    EXPECT_GE(reader.BufferSize(), 1000u);
+    EXPECT_LE(reader.BufferSize(), 2048u);
+
+    // Long text is split rather than growing the window further
+    size_t size = reader.BufferSize();
+    int    count, ids;
+    summarize(reader, count, ids);
+    EXPECT_EQ(reader.BufferSize(), size);
+}
+
+TEST(StreamReaderTest, TagLargerThanMaximum)
+{
+    std::string document = "<a><b x='" + std::string(200, 'v') + "'/></a>";
+
+    StreamReader reader(chunks(document, 7), 16, 64);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+    EXPECT_EQ(reader.Next(), Token::Error);
+    EXPECT_STREQ(reader.ErrorMessage(), "A tag is larger than the maximum buffer size");
+    EXPECT_EQ(reader.BufferSize(), 64u);
+
+    // The error is returned from then on
+    EXPECT_EQ(reader.Next(), Token::Error);
+
+    // The same tag fits with a larger maximum
+    StreamReader larger(chunks(document, 7), 16, 256);
+    int          count, ids;
+    summarize(larger, count, ids);
+    EXPECT_EQ(count, 2);
+}
+
+TEST(StreamReaderTest, TextSplitsKeepReferencesAndUtf8Whole)
+{
+    // Text of references and one- to four-byte UTF-8 sequences, read through windows of several sizes
+    static char const * const PIECES[] = { "a", "&amp;", "&#x20AC;", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                                           " ", "&lt;", "bc" };
+    std::mt19937 random(11);
+    for (int trial = 0; trial < 50; ++trial)
+    {
+        std::string raw;
+        for (int i = 0; i < 200; ++i)
+            raw += PIECES[random() % (sizeof(PIECES) / sizeof(PIECES[0]))];
+        std::string expected;
+        ASSERT_TRUE(Unescape(raw, expected));
+
+        std::string document = "<a>" + raw + "</a>";
+        for (size_t window : { 16, 17, 19, 23, 32 })
+        {
+            SCOPED_TRACE(std::to_string(trial) + " in a window of " + std::to_string(window));
+            StreamReader reader(chunks(document, 1 + random() % 9), window);
+            ASSERT_EQ(reader.Next(), Token::StartElement);
+
+            std::string joined;
+            std::string text;
+            int         pieces = 0;
+            for (Token t = reader.Next(); t == Token::Text; t = reader.Next())
+            {
+                std::string_view value = reader.Value();
+                EXPECT_EQ(reader.IsTextContinued(), pieces > 0);
+                EXPECT_TRUE(isCompleteUtf8(value));
+
+                // Each part expands on its own, so no reference was cut
+                std::string part;
+                EXPECT_TRUE(Unescape(value, part)) << value;
+                EXPECT_EQ(reader.GetText(), part);
+                joined.append(value.data(), value.size());
+                text += part;
+                ++pieces;
+            }
+            EXPECT_EQ(reader.Current(), Token::EndElement);
+            EXPECT_GT(pieces, 1);
+            EXPECT_EQ(joined, raw);
+            EXPECT_EQ(text, expected);
+        }
+    }
+}
+
+TEST(StreamReaderTest, IsAtAndAncestors)
+{
+    StreamReader reader{ std::string_view(DOCUMENT) };
+    std::vector<std::string> found;
+    for (Token t = reader.Next(); t != Token::End; t = reader.Next())
+    {
+        ASSERT_NE(t, Token::Error);
+        if (t == Token::StartElement && reader.IsAt("world/entity/part"))
+        {
+            found.push_back(std::string(reader.Ancestor(0)) + "/" + std::string(reader.Ancestor(1)));
+            EXPECT_EQ(reader.Depth(), 2);
+        }
+        if (t == Token::Text && reader.IsAt("world/entity/name"))
+        {
+            EXPECT_EQ(reader.GetText(), "lamp");
+        }
+        if (t == Token::EndElement && reader.Name() == "render")
+        {
+            EXPECT_TRUE(reader.IsAt("world/render"));
+        }
+    }
+    EXPECT_EQ(found, std::vector<std::string>({ "world/entity", "world/entity" }));
+
+    // Partial paths, longer paths and paths below the current element do not match
+    StreamReader at{ std::string_view("<a><b><c/></b></a>") };
+    at.Next();
+    at.Next();
+    EXPECT_TRUE(at.IsAt("a/b"));
+    EXPECT_FALSE(at.IsAt("a"));
+    EXPECT_FALSE(at.IsAt("b"));
+    EXPECT_FALSE(at.IsAt("a/b/c"));
+    EXPECT_FALSE(at.IsAt("a/c"));
+    EXPECT_FALSE(at.IsAt(""));
+}
+
+TEST(StreamReaderTest, Skip)
+{
+    // Skipping works across windows, and does nothing on tokens other than start tags
+    StreamReader reader(chunks("<a><b><c/><d>x</d></b><e/></a>", 3), 16);
+    reader.Next();
+    reader.Next();
+    ASSERT_EQ(reader.Name(), "b");
+    reader.Skip();
+    EXPECT_EQ(reader.Current(), Token::EndElement);
+    EXPECT_EQ(reader.Name(), "b");
+    reader.Skip();
+    EXPECT_EQ(reader.Current(), Token::EndElement);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+    EXPECT_EQ(reader.Name(), "e");
+    EXPECT_TRUE(reader.IsEmptyElement());
+    reader.Skip();
+    EXPECT_EQ(reader.Current(), Token::EndElement);
+    EXPECT_EQ(reader.Name(), "e");
+}
+
+TEST(StreamReaderTest, ForEachSubElement)
+{
+    StreamReader reader(chunks(DOCUMENT, 5), 16);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+
+    std::vector<std::string> names;
+    int                      ids = 0;
+    EXPECT_TRUE(reader.ForEachSubElement([&] (StreamReader & element) {
+        names.emplace_back(element.Name());
+        ids += element.GetIntAttribute("id");
+
+        // Advancing within the sub-element does not disturb the enumeration
+        if (element.Name() == "render")
+        {
+            EXPECT_EQ(element.Next(), Token::StartElement);
+            EXPECT_EQ(element.GetIntAttribute("resolution"), 2048);
+        }
+        return true;
+    }));
+    EXPECT_EQ(names, std::vector<std::string>({ "entity", "entity", "render" }));
+    EXPECT_EQ(ids, 3);
+    EXPECT_EQ(reader.Current(), Token::EndElement);
+    EXPECT_EQ(reader.Name(), "world");
+    EXPECT_EQ(reader.Next(), Token::End);
+
+    StreamReader aborted{ std::string_view(DOCUMENT) };
+    aborted.Next();
+    int count = 0;
+    EXPECT_FALSE(aborted.ForEachSubElement([&] (StreamReader &) { return ++count < 2; }));
+    EXPECT_EQ(count, 2);
+
+    // Only a start tag has sub-elements
+    StreamReader none{ std::string_view(DOCUMENT) };
+    EXPECT_FALSE(none.ForEachSubElement([] (StreamReader &) { return true; }));
+}
+
+TEST(StreamReaderTest, TypedAttributes)
+{
+    StreamReader reader(chunks(DOCUMENT, 3), 16);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+
+    EXPECT_EQ(reader.GetIntAttribute("version"), 3);
+    EXPECT_EQ(reader.GetFloatAttribute("scale"), 1.5f);
+    EXPECT_EQ(reader.GetHexAttribute("mask"), 0xffu);
+    EXPECT_TRUE(reader.GetBoolAttribute("on"));
+    EXPECT_EQ(reader.GetStringAttribute("name"), "a & b");
+
+    std::string_view raw;
+    EXPECT_TRUE(reader.FindAttribute("name", raw));
+    EXPECT_EQ(raw, "a &amp; b");
+    EXPECT_FALSE(reader.FindAttribute("missing", raw));
+
+    // Missing and invalid values give the default
+    EXPECT_EQ(reader.GetStringAttribute("missing", "default"), "default");
+    EXPECT_EQ(reader.GetIntAttribute("missing", 7), 7);
+    EXPECT_EQ(reader.GetIntAttribute("name", 7), 7);
+    EXPECT_EQ(reader.GetFloatAttribute("name", 2.f), 2.f);
+    EXPECT_EQ(reader.GetHexAttribute("name", 5), 5u);
+    EXPECT_TRUE(reader.GetBoolAttribute("name", true));
+
+    std::vector<int> list;
+    EXPECT_TRUE(reader.GetIntArrayAttribute("list", list));
+    EXPECT_EQ(list, std::vector<int>({ 1, 2, 3 }));
+
+    // Other tokens have no attributes
+    ASSERT_EQ(reader.Next(), Token::Text);
+    EXPECT_EQ(reader.GetIntAttribute("version", 7), 7);
+    EXPECT_FALSE(reader.Attributes().begin() != reader.Attributes().end());
+}
+
+TEST(StreamReaderTest, ArrayAttributes)
+{
+    // The tag is larger than the window, which grows to hold it
+    StreamReader reader(chunks("<mesh points='0 1.5 -2e1' ids=' 1 2\t3 ' colors='ff 0x00ff00 DEADBEEF' bad='1 x'/>", 3),
+                        16);
+    ASSERT_EQ(reader.Next(), Token::StartElement);
+
+    std::vector<float>    floats;
+    std::vector<int>      ints;
+    std::vector<uint32_t> hex;
+    EXPECT_TRUE(reader.GetFloatArrayAttribute("points", floats));
+    EXPECT_EQ(floats, std::vector<float>({ 0.f, 1.5f, -20.f }));
+    EXPECT_TRUE(reader.GetIntArrayAttribute("ids", ints));
+    EXPECT_EQ(ints, std::vector<int>({ 1, 2, 3 }));
+    EXPECT_TRUE(reader.GetHexArrayAttribute("colors", hex));
+    EXPECT_EQ(hex, std::vector<uint32_t>({ 0xff, 0xff00, 0xdeadbeef }));
+    EXPECT_FALSE(reader.GetFloatArrayAttribute("bad", floats));
+    EXPECT_TRUE(floats.empty());
+    EXPECT_FALSE(reader.GetHexArrayAttribute("missing", hex));
+    EXPECT_TRUE(hex.empty());
+
+    int    array[2] = {};
+    size_t count    = 2;
+    EXPECT_FALSE(reader.GetIntArrayAttribute("ids", array, count));
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(array[1], 2);
+    float points[3] = {};
+    count           = 3;
+    EXPECT_TRUE(reader.GetFloatArrayAttribute("points", points, count));
+    EXPECT_EQ(points[2], -20.f);
+    uint32_t colors[3] = {};
+    count              = 3;
+    EXPECT_FALSE(reader.GetHexArrayAttribute("bad", colors, count));
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(StreamReaderTest, ParseStreamStops)
+{
+    // The handler stops at the first part, after the events before it
+    StreamReader reader(chunks(DOCUMENT, 4), 16);
+    Stopper      stopper("part");
+    EXPECT_FALSE(ParseStream(reader, stopper));
+    EXPECT_EQ(stopper.events, "<world<entity<namelamp/name/entity<entity<part");
+    EXPECT_EQ(reader.ErrorMessage(), nullptr);
+
+    // A handler that never stops sees every event
+    StreamReader whole(chunks(DOCUMENT, 4), 16);
+    Stopper      all("none");
+    EXPECT_TRUE(ParseStream(whole, all));
+    EXPECT_EQ(all.events, "<world<entity<namelamp/name/entity<entity<part/part<part<deep/deep/part/entity"
+                          "<render<shadows/shadows/render/world");
+
+    // A malformed document stops parsing with an error
+    StreamReader malformed{ std::string_view("<a><b></a>") };
+    Stopper      none("none");
+    EXPECT_FALSE(ParseStream(malformed, none));
+    EXPECT_STREQ(malformed.ErrorMessage(), "Mismatched end tag");
+}
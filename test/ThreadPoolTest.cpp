@@ -0,0 +1,117 @@
+#include <Msxmlx/ThreadPool.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Msxmlx;
+
+TEST(ThreadPoolTest, CoversTheRangeOnce)
+{
+    for (size_t threads : { 1, 2, 4, 8 })
+    {
+        ThreadPool                     pool(threads);
+        std::vector<std::atomic<int>> counts(10000);
+        pool.ParallelFor(0, counts.size(), 7, [&] (size_t begin, size_t end) {
+            EXPECT_LE(end - begin, 7u);
+            for (size_t i = begin; i < end; ++i)
+                ++counts[i];
+        });
+        for (std::atomic<int> const & count : counts)
+        {
+            ASSERT_EQ(count.load(), 1) << threads << " threads";
+        }
+    }
+}
+
+TEST(ThreadPoolTest, EmptyRangeAndZeroGrain)
+{
+    ThreadPool pool(4);
+    bool       called = false;
+    pool.ParallelFor(5, 5, 1, [&] (size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+
+    std::atomic<size_t> sum{ 0 };
+    pool.ParallelFor(0, 100, 0, [&] (size_t begin, size_t end) {
+        EXPECT_EQ(end - begin, 1u);
+        sum += begin;
+    });
+    EXPECT_EQ(sum.load(), 4950u);
+}
+
+TEST(ThreadPoolTest, Nested)
+{
+    ThreadPool          pool(4);
+    std::atomic<size_t> count{ 0 };
+    pool.ParallelFor(0, 16, 1, [&] (size_t, size_t) {
+        pool.ParallelFor(0, 100, 3, [&] (size_t begin, size_t end) { count += end - begin; });
+    });
+    EXPECT_EQ(count.load(), 1600u);
+}
+
+TEST(ThreadPoolTest, ExceptionIsRethrownOnTheCaller)
+{
+    for (size_t threads : { 1, 2, 4 })
+    {
+        ThreadPool pool(threads);
+
+        // Every subrange throws, so some throw on the calling thread and some on the workers
+        EXPECT_THROW(pool.ParallelFor(0, 1000, 1, [] (size_t, size_t) { throw std::runtime_error("every"); }),
+                     std::runtime_error);
+
+        // Only one subrange throws, probably on a worker
+        std::atomic<size_t> count{ 0 };
+        try
+        {
+            pool.ParallelFor(0, 1000, 1, [&] (size_t begin, size_t) {
+                if (begin == 999)
+                    throw std::out_of_range("last");
+                ++count;
+            });
+            ADD_FAILURE() << "No exception";
+        }
+        catch (std::out_of_range const & e)
+        {
+            EXPECT_STREQ(e.what(), "last");
+        }
+        EXPECT_LE(count.load(), 999u);
+
+        // The pool is still usable
+        count = 0;
+        pool.ParallelFor(0, 1000, 1, [&] (size_t begin, size_t end) { count += end - begin; });
+        EXPECT_EQ(count.load(), 1000u);
+    }
+}
+
+TEST(ThreadPoolTest, NestedException)
+{
+    ThreadPool pool(4);
+    EXPECT_THROW(pool.ParallelFor(0, 8, 1, [&] (size_t begin, size_t) {
+        pool.ParallelFor(0, 64, 1, [&] (size_t first, size_t) {
+            if (begin == 3 && first == 40)
+                throw std::logic_error("inner");
+        });
+    }), std::logic_error);
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers)
+{
+    ThreadPool               pool(4);
+    std::atomic<size_t>      count{ 0 };
+    std::vector<std::thread> callers;
+    for (int i = 0; i < 4; ++i)
+    {
+        callers.emplace_back([&] {
+            for (int j = 0; j < 20; ++j)
+                pool.ParallelFor(0, 500, 5, [&] (size_t begin, size_t end) { count += end - begin; });
+        });
+    }
+    for (std::thread & caller : callers)
+    {
+        caller.join();
+    }
+    EXPECT_EQ(count.load(), 4u * 20u * 500u);
+}
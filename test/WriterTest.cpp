@@ -0,0 +1,315 @@
+#include <Msxmlx/Reader.h>
+#include <Msxmlx/Writer.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+using namespace Msxmlx;
+
+namespace
+{
+// Writes a small document with every kind of content
+void writeDocument(Writer & writer)
+{
+    writer.Declaration();
+    writer.StartElement("world");
+    writer.StringAttribute("name", "a<b>&\"c'");
+    writer.StartElement("entity");
+    writer.IntAttribute("id", -7);
+    writer.HexAttribute("flags", 0xbeef);
+    writer.FloatAttribute("scale", 1.5f);
+    writer.BoolAttribute("visible", true);
+    writer.StringElement("name", "x & y");
+    writer.IntElement("health", 100);
+    writer.StartElement("empty");
+    writer.EndElement();
+    writer.EndElement();
+    writer.Comment(" end ");
+    writer.CData("<raw>");
+}
+} // anonymous namespace
+
+TEST(WriterTest, AttributeEscaping)
+{
+    Writer writer;
+    writer.StartElement("a");
+    writer.StringAttribute("v", "<&>\"'\t\n\r");
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(), "<a v=\"&lt;&amp;&gt;&quot;'&#9;&#10;&#13;\"/>");
+
+    // The value reads back unchanged
+    Reader reader(writer.Data());
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.GetStringAttribute("v"), "<&>\"'\t\n\r");
+}
+
+TEST(WriterTest, TextEscaping)
+{
+    Writer writer;
+    writer.StartElement("a");
+    writer.Text("<&>\"'\t\n\r");
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(), "<a>&lt;&amp;&gt;\"'\t\n&#13;</a>");
+
+    Reader reader(writer.Data());
+    ASSERT_EQ(reader.Next(), Reader::Token::StartElement);
+    EXPECT_EQ(reader.GetStringSubElement("missing", "none"), "none");
+    ASSERT_EQ(reader.Next(), Reader::Token::Text);
+    EXPECT_EQ(reader.GetText(), "<&>\"'\t\n\r");
+}
+
+TEST(WriterTest, ControlCharacters)
+{
+    // Control characters other than tab, line feed and carriage return are not allowed in XML
+    Writer writer;
+    writer.StartElement("a");
+    writer.StringAttribute("v", std::string_view("x\x01y\x1f" "z\0", 6));
+    writer.Text(std::string_view("\x02\x7f\0", 3));
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(),
+              "<a v=\"x\xef\xbf\xbdy\xef\xbf\xbdz\xef\xbf\xbd\">\xef\xbf\xbd\x7f\xef\xbf\xbd</a>");
+}
+
+TEST(WriterTest, CDataIsSplit)
+{
+    Writer writer;
+    writer.StartElement("a");
+    writer.CData("x]]>y");
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(), "<a><![CDATA[x]]]]><![CDATA[>y]]></a>");
+}
+
+TEST(WriterTest, NonAsciiIsUnchanged)
+{
+    Writer writer;
+    writer.StartElement("a");
+    writer.Text("r\xc3\xa9sum\xc3\xa9 \xf0\x9f\x98\x80");
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(), "<a>r\xc3\xa9sum\xc3\xa9 \xf0\x9f\x98\x80</a>");
+}
+
+TEST(WriterTest, SelfClosing)
+{
+    Writer writer;
+    writer.StartElement("a");
+    writer.StartElement("b");
+    writer.IntAttribute("x", 1);
+    writer.EndElement();
+    writer.StartElement("c");
+    writer.Text("");
+    writer.EndElement();
+    writer.StringElement("d", "");
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(), "<a><b x=\"1\"/><c></c><d></d></a>");
+}
+
+TEST(WriterTest, Indentation)
+{
+    Writer writer;
+    writer.SetIndentation(2);
+    writeDocument(writer);
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(),
+              "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+              "<world name=\"a&lt;b&gt;&amp;&quot;c'\">\n"
+              "  <entity id=\"-7\" flags=\"0x0000beef\" scale=\"1.5\" visible=\"true\">\n"
+              "    <name>x &amp; y</name>\n"
+              "    <health>100</health>\n"
+              "    <empty/>\n"
+              "  </entity>\n"
+              "  <!-- end --><![CDATA[<raw>]]></world>\n");
+}
+
+TEST(WriterTest, MixedContentIsNotIndented)
+{
+    Writer writer;
+    writer.SetIndentation(4);
+    writer.StartElement("p");
+    writer.Text("one ");
+    writer.StartElement("b");
+    writer.Text("two");
+    writer.EndElement();
+    writer.Text(" three");
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.Data(), "<p>one <b>two</b> three</p>\n");
+}
+
+TEST(WriterTest, Errors)
+{
+    {
+        Writer writer;
+        writer.StartElement("a");
+        writer.Declaration();
+        EXPECT_FALSE(writer.Finish());
+        EXPECT_STREQ(writer.ErrorMessage(), "The declaration must be written first");
+    }
+    {
+        Writer writer;
+        writer.StartElement("a");
+        writer.EndElement();
+        writer.StartElement("b");
+        EXPECT_FALSE(writer.Finish());
+        EXPECT_STREQ(writer.ErrorMessage(), "More than one root element");
+    }
+    {
+        Writer writer;
+        writer.StartElement("a");
+        writer.Text("x");
+        writer.IntAttribute("late", 1);
+        EXPECT_FALSE(writer.Finish());
+        EXPECT_STREQ(writer.ErrorMessage(), "Attributes must immediately follow a start tag");
+    }
+    {
+        Writer writer;
+        writer.StartElement("a");
+        writer.Comment("a--b");
+        EXPECT_FALSE(writer.Finish());
+    }
+    {
+        Writer writer;
+        writer.EndElement();
+        EXPECT_FALSE(writer.Finish());
+        EXPECT_STREQ(writer.ErrorMessage(), "There is no element to end");
+    }
+    {
+        Writer writer;
+        EXPECT_FALSE(writer.Finish());
+        EXPECT_STREQ(writer.ErrorMessage(), "No root element");
+    }
+}
+
+TEST(WriterTest, SinkReceivesChunks)
+{
+    Writer expected;
+    writeDocument(expected);
+    ASSERT_TRUE(expected.Finish());
+
+    std::string output;
+    size_t      calls = 0;
+    Writer      writer([&] (char const * pData, size_t size) {
+        EXPECT_LE(size, 64u);
+        output.append(pData, size);
+        ++calls;
+        return true;
+    }, 64);
+    writeDocument(writer);
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(output, expected.Data());
+    EXPECT_GT(calls, 1u);
+}
+
+TEST(WriterTest, SinkFailure)
+{
+    size_t calls = 0;
+    Writer writer([&] (char const *, size_t) { return ++calls < 2; }, 64);
+    for (int i = 0; i < 100; ++i)
+    {
+        writeDocument(writer);
+    }
+    EXPECT_FALSE(writer.Finish());
+    EXPECT_STREQ(writer.ErrorMessage(), "The output could not be written");
+
+    // The rest of the output is discarded
+    EXPECT_EQ(calls, 2u);
+}
+
+#if !defined(_WIN32)
+TEST(WriterTest, FileDescriptor)
+{
+    Writer expected;
+    writeDocument(expected);
+    ASSERT_TRUE(expected.Finish());
+
+    // The output passes through a pipe that is drained a few bytes at a time
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::string output;
+    std::thread reader([&] {
+        char buffer[7];
+        for (ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) > 0;)
+            output.append(buffer, size_t(n));
+    });
+
+    Writer writer(fds[1], 64);
+    writeDocument(writer);
+    EXPECT_TRUE(writer.Finish());
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+    EXPECT_EQ(output, expected.Data());
+}
+
+TEST(WriterTest, FileDescriptorPartialWrite)
+{
+    Writer expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        expected.StartElement(i == 0 ? "root" : "e");
+    }
+    ASSERT_TRUE(expected.Finish());
+
+    // The file size limit makes write() write part of a chunk, and then fail
+    char path[] = "/tmp/msxmlx_writer_XXXXXX";
+    int  fd     = mkstemp(path);
+    ASSERT_GE(fd, 0);
+
+    size_t constexpr LIMIT = 1000;
+    struct rlimit    previous;
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &previous), 0);
+    struct rlimit limit = previous;
+    limit.rlim_cur      = LIMIT;
+    void (*handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+
+    Writer writer(fd, 4096);
+    for (int i = 0; i < 1000; ++i)
+    {
+        writer.StartElement(i == 0 ? "root" : "e");
+    }
+    bool ok = writer.Finish();
+
+    setrlimit(RLIMIT_FSIZE, &previous);
+    signal(SIGXFSZ, handler);
+
+    EXPECT_FALSE(ok);
+    EXPECT_STREQ(writer.ErrorMessage(), "The output could not be written");
+
+    // What was written before the failure is the start of the output
+    std::string written(LIMIT + 1, '\0');
+    ASSERT_EQ(lseek(fd, 0, SEEK_SET), 0);
+    written.resize(size_t(read(fd, &written[0], written.size())));
+    close(fd);
+    unlink(path);
+    EXPECT_EQ(written, expected.Data().substr(0, LIMIT));
+}
+
+TEST(WriterTest, FileDescriptorError)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    close(fds[0]);
+    void (*handler)(int) = signal(SIGPIPE, SIG_IGN);
+
+    Writer writer(fds[1], 64);
+    writeDocument(writer);
+    EXPECT_FALSE(writer.Finish());
+    EXPECT_STREQ(writer.ErrorMessage(), "The output could not be written");
+
+    signal(SIGPIPE, handler);
+    close(fds[1]);
+
+    Writer closed(-1);
+    writeDocument(closed);
+    EXPECT_FALSE(closed.Finish());
+}
+#endif // !defined(_WIN32)